@@ -0,0 +1,97 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\file blockhessian.h
+///\brief Symmetric matrix stored as a set of distinct square blocks
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef MPC_WALKGEN_BLOCKHESSIAN_H
+#define MPC_WALKGEN_BLOCKHESSIAN_H
+
+#include <mpc-walkgen/api.h>
+#include <mpc-walkgen/type.h>
+#include <mpc-walkgen/constant_part_archive.h>
+#include <vector>
+
+#ifdef _MSC_VER
+# pragma warning( push )
+// C4251: class needs to have DLL interface
+# pragma warning( disable: 4251 )
+#endif
+
+namespace MPCWalkgen
+{
+  /// \brief  Symmetric matrix of size (nbBlocks*blockSize), made of
+  ///         nbBlocks*nbBlocks square blocks of size blockSize.
+  ///         Only the distinct blocks are stored: a non-zero block (row, col)
+  ///         of the upper triangular part refers to a stored block, possibly
+  ///         transposed and multiplied by a factor. The block (col, row) is
+  ///         its transpose, and blocks which are not set are zero.
+  ///         For the Zebulon objectives, this stores N*N blocks which are
+  ///         shared between the X and Y axes only once.
+  template <typename Scalar>
+  class MPC_WALKGEN_API BlockHessian
+  {
+    TEMPLATE_TYPEDEF(Scalar)
+
+    public:
+      BlockHessian();
+
+      /// \brief Set all blocks to zero and release the stored blocks
+      void reset(int nbBlocks, int blockSize);
+
+      /// \brief Store a block and return its index. If an identical block is
+      ///        already stored, its index is returned instead.
+      int addBlock(const MatrixX& block);
+
+      /// \brief Set the block (row, col) to factor times the stored block
+      ///        index, and the block (col, row) to its transpose.
+      ///        A diagonal block must be symmetric.
+      void setBlock(int row, int col, int index, Scalar factor = 1);
+
+      int rows() const;
+      int cols() const;
+      int getNbBlocks() const;
+      int getBlockSize() const;
+      int getNbStoredBlocks() const;
+      const MatrixX& getStoredBlock(int index) const;
+
+      /// \brief Value of the coefficient (i, j) of the full matrix
+      Scalar operator()(int i, int j) const;
+
+      /// \brief Add weight times the full matrix to the square sub-matrix of
+      ///        dst which starts at (first, first)
+      void addTo(MatrixX& dst, Scalar weight, int first = 0) const;
+
+      /// \brief Compute res = H*x
+      void multiply(const VectorX& x, VectorX& res) const;
+
+      MatrixX toDense() const;
+
+      /// \brief Save or load the stored blocks and their layout
+      void archive(ConstantPartArchive<Scalar>& ar);
+
+    private:
+      struct BlockEntry
+      {
+        int row;
+        int col;
+        int index;
+        Scalar factor;
+        bool transposed;
+      };
+
+      int nbBlocks_;
+      int blockSize_;
+      std::vector<MatrixX> blocks_;
+      std::vector<BlockEntry> entries_;
+  };
+}
+
+#ifdef _MSC_VER
+# pragma warning( pop )
+#endif
+
+#endif
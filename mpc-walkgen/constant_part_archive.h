@@ -0,0 +1,139 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\file constant_part_archive.h
+///\brief Serialization of the precomputed constant parts of the walkgens
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef MPC_WALKGEN_CONSTANT_PART_ARCHIVE_H
+#define MPC_WALKGEN_CONSTANT_PART_ARCHIVE_H
+
+#include <mpc-walkgen/api.h>
+#include <mpc-walkgen/type.h>
+#include <boost/cstdint.hpp>
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#ifdef _MSC_VER
+# pragma warning( push )
+// C4251: class needs to have DLL interface
+# pragma warning( disable: 4251 )
+#endif
+
+namespace MPCWalkgen
+{
+  /// \brief  Archive of the state of the models, functions and QP matrices
+  ///         of a walkgen, so that a process can restore the matrices
+  ///         computed by another one instead of computing them again.
+  ///         The same archive methods save and load a class: each value
+  ///         given to process is written by a saving archive, and
+  ///         overwritten by the next value read by a loading archive.
+  ///
+  ///         The serialized data has the following layout, in the native
+  ///         byte order:
+  ///         - "MWCP", then version and sizeof(Scalar) as 32-bit unsigned
+  ///           integers, 4 bytes of padding, and the size in bytes of the
+  ///           whole data as a 64-bit unsigned integer
+  ///         - the values, in the order in which they are processed, each
+  ///           one padded to a multiple of 8 bytes. Integers, booleans and
+  ///           sizes are 32-bit integers, matrices are their number of rows
+  ///           and columns followed by their coefficients in column-major
+  ///           order, and strings are their size followed by their bytes.
+  template <typename Scalar>
+  class MPC_WALKGEN_API ConstantPartArchive
+  {
+    TEMPLATE_TYPEDEF(Scalar)
+
+    public:
+      /// \brief Archive which serializes the processed values
+      ConstantPartArchive();
+      /// \brief Archive which reads the processed values from the size bytes
+      ///        of data, e.g. a memory-mapped file, which must outlive it.
+      ///        data does not need to be aligned. The archive is invalid if
+      ///        the header does not match this version and Scalar.
+      ConstantPartArchive(const char* data, size_t size);
+
+      inline bool isLoading() const
+      {return data_!=NULL;}
+      /// \brief False once a loading archive read inconsistent data, or
+      ///        invalidate was called. The values read since must be
+      ///        discarded.
+      inline bool isValid() const
+      {return isValid_;}
+      /// \brief Mark the archive as invalid, e.g. if the values read are not
+      ///        consistent with each other
+      void invalidate();
+      /// \brief True if a loading archive read all its data
+      bool isAtEnd() const;
+
+      /// \brief Data written by a saving archive, header included
+      const std::vector<char>& getData() const;
+      /// \brief Read serialized data, whose size is given by its header,
+      ///        from stream. Return false if it is not an archive or if
+      ///        the stream ends before its end.
+      static bool readData(std::istream& stream, std::vector<char>& data);
+
+      void process(bool& value);
+      void process(int& value);
+      void process(Scalar& value);
+      void process(std::string& value);
+      void process(std::vector<int>& value);
+
+      template <typename Derived>
+      void process(Eigen::PlainObjectBase<Derived>& m)
+      {
+        int rows = static_cast<int>(m.rows());
+        int cols = static_cast<int>(m.cols());
+        processMatrixSize(rows, cols);
+        if (isLoading())
+        {
+          if ((Derived::RowsAtCompileTime!=Eigen::Dynamic &&
+               rows!=Derived::RowsAtCompileTime) ||
+              (Derived::ColsAtCompileTime!=Eigen::Dynamic &&
+               cols!=Derived::ColsAtCompileTime))
+          {
+            invalidate();
+            return;
+          }
+          m.resize(rows, cols);
+        }
+        processData(m.data(), rows*cols);
+      }
+
+      /// \brief Process the size of a container, which must then be resized
+      ///        to the returned size before its elements are processed
+      int processSize(int size);
+
+    private:
+      static const boost::uint32_t VERSION = 1;
+      static const int HEADER_SIZE = 24;
+
+      /// \brief Write or read size bytes, followed by their padding
+      void processBytes(void* bytes, size_t size);
+      /// \brief Process the size of a matrix, which is reset to zero if it
+      ///        does not fit in the remaining data
+      void processMatrixSize(int& rows, int& cols);
+      void processData(Scalar* data, int size);
+
+      bool isValid_;
+
+      /// \brief Written data, used by a saving archive
+      std::vector<char> savedData_;
+
+      /// \brief Data read by a loading archive, NULL for a saving one, and
+      ///        offset of the next value
+      const char* data_;
+      size_t size_;
+      size_t offset_;
+  };
+}
+
+#ifdef _MSC_VER
+# pragma warning( pop )
+#endif
+
+#endif
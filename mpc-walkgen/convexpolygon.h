@@ -14,6 +14,7 @@
 
 #include <mpc-walkgen/api.h>
 #include <mpc-walkgen/type.h>
+#include <mpc-walkgen/constant_part_archive.h>
 
 #ifdef _MSC_VER
 # pragma warning( push )
@@ -52,6 +53,13 @@ namespace MPCWalkgen
       inline Scalar getYInfBound() const
       {return yInfBound_;}
 
+      /// \brief Return true if at least one edge of the convex polygon is
+      ///        parallel to axis Y, i.e. if xInfBound_ or xSupBound_ is finite
+      bool hasXBounds() const;
+      /// \brief Return true if at least one edge of the convex polygon is
+      ///        parallel to axis X, i.e. if yInfBound_ or ySupBound_ is finite
+      bool hasYBounds() const;
+
       inline const VectorX& getGeneralConstraintsMatrixCoefsForX() const
       {return generalConstraintsMatrixCoefsForX_;}
       inline const VectorX& getGeneralConstraintsMatrixCoefsForY() const
@@ -62,6 +70,13 @@ namespace MPCWalkgen
       inline int getNbGeneralConstraints() const
       {return generalConstraintsConstantPart_.rows();}
 
+      /// \brief Get the area of the convex polygon
+      inline Scalar getArea() const
+      {return computeArea(p_);}
+
+      /// \brief Save or load the vertices and the constraints built on them
+      void archive(ConstantPartArchive<Scalar>& ar);
+
       //TODO: think about changing type and tools into something else. E.g. angleBetweenVecs
       //should be in tools, but tools depends of type... Also these static attributes are an
       //ugly solution but comfortable for now.
@@ -85,6 +100,22 @@ namespace MPCWalkgen
       static int getIndexOfSmallestAngleVertice(int currentVerticeIndex,
                                                 const Vector2 &lastVertice,
                                                 const vectorOfVector2 &ptot);
+      /// \brief Return the area of the convex polygon whose counter-clockwise
+      ///        ordered vertices are p
+      static Scalar computeArea(const vectorOfVector2 &p);
+      /// \brief Return an inner approximation of the convex polygon whose
+      ///        counter-clockwise ordered vertices are p, with at most
+      ///        maxNbVertices vertices.
+      ///        Vertices are greedily removed, the one whose removal loses the
+      ///        least area first. Since the result is a subset of the vertices of p,
+      ///        it is contained in the original polygon and constraints built
+      ///        from it stay conservative. The removal stops early if the area lost
+      ///        would exceed maxAreaLossRatio times the area of p, so that the
+      ///        bound on the area loss always holds, even if it means keeping
+      ///        more than maxNbVertices vertices.
+      static vectorOfVector2 simplifyVertices(const vectorOfVector2 &p,
+                                              int maxNbVertices,
+                                              Scalar maxAreaLossRatio);
 
     private:
       /// \brief Compute Vectors generalConstraintsMatrixCoefsForX_,
@@ -0,0 +1,115 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\file explicit_mpc_table.h
+///\brief Piecewise affine control law of an explicit MPC
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef MPC_WALKGEN_EXPLICIT_MPC_TABLE_H
+#define MPC_WALKGEN_EXPLICIT_MPC_TABLE_H
+
+#include <mpc-walkgen/api.h>
+#include <mpc-walkgen/type.h>
+#include <mpc-walkgen/constant.h>
+#include <boost/cstdint.hpp>
+#include <iosfwd>
+#include <vector>
+
+#ifdef _MSC_VER
+# pragma warning( push )
+// C4251: class needs to have DLL interface
+# pragma warning( disable: 4251 )
+#endif
+
+namespace MPCWalkgen
+{
+  /// \brief  Explicit solution of a parametric QP: a set of polyhedral
+  ///         regions of the parameter space, each one with the affine law
+  ///         giving the first control of the horizon. The region r is
+  ///         {theta | a_i.theta <= b_i for each row i of r}, and the control
+  ///         in it is f_r.theta + g_r.
+  ///
+  ///         The serialized table has the following layout, in the native
+  ///         byte order, so that it can be used in place, e.g. from a
+  ///         memory-mapped file:
+  ///         - "MWEX", then version, sizeof(Scalar), nbParameters, nbRegions
+  ///           and nbRows as 32-bit unsigned integers
+  ///         - the nbRegions+1 indexes of the first row of each region, as
+  ///           32-bit unsigned integers, padded to a multiple of 8 bytes
+  ///         - the nbRegions laws (f, g), then the nbRows rows (a, b), each
+  ///           one made of nbParameters+1 scalars
+  template <typename Scalar>
+  class MPC_WALKGEN_API ExplicitMPCTable
+  {
+    TEMPLATE_TYPEDEF(Scalar)
+
+    public:
+      ExplicitMPCTable();
+
+      /// \brief Remove all the regions and set the size of the parameters
+      void reset(int nbParameters);
+
+      /// \brief Add the region {theta | a.theta <= b} with the control law
+      ///        f.theta + g
+      void addRegion(const MatrixX& a, const VectorX& b,
+                     const VectorX& f, Scalar g);
+
+      inline int getNbParameters() const
+      {return nbParameters_;}
+      inline int getNbRegions() const
+      {return nbRegions_;}
+
+      /// \brief Index of a region which contains theta, up to tolerance, or
+      ///        -1 if there is none. The region hint is tested first: the
+      ///        region found at the previous feedback period is a good one.
+      int findRegion(const VectorX& theta, int hint = -1,
+                     Scalar tolerance = Constant<Scalar>::EPSILON) const;
+
+      /// \brief Control given by the law of the region at theta
+      Scalar computeControl(int region, const VectorX& theta) const;
+      /// \brief Coefficient of theta(parameter) in the law of the region,
+      ///        i.e. the derivative of the control with respect to it
+      Scalar getLawCoefficient(int region, int parameter) const;
+
+      /// \brief Write the serialized table
+      void save(std::ostream& stream) const;
+      /// \brief Read a serialized table, which is copied. Return false, and
+      ///        leave the table empty, if it is not valid for Scalar.
+      bool load(std::istream& stream);
+      /// \brief Use the serialized table of size bytes at data in place,
+      ///        without any copy. data must be aligned on 8 bytes and must
+      ///        outlive the table. Return false, and leave the table empty,
+      ///        if it is not valid for Scalar.
+      bool setData(const char* data, size_t size);
+
+    private:
+      static const boost::uint32_t VERSION = 1;
+      static const int HEADER_SIZE = 24;
+
+      /// \brief Size in bytes of the offsets, with their padding
+      static size_t getOffsetsSize(int nbRegions);
+      /// \brief Point to the owned storage
+      void useOwnedStorage();
+
+      int nbParameters_;
+      int nbRegions_;
+      int nbRows_;
+
+      /// \brief Owned storage, not used when a table is used in place
+      std::vector<boost::uint32_t> ownedOffsets_;
+      std::vector<Scalar> ownedLaws_;
+      std::vector<Scalar> ownedRows_;
+
+      const boost::uint32_t* offsets_;
+      const Scalar* laws_;
+      const Scalar* rows_;
+  };
+}
+
+#ifdef _MSC_VER
+# pragma warning( pop )
+#endif
+
+#endif
@@ -0,0 +1,395 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\file fixed_horizon_walkgen.h
+///\brief Walkgens whose number of samples is fixed at compile time
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef MPC_WALKGEN_FIXED_HORIZON_WALKGEN_H
+#define MPC_WALKGEN_FIXED_HORIZON_WALKGEN_H
+
+#include <mpc-walkgen/trajectory_walkgen_type.h>
+#include <mpc-walkgen/zebulon_walkgen.h>
+#include <mpc-walkgen/qpsolverfactory.h>
+#include <mpc-walkgen/lineardynamic.h>
+#include <mpc-walkgen/constant.h>
+#include <mpc-walkgen/tools.h>
+#include <boost/scoped_ptr.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/static_assert.hpp>
+
+namespace MPCWalkgen
+{
+  /// \brief  Trajectory walkgen with N samples of the same period, N being
+  ///         fixed at compile time. It solves the same problem as
+  ///         TrajectoryWalkgen, but its dynamics, objectives and constraints
+  ///         are fixed-size matrices, so that their products are unrolled
+  ///         and vectorized, and it is header-only, so that it can be
+  ///         instantiated for any N. The QP is only copied in the buffers of
+  ///         the solver, allocated by the setters of the constant part:
+  ///         solving and setting the references and the state does not
+  ///         allocate any memory.
+  ///         Different sampling periods, move blocking, the explicit MPC and
+  ///         the feedback gain are not supported. Fixed-size members are
+  ///         not meant for large horizons, where TrajectoryWalkgen must be
+  ///         used.
+  template <typename Scalar, int N>
+  class FixedHorizonTrajectoryWalkgen : boost::noncopyable
+  {
+    BOOST_STATIC_ASSERT(N>0);
+    TEMPLATE_TYPEDEF(Scalar)
+
+  public:
+    typedef Eigen::Matrix<Scalar, N, 1> VectorN;
+    typedef Eigen::Matrix<Scalar, N, N> MatrixN;
+    typedef Eigen::Matrix<Scalar, N, 3> MatrixN3;
+    typedef Eigen::Matrix<Scalar, 2*N, 1> Vector2N;
+    typedef Eigen::Matrix<Scalar, 2*N, N> Matrix2NN;
+    typedef Eigen::Matrix<Scalar, 2*N, 3> Matrix2N3;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    FixedHorizonTrajectoryWalkgen()
+    :samplingPeriod_(1.0)
+    ,velLimit_(1.0)
+    ,accLimit_(1.0)
+    ,jerkLimit_(1.0)
+    ,state_(Vector3::Zero())
+    ,velRef_(VectorN::Zero())
+    ,posRef_(VectorN::Zero())
+    ,X_(VectorN::Zero())
+    ,dX_(VectorX::Zero(N))
+    ,jerk_(0)
+    ,timeSinceLastShift_(0)
+    {
+      computeDynamics();
+      computeLimits();
+      computeConstantPart();
+    }
+
+    static int getNbSamples()
+    {return N;}
+
+    void setSamplingPeriod(Scalar samplingPeriod)
+    {
+      assert(samplingPeriod>0.0);
+
+      samplingPeriod_ = samplingPeriod;
+      computeDynamics();
+      computeConstantPart();
+    }
+
+    void setVelRefInWorldFrame(const VectorN& velRef)
+    {
+      assert(velRef==velRef);
+      velRef_ = velRef;
+    }
+
+    void setPosRefInWorldFrame(const VectorN& posRef)
+    {
+      assert(posRef==posRef);
+      posRef_ = posRef;
+    }
+
+    void setVelLimit(Scalar limit)
+    {
+      assert(limit>=0);
+      velLimit_ = limit;
+      computeLimits();
+    }
+
+    void setAccLimit(Scalar limit)
+    {
+      assert(limit>=0);
+      accLimit_ = limit;
+      computeLimits();
+    }
+
+    void setJerkLimit(Scalar limit)
+    {
+      assert(limit>=0);
+      jerkLimit_ = limit;
+    }
+
+    /// \brief The state is (Position, Velocity, Acceleration)
+    void setState(const Vector3& state)
+    {
+      assert(state==state);
+      state_ = state;
+    }
+
+    void setWeightings(const TrajectoryWalkgenWeighting<Scalar>& weighting)
+    {
+      assert(weighting.velocityTracking>=0);
+      assert(weighting.positionTracking>=0);
+      assert(weighting.jerkMinimization>=0);
+
+      weighting_ = weighting;
+      computeConstantPart();
+    }
+
+    /// \brief withFeedbackGain must not be set. withPeriodWeighting has no
+    ///        effect, all the periods being the same
+    void setConfig(const TrajectoryWalkgenConfig<Scalar>& config)
+    {
+      assert(!config.withFeedbackGain);
+
+      config_ = config;
+      computeConstantPart();
+    }
+
+    bool solve(Scalar feedBackPeriod)
+    {
+      assert(feedBackPeriod>0);
+
+      p_.noalias() = Q_*X_;
+      if (weighting_.velocityTracking>0.0)
+      {
+        tmp_.noalias() = velS_*state_;
+        tmp_ -= velRef_;
+        p_.noalias() += velGradient_*tmp_;
+      }
+      if (weighting_.positionTracking>0.0)
+      {
+        tmp_.noalias() = posS_*state_;
+        tmp_ -= posRef_;
+        p_.noalias() += posGradient_*tmp_;
+      }
+      qpMatrix_.p = p_;
+
+      if (config_.withMotionConstraints)
+      {
+        ctrValue_.noalias() = ctrS_*state_;
+        ctrValue_.noalias() += ctrU_*X_;
+        qpMatrix_.bl = -limits_ - ctrValue_;
+        qpMatrix_.bu = limits_ - ctrValue_;
+
+        qpMatrix_.xl = VectorN::Constant(-jerkLimit_) - X_;
+        qpMatrix_.xu = VectorN::Constant(jerkLimit_) - X_;
+      }
+
+      bool solutionFound = qpSolver_->solve(qpMatrix_, dX_, true);
+
+      X_ += dX_;
+
+      jerk_ = X_(0);
+      Tools::ConstantJerkDynamic<Scalar>::updateState(jerk_, feedBackPeriod, state_);
+
+      if (config_.withWarmStartShift && solutionFound)
+      {
+        timeSinceLastShift_ += feedBackPeriod;
+        if (timeSinceLastShift_ > samplingPeriod_ - Constant<Scalar>::EPSILON)
+        {
+          timeSinceLastShift_ -= samplingPeriod_;
+          shiftWarmStart();
+        }
+      }
+
+      return solutionFound;
+    }
+
+    const Vector3& getState() const
+    {return state_;}
+
+    /// \brief Jerk of the first sample given by the last solve
+    Scalar getJerk() const
+    {return jerk_;}
+
+  private:
+    /// \brief Copy the dynamics of the position, velocity and acceleration
+    ///        computed by Tools in the fixed-size matrices
+    void computeDynamics()
+    {
+      LinearDynamic<Scalar> dyn;
+
+      Tools::ConstantJerkDynamic<Scalar>::computePosDynamic(samplingPeriod_, samplingPeriod_,
+                                                            N, dyn);
+      posU_ = dyn.U;
+      posS_ = dyn.S;
+
+      Tools::ConstantJerkDynamic<Scalar>::computeVelDynamic(samplingPeriod_, samplingPeriod_,
+                                                            N, dyn);
+      velU_ = dyn.U;
+      velS_ = dyn.S;
+      ctrU_.template topRows<N>() = dyn.U;
+      ctrS_.template topRows<N>() = dyn.S;
+
+      Tools::ConstantJerkDynamic<Scalar>::computeAccDynamic(samplingPeriod_, samplingPeriod_,
+                                                            N, dyn);
+      ctrU_.template bottomRows<N>() = dyn.U;
+      ctrS_.template bottomRows<N>() = dyn.S;
+    }
+
+    void computeLimits()
+    {
+      limits_.template head<N>().fill(velLimit_);
+      limits_.template tail<N>().fill(accLimit_);
+    }
+
+    /// \brief Compute the Hessian and the gradient factors, and allocate
+    ///        the solver and its QP once for the next solves
+    void computeConstantPart()
+    {
+      const int M = config_.withMotionConstraints ? 2*N : 0;
+
+      Q_.noalias() = weighting_.velocityTracking*velU_.transpose()*velU_;
+      Q_.noalias() += weighting_.positionTracking*posU_.transpose()*posU_;
+      Q_.diagonal().array() += weighting_.jerkMinimization;
+
+      velGradient_ = weighting_.velocityTracking*velU_.transpose();
+      posGradient_ = weighting_.positionTracking*posU_.transpose();
+
+      qpSolver_.reset(makeQPSolver<Scalar>(N, M));
+
+      qpMatrix_.Q = Q_;
+      qpMatrix_.p.setZero(N);
+      qpMatrix_.xl.setConstant(N, Scalar(-10e10));
+      qpMatrix_.xu.setConstant(N, Scalar(10e10));
+      if (config_.withMotionConstraints)
+      {
+        qpMatrix_.A = ctrU_;
+      }
+      else
+      {
+        qpMatrix_.A.setZero(0, N);
+      }
+      qpMatrix_.At = qpMatrix_.A.transpose();
+      qpMatrix_.bl.setZero(M);
+      qpMatrix_.bu.setZero(M);
+      qpMatrix_.notifyMatricesChanged();
+    }
+
+    /// \brief Shift X_ and the multipliers of the jerk bounds, then of the
+    ///        velocity and acceleration rows, by one sample
+    void shiftWarmStart()
+    {
+      for(int i=0; i<N-1; ++i)
+      {
+        X_(i) = X_(i+1);
+      }
+
+      qpSolver_->getDualSolution(dual_);
+      assert(dual_.size()%N == 0);
+      Tools::shiftSamples<Scalar>(dual_, 0, N, static_cast<int>(dual_.size())/N);
+      qpSolver_->setDualGuess(dual_);
+    }
+
+  private:
+    Scalar samplingPeriod_;
+    Scalar velLimit_;
+    Scalar accLimit_;
+    Scalar jerkLimit_;
+    Vector3 state_;
+
+    TrajectoryWalkgenWeighting<Scalar> weighting_;
+    TrajectoryWalkgenConfig<Scalar> config_;
+
+    /// \brief Dynamics of the position and of the velocity, and of the
+    ///        constrained velocities then accelerations
+    MatrixN posU_;
+    MatrixN3 posS_;
+    MatrixN velU_;
+    MatrixN3 velS_;
+    Matrix2NN ctrU_;
+    Matrix2N3 ctrS_;
+    Vector2N limits_;
+
+    /// \brief Weighted hessian, and weighted U^T of the tracking objectives
+    MatrixN Q_;
+    MatrixN velGradient_;
+    MatrixN posGradient_;
+
+    VectorN velRef_;
+    VectorN posRef_;
+
+    VectorN X_;
+    VectorN p_;
+    VectorN tmp_;
+    Vector2N ctrValue_;
+
+    boost::scoped_ptr< QPSolver<Scalar> > qpSolver_;
+    QPMatrices<Scalar> qpMatrix_;
+    VectorX dX_;
+    VectorX dual_;
+
+    /// \brief Jerk applied by the last solve, before the warm start shift
+    Scalar jerk_;
+    /// \brief Time elapsed since the last shift of the warm start
+    Scalar timeSinceLastShift_;
+  };
+
+  /// \brief  ZebulonWalkgen with N samples, set at construction and which
+  ///         cannot be changed. Unlike FixedHorizonTrajectoryWalkgen, it is a
+  ///         wrapper of the dynamic walkgen, whose matrices keep dynamic
+  ///         sizes. The references have fixed-size types, of size
+  ///         2N, and are copied in buffers allocated once: solving and
+  ///         setting the references does not allocate any memory.
+  ///         setNbSamples, setSamplingPeriods, reserveMaxSamples and
+  ///         setHorizonTunerConfig, which change or prepare a change of the
+  ///         number of samples, are hidden. They are not virtual, so they
+  ///         can still be called through a ZebulonWalkgen reference, which
+  ///         must not be done. Neither must a constant part of another
+  ///         number of samples be loaded.
+  template <typename Scalar, int N>
+  class FixedHorizonZebulonWalkgen : public ZebulonWalkgen<Scalar>
+  {
+    BOOST_STATIC_ASSERT(N>0);
+    TEMPLATE_TYPEDEF(Scalar)
+    typedef ZebulonWalkgen<Scalar> Base;
+
+  public:
+    typedef Eigen::Matrix<Scalar, 2*N, 1> Vector2N;
+
+    FixedHorizonZebulonWalkgen()
+    :velRef_(VectorX::Zero(2*N))
+    ,posRef_(VectorX::Zero(2*N))
+    ,copRef_(VectorX::Zero(2*N))
+    ,comRef_(VectorX::Zero(2*N))
+    {
+      Base::setNbSamples(N);
+      Base::setVelRefInWorldFrame(velRef_);
+      Base::setPosRefInWorldFrame(posRef_);
+      Base::setCopRefInLocalFrame(copRef_);
+      Base::setComRefInLocalFrame(comRef_);
+    }
+
+    void setVelRefInWorldFrame(const Vector2N& velRef)
+    {
+      velRef_ = velRef;
+      Base::setVelRefInWorldFrame(velRef_);
+    }
+
+    void setPosRefInWorldFrame(const Vector2N& posRef)
+    {
+      posRef_ = posRef;
+      Base::setPosRefInWorldFrame(posRef_);
+    }
+
+    void setCopRefInLocalFrame(const Vector2N& copRef)
+    {
+      copRef_ = copRef;
+      Base::setCopRefInLocalFrame(copRef_);
+    }
+
+    void setComRefInLocalFrame(const Vector2N& comRef)
+    {
+      comRef_ = comRef;
+      Base::setComRefInLocalFrame(comRef_);
+    }
+
+  private:
+    using Base::setNbSamples;
+    using Base::setSamplingPeriods;
+    using Base::reserveMaxSamples;
+    using Base::setHorizonTunerConfig;
+
+    VectorX velRef_;
+    VectorX posRef_;
+    VectorX copRef_;
+    VectorX comRef_;
+  };
+}
+
+#endif
@@ -40,6 +40,8 @@ namespace MPCWalkgen{
       ///        It is a vector of size 2*N, with N the number of samples
       ///        (refX, refY)
       void setVelRefInWorldFrame(const VectorX& velRefInWorldFrame);
+      inline const VectorX& getVelRefInWorldFrame() const
+      {return velRefInWorldFrame_;}
 
     private:
       const LIPModel<Scalar>& lipModel_;
@@ -37,7 +37,7 @@ namespace MPCWalkgen
     const NoDynamicModel<Scalar>& model_;
 
     VectorX function_;
-    MatrixX gradient_;
+    VectorX gradient_;
     MatrixX hessian_;
   };
 
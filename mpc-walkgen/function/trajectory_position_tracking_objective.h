@@ -33,6 +33,8 @@ namespace MPCWalkgen
 
     /// \brief Set the base position reference in the world frame
     void setPosRefInWorldFrame(const VectorX& posRefInWorldFrame);
+    inline const VectorX& getPosRefInWorldFrame() const
+    {return posRefInWorldFrame_;}
 
     void computeConstantPart();
 
@@ -33,6 +33,8 @@ namespace MPCWalkgen
 
     /// \brief Set the base velocity reference in the world frame
     void setVelRefInWorldFrame(const VectorX& velRefInWorldFrame);
+    inline const VectorX& getVelRefInWorldFrame() const
+    {return velRefInWorldFrame_;}
 
     void computeConstantPart();
 
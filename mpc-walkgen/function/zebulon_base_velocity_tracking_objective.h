@@ -12,6 +12,7 @@
 #define MPC_WALKGEN_FUNCTION_ZEBULON_BASE_VELOCITY_TRACKING_OBJECTIVE_H
 
 #include <mpc-walkgen/type.h>
+#include <mpc-walkgen/blockhessian.h>
 #include <mpc-walkgen/model/zebulon_base_model.h>
 
 #ifdef _MSC_VER
@@ -31,27 +32,59 @@ namespace MPCWalkgen
     BaseVelocityTrackingObjective(const BaseModel<Scalar>& baseModel);
     ~BaseVelocityTrackingObjective();
 
-    const MatrixX& getGradient(const VectorX& x0);
-    const MatrixX& getHessian();
+    const VectorX& getGradient(const VectorX& x0);
+    /// \brief Part of the gradient which does not depend on x0:
+    ///        getGradient(x0) = getHessian()*x0 + getLinearTerm()
+    const VectorX& getLinearTerm();
+    /// \brief Linear term of the objective on the first nbSamples samples
+    ///        of the model only, as for a model of nbSamples samples, with
+    ///        blocks of nbSamples values. The dynamics being causal, it is
+    ///        computed on the first rows and columns of the current ones
+    typename VectorX::ConstSegmentReturnType getLinearTerm(int nbSamples);
+    const BlockHessian<Scalar>& getHessian();
 
     /// \brief Set the base velocity reference in the world frame
     ///        It's a vector of size 2*N, where N is the number of samples
     ///        of the base model:
     ///        (refX, refY)
     void setVelRefInWorldFrame(const VectorX& velRefInWorldFrame);
+    inline const VectorX& getVelRefInWorldFrame() const
+    {return velRefInWorldFrame_;}
+    /// \brief Shift the reference by one sample, and set its last sample:
+    ///        (refX, refY)
+    void pushVelRefInWorldFrame(const Vector2& velRefInWorldFrame);
 
     void computeConstantPart();
 
+    /// \brief Save or load the constant part, the references and the
+    ///        buffers. The models are archived separately
+    void archive(ConstantPartArchive<Scalar>& ar);
+
+  protected:
+    /// \brief Compute refTerm_ from the whole reference
+    void computeRefTerm();
+    /// \brief Set linearTerm_ to the part of the linear term which depends
+    ///        on the state, on the first nbSamples samples of the model
+    void computeStateTerm(int nbSamples);
+
   protected:
     const BaseModel<Scalar>& baseModel_;
 
     VectorX velRefInWorldFrame_;
 
     VectorX function_;
-    MatrixX gradient_;
-    MatrixX hessian_;
+    VectorX gradient_;
+    VectorX linearTerm_;
+    BlockHessian<Scalar> hessian_;
 
     VectorX tmp_;
+
+    /// \brief Part of the linear term which depends on the reference:
+    ///         refTerm_ = refGradient_*velRefInWorldFrame_
+    VectorX refTerm_;
+    MatrixX refGradient_;
+    /// \brief Whether refTerm_ can be shifted with the reference
+    bool refTermIsShiftable_;
   };
 }
 
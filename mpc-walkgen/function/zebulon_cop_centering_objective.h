@@ -12,6 +12,7 @@
 #define MPC_WALKGEN_FUNCTION_ZEBULON_COP_CENTERING_OBJECTIVE_H
 
 #include <mpc-walkgen/type.h>
+#include <mpc-walkgen/blockhessian.h>
 #include <mpc-walkgen/model/zebulon_base_model.h>
 #include <mpc-walkgen/model/lip_model.h>
 
@@ -32,17 +33,41 @@ namespace MPCWalkgen
     CopCenteringObjective(const LIPModel<Scalar>& lipModel, const BaseModel<Scalar>& baseModel);
     ~CopCenteringObjective();
 
-    const MatrixX& getGradient(const VectorX& x0);
-    const MatrixX& getHessian();
+    const VectorX& getGradient(const VectorX& x0);
+    /// \brief Part of the gradient which does not depend on x0:
+    ///        getGradient(x0) = getHessian()*x0 + getLinearTerm()
+    const VectorX& getLinearTerm();
+    /// \brief Linear term of the objective on the first nbSamples samples
+    ///        of the models only, as for models of nbSamples samples, with
+    ///        blocks of nbSamples values. The dynamics being causal, it is
+    ///        computed on the first rows and columns of the current ones
+    typename VectorX::ConstSegmentReturnType getLinearTerm(int nbSamples);
+    const BlockHessian<Scalar>& getHessian();
 
     /// \brief Set the CoP reference in the world frame
     ///        It's a vector of size 2*N, where N is the number of samples
     ///        of the lip/base model:
     ///        (refX, refY)
     void setCopRefInLocalFrame(const VectorX& copRefInWorldFrame);
+    inline const VectorX& getCopRefInLocalFrame() const
+    {return copRefInLocalFrame_;}
+    /// \brief Shift the reference by one sample, and set its last sample:
+    ///        (refX, refY)
+    void pushCopRefInLocalFrame(const Vector2& copRefInLocalFrame);
 
     void computeConstantPart();
 
+    /// \brief Save or load the constant part, the references and the
+    ///        buffers. The models are archived separately
+    void archive(ConstantPartArchive<Scalar>& ar);
+
+  private:
+    /// \brief Compute refTerm_ from the whole reference
+    void computeRefTerm();
+    /// \brief Set linearTerm_ to the part of the linear term which depends
+    ///        on the states, on the first nbSamples samples of the models
+    void computeStateTerm(int nbSamples);
+
   private:
     const LIPModel<Scalar>& lipModel_;
     const BaseModel<Scalar>& baseModel_;
@@ -50,10 +75,18 @@ namespace MPCWalkgen
     VectorX copRefInLocalFrame_;
 
     VectorX function_;
-    MatrixX gradient_;
-    MatrixX hessian_;
+    VectorX gradient_;
+    VectorX linearTerm_;
+    BlockHessian<Scalar> hessian_;
 
     VectorX tmp_;
+
+    /// \brief Part of the linear term which depends on the reference:
+    ///         refTerm_ = refGradient_*copRefInLocalFrame_
+    VectorX refTerm_;
+    MatrixX refGradient_;
+    /// \brief Whether refTerm_ can be shifted with the reference
+    bool refTermIsShiftable_;
   };
 
 }
@@ -32,28 +32,46 @@ namespace MPCWalkgen
     CopConstraint(const LIPModel<Scalar>& lipModel, const BaseModel<Scalar>& baseModel);
     ~CopConstraint();
 
-    const VectorX& getFunction(const VectorX& x0);
+    /// \brief The constraints are getFunctionInf(x0) <= getGradient()*dX
+    ///        <= getFunctionSup(x0). The first rows are the general constraints
+    ///        of the support convex polygon, they only have a lower bound.
+    ///        They are followed by N range rows on the CoP X position if the
+    ///        polygon has edges parallel to axis Y, and N range rows on the
+    ///        CoP Y position if it has edges parallel to axis X.
+    const VectorX& getFunctionInf(const VectorX& x0);
+    const VectorX& getFunctionSup(const VectorX& x0);
     const MatrixX& getGradient();
 
     int getNbConstraints();
 
     void computeConstantPart();
 
+    /// \brief Save or load the constant part, the references and the
+    ///        buffers. The models are archived separately
+    void archive(ConstantPartArchive<Scalar>& ar);
+
   private:
-    /// \brief Compute the constraints inequalities : A X + b <= 0
+    /// \brief Compute the general constraints inequalities : A X + b <= 0
     void computeconstraintMatrices();
+    /// \brief Compute relPos_, the CoP position relative to the base
+    void computeRelativePosition(const VectorX& x0);
 
   private:
     const LIPModel<Scalar>& lipModel_;
     const BaseModel<Scalar>& baseModel_;
 
-    VectorX function_;
+    VectorX functionInf_;
+    VectorX functionSup_;
     MatrixX gradient_;
     MatrixX hessian_;
 
     MatrixX A_;
     VectorX b_;
 
+    /// \brief Gradient of the CoP position relative to the base
+    MatrixX relPosGradient_;
+    VectorX relPos_;
+
     VectorX tmp_;
 
   };
@@ -12,6 +12,7 @@
 #define MPC_WALKGEN_FUNCTION_ZEBULON_JERK_MINIMIZATION_OBJECTIVE_H
 
 #include <mpc-walkgen/type.h>
+#include <mpc-walkgen/blockhessian.h>
 #include <mpc-walkgen/model/zebulon_base_model.h>
 #include <mpc-walkgen/model/lip_model.h>
 
@@ -33,17 +34,21 @@ namespace MPCWalkgen
     ~JerkMinimizationObjective();
 
     const VectorX& getGradient(const VectorX& x0);
-    const MatrixX& getHessian();
+    const BlockHessian<Scalar>& getHessian();
 
     void computeConstantPart();
 
+    /// \brief Save or load the constant part, the references and the
+    ///        buffers. The models are archived separately
+    void archive(ConstantPartArchive<Scalar>& ar);
+
   private:
     const LIPModel<Scalar>& lipModel_;
     const BaseModel<Scalar>& baseModel_;
 
     VectorX function_;
-    MatrixX gradient_;
-    MatrixX hessian_;
+    VectorX gradient_;
+    BlockHessian<Scalar> hessian_;
   };
 
 }
@@ -12,6 +12,7 @@
 #define MPC_WALKGEN_FUNCTION_ZEBULON_TILT_MINIMIZATION_OBJECTIVE_H
 
 #include <mpc-walkgen/type.h>
+#include <mpc-walkgen/blockhessian.h>
 #include <mpc-walkgen/model/zebulon_base_model.h>
 #include <mpc-walkgen/model/lip_model.h>
 
@@ -32,19 +33,46 @@ namespace MPCWalkgen
     TiltMinimizationObjective(const LIPModel<Scalar>& lipModel, const BaseModel<Scalar>& baseModel);
     ~TiltMinimizationObjective();
 
-    const MatrixX& getGradient(const VectorX& x0);
-    const MatrixX& getHessian();
+    const VectorX& getGradient(const VectorX& x0);
+    /// \brief Part of the gradient which does not depend on x0:
+    ///        getGradient(x0) = getHessian()*x0 + getLinearTerm()
+    const VectorX& getLinearTerm();
+    /// \brief Linear term of the objective on the first nbSamples samples
+    ///        of the models only, as for models of nbSamples samples, with
+    ///        blocks of nbSamples values. The dynamics being causal, it is
+    ///        computed on the first rows and columns of the current ones
+    typename VectorX::ConstSegmentReturnType getLinearTerm(int nbSamples);
+    const BlockHessian<Scalar>& getHessian();
 
     void updateTiltContactPoint();
     void computeConstantPart();
 
+    /// \brief Save or load the constant part, the references and the
+    ///        buffers. The models are archived separately
+    void archive(ConstantPartArchive<Scalar>& ar);
+
+    /// \brief Tilt angles along X and Y at the N samples, for the jerks x0
+    ///        applied from the given CoM and base states
+    void computeTiltAngles(const VectorX& x0,
+                           const Vector3& comStateX, const Vector3& comStateY,
+                           const Vector3& baseStateX, const Vector3& baseStateY,
+                           VectorX& tiltX, VectorX& tiltY) const;
+
+  private:
+    /// \brief Set linearTerm_ to the linear term, on the first nbSamples
+    ///        samples of the models
+    void computeStateTerm(int nbSamples);
+
   private:
     const LIPModel<Scalar>& lipModel_;
     const BaseModel<Scalar>& baseModel_;
 
     VectorX function_;
-    MatrixX gradient_;
-    MatrixX hessian_;
+    VectorX gradient_;
+    VectorX linearTerm_;
+    VectorX tmpX_;
+    VectorX tmpY_;
+    BlockHessian<Scalar> hessian_;
 
     MatrixX uInv_;
     LinearDynamic<Scalar> dynB_;
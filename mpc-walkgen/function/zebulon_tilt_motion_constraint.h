@@ -39,6 +39,10 @@ namespace MPCWalkgen
 
     void computeConstantPart();
 
+    /// \brief Save or load the constant part, the references and the
+    ///        buffers. The models are archived separately
+    void archive(ConstantPartArchive<Scalar>& ar);
+
 
   private:
     const LIPModel<Scalar>& lipModel_;
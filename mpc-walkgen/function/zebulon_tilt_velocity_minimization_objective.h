@@ -12,6 +12,7 @@
 #ifndef MPC_WALKGEN_FUNCTION_ZEBULON_TILT_VELOCITY_MINIMIZATION_OBJECTIVE_H
 #define MPC_WALKGEN_FUNCTION_ZEBULON_TILT_VELOCITY_MINIMIZATION_OBJECTIVE_H
 
+#include <mpc-walkgen/blockhessian.h>
 #include <mpc-walkgen/model/zebulon_base_model.h>
 #include <mpc-walkgen/model/lip_model.h>
 
@@ -33,19 +34,39 @@ namespace MPCWalkgen
                                  const BaseModel<Scalar>& baseModel);
     ~TiltVelMinimizationObjective();
 
-    const MatrixX& getGradient(const VectorX& x0);
-    const MatrixX& getHessian();
+    const VectorX& getGradient(const VectorX& x0);
+    /// \brief Part of the gradient which does not depend on x0:
+    ///        getGradient(x0) = getHessian()*x0 + getLinearTerm()
+    const VectorX& getLinearTerm();
+    /// \brief Linear term of the objective on the first nbSamples samples
+    ///        of the models only, as for models of nbSamples samples, with
+    ///        blocks of nbSamples values. The dynamics being causal, it is
+    ///        computed on the first rows and columns of the current ones
+    typename VectorX::ConstSegmentReturnType getLinearTerm(int nbSamples);
+    const BlockHessian<Scalar>& getHessian();
 
     void updateTiltContactPoint();
     void computeConstantPart();
 
+    /// \brief Save or load the constant part, the references and the
+    ///        buffers. The models are archived separately
+    void archive(ConstantPartArchive<Scalar>& ar);
+
+  private:
+    /// \brief Set linearTerm_ to the linear term, on the first nbSamples
+    ///        samples of the models
+    void computeStateTerm(int nbSamples);
+
   private:
     const LIPModel<Scalar>& lipModel_;
     const BaseModel<Scalar>& baseModel_;
 
     VectorX function_;
-    MatrixX gradient_;
-    MatrixX hessian_;
+    VectorX gradient_;
+    VectorX linearTerm_;
+    VectorX tmpX_;
+    VectorX tmpY_;
+    BlockHessian<Scalar> hessian_;
 
     MatrixX uInv_;
     LinearDynamic<Scalar> dynB_;
@@ -0,0 +1,108 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\file horizon_tuner.h
+///\brief Choose the number of samples of a walkgen from its solve times
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef MPC_WALKGEN_HORIZON_TUNER_H
+#define MPC_WALKGEN_HORIZON_TUNER_H
+
+#include <mpc-walkgen/api.h>
+#include <mpc-walkgen/type.h>
+#include <vector>
+
+#ifdef _MSC_VER
+# pragma warning( push )
+// C4251: class needs to have DLL interface
+# pragma warning( disable: 4251 )
+#endif
+
+namespace MPCWalkgen
+{
+  template <typename Scalar>
+  struct HorizonTunerConfig
+  {
+    HorizonTunerConfig()
+    :minNbSamples(1)
+    ,maxNbSamples(1)
+    ,nbSamplesStep(1)
+    ,solveTimeBudget(0)
+    ,percentile(0.95f)
+    ,windowSize(50)
+    ,increaseRatio(0.6f)
+    {}
+
+    /// \brief Bounds of the number of samples, and the step by which it is
+    ///        decreased or increased
+    int minNbSamples;
+    int maxNbSamples;
+    int nbSamplesStep;
+
+    /// \brief Budget, in seconds, for the percentile of the solve times.
+    ///        The tuning is disabled if it is not positive
+    Scalar solveTimeBudget;
+    Scalar percentile;
+    /// \brief Number of the last solve times taken into account
+    int windowSize;
+    /// \brief The number of samples is increased when the percentile of
+    ///        the solve times is below increaseRatio*solveTimeBudget
+    Scalar increaseRatio;
+  };
+
+  /// \brief Monitor the solve times of a walkgen over a sliding window, and
+  ///        decrease its number of samples when their percentile exceeds
+  ///        the budget, or increase it when they are well below, so that it
+  ///        degrades gracefully under CPU contention.
+  ///        Once the number of samples changes, the window is cleared, and
+  ///        it must be full again before the next change.
+  template <typename Scalar>
+  class MPC_WALKGEN_API HorizonTuner
+  {
+    public:
+      HorizonTuner();
+
+      void setConfig(const HorizonTunerConfig<Scalar>& config);
+      inline const HorizonTunerConfig<Scalar>& getConfig() const
+      {return config_;}
+
+      inline bool isEnabled() const
+      {return config_.solveTimeBudget>0;}
+
+      /// \brief Add the time of a solve with nbSamples samples, in
+      ///        seconds, and return the number of samples to use for the
+      ///        next solves. It is nbSamples, unless the window is full and
+      ///        the budget is exceeded or well respected, or nbSamples is
+      ///        out of the bounds
+      int addSolveTime(Scalar solveTime, int nbSamples);
+
+      /// \brief Percentile of the solve times of the window, or 0 if it is
+      ///        empty
+      Scalar getSolveTimePercentile() const;
+
+      inline int getNbSolveTimes() const
+      {return nbSolveTimes_;}
+
+      /// \brief Clear the window
+      void reset();
+
+    private:
+      HorizonTunerConfig<Scalar> config_;
+
+      /// \brief Circular buffer of windowSize solve times, nextSolveTime_
+      ///        being the index of the next one
+      std::vector<Scalar> solveTimes_;
+      int nbSolveTimes_;
+      int nextSolveTime_;
+      /// \brief Copy of the window, partially sorted to find the percentile
+      mutable std::vector<Scalar> sortedSolveTimes_;
+  };
+}
+
+#ifdef _MSC_VER
+# pragma warning( pop )
+#endif
+
+#endif
@@ -136,22 +136,22 @@ namespace MPCWalkgen
       inline const MatrixX& getRotationMatrixT() const
       {return rotationMatrixT_;}
 
-      inline const VectorX& getLeftFootStateX() const
+      inline const Vector3& getLeftFootStateX() const
       {return leftFootModel_.getStateX();}
 
-      inline const VectorX& getLeftFootStateY() const
+      inline const Vector3& getLeftFootStateY() const
       {return leftFootModel_.getStateY();}
 
-      inline const VectorX& getLeftFootStateZ() const
+      inline const Vector3& getLeftFootStateZ() const
       {return leftFootModel_.getStateZ();}
 
-      inline const VectorX& getRightFootStateX() const
+      inline const Vector3& getRightFootStateX() const
       {return rightFootModel_.getStateX();}
 
-      inline const VectorX& getRightFootStateY() const
+      inline const Vector3& getRightFootStateY() const
       {return rightFootModel_.getStateY();}
 
-      inline const VectorX& getRightFootStateZ() const
+      inline const Vector3& getRightFootStateZ() const
       {return rightFootModel_.getStateZ();}
 
       /// \brief Methods used to size the QP problem solvers and matrices vectors
@@ -165,9 +165,9 @@ namespace MPCWalkgen
       /// \brief Return the kinematic convex polygon of the stepIndex-th previewed step
       const ConvexPolygon<Scalar>& getKinematicConvexPolygon(int stepIndex) const;
       /// \brief Return X state of the current support foot
-      const VectorX& getSupportFootStateX() const;
+      const Vector3& getSupportFootStateX() const;
       /// \brief Return Y state of the current support foot
-      const VectorX& getSupportFootStateY() const;
+      const Vector3& getSupportFootStateY() const;
       /// \brief Return the number of feedback period before the beginning next QP sample
       int getNbOfCallsBeforeNextSample() const;
 
@@ -181,8 +181,20 @@ namespace MPCWalkgen
       /// \brief Update left and right foot states
       void updateFeetStates(const VectorX& stepVec,
                             Scalar feedBackPeriod);
+      /// \brief Write the feet states during the last update, at t = k*dt
+      ///        for k = 1..nbSetpoints, with k*dt up to its feedback period.
+      ///        setpoints must hold 18*nbSetpoints values: for the left foot
+      ///        then the right foot, along X, Y and Z, the positions,
+      ///        velocities and accelerations, each as nbSetpoints
+      ///        consecutive values.
+      void computeFeetSetpoints(Scalar dt, int nbSetpoints, Scalar* setpoints);
       void computeConstantPart();
 
+      /// \brief Copy the state of supervisor: feet states, timeline and timers.
+      ///        The step and double support periods are kept: they apply to
+      ///        the phases which follow the current one.
+      void copyStateFrom(const HumanoidFeetSupervisor& supervisor);
+
     private:
       /// \brief Called by the constructor
       void init();
@@ -193,6 +205,8 @@ namespace MPCWalkgen
       void setPhase(typename Phase<Scalar>::PhaseType phaseType);
       /// \brief Shorten the QP variable accordingly to the FSM
       void shortenStepVec(VectorX& variable) const;
+      /// \brief Keep the nbSteps first steps of the QP variable
+      void shortenStepVecTo(VectorX& variable, int nbSteps) const;
       /// \brief Enlarge the QP variable accordingly to the FSM
       void enlargeStepVec(VectorX& variable) const;
 
@@ -213,7 +227,7 @@ namespace MPCWalkgen
       Scalar feedbackPeriod_;
 
       HumanoidFootModel<Scalar> leftFootModel_, rightFootModel_;
-      mutable VectorX middleState_;
+      mutable Vector3 middleState_;
       mutable ConvexPolygon<Scalar> copDSConvexPolygon_;
       mutable vectorOfVector2 copDSpoints_;
 
@@ -242,6 +256,15 @@ namespace MPCWalkgen
 
       boost::circular_buffer<Phase<Scalar> > timeline_;
       Phase<Scalar> phase_;
+
+      /// \brief Interpolations of the flying foot during the last update,
+      ///        along X, Y and Z, used by computeFeetSetpoints
+      typename Phase<Scalar>::PhaseType lastUpdatePhaseType_;
+      bool lastUpdateHasFlyingFoot_;
+      Scalar lastUpdateFeedbackPeriod_;
+      Vector3 lastUpdateInitialStates_[3];
+      Vector3 lastUpdateObjStates_[3];
+      Scalar lastUpdatePeriods_[3];
   };
 }
 #ifdef _MSC_VER
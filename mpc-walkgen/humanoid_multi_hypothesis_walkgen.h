@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\file humanoid_multi_hypothesis_walkgen.h
+///\brief Humanoid walkgen evaluating several step timings at once
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef MPC_WALKGEN_HUMANOID_MULTI_HYPOTHESIS_WALKGEN_H
+#define MPC_WALKGEN_HUMANOID_MULTI_HYPOTHESIS_WALKGEN_H
+
+#include <mpc-walkgen/api.h>
+#include <mpc-walkgen/type.h>
+#include <mpc-walkgen/humanoid_walkgen.h>
+#include <mpc-walkgen/walkgen_scheduler.h>
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/noncopyable.hpp>
+
+#ifdef _MSC_VER
+# pragma warning( push )
+// C4251: class needs to have DLL interface
+// C4275: non dll-interface class used as base for dll-interface class
+# pragma warning( disable: 4251 4275)
+#endif
+
+namespace MPCWalkgen
+{
+  /// \brief  Set of HumanoidWalkgen, one per hypothesis on the step timing,
+  ///         e.g. several step periods or double support lengths for push
+  ///         recovery. Each hypothesis has its own supervisor timeline,
+  ///         selection matrices, QP matrices and solvers, so that their QP
+  ///         can be solved in parallel.
+  ///         At each solve, the feasible hypothesis with the lowest cost is
+  ///         selected, and its state is copied to the other ones: they all
+  ///         start the next solve from the committed plan, with their own
+  ///         timing for the phases which follow the current one.
+  template <typename Scalar>
+  class MPC_WALKGEN_API HumanoidMultiHypothesisWalkgen : boost::noncopyable
+  {
+    TEMPLATE_TYPEDEF(Scalar)
+  public:
+    explicit HumanoidMultiHypothesisWalkgen(int nbHypotheses);
+    ~HumanoidMultiHypothesisWalkgen();
+
+    inline int getNbHypotheses() const
+    {return static_cast<int>(hypotheses_.size());}
+
+    /// \brief Walkgen of a hypothesis. All the hypotheses must be given the
+    ///        same configuration, states and references, except for their
+    ///        step period and initial double support length.
+    inline HumanoidWalkgen<Scalar>& getHypothesis(int index)
+    {return hypotheses_[index];}
+    inline const HumanoidWalkgen<Scalar>& getHypothesis(int index) const
+    {return hypotheses_[index];}
+
+    /// \brief Number of threads solving the hypotheses, 1 by default
+    void setNbThreads(int nbThreads);
+
+    /// \brief Solve all the hypotheses and commit the feasible one with the
+    ///        lowest cost. If none of them is feasible, the first hypothesis
+    ///        is committed and false is returned.
+    bool solve(Scalar feedBackPeriod);
+
+    /// \brief Index of the hypothesis committed by the last solve
+    inline int getSelectedHypothesis() const
+    {return selectedHypothesis_;}
+
+    /// \brief Walkgen of the committed hypothesis, which gives the states
+    inline const HumanoidWalkgen<Scalar>& getSelectedWalkgen() const
+    {return hypotheses_[selectedHypothesis_];}
+
+  private:
+    boost::ptr_vector< HumanoidWalkgen<Scalar> > hypotheses_;
+    boost::scoped_ptr<WalkgenScheduler> scheduler_;
+    int selectedHypothesis_;
+  };
+}
+
+#ifdef _MSC_VER
+# pragma warning( pop )
+#endif
+
+#endif
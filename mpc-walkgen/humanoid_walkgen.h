@@ -88,31 +88,31 @@ namespace MPCWalkgen
     void setComStateY(const VectorX& state);
     void setComStateZ(const VectorX& state);
 
-    inline const VectorX& getLeftFootStateX() const
+    inline const Vector3& getLeftFootStateX() const
     {return feetSupervisor_.getLeftFootStateX();}
 
-    inline const VectorX& getLeftFootStateY() const
+    inline const Vector3& getLeftFootStateY() const
     {return feetSupervisor_.getLeftFootStateY();}
 
-    inline const VectorX& getLeftFootStateZ() const
+    inline const Vector3& getLeftFootStateZ() const
     {return feetSupervisor_.getLeftFootStateZ();}
 
-    inline const VectorX& getRightFootStateX() const
+    inline const Vector3& getRightFootStateX() const
     {return feetSupervisor_.getRightFootStateX();}
 
-    inline const VectorX& getRightFootStateY() const
+    inline const Vector3& getRightFootStateY() const
     {return feetSupervisor_.getRightFootStateY();}
 
-    inline const VectorX& getRightFootStateZ() const
+    inline const Vector3& getRightFootStateZ() const
     {return feetSupervisor_.getRightFootStateZ();}
 
-    inline const VectorX& getComStateX() const
+    inline const Vector3& getComStateX() const
     {return lipModel_.getStateX();}
 
-    inline const VectorX& getComStateY() const
+    inline const Vector3& getComStateY() const
     {return lipModel_.getStateY();}
 
-    inline const VectorX& getComStateZ() const
+    inline const Vector3& getComStateZ() const
     {return lipModel_.getStateZ();}
 
     ///  \brief Set the maximum height that both feet can reach during a step
@@ -148,9 +148,39 @@ namespace MPCWalkgen
     ///        new samples are sent to the actuators
     bool solve(Scalar feedBackPeriod);
 
+    /// \brief Value of the weighted objectives on the trajectory previewed
+    ///        by the last solve, e.g. to compare several walkgens
+    inline Scalar getCost() const
+    {return cost_;}
+
+    /// \brief Copy the state of walkgen: CoM and feet states, footsteps
+    ///        timeline and warm start. Both walkgens must have the same
+    ///        configuration, except for their step and double support
+    ///        periods, which are kept and apply from the next phase.
+    void copyStateFrom(const HumanoidWalkgen& walkgen);
+
+    /// \brief Write the states reached during the feedback period of the
+    ///        last solve, at t = k*dt for k = 1..nbSetpoints, e.g. to send
+    ///        setpoints to the actuators at a higher rate than the MPC.
+    ///        nbSetpoints*dt must not exceed the feedback period.
+    ///        setpoints must hold 24*nbSetpoints values: the CoM along X and
+    ///        Y, then the left foot and the right foot along X, Y and Z. For
+    ///        each of them, the positions, velocities and accelerations are
+    ///        written as nbSetpoints consecutive values.
+    void computeSetpoints(Scalar dt, int nbSetpoints, Scalar* setpoints);
+
   private:
     void computeConstantPart();
     void convertCopInLFtoComJerk();
+    /// \brief Compute cost_ from transformedX_, before the update of the
+    ///        CoM state
+    void computeCost();
+    /// \brief Shift the CoP part of X_ by one sample, and build a guess of
+    ///        the next working set from the multipliers of solver
+    void shiftWarmStart(const QPSolver<Scalar>& solver, int nbCtrCop);
+    /// \brief Apply the polygon simplification requested in config_
+    ConvexPolygon<Scalar> simplifyConvexPolygon(
+        const ConvexPolygon<Scalar>& convexPolygon) const;
 
   private:
 
@@ -187,12 +217,35 @@ namespace MPCWalkgen
     HumanoidWalkgenWeighting<Scalar> weighting_;
     HumanoidWalkgenConfig<Scalar> config_;
 
+    /// \brief Convex polygons of the feet as given by the user, before
+    ///        simplification
+    ConvexPolygon<Scalar> leftFootKinematicConvexPolygon_;
+    ConvexPolygon<Scalar> rightFootKinematicConvexPolygon_;
+    ConvexPolygon<Scalar> leftFootCopConvexPolygon_;
+    ConvexPolygon<Scalar> rightFootCopConvexPolygon_;
+
     int maximumNbOfConstraints_;
     int maximumNbOfSteps_;
 
     bool move_;
     bool firstCallSinceLastDS_;
 
+    /// \brief Time elapsed since the last shift of the warm start
+    Scalar timeSinceLastShift_;
+    /// \brief Guess of the multipliers of the next QP, only used if its size
+    ///        does not change
+    VectorX dual_;
+    bool hasDualGuess_;
+
+    Scalar cost_;
+
+    /// \brief CoM states and jerks of the last solve, before the update
+    Vector3 lastComStateX_;
+    Vector3 lastComStateY_;
+    Scalar lastComJerkX_;
+    Scalar lastComJerkY_;
+    Scalar lastFeedBackPeriod_;
+
   };
 }
 
@@ -38,10 +38,32 @@ namespace MPCWalkgen
     HumanoidWalkgenConfig()
     :withCopConstraints(false)
     ,withFeetConstraints(false)
+    ,withPresolve(false)
+    ,withWarmStartShift(false)
+    ,maxNbPolygonVertices(0)
+    ,maxPolygonAreaLossRatio(0.)
     {}
 
     bool withCopConstraints;
     bool withFeetConstraints;
+
+    /// \brief Presolve the QP before solving it. Duplicated CoP constraints
+    ///        and constraints which are simple bounds are removed. See QPPresolver
+    bool withPresolve;
+
+    /// \brief Each time a sampling period has elapsed, shift the previous
+    ///        solution and the working set of the solver by one sample before
+    ///        the next solve, so that it starts close to the optimum
+    bool withWarmStartShift;
+
+    /// \brief If greater than or equal to 3, the CoP and kinematic convex
+    ///        polygons of the feet are replaced by inner approximations with
+    ///        at most this number of vertices, losing at most
+    ///        maxPolygonAreaLossRatio of their area. This bounds the number
+    ///        of rows of the CoP and foot constraints.
+    ///        See ConvexPolygon::simplifyVertices
+    int maxNbPolygonVertices;
+    Scalar maxPolygonAreaLossRatio;
   };
 }
 
@@ -48,6 +48,19 @@ namespace MPCWalkgen
                          const VectorX &factor,
                          Scalar t,
                          Scalar T) const;
+
+      /// \brief Write the values of the spline of duration T, and of its
+      ///        first and second derivatives, at t = k*dt for
+      ///        k = 1..nbSetpoints in pos, vel and acc. Each of them can be
+      ///        NULL, or must hold nbSetpoints values. The setpoints of each
+      ///        polynom are computed at once, without allocation.
+      void sampleSpline(const VectorX &factor,
+                        Scalar T,
+                        Scalar dt,
+                        int nbSetpoints,
+                        Scalar* pos,
+                        Scalar* vel,
+                        Scalar* acc) const;
     private:
       /// \brief We have a cubic spline of three polynoms with 3 constraints
       ///        (position, velocity and acceleration) on both edges of the spline,
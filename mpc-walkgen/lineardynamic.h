@@ -14,6 +14,8 @@
 
 #include <mpc-walkgen/api.h>
 #include <mpc-walkgen/type.h>
+#include <mpc-walkgen/constant_part_archive.h>
+#include <vector>
 
 #ifdef _MSC_VER
 # pragma warning( push )
@@ -44,6 +46,17 @@ namespace MPCWalkgen
                  int stateVectorSize,
                  int variableVectorSize);
 
+      /// \brief Tie consecutive variables together (move blocking): the
+      ///        variables are split in consecutive blocks of sizes
+      ///        blockSizes, and each block is replaced by a single variable.
+      ///        U becomes U.B, where B is the 0/1 matrix which copies each
+      ///        new variable to the variables of its block. The sizes must
+      ///        sum to the current number of variables.
+      void applyMoveBlocking(const std::vector<int>& blockSizes);
+
+      /// \brief Save or load the matrices
+      void archive(ConstantPartArchive<Scalar>& ar);
+
     public:
       MatrixX U;
       MatrixX UT;
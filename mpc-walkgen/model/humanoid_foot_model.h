@@ -81,49 +81,53 @@ namespace MPCWalkgen{
       /// \brief Set the state of the Foot along the X coordinate
       ///        It is a vector of size 3:
       ///        (Position, Velocity, Acceleration)
-      inline void setStateX(const VectorX& state)
+      template <typename Derived>
+      inline void setStateX(const Eigen::MatrixBase<Derived>& state)
       {
         stateX_=state;
       }
 
       /// \brief Get the state of the Foot along the X coordinate
-      inline const VectorX& getStateX() const
+      inline const Vector3& getStateX() const
       {return stateX_;}
 
       /// \brief Get the state of the Foot along the Y coordinate
       ///        It is a vector of size 3:
       ///        (Position, Velocity, Acceleration)
-      inline void setStateY(const VectorX& state)
+      template <typename Derived>
+      inline void setStateY(const Eigen::MatrixBase<Derived>& state)
       {
         stateY_=state;
       }
 
       /// \brief Get the state of the Foot along the Y coordinate
-      inline const VectorX& getStateY() const
+      inline const Vector3& getStateY() const
       {return stateY_;}
 
       /// \brief Get the state of the Foot along the Z coordinate
       ///        It is a vector of size 3:
       ///        (Position, Velocity, Acceleration)
-      inline void setStateZ(const VectorX& state)
+      template <typename Derived>
+      inline void setStateZ(const Eigen::MatrixBase<Derived>& state)
       {
         stateZ_=state;
       }
 
       /// \brief Get the state of the Foot along the Z coordinate
-      inline const VectorX& getStateZ() const
+      inline const Vector3& getStateZ() const
       {return stateZ_;}
 
       /// \brief Get the state of the Foot around Yaw axis
       ///        It is a vector of size 3:
       ///        (Position, Velocity, Acceleration)
-      inline void setStateYaw(const VectorX& state)
+      template <typename Derived>
+      inline void setStateYaw(const Eigen::MatrixBase<Derived>& state)
       {
         stateYaw_=state;
       }
 
       /// \brief Get the state of the Foot around Yaw axis
-      inline const VectorX& getStateYaw() const
+      inline const Vector3& getStateYaw() const
       {return stateYaw_;}
 
 
@@ -147,6 +151,19 @@ namespace MPCWalkgen{
                         Scalar T,
                         Scalar t);
 
+      /// \brief Write the states that an update from initialState to obj
+      ///        with the interpolation interval T would give at t = k*dt,
+      ///        for k = 1..nbSetpoints, in pos, vel and acc, which can be
+      ///        NULL. The state of the foot is not changed.
+      void sampleTrajectory(const Vector3& initialState,
+                            const Vector3& obj,
+                            Scalar T,
+                            Scalar dt,
+                            int nbSetpoints,
+                            Scalar* pos,
+                            Scalar* vel,
+                            Scalar* acc);
+
       /// \brief True if the foot touch the ground at the ith sample
       inline bool isInContact(int nbSample) const
       {
@@ -177,7 +194,7 @@ namespace MPCWalkgen{
       void init();
       /// \brief Interpolate trajectory between  currentState and objstate, using interpolator_.
       ///        Then update currentState
-      void interpolateTrajectory(VectorX &currentState,
+      void interpolateTrajectory(Vector3& currentState,
                                  const Vector3& objState,
                                  Scalar T,
                                  Scalar t);
@@ -186,10 +203,10 @@ namespace MPCWalkgen{
       int nbSamples_;
       Scalar samplingPeriod_;
 
-      VectorX stateX_;
-      VectorX stateY_;
-      VectorX stateZ_;
-      VectorX stateYaw_;
+      Vector3 stateX_;
+      Vector3 stateY_;
+      Vector3 stateZ_;
+      Vector3 stateYaw_;
 
       KinematicLimits kinematicLimits_;
 
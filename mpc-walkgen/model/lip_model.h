@@ -113,7 +113,9 @@ namespace MPCWalkgen
       /// \brief Get the state of the CoM along the X coordinate
       ///        It is a vector of size 3:
       ///        (Position, Velocity, Acceleration)
-      inline void setStateX(const VectorX& state)
+      ///        Any Eigen expression of size 3 is copied without temporary
+      template <typename Derived>
+      inline void setStateX(const Eigen::MatrixBase<Derived>& state)
       {
         assert(state==state);
         assert(state.size()==3);
@@ -121,13 +123,14 @@ namespace MPCWalkgen
       }
 
       /// \brief Get the state of the CoM along the X coordinate
-      inline const VectorX& getStateX() const
+      inline const Vector3& getStateX() const
       {return stateX_;}
 
       /// \brief Get the state of the CoM along the Y coordinate
       ///        It is a vector of size 3:
       ///        (Position, Velocity, Acceleration)
-      inline void setStateY(const VectorX& state)
+      template <typename Derived>
+      inline void setStateY(const Eigen::MatrixBase<Derived>& state)
       {
         assert(state==state);
         assert(state.size()==3);
@@ -135,17 +138,18 @@ namespace MPCWalkgen
       }
 
       /// \brief Get the state of the CoM along the Y coordinate
-      inline const VectorX& getStateY() const
+      inline const Vector3& getStateY() const
       {return stateY_;}
 
       /// \brief Get the state of the CoM along the Z coordinate
-      inline const VectorX& getStateZ() const
+      inline const Vector3& getStateZ() const
       {return stateZ_;}
 
       /// \brief Get the yaw state of the CoM around the Z axis
       ///        It is a vector of size 3:
       ///        (Position, Velocity, Acceleration)
-      inline void setStateYaw(const VectorX& state)
+      template <typename Derived>
+      inline void setStateYaw(const Eigen::MatrixBase<Derived>& state)
       {
         assert(state==state);
         assert(state.size()==3);
@@ -154,7 +158,7 @@ namespace MPCWalkgen
       }
 
       /// \brief Get the state of the CoM around the Z coordinate
-      inline const VectorX& getStateYaw() const
+      inline const Vector3& getStateYaw() const
       {return stateYaw_;}
 
       /// \brief Set the number of samples for this dynamic
@@ -179,10 +183,33 @@ namespace MPCWalkgen
       /// \brief Set the feedback period of the MPC that uses this LIP model
       void setFeedbackPeriod(Scalar feedbackPeriod);
 
-      /// \brief Get the sampling period for each sample
+      /// \brief Set a different sampling period for each sample, as in
+      ///        NoDynamicModel::setSamplingPeriods. The feedback period is
+      ///        reset to the first one.
+      void setSamplingPeriods(const VectorX& samplingPeriods);
+
+      /// \brief Get the sampling period of the first sample
       inline Scalar getSamplingPeriod(void) const
       {return samplingPeriod_;}
 
+      /// \brief Get the sampling periods of all the samples
+      inline const VectorX& getSamplingPeriods() const
+      {return samplingPeriods_;}
+
+      /// \brief Weight the cost of each sample by its sampling period,
+      ///        relative to the first one, so that the objectives approximate
+      ///        integrals over the horizon. Without it, all the samples have
+      ///        the same weight whatever their periods.
+      void setPeriodWeighting(bool withPeriodWeighting);
+
+      inline bool getPeriodWeighting() const
+      {return withPeriodWeighting_;}
+
+      /// \brief Get the weight of each sample in the objectives, see
+      ///        setPeriodWeighting
+      inline const VectorX& getSampleWeights() const
+      {return sampleWeights_;}
+
       /// \brief Get the feedback period of the MPC that uses this LIP model
       inline Scalar getFeedbackPeriod() const
       {return feedbackPeriod_;}
@@ -211,6 +238,13 @@ namespace MPCWalkgen
       inline const Vector3& getGravity(void) const
       {return gravity_;}
 
+      /// \brief Save or load the parameters, the states and the dynamics
+      void archive(ConstantPartArchive<Scalar>& ar);
+
+    private:
+      /// \brief Compute samplingPeriods_ from the periods given by the user
+      void computeSamplingPeriods();
+
     private:
       bool autoCompute_;
 
@@ -218,13 +252,20 @@ namespace MPCWalkgen
 
       int nbSamples_;
       Scalar samplingPeriod_;
+      /// \brief Periods given to setSamplingPeriods, empty if they are all
+      ///        samplingPeriod_, and the resulting period of each sample
+      VectorX givenSamplingPeriods_;
+      VectorX samplingPeriods_;
+      /// \brief See setPeriodWeighting
+      bool withPeriodWeighting_;
+      VectorX sampleWeights_;
       Scalar feedbackPeriod_;
       int nbFeedbackInOneSample_;
 
-      VectorX stateX_;
-      VectorX stateY_;
-      VectorX stateZ_;
-      VectorX stateYaw_;
+      Vector3 stateX_;
+      Vector3 stateY_;
+      Vector3 stateZ_;
+      Vector3 stateYaw_;
 
       Scalar comHeight_;
       Vector3 gravity_;
@@ -9,6 +9,8 @@
 #define MPC_WALKGEN_NO_DYNAMIC_MODEL_H
 
 #include <mpc-walkgen/lineardynamic.h>
+#include <mpc-walkgen/tools.h>
+#include <vector>
 
 #ifdef _MSC_VER
 # pragma warning( push )
@@ -54,13 +56,14 @@ namespace MPCWalkgen
     {return jerkDynamic_;}
 
     /// \brief Get the state of the base
-    inline const VectorX& getState() const
+    inline const Vector3& getState() const
     {return state_;}
 
     /// \brief Get the state
     ///        It's a vector of size 3:
     ///        (Position, Velocity, Acceleration)
-    inline void setState(const VectorX& state)
+    template <typename Derived>
+    inline void setState(const Eigen::MatrixBase<Derived>& state)
     {
       assert(state==state);
       assert(state.size()==3);
@@ -74,16 +77,92 @@ namespace MPCWalkgen
     inline int getNbSamples() const
     {return nbSamples_;}
 
+    /// \brief Set the move blocking pattern: the numbers of consecutive
+    ///        samples whose jerks are tied together in a single variable,
+    ///        from the first sample. The last number is repeated until the
+    ///        end of the horizon, and the last block is truncated to it.
+    ///        The dynamics are then expressed in these variables. An empty
+    ///        pattern gives one variable per sample.
+    void setMoveBlocking(const std::vector<int>& moveBlocking);
+
+    inline const std::vector<int>& getMoveBlocking() const
+    {return moveBlocking_;}
+
+    /// \brief Get the number of variables of the dynamics, which is the
+    ///        number of samples without move blocking
+    inline int getNbVariables() const
+    {return blockSizes_.empty() ? nbSamples_ : static_cast<int>(blockSizes_.size());}
+
+    /// \brief Shift the variables of each column of X by one sample, the
+    ///        last sample being extrapolated as constant. With move
+    ///        blocking, the jerks of the samples are shifted, then each
+    ///        variable takes the mean of the shifted jerks of its block,
+    ///        i.e. they are projected back onto the blocks. With different
+    ///        sampling periods, the jerks are shifted in time by the first
+    ///        period, as Tools::shiftInTime, so that each variable keeps
+    ///        the jerks of the instants it covers.
+    template <typename Derived>
+    inline void shiftVariables(Eigen::MatrixBase<Derived>& X) const
+    {
+      assert(X.rows()==getNbVariables());
+
+      const int nbVariables = getNbVariables();
+      if (!(samplingPeriods_.array()==samplingPeriod_).all())
+      {
+        VectorX durations(nbVariables);
+        for(int b=0, i=0; b<nbVariables; ++b)
+        {
+          const int size = blockSizes_.empty() ? 1 : blockSizes_[b];
+          durations(b) = samplingPeriods_.segment(i, size).sum();
+          i += size;
+        }
+        Tools::shiftInTime<Scalar>(X, durations, samplingPeriod_);
+        return;
+      }
+
+      // The last sample of each block takes the jerk of the next block
+      for(int b=0; b<nbVariables-1; ++b)
+      {
+        const Scalar size = static_cast<Scalar>(blockSizes_.empty() ? 1 : blockSizes_[b]);
+        X.row(b) *= (size - 1)/size;
+        X.row(b) += X.row(b + 1)/size;
+      }
+    }
+
     /// \brief Update the state
     void updateState(Scalar jerk, Scalar feedBackPeriod);
 
     /// \brief Set the sampling period for each sample
     void setSamplingPeriod(Scalar samplingPeriod);
 
-    /// \brief Get the sampling period for each sample
+    /// \brief Set a different sampling period for each sample, from the
+    ///        first one, the last value being repeated until the end of
+    ///        the horizon, e.g. short periods first and longer ones later.
+    ///        setSamplingPeriod goes back to a single period.
+    void setSamplingPeriods(const VectorX& samplingPeriods);
+
+    /// \brief Get the sampling period of the first sample
     inline Scalar getSamplingPeriod(void) const
     {return samplingPeriod_;}
 
+    /// \brief Get the sampling periods of all the samples
+    inline const VectorX& getSamplingPeriods() const
+    {return samplingPeriods_;}
+
+    /// \brief Weight the cost of each sample by its sampling period,
+    ///        relative to the first one, so that the objectives approximate
+    ///        integrals over the horizon. Without it, all the samples have
+    ///        the same weight whatever their periods.
+    void setPeriodWeighting(bool withPeriodWeighting);
+
+    inline bool getPeriodWeighting() const
+    {return withPeriodWeighting_;}
+
+    /// \brief Get the weight of each sample in the objectives, see
+    ///        setPeriodWeighting
+    inline const VectorX& getSampleWeights() const
+    {return sampleWeights_;}
+
     /// \brief Get the velocity maximum value
     inline Scalar getVelocityLimit(void) const
     {return velocityLimit_;}
@@ -117,13 +196,30 @@ namespace MPCWalkgen
       jerkLimit_ = jerkLimit;
     }
 
+  private:
+    /// \brief Compute samplingPeriods_ from the periods given by the user
+    void computeSamplingPeriods();
+    /// \brief Compute blockSizes_ from moveBlocking_ and nbSamples_
+    void computeBlockSizes();
+    void applyMoveBlocking(LinearDynamic<Scalar>& dyn) const;
+
   private:
     bool autoCompute_;
 
     int nbSamples_;
+    std::vector<int> moveBlocking_;
+    /// \brief Number of samples of each variable, empty without move blocking
+    std::vector<int> blockSizes_;
     Scalar samplingPeriod_;
-
-    VectorX state_;
+    /// \brief Periods given to setSamplingPeriods, empty if they are all
+    ///        samplingPeriod_, and the resulting period of each sample
+    VectorX givenSamplingPeriods_;
+    VectorX samplingPeriods_;
+    /// \brief See setPeriodWeighting
+    bool withPeriodWeighting_;
+    VectorX sampleWeights_;
+
+    Vector3 state_;
 
     Scalar velocityLimit_;
     Scalar accelerationLimit_;
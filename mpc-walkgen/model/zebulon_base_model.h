@@ -76,13 +76,14 @@ namespace MPCWalkgen
     {return baseJerkDynamic_;}
 
     /// \brief Get the state of the base along the X coordinate
-    inline const VectorX& getStateX() const
+    inline const Vector3& getStateX() const
     {return stateX_;}
 
     /// \brief Get the state of the CoM along the X coordinate
     ///        It's a vector of size 4:
     ///        (Position, Velocity, Acceleration, 1)
-    inline void setStateX(const VectorX& state)
+    template <typename Derived>
+    inline void setStateX(const Eigen::MatrixBase<Derived>& state)
     {
       assert(state==state);
       assert(state.size()==3);
@@ -91,13 +92,14 @@ namespace MPCWalkgen
 
 
     /// \brief Get the state of the base along the Y coordinate
-    inline const VectorX& getStateY() const
+    inline const Vector3& getStateY() const
     {return stateY_;}
 
     /// \brief Get the state of the CoM along the Y coordinate
     ///        It's a vector of size 4:
     ///        (Position, Velocity, Acceleration, 1)
-    inline void setStateY(const VectorX& state)
+    template <typename Derived>
+    inline void setStateY(const Eigen::MatrixBase<Derived>& state)
     {
       assert(state==state);
       assert(state.size()==3);
@@ -106,13 +108,14 @@ namespace MPCWalkgen
 
 
     /// \brief Get the state of the base along the Theta coordinate
-    inline const VectorX& getStateRoll() const
+    inline const Vector3& getStateRoll() const
     {return stateRoll_;}
 
     /// \brief Get the state of the CoM along the Theta coordinate
     ///        It's a vector of size 4:
     ///        (Position, Velocity, Acceleration, 1)
-    inline void setStateRoll(const VectorX& state)
+    template <typename Derived>
+    inline void setStateRoll(const Eigen::MatrixBase<Derived>& state)
     {
       assert(state==state);
       assert(state.size()==3);
@@ -120,13 +123,14 @@ namespace MPCWalkgen
     }
 
     /// \brief Get the state of the base along the Theta coordinate
-    inline const VectorX& getStatePitch() const
+    inline const Vector3& getStatePitch() const
     {return statePitch_;}
 
     /// \brief Get the state of the CoM along the Theta coordinate
     ///        It's a vector of size 4:
     ///        (Position, Velocity, Acceleration, 1)
-    inline void setStatePitch(const VectorX& state)
+    template <typename Derived>
+    inline void setStatePitch(const Eigen::MatrixBase<Derived>& state)
     {
       assert(state==state);
       assert(state.size()==3);
@@ -134,13 +138,14 @@ namespace MPCWalkgen
     }
 
     /// \brief Get the state of the base along the Theta coordinate
-    inline const VectorX& getStateYaw() const
+    inline const Vector3& getStateYaw() const
     {return stateYaw_;}
 
     /// \brief Get the state of the CoM along the Theta coordinate
     ///        It's a vector of size 4:
     ///        (Position, Velocity, Acceleration, 1)
-    inline void setStateYaw(const VectorX& state)
+    template <typename Derived>
+    inline void setStateYaw(const Eigen::MatrixBase<Derived>& state)
     {
       assert(state==state);
       assert(state.size()==3);
@@ -163,10 +168,32 @@ namespace MPCWalkgen
     /// \brief Set the sampling period for each sample
     void setSamplingPeriod(Scalar samplingPeriod);
 
-    /// \brief Get the sampling period for each sample
+    /// \brief Set a different sampling period for each sample, as in
+    ///        NoDynamicModel::setSamplingPeriods
+    void setSamplingPeriods(const VectorX& samplingPeriods);
+
+    /// \brief Get the sampling period of the first sample
     inline Scalar getSamplingPeriod(void) const
     {return samplingPeriod_;}
 
+    /// \brief Get the sampling periods of all the samples
+    inline const VectorX& getSamplingPeriods() const
+    {return samplingPeriods_;}
+
+    /// \brief Weight the cost of each sample by its sampling period,
+    ///        relative to the first one, so that the objectives approximate
+    ///        integrals over the horizon. Without it, all the samples have
+    ///        the same weight whatever their periods.
+    void setPeriodWeighting(bool withPeriodWeighting);
+
+    inline bool getPeriodWeighting() const
+    {return withPeriodWeighting_;}
+
+    /// \brief Get the weight of each sample in the objectives, see
+    ///        setPeriodWeighting
+    inline const VectorX& getSampleWeights() const
+    {return sampleWeights_;}
+
     /// \brief Set the CoM constant height
     void setComHeight(Scalar comHeight);
 
@@ -261,17 +288,32 @@ namespace MPCWalkgen
       return tiltContactPointY_;
     }
 
+    /// \brief Save or load the parameters, the states, the limits, the
+    ///        support polygons and the dynamics
+    void archive(ConstantPartArchive<Scalar>& ar);
+
+  private:
+    /// \brief Compute samplingPeriods_ from the periods given by the user
+    void computeSamplingPeriods();
+
   private:
     bool autoCompute_;
 
     int nbSamples_;
     Scalar samplingPeriod_;
-
-    VectorX stateX_;
-    VectorX stateY_;
-    VectorX stateRoll_;
-    VectorX statePitch_;
-    VectorX stateYaw_;
+    /// \brief Periods given to setSamplingPeriods, empty if they are all
+    ///        samplingPeriod_, and the resulting period of each sample
+    VectorX givenSamplingPeriods_;
+    VectorX samplingPeriods_;
+    /// \brief See setPeriodWeighting
+    bool withPeriodWeighting_;
+    VectorX sampleWeights_;
+
+    Vector3 stateX_;
+    Vector3 stateY_;
+    Vector3 stateRoll_;
+    Vector3 statePitch_;
+    Vector3 stateYaw_;
 
 
     Scalar comHeight_;
@@ -0,0 +1,204 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\file multi_axis_trajectory_walkgen.h
+///\brief Trajectory walkgen controlling several independent axes at once
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef MPC_WALKGEN_MULTI_AXIS_TRAJECTORY_WALKGEN_H
+#define MPC_WALKGEN_MULTI_AXIS_TRAJECTORY_WALKGEN_H
+
+#include <mpc-walkgen/api.h>
+#include <mpc-walkgen/type.h>
+
+
+#include <mpc-walkgen/model/no_dynamic_model.h>
+#include <mpc-walkgen/function/trajectory_jerk_minimization_objective.h>
+#include <mpc-walkgen/function/trajectory_position_tracking_objective.h>
+#include <mpc-walkgen/function/trajectory_velocity_tracking_objective.h>
+#include <mpc-walkgen/function/trajectory_motion_constraint.h>
+
+
+#include <mpc-walkgen/qpsolverfactory.h>
+#include <mpc-walkgen/walkgen_scheduler.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/function.hpp>
+
+#include <mpc-walkgen/trajectory_walkgen_type.h>
+#include <boost/noncopyable.hpp>
+#include <vector>
+
+#ifdef _MSC_VER
+# pragma warning( push )
+// C4251: class needs to have DLL interface
+// C4275: non dll-interface class used as base for dll-interface class
+# pragma warning( disable: 4251 4275)
+#endif
+
+namespace MPCWalkgen
+{
+  /// \brief  Equivalent to nbAxes TrajectoryWalkgen sharing their number of
+  ///         samples, sampling period, weightings and config.
+  ///         The states, references and solutions of the axes are stored
+  ///         column by column (one column per axis), so that the gradients
+  ///         and constraint bounds of all the axes are computed with a few
+  ///         matrix-matrix products. The Hessian and the constraint matrix
+  ///         are computed once for all the axes. Each axis keeps its own QP
+  ///         solver, hence its own warm start, and the axes can be solved
+  ///         by several threads.
+  template <typename Scalar>
+  class MPC_WALKGEN_API MultiAxisTrajectoryWalkgen : boost::noncopyable
+  {
+    TEMPLATE_TYPEDEF(Scalar)
+  public:
+    explicit MultiAxisTrajectoryWalkgen(int nbAxes);
+    ~MultiAxisTrajectoryWalkgen();
+
+    void setNbSamples(int nbSamples);
+    void setSamplingPeriod(Scalar samplingPeriod);
+    /// \brief Sampling periods shared by all the axes, as in
+    ///        TrajectoryWalkgen::setSamplingPeriods
+    void setSamplingPeriods(const VectorX& samplingPeriods);
+    /// \brief Move blocking pattern shared by all the axes, as in
+    ///        TrajectoryWalkgen::setMoveBlocking
+    void setMoveBlocking(const std::vector<int>& moveBlocking);
+
+    inline int getNbAxes() const
+    {return nbAxes_;}
+
+    /// \brief Number of threads solving the axes, 1 by default.
+    ///        The axes are split in nbThreads contiguous chunks, solved by a
+    ///        WalkgenScheduler whose threads are created here and kept
+    ///        between solves, as for ZebulonWalkgenConfig::withParallelAxisSolve.
+    void setNbThreads(int nbThreads);
+
+    /// \brief The references are matrices of size (nbSamples, nbAxes)
+    void setVelRefInWorldFrame(const MatrixX& velRef);
+    void setPosRefInWorldFrame(const MatrixX& posRef);
+    void setVelRefInWorldFrame(int axis, const VectorX& velRef);
+    void setPosRefInWorldFrame(int axis, const VectorX& posRef);
+
+    /// \brief The limits are set for all the axes, or for one of them
+    void setVelLimit(Scalar limit);
+    void setAccLimit(Scalar limit);
+    void setJerkLimit(Scalar limit);
+    void setVelLimit(int axis, Scalar limit);
+    void setAccLimit(int axis, Scalar limit);
+    void setJerkLimit(int axis, Scalar limit);
+
+    /// \brief The states are a matrix of size (3, nbAxes), whose columns are
+    ///        the (Position, Velocity, Acceleration) of each axis
+    void setStates(const MatrixX& states);
+    void setState(int axis, const Vector3& state);
+
+    void setWeightings(const TrajectoryWalkgenWeighting<Scalar>& weighting);
+    void setConfig(const TrajectoryWalkgenConfig<Scalar>& config);
+
+    /// \brief Solve the problems of all the axes, and return true if all of
+    ///        them were solved. The states of the axes whose problem failed
+    ///        are updated with the last primal solution of their solver,
+    ///        as done by TrajectoryWalkgen.
+    bool solve(Scalar feedBackPeriod);
+
+    inline const MatrixX& getStates() const
+    {return states_;}
+    inline Vector3 getState(int axis) const
+    {
+      assert(axis>=0 && axis<nbAxes_);
+      return states_.col(axis);
+    }
+    inline Scalar getJerk(int axis) const
+    {
+      assert(axis>=0 && axis<nbAxes_);
+      return jerks_(axis);
+    }
+    /// \brief True if the last solve of this axis succeeded
+    inline bool isSolutionFound(int axis) const
+    {
+      assert(axis>=0 && axis<nbAxes_);
+      return solutionFound_[axis]!=0;
+    }
+
+  private:
+    void computeConstantPart();
+
+    /// \brief Solve the problems of the axes [firstAxis, firstAxis+nbAxes),
+    ///        with the buffers of the given worker, and return true if all
+    ///        of them were solved
+    bool solveAxes(int worker, int firstAxis, int nbAxes);
+
+    /// \brief Shift X_ by one sample
+    void shiftWarmStart();
+
+  private:
+    /// \brief QP matrices and buffers used by one thread. The constant
+    ///        parts are the same for all the workers.
+    struct Worker
+    {
+      QPMatrices<Scalar> qpMatrix;
+      VectorX dX;
+    };
+
+    int nbAxes_;
+    int nbThreads_;
+
+    /// \brief Dynamics shared by all the axes. The state of this model is
+    ///        not used, the states of the axes are in states_.
+    NoDynamicModel<Scalar> noDynModel_;
+
+    TrajectoryJerkMinimizationObjective<Scalar> jerkMinObj_;
+    VelocityTrackingObjective<Scalar> velTrackingObj_;
+    PositionTrackingObjective<Scalar> posTrackingObj_;
+    MotionConstraint<Scalar> motionConstraint_;
+
+    TrajectoryWalkgenWeighting<Scalar> weighting_;
+    TrajectoryWalkgenConfig<Scalar> config_;
+
+    /// \brief Weighted products of the tracking objectives, such that the
+    ///        gradient of all the axes is
+    ///        Q.X + velGradient_.(Svel.states - velRef) +
+    ///              posGradient_.(Spos.states - posRef)
+    MatrixX velGradient_;
+    MatrixX posGradient_;
+    /// \brief Dependency of the motion constraints on the states
+    MatrixX stateGradient_;
+
+    /// \brief One column per axis
+    MatrixX states_;
+    /// \brief Jerks applied after the last solve, as X_ may have been shifted
+    VectorX jerks_;
+    MatrixX velRef_;
+    MatrixX posRef_;
+    MatrixX X_;
+    MatrixX p_;
+    MatrixX bl_;
+    MatrixX bu_;
+    MatrixX tmp_;
+
+    VectorX velLimit_;
+    VectorX accLimit_;
+    VectorX jerkLimit_;
+
+    std::vector< boost::shared_ptr< QPSolver<Scalar> > > qpSolvers_;
+    std::vector<Worker> workers_;
+    std::vector<char> solutionFound_;
+
+    /// \brief With several threads, solveAxes of the chunk of each worker,
+    ///        bound once and given by reference to the scheduler
+    boost::scoped_ptr<WalkgenScheduler> scheduler_;
+    std::vector< boost::function<bool ()> > workerSolves_;
+
+    /// \brief Time elapsed since the last shift of the warm start
+    Scalar timeSinceLastShift_;
+    VectorX dual_;
+  };
+
+}
+#ifdef _MSC_VER
+# pragma warning( pop )
+#endif
+
+#endif
@@ -12,6 +12,7 @@
 
 #include <mpc-walkgen/api.h>
 #include <mpc-walkgen/qpsolver.h>
+#include <mpc-walkgen/qppresolver.h>
 
 namespace MPCWalkgen
 {
@@ -14,6 +14,8 @@
 #include <mpc-walkgen/lineardynamic.h>
 #include <Eigen/LU>
 #include <Eigen/SVD>
+#include <cassert>
+#include <algorithm>
 
 namespace MPCWalkgen
 {
@@ -54,7 +56,51 @@ namespace MPCWalkgen
 
         static void computeJerkDynamic(int N, LinearDynamic<Scalar>& dyn);
 
-        static void updateState(Scalar jerk, Scalar T, VectorX& state);
+        /// \brief The same dynamics, for samples whose periods differ:
+        ///        periods(0) is the remaining time before the first sample,
+        ///        and periods(i) the time between samples i-1 and i.
+        ///        N is the size of periods.
+        static void computeCopDynamic(const VectorX& periods,
+                                      LinearDynamic<Scalar>& dyn,
+                                      Scalar comHeight, Scalar gravityX,
+                                      Scalar gravityZ, Scalar mass,
+                                      Scalar totalMass);
+
+        static void computePosDynamic(const VectorX& periods,
+                                      LinearDynamic<Scalar>& dyn);
+
+        static void computeVelDynamic(const VectorX& periods,
+                                      LinearDynamic<Scalar>& dyn);
+
+        static void computeOrder2PosDynamic(const VectorX& periods,
+                                      LinearDynamic<Scalar>& dyn);
+
+        static void computeAccDynamic(const VectorX& periods,
+                                      LinearDynamic<Scalar>& dyn);
+
+        static void computeOrder2VelDynamic(const VectorX& periods,
+                                      LinearDynamic<Scalar>& dyn);
+
+        /// \brief Periods of N samples, the first one being S and the
+        ///        others T
+        static void computeSamplingPeriods(Scalar S, Scalar T, int N,
+                                           VectorX& periods);
+
+        /// \brief Periods of N samples given by the first values of
+        ///        pattern, its last value being repeated until the N-th
+        ///        sample. If pattern is empty, all the periods are T.
+        static void computeSamplingPeriods(const VectorX& pattern, Scalar T,
+                                           int N, VectorX& periods);
+
+        static void updateState(Scalar jerk, Scalar T, Vector3& state);
+
+        /// \brief Write the states that updateState(jerk, k*dt, state)
+        ///        would give, for k = 1..nbSetpoints, in pos, vel and acc.
+        ///        Each of them can be NULL, or must hold nbSetpoints values.
+        ///        All the setpoints are computed at once, without allocation.
+        static void sampleState(const Vector3& state, Scalar jerk, Scalar dt,
+                                int nbSetpoints, Scalar* pos, Scalar* vel,
+                                Scalar* acc);
     };
 
     /// \brief Compute inverse of matrix A using LU decomposition,
@@ -90,6 +136,252 @@ namespace MPCWalkgen
             ).matrix().asDiagonal() * svd.matrixU().adjoint();
     }
 
+    /// \brief Shift forward the nbBlocks consecutive blocks of blockSize values
+    ///        of vec which start at index first: each value takes the one
+    ///        which is shift values ahead in its block, and the last shift
+    ///        values of each block are kept.
+    ///        This is used to shift quantities indexed by sample by one
+    ///        sampling period, the last sample being extrapolated as constant.
+    template <typename Scalar>
+    void shiftSamples(typename Type<Scalar>::VectorX& vec, int first,
+                      int blockSize, int nbBlocks = 1, int shift = 1) {
+      assert(first>=0 && blockSize>=0 && nbBlocks>=0 && shift>=0);
+      assert(first + nbBlocks*blockSize <= vec.size());
+
+      if (shift==0 || shift>=blockSize)
+      {
+        return;
+      }
+
+      for(int i=0; i<nbBlocks; ++i)
+      {
+        int begin = first + i*blockSize;
+        for(int j=0; j<blockSize-shift; ++j)
+        {
+          vec(begin + j) = vec(begin + j + shift);
+        }
+      }
+    }
+
+    /// \brief Shift forward in time by shift the columns of X, which hold
+    ///        piecewise constant functions whose values last the given
+    ///        durations: each value takes the mean of its function over its
+    ///        shifted interval, the last value being extrapolated as
+    ///        constant. The values are resampled in place, in O(X.size()).
+    template <typename Scalar, typename Derived, typename DerivedDurations>
+    void shiftInTime(Eigen::MatrixBase<Derived>& X,
+                     const Eigen::MatrixBase<DerivedDurations>& durations,
+                     Scalar shift) {
+      assert(X.rows()==durations.size());
+      assert(shift>=0 && durations.minCoeff()>0);
+
+      const int n = static_cast<int>(durations.size());
+      for(int c=0; c<X.cols(); ++c)
+      {
+        // The shifted interval of value i only overlaps values j>=i,
+        // which are not overwritten yet
+        int j = 0;
+        Scalar beginJ = 0;
+        Scalar beginI = 0;
+        for(int i=0; i<n; ++i)
+        {
+          const Scalar from = beginI + shift;
+          const Scalar to = from + durations(i);
+          while (j<n-1 && beginJ + durations(j)<=from)
+          {
+            beginJ += durations(j);
+            ++j;
+          }
+
+          Scalar sum = 0;
+          Scalar t = from;
+          Scalar beginK = beginJ;
+          for(int k=j; t<to; ++k)
+          {
+            const Scalar endK = k<n-1 ? std::min(beginK + durations(k), to) : to;
+            sum += (endK - t)*X(k, c);
+            t = endK;
+            beginK = endK;
+          }
+
+          X(i, c) = sum/durations(i);
+          beginI += durations(i);
+        }
+      }
+    }
+
+    /// \brief Shift forward in time by periods(0) the nbBlocks consecutive
+    ///        blocks of blockSize samples of vec which start at index first,
+    ///        the samples of each block lasting the first blockSize periods,
+    ///        as shiftInTime. With uniform periods, this is shiftSamples by
+    ///        one sample.
+    template <typename Scalar>
+    void shiftSamples(typename Type<Scalar>::VectorX& vec, int first,
+                      const typename Type<Scalar>::VectorX& periods,
+                      int blockSize, int nbBlocks) {
+      assert(blockSize>0 && blockSize<=periods.size());
+      if ((periods.head(blockSize).array()==periods(0)).all())
+      {
+        shiftSamples<Scalar>(vec, first, blockSize, nbBlocks);
+        return;
+      }
+
+      assert(first>=0 && nbBlocks>=0);
+      assert(first + nbBlocks*blockSize <= vec.size());
+      for(int i=0; i<nbBlocks; ++i)
+      {
+        typename Type<Scalar>::VectorX::SegmentReturnType block =
+            vec.segment(first + i*blockSize, blockSize);
+        shiftInTime<Scalar>(block, periods.head(blockSize), periods(0));
+      }
+    }
+
+    /// \brief Same as above, with blocks of periods.size() samples
+    template <typename Scalar>
+    void shiftSamples(typename Type<Scalar>::VectorX& vec, int first,
+                      const typename Type<Scalar>::VectorX& periods,
+                      int nbBlocks = 1) {
+      shiftSamples<Scalar>(vec, first, periods, static_cast<int>(periods.size()), nbBlocks);
+    }
+
+    /// \brief Write in resized the nbBlocks consecutive blocks of samples of
+    ///        vec, resized to blockSize values each: the samples of each
+    ///        block are truncated, or extended by its last sample, e.g. to
+    ///        reuse a warm start or references with another number of
+    ///        samples. resized is not reallocated if it has the right size.
+    template <typename Scalar>
+    void resizeSamples(const typename Type<Scalar>::VectorX& vec, int nbBlocks,
+                       int blockSize, typename Type<Scalar>::VectorX& resized) {
+      assert(nbBlocks>0 && blockSize>0);
+      assert(vec.size()%nbBlocks==0);
+      assert(&vec!=&resized);
+
+      const int oldBlockSize = static_cast<int>(vec.size())/nbBlocks;
+      resized.resize(nbBlocks*blockSize);
+      for(int i=0; i<nbBlocks; ++i)
+      {
+        for(int j=0; j<blockSize; ++j)
+        {
+          resized(i*blockSize + j) = oldBlockSize>0 ?
+                vec(i*oldBlockSize + std::min(j, oldBlockSize - 1)) :
+                static_cast<Scalar>(0);
+        }
+      }
+    }
+
+    /// \brief Resize the blocks of samples of vec in place, as above
+    template <typename Scalar>
+    void resizeSamples(typename Type<Scalar>::VectorX& vec, int nbBlocks,
+                       int blockSize) {
+      assert(nbBlocks>0 && vec.size()%nbBlocks==0);
+
+      if (vec.size()==nbBlocks*blockSize)
+      {
+        return;
+      }
+
+      typename Type<Scalar>::VectorX resized;
+      resizeSamples<Scalar>(vec, nbBlocks, blockSize, resized);
+      vec.swap(resized);
+    }
+
+    /// \brief Write in restricted, from index first, the first nbSamples
+    ///        samples of each of the nbBlocks consecutive blocks of samples
+    ///        of vec, e.g. to use quantities computed for a longer horizon
+    ///        in a problem of nbSamples samples. Nothing is allocated.
+    template <typename Scalar>
+    void restrictSamples(const typename Type<Scalar>::VectorX& vec, int nbBlocks,
+                         int nbSamples, typename Type<Scalar>::VectorX& restricted,
+                         int first = 0) {
+      assert(nbBlocks>=0 && vec.size()%std::max(nbBlocks, 1)==0);
+      assert(&vec!=&restricted);
+
+      const int blockSize = nbBlocks>0 ? static_cast<int>(vec.size())/nbBlocks : 0;
+      assert(nbSamples>=0 && nbSamples<=blockSize);
+      assert(first>=0 && first + nbBlocks*nbSamples<=restricted.size());
+      for(int i=0; i<nbBlocks; ++i)
+      {
+        restricted.segment(first + i*nbSamples, nbSamples) =
+            vec.segment(i*blockSize, nbSamples);
+      }
+    }
+
+    /// \brief Set the samples of each of the nbBlocks consecutive blocks of
+    ///        samples of vec after the first nbSamples ones to the last of
+    ///        them, as resizeSamples extends them
+    template <typename Scalar>
+    void padSamples(typename Type<Scalar>::VectorX& vec, int nbBlocks, int nbSamples) {
+      assert(nbBlocks>0 && vec.size()%nbBlocks==0);
+
+      const int blockSize = static_cast<int>(vec.size())/nbBlocks;
+      assert(nbSamples>0 && nbSamples<=blockSize);
+      for(int i=0; i<nbBlocks; ++i)
+      {
+        vec.segment(i*blockSize + nbSamples, blockSize - nbSamples)
+            .setConstant(vec(i*blockSize + nbSamples - 1));
+      }
+    }
+
+    /// \brief True if each block of blockSize x blockSize values of m is
+    ///        upper triangular and constant along its diagonals, up to the
+    ///        rounding errors, as the transposed dynamics of uniformly
+    ///        sampled models
+    template <typename Scalar>
+    bool isBlockUpperToeplitz(const typename Type<Scalar>::MatrixX& m,
+                              int blockSize) {
+      assert(blockSize>0);
+      assert(m.rows()%blockSize==0 && m.cols()%blockSize==0);
+
+      if (m.size()==0)
+      {
+        return true;
+      }
+      const Scalar tolerance = Eigen::NumTraits<Scalar>::dummy_precision()
+          *m.cwiseAbs().maxCoeff();
+
+      for(int i=0; i<m.rows(); ++i)
+      {
+        for(int j=0; j<m.cols(); ++j)
+        {
+          const int bi = i%blockSize;
+          const int bj = j%blockSize;
+          if ((bi>bj && std::abs(m(i, j))>tolerance) ||
+              (bi>0 && bj>0 && std::abs(m(i, j) - m(i - 1, j - 1))>tolerance))
+          {
+            return false;
+          }
+        }
+      }
+      return true;
+    }
+
+    /// \brief Update prod = m*vec after the samples of vec were shifted by
+    ///        shiftSamples and the last sample of each of its blocks was
+    ///        replaced. The blocks of m must satisfy isBlockUpperToeplitz:
+    ///        each block of prod then takes the value of its next sample,
+    ///        plus the contribution of the new last samples of vec, in
+    ///        O(m.rows()) per block of vec instead of a full product.
+    template <typename Scalar>
+    void shiftProduct(typename Type<Scalar>::VectorX& prod,
+                      const typename Type<Scalar>::MatrixX& m,
+                      const typename Type<Scalar>::VectorX& vec,
+                      int blockSize) {
+      assert(m.rows()==prod.size() && m.cols()==vec.size());
+      assert(blockSize>0 && prod.size()%blockSize==0);
+
+      const int nbBlocks = static_cast<int>(prod.size())/blockSize;
+      shiftSamples<Scalar>(prod, 0, blockSize, nbBlocks);
+      for(int i=0; i<nbBlocks; ++i)
+      {
+        prod((i + 1)*blockSize - 1) = 0;
+      }
+
+      for(int j=blockSize-1; j<vec.size(); j+=blockSize)
+      {
+        prod.noalias() += vec(j)*m.col(j);
+      }
+    }
+
     /// \brief Methods relative to the computation of polynomials
     template <typename Scalar>
     inline Scalar polynomValue(const typename Type<Scalar>::Vector4& factor,
@@ -23,10 +23,12 @@
 
 
 #include <mpc-walkgen/qpsolverfactory.h>
+#include <mpc-walkgen/explicit_mpc_table.h>
 #include <boost/scoped_ptr.hpp>
 
 #include <mpc-walkgen/trajectory_walkgen_type.h>
 #include <boost/noncopyable.hpp>
+#include <vector>
 
 #ifdef _MSC_VER
 # pragma warning( push )
@@ -47,6 +49,20 @@ namespace MPCWalkgen
 
     void setNbSamples(int nbSamples);
     void setSamplingPeriod(Scalar samplingPeriod);
+    /// \brief Use a different sampling period for each sample, e.g. short
+    ///        ones near the present and longer ones in the far horizon, to
+    ///        cover the same time with fewer samples. The last period is
+    ///        repeated until the end of the horizon. The warm start is
+    ///        still shifted after each period of the first sample.
+    void setSamplingPeriods(const VectorX& samplingPeriods);
+
+    /// \brief Tie the jerks of consecutive samples together, so that the QP
+    ///        has fewer variables than samples: moveBlocking gives the
+    ///        number of samples of each jerk variable, from the first one,
+    ///        its last value being repeated until the end of the horizon,
+    ///        e.g. {1, 1, 2, 4}. An empty pattern, the default, gives one
+    ///        jerk per sample. The references keep one value per sample.
+    void setMoveBlocking(const std::vector<int>& moveBlocking);
 
     void setVelRefInWorldFrame(const VectorX& velRef);
     void setPosRefInWorldFrame(const VectorX& posRef);
@@ -55,19 +71,82 @@ namespace MPCWalkgen
     void setAccLimit(Scalar limit);
     void setJerkLimit(Scalar limit);
 
-    void setState(const VectorX& state);
+    /// \brief The state is (Position, Velocity, Acceleration). The template
+    ///        overload takes a VectorX or any expression of size 3.
+    void setState(const Vector3& state);
+    template <typename Derived>
+    inline void setState(const Eigen::MatrixBase<Derived>& state)
+    {
+      assert(state.size()==3);
+      setState(Vector3(state));
+    }
 
     void setWeightings(const TrajectoryWalkgenWeighting<Scalar>& weighting);
     void setConfig(const TrajectoryWalkgenConfig<Scalar>& config);
 
     bool solve(Scalar feedBackPeriod);
 
-    const VectorX& getState() const;
+    /// \brief Build the explicit MPC table of the current problem, whose
+    ///        parameters are theta = (state, velRef, posRef), of size 2N+3.
+    ///        The QP is solved at each column of parameterSamples which is in
+    ///        no region yet, and the critical region of its active set is
+    ///        added to the table. The table is only valid for the current
+    ///        number of samples, sampling period, weightings, config and
+    ///        limits. Return the number of samples left in no region, because
+    ///        their active set is degenerate.
+    int buildExplicitTable(ExplicitMPCTable<Scalar>& table,
+                           const MatrixX& parameterSamples);
+    /// \brief Use an explicit MPC table in solve: when the parameters are in
+    ///        one of its regions, the jerk is given by the law of the region
+    ///        and no QP is solved, otherwise the QP is solved. The table is
+    ///        not copied, it can be shared by several walkgens. NULL disables
+    ///        the explicit MPC.
+    void setExplicitTable(const ExplicitMPCTable<Scalar>* table);
+    /// \brief Current parameters of the explicit MPC: (state, velRef, posRef)
+    void getExplicitParameters(VectorX& theta) const;
+
+    const Vector3& getState() const;
     const Scalar getJerk() const;
 
+    /// \brief Gain of the jerk given by the last solve with respect to the
+    ///        state it started from, if config.withFeedbackGain is set.
+    ///        Between two solves, a faster loop can apply
+    ///        getJerk() + getFeedbackGain().dot(measuredState - solvedState),
+    ///        which is exact as long as the active set does not change.
+    ///        If the active rows of the last solve are linearly dependent,
+    ///        the gain of the previous solve is kept.
+    inline const Vector3& getFeedbackGain() const
+    {return feedbackGain_;}
+
+    /// \brief Write the positions, velocities and accelerations reached
+    ///        during the feedback period of the last solve, at t = k*dt for
+    ///        k = 1..nbSetpoints, e.g. to send setpoints to the actuators at
+    ///        a higher rate than the MPC. nbSetpoints*dt must not exceed the
+    ///        feedback period. Each of pos, vel and acc holds nbSetpoints
+    ///        values, or is NULL.
+    void computeSetpoints(Scalar dt, int nbSetpoints,
+                          Scalar* pos, Scalar* vel, Scalar* acc) const;
+
   private:
     void computeConstantPart();
 
+    /// \brief Apply the jerk X_(0) to the state during feedBackPeriod
+    void updateState(Scalar feedBackPeriod);
+
+    /// \brief Write the QP as a parametric QP in theta = (state, velRef,
+    ///        posRef): min 0.5*U.Q.U + U.F.theta s.t. G.U <= w + S.theta.
+    ///        The rows of G are C and -C, where C.U gives the constrained
+    ///        velocities, accelerations and jerks.
+    void computeParametricQP(MatrixX& F, MatrixX& G, VectorX& w, MatrixX& S);
+    /// \brief Active rows of G at the optimum of solver, from the signs of
+    ///        its multipliers
+    void computeActiveSet(const QPSolver<Scalar>& solver, std::vector<int>& active);
+    /// \brief Compute feedbackGain_ from the active set of the last solve
+    void computeFeedbackGain();
+
+    /// \brief Shift X_ by one sample
+    void shiftWarmStart();
+
   private:
     boost::scoped_ptr< QPSolver<Scalar> > qpoasesSolver_;
 
@@ -85,6 +164,30 @@ namespace MPCWalkgen
     VectorX X_;
 
     QPMatrices<Scalar> qpMatrix_;
+
+    /// \brief Time elapsed since the last shift of the warm start
+    Scalar timeSinceLastShift_;
+    VectorX dual_;
+
+    const ExplicitMPCTable<Scalar>* explicitTable_;
+    /// \brief Region of the last explicit solve, tested first by the next one
+    int explicitRegion_;
+    VectorX explicitParameters_;
+
+    Vector3 feedbackGain_;
+    /// \brief Constant parts of the feedback gain: the inverse of the Hessian
+    ///        times the state columns of F and times G^T, G, and the state
+    ///        columns of S
+    MatrixX feedbackQinvF_;
+    MatrixX feedbackQinvGt_;
+    MatrixX feedbackG_;
+    MatrixX feedbackS_;
+    std::vector<int> activeSet_;
+
+    /// \brief State and jerk of the last solve, before the update
+    Vector3 lastState_;
+    Scalar lastJerk_;
+    Scalar lastFeedBackPeriod_;
   };
 
 }
@@ -33,9 +33,30 @@ namespace MPCWalkgen
   public:
     TrajectoryWalkgenConfig()
     :withMotionConstraints(false)
+    ,withWarmStartShift(false)
+    ,withPeriodWeighting(false)
+    ,withFeedbackGain(false)
     {}
 
     bool withMotionConstraints;
+
+    /// \brief Each time a sampling period has elapsed, shift the previous
+    ///        solution and the working set of the solver by one sample before
+    ///        the next solve, so that it starts close to the optimum. With
+    ///        different sampling periods, they are shifted in time by the
+    ///        first period instead, see Tools::shiftInTime
+    bool withWarmStartShift;
+
+    /// \brief With different sampling periods, weight the cost of each
+    ///        sample by its period, relative to the first one, so that the
+    ///        objectives approximate integrals over the horizon. Otherwise,
+    ///        all the samples have the same weight. See
+    ///        NoDynamicModel::setPeriodWeighting
+    bool withPeriodWeighting;
+
+    /// \brief After each solve, compute the gain of the first jerk with
+    ///        respect to the state, from the active set at the optimum
+    bool withFeedbackGain;
   };
 }
 
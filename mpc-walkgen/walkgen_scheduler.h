@@ -0,0 +1,140 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\file walkgen_scheduler.h
+///\brief Solve batches of walkgen instances with a pool of threads
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef MPC_WALKGEN_WALKGEN_SCHEDULER_H
+#define MPC_WALKGEN_WALKGEN_SCHEDULER_H
+
+#include <mpc-walkgen/api.h>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/mpl/identity.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/chrono/chrono.hpp>
+#include <deque>
+#include <vector>
+
+#ifdef _MSC_VER
+# pragma warning( push )
+// C4251: class needs to have DLL interface
+# pragma warning( disable: 4251 )
+#endif
+
+namespace MPCWalkgen
+{
+  /// \brief  Pool of threads solving batches of walkgen instances, e.g.
+  ///         several robots and many trajectory axes in one process.
+  ///         Each request is bound to an instance, and each instance to a
+  ///         worker (instance modulo the number of threads), so that an
+  ///         instance is solved by the same thread from batch to batch while
+  ///         the load is balanced. A worker whose queue is empty steals the
+  ///         last requests of the other queues. The calling thread of run is
+  ///         the first worker.
+  ///         The requests of a batch must use distinct walkgens, which must
+  ///         not be used by other threads during run.
+  class MPC_WALKGEN_API WalkgenScheduler : boost::noncopyable
+  {
+    public:
+      enum Status
+      {
+        SOLVED,
+        /// \brief The solve of the walkgen returned false, or threw an
+        ///        exception, which is not propagated
+        FAILED,
+        /// \brief The request was not started before the deadline
+        CANCELLED
+      };
+
+      /// \brief nbThreads threads solve the batches, including the one
+      ///        calling run: nbThreads-1 threads are created
+      explicit WalkgenScheduler(int nbThreads);
+      ~WalkgenScheduler();
+
+      inline int getNbThreads() const
+      {return static_cast<int>(workers_.size());}
+
+      /// \brief Add a request to the next batch: solve is called by one of
+      ///        the threads, and returns whether it succeeded
+      void add(int instance, const boost::function<bool ()>& solve);
+
+      /// \brief Add walkgen.solve(feedBackPeriod) to the next batch, for
+      ///        the Zebulon, trajectory and humanoid walkgens
+      template <template <typename> class Walkgen, typename Scalar>
+      void addSolve(int instance, Walkgen<Scalar>& walkgen,
+                    typename boost::mpl::identity<Scalar>::type feedBackPeriod)
+      {
+        add(instance, boost::bind(&Walkgen<Scalar>::solve, boost::ref(walkgen),
+                                  feedBackPeriod));
+      }
+
+      /// \brief Solve the requests of the batch, and return true if all of
+      ///        them were solved. With a timeout, in seconds, the requests
+      ///        which are not started when it expires are cancelled. A
+      ///        request cannot be interrupted: run returns once the started
+      ///        requests are done. The requests are then removed, and their
+      ///        status are available until the next run.
+      bool run(double timeout = 0.);
+
+      inline int getNbRequests() const
+      {return static_cast<int>(status_.size());}
+      /// \brief Status of the request index, in the order of the calls to add
+      inline Status getStatus(int index) const
+      {return status_[index];}
+
+    private:
+      struct Request
+      {
+        int instance;
+        boost::function<bool ()> solve;
+      };
+
+      struct Worker
+      {
+        boost::mutex mutex;
+        std::deque<int> queue;
+      };
+
+      /// \brief Loop of the threads of the pool
+      void workerLoop(int worker);
+      /// \brief Run the requests of the batch until there is none left
+      void processRequests(int worker);
+      /// \brief Index of the next request for the worker, taken from its
+      ///        queue or stolen from another one, or -1
+      int takeRequest(int worker);
+
+      std::vector< boost::shared_ptr<Worker> > workers_;
+      boost::thread_group threads_;
+
+      std::vector<Request> requests_;
+      std::vector<Status> status_;
+      std::vector<Request> batch_;
+
+      boost::mutex mutex_;
+      boost::condition_variable batchStarted_;
+      boost::condition_variable batchDone_;
+      unsigned int batchIndex_;
+      int nbRemaining_;
+      bool stop_;
+
+      bool hasDeadline_;
+      /// \brief Measured with a monotonic clock, so that the timeout does
+      ///        not depend on changes of the system time
+      boost::chrono::steady_clock::time_point deadline_;
+  };
+}
+
+#ifdef _MSC_VER
+# pragma warning( pop )
+#endif
+
+#endif
@@ -27,11 +27,22 @@
 #include <mpc-walkgen/function/zebulon_base_motion_constraint.h>
 
 #include <mpc-walkgen/qpsolverfactory.h>
+#include <mpc-walkgen/horizon_tuner.h>
+#include <mpc-walkgen/constant_part_archive.h>
+#include <mpc-walkgen/walkgen_scheduler.h>
 #include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <vector>
+#include <map>
+#include <string>
+#include <iosfwd>
 
 #include <mpc-walkgen/function/zebulon_tilt_motion_constraint.h>
 #include <mpc-walkgen/zebulon_walkgen_type.h>
 #include <boost/noncopyable.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
 
 #ifdef _MSC_VER
 # pragma warning( push )
@@ -52,6 +63,11 @@ namespace MPCWalkgen
 
     void setNbSamples(int nbSamples);
     void setSamplingPeriod(Scalar samplingPeriod);
+    /// \brief Use a different sampling period for each sample, the last one
+    ///        being repeated until the end of the horizon, as in
+    ///        TrajectoryWalkgen::setSamplingPeriods. The references are
+    ///        still given at each sample.
+    void setSamplingPeriods(const VectorX& samplingPeriods);
 
     void setGravity(const Vector3& gravity);
     void setBaseCopConvexPolygon(const ConvexPolygon<Scalar>& convexPolygon);
@@ -69,18 +85,73 @@ namespace MPCWalkgen
     void setPosRefInWorldFrame(const VectorX& posRef);
     void setCopRefInLocalFrame(const VectorX& copRef);
     void setComRefInLocalFrame(const VectorX& comRef);
+    /// \brief Shift the references by one sample and set their last sample,
+    ///        (refX, refY), e.g. when they are streamed once per sampling
+    ///        period. The part of the gradient which depends on them is
+    ///        shifted in O(N), using the Toeplitz structure of the dynamics,
+    ///        instead of being recomputed.
+    void pushVelRefInWorldFrame(const Vector2& velRef);
+    void pushPosRefInWorldFrame(const Vector2& posRef);
+    void pushCopRefInLocalFrame(const Vector2& copRef);
+    void pushComRefInLocalFrame(const Vector2& comRef);
 
     void setBaseVelLimit(Scalar limit);
     void setBaseAccLimit(Scalar limit);
     void setBaseJerkLimit(Scalar limit);
 
-    void setBaseStateX(const VectorX& state);
-    void setBaseStateY(const VectorX& state);
-    void setBaseStateRoll(const VectorX& state);
-    void setBaseStatePitch(const VectorX& state);
-    void setBaseStateYaw(const VectorX& state);
-    void setComStateX(const VectorX& state);
-    void setComStateY(const VectorX& state);
+    /// \brief The states are (Position, Velocity, Acceleration). They are
+    ///        stored in fixed-size vectors: the Vector3 overloads copy them
+    ///        directly, the template ones take a VectorX or any expression
+    ///        of size 3, such as a segment.
+    void setBaseStateX(const Vector3& state);
+    void setBaseStateY(const Vector3& state);
+    void setBaseStateRoll(const Vector3& state);
+    void setBaseStatePitch(const Vector3& state);
+    void setBaseStateYaw(const Vector3& state);
+    void setComStateX(const Vector3& state);
+    void setComStateY(const Vector3& state);
+    template <typename Derived>
+    inline void setBaseStateX(const Eigen::MatrixBase<Derived>& state)
+    {
+      assert(state.size()==3);
+      setBaseStateX(Vector3(state));
+    }
+    template <typename Derived>
+    inline void setBaseStateY(const Eigen::MatrixBase<Derived>& state)
+    {
+      assert(state.size()==3);
+      setBaseStateY(Vector3(state));
+    }
+    template <typename Derived>
+    inline void setBaseStateRoll(const Eigen::MatrixBase<Derived>& state)
+    {
+      assert(state.size()==3);
+      setBaseStateRoll(Vector3(state));
+    }
+    template <typename Derived>
+    inline void setBaseStatePitch(const Eigen::MatrixBase<Derived>& state)
+    {
+      assert(state.size()==3);
+      setBaseStatePitch(Vector3(state));
+    }
+    template <typename Derived>
+    inline void setBaseStateYaw(const Eigen::MatrixBase<Derived>& state)
+    {
+      assert(state.size()==3);
+      setBaseStateYaw(Vector3(state));
+    }
+    template <typename Derived>
+    inline void setComStateX(const Eigen::MatrixBase<Derived>& state)
+    {
+      assert(state.size()==3);
+      setComStateX(Vector3(state));
+    }
+    template <typename Derived>
+    inline void setComStateY(const Eigen::MatrixBase<Derived>& state)
+    {
+      assert(state.size()==3);
+      setComStateY(Vector3(state));
+    }
 
     void setTiltContactPointOnTheGroundInLocalFrameX(Scalar pos);
     void setTiltContactPointOnTheGroundInLocalFrameY(Scalar pos);
@@ -88,47 +159,433 @@ namespace MPCWalkgen
     void setWeightings(const ZebulonWalkgenWeighting<Scalar>& weighting);
     void setConfig(const ZebulonWalkgenConfig<Scalar>& config);
 
+    /// \brief Register a named pair of weightings and config. The QP
+    ///        matrices and solvers of each preset are computed and
+    ///        initialized once, for each reserved number of samples, and
+    ///        computed again only when the models change, so that
+    ///        selectPreset does not recompute anything.
+    ///        The polygon simplification parameters are shared by all the
+    ///        presets: the ones of the current config are used.
+    void addPreset(const std::string& name,
+                   const ZebulonWalkgenWeighting<Scalar>& weighting,
+                   const ZebulonWalkgenConfig<Scalar>& config);
+    /// \brief Use the weightings and config of a registered preset
+    void selectPreset(const std::string& name);
+
+    /// \brief Adapt the number of samples to the solve times, between
+    ///        config.minNbSamples and config.maxNbSamples, see HorizonTuner.
+    ///        The numbers of samples which can be reached from the current
+    ///        one are reserved here, as with reserveMaxSamples, and the
+    ///        tuner only switches to reserved ones, at the start of the
+    ///        next solve, without computing anything.
+    void setHorizonTunerConfig(const HorizonTunerConfig<Scalar>& config);
+    const HorizonTuner<Scalar>& getHorizonTuner() const;
+
+    /// \brief Allocate the models, the functions and the buffers once for
+    ///        maxNbSamples samples, and compute the QP constant parts of
+    ///        every number of samples up to it, so that setNbSamples with
+    ///        one of them only swaps them in, without any computation nor
+    ///        allocation, e.g. from the control thread. The problems of
+    ///        fewer samples use the first samples of the functions, which
+    ///        are causal. The warm start and the references are truncated,
+    ///        or extended by their last sample, to the new number of
+    ///        samples.
+    ///        The QP constant parts of all the reserved numbers of samples
+    ///        are kept up to date: they are computed again with the models,
+    ///        the weightings, the config and the presets, in the background
+    ///        with withBackgroundConstantPart, and a change of the yaw only
+    ///        updates the rows of the tilt motion constraint in each of them.
+    void reserveMaxSamples(int maxNbSamples);
+
+    /// \brief Write the constant part of the walkgen, see
+    ///        ConstantPartArchive: the models in use and the objectives and
+    ///        constraints built on them, the weightings, the config, the
+    ///        support polygons, and the equilibrated QP matrices of the
+    ///        current weightings and of the presets. A process can load it
+    ///        at startup instead of computing it again. The horizon tuner,
+    ///        the reserved numbers of samples and the warm start are not
+    ///        saved.
+    void saveConstantPart(std::ostream& stream) const;
+    /// \brief Use a constant part written by saveConstantPart, with the
+    ///        same version of the library and the same Scalar. Only the
+    ///        solvers are created and factorized again, the numbers of samples
+    ///        reserved before are computed again from the loaded models, and
+    ///        the warm start is reset. Return false, and leave the walkgen
+    ///        unchanged, if the constant part is not valid.
+    bool loadConstantPart(std::istream& stream);
+    /// \brief Same as above, from the size bytes of data, e.g. a
+    ///        memory-mapped file, which can be released once loaded
+    bool loadConstantPart(const char* data, size_t size);
+
     bool solve(Scalar feedBackPeriod);
+    /// \brief Number of iterations of the QP solver during the last solve,
+    ///        summed over both axes when they are solved separately
+    int getNbIterations() const;
+
+    /// \brief Number of samples of the problem in use. With
+    ///        withBackgroundConstantPart, a new number of samples is used
+    ///        once its problem is swapped in by solve, and the references
+    ///        must have the size of the problem in use. When the number of
+    ///        samples changes, the references are reset to zero, unless it
+    ///        is reserved, see reserveMaxSamples.
+    int getNbSamples() const;
+
+    const Vector3& getBaseStateX() const;
+    const Vector3& getBaseStateY() const;
+    const Vector3& getComStateX() const;
+    const Vector3& getComStateY() const;
 
-    const VectorX& getBaseStateX() const;
-    const VectorX& getBaseStateY() const;
-    const VectorX& getComStateX() const;
-    const VectorX& getComStateY() const;
+    /// \brief Write the states reached during the feedback period of the
+    ///        last solve, at t = k*dt for k = 1..nbSetpoints, e.g. to send
+    ///        setpoints to the actuators at a higher rate than the MPC.
+    ///        nbSetpoints*dt must not exceed the feedback period.
+    ///        setpoints must hold 12*nbSetpoints values: the CoM along X and
+    ///        Y, then the base along X and Y. For each of them, the
+    ///        positions, velocities and accelerations are written as
+    ///        nbSetpoints consecutive values.
+    void computeSetpoints(Scalar dt, int nbSetpoints, Scalar* setpoints) const;
+
+    /// \brief Trajectories predicted by the last solve at its N samples,
+    ///        along X and Y. They are only computed on request, and once per
+    ///        solve, from the dynamics of the models, which must not change
+    ///        in between. The buffers are resized to N if needed.
+    void getPredictedComPosition(VectorX& posX, VectorX& posY) const;
+    void getPredictedBasePosition(VectorX& posX, VectorX& posY) const;
+    void getPredictedCopPosition(VectorX& posX, VectorX& posY) const;
+    void getPredictedTiltAngle(VectorX& angleX, VectorX& angleY) const;
 
   private:
-    void computeConstantPart();
+    /// \brief Predicted quantities, by pair of X and Y trajectories
+    enum Prediction
+    {
+      PREDICTED_COM_POSITION = 0,
+      PREDICTED_BASE_POSITION,
+      PREDICTED_COP_POSITION,
+      PREDICTED_TILT_ANGLE,
+      NB_PREDICTIONS
+    };
+    /// \brief Models, and the objectives and constraints built on them
+    struct Problem : boost::noncopyable
+    {
+      Problem();
+
+      /// \brief Recompute the constant part of all the objectives and
+      ///        constraints, after the models were replaced
+      void computeConstantPart();
+
+      LIPModel<Scalar> lipModel;
+      BaseModel<Scalar> baseModel;
+
+      BaseVelocityTrackingObjective<Scalar> velTrackingObj;
+      BasePositionTrackingObjective<Scalar> posTrackingObj;
+      JerkMinimizationObjective<Scalar> jerkMinObj;
+      TiltMinimizationObjective<Scalar> tiltMinObj;
+      TiltVelMinimizationObjective<Scalar> tiltVelMinObj;
+      CopCenteringObjective<Scalar> copCenteringObj;
+      ComCenteringObjective<Scalar> comCenteringObj;
+      CopConstraint<Scalar> copConstraint;
+      ComConstraint<Scalar> comConstraint;
+      BaseMotionConstraint<Scalar> baseMotionConstraint;
+      TiltMotionConstraint<Scalar> tiltMotionConstraint;
+    };
+    typedef boost::shared_ptr<Problem> ProblemPtr;
+    /// \brief Change of the models, and update of the functions depending
+    ///        on them
+    typedef boost::function<void (Problem&)> ProblemUpdate;
+
+    /// \brief Part of the QP which only depends on the models, the
+    ///        weightings and the config: Q and A with their equilibration,
+    ///        and the solvers, whose factorizations are kept between solves
+    struct QPConstantPart
+    {
+      ZebulonWalkgenWeighting<Scalar> weighting;
+      ZebulonWalkgenConfig<Scalar> config;
+
+      QPMatrices<Scalar> qpMatrix;
+      boost::scoped_ptr< QPSolver<Scalar> > qpSolver;
+
+      /// \brief When no objective nor constraint couples the X and Y axes,
+      ///        the QP is split in two QPs of 2N variables, one per axis.
+      ///        Variable and constraint indices are the ones of qpMatrix
+      bool axesAreDecoupled;
+      std::vector<int> axisVariables[2];
+      std::vector<int> axisConstraints[2];
+      QPMatrices<Scalar> axisQPMatrix[2];
+      boost::scoped_ptr< QPSolver<Scalar> > axisQPSolver[2];
+      VectorX axisDX[2];
+      bool axisSolutionFound[2];
+
+      /// \brief Warm start restricted to the samples of the QP, solution of
+      ///        the QP, and buffers of the dual solutions of its solvers
+      VectorX X;
+      VectorX dX;
+      VectorX dual;
+      VectorX axisDual[2];
+
+      /// \brief Set on the presets which are not in use when the models
+      ///        change. They are computed again when they are selected
+      bool isStale;
+
+      QPConstantPart()
+      :isStale(false)
+      {}
+    };
+    typedef boost::shared_ptr<QPConstantPart> QPConstantPartPtr;
+    typedef std::map<std::string, QPConstantPartPtr> PresetMap;
+
+    /// \brief QP constant parts of a reserved number of samples. The ones
+    ///        of the number of samples in use are swapped with qp_ and
+    ///        presets_
+    struct ReservedHorizon
+    {
+      QPConstantPartPtr qp;
+      PresetMap presets;
+    };
+    typedef std::map<int, ReservedHorizon> HorizonMap;
+
+    /// \brief Change after which the QP constant parts are updated
+    enum ConstantPartChange
+    {
+      MODELS_CHANGED = 0,
+      WEIGHTINGS_CHANGED,
+      PRESET_SELECTED
+    };
+
+    /// \brief Recomputation of a problem and of its QP constant parts, for
+    ///        each reserved number of samples, in a worker thread. The inputs
+    ///        are copies, owned by the job, and the outputs are read once
+    ///        isDone is set. A follow-up job is given the problem and the
+    ///        parts already built by a previous one, and only computes the
+    ///        missing parts.
+    struct BackgroundJob
+    {
+      LIPModel<Scalar> lipModel;
+      BaseModel<Scalar> baseModel;
+      std::vector<ProblemUpdate> updates;
+      ZebulonWalkgenWeighting<Scalar> weighting;
+      ZebulonWalkgenConfig<Scalar> config;
+      int qpVersion;
+      std::string selectedPreset;
+      PresetMap presets;
+      std::vector<int> nbSamples;
+
+      ProblemPtr problem;
+      HorizonMap builtHorizons;
+
+      boost::mutex mutex;
+      bool isDone;
+    };
+
+    /// \brief Apply update to the models, synchronously or in the
+    ///        background depending on config_.withBackgroundConstantPart
+    void updateProblem(const ProblemUpdate& update);
 
-    void computeNormalizationFactor(MatrixX& Q, MatrixX& A);
+    static void applyNbSamples(Problem& pb, int nbSamples);
+    static void applySamplingPeriod(Problem& pb, Scalar samplingPeriod);
+    static void applySamplingPeriods(Problem& pb, const VectorX& samplingPeriods);
+    static void applyPeriodWeighting(Problem& pb, bool withPeriodWeighting);
+    static void applyGravity(Problem& pb, const Vector3& gravity);
+    static void applyCopConvexPolygon(Problem& pb, const ConvexPolygon<Scalar>& convexPolygon);
+    static void applyComConvexPolygon(Problem& pb, const ConvexPolygon<Scalar>& convexPolygon);
+    static void applyConvexPolygons(Problem& pb, const ConvexPolygon<Scalar>& copConvexPolygon,
+                                    const ConvexPolygon<Scalar>& comConvexPolygon);
+    static void applyComBodyHeight(Problem& pb, Scalar comHeight);
+    static void applyComBaseHeight(Problem& pb, Scalar comHeight);
+    static void applyBodyMass(Problem& pb, Scalar mass);
+    static void applyBaseMass(Problem& pb, Scalar mass);
+
+    /// \brief Reset the warm start and the buffers, for the samples of
+    ///        problem_
+    void resetBuffers();
+
+    /// \brief Start a background job with the pending updates, unless one
+    ///        is already running
+    void startBackgroundJob();
+    static void runBackgroundJob(const ZebulonWalkgen<Scalar>* walkgen,
+                                 BackgroundJob* job);
+    /// \brief Start a job which computes, for the problem of job, the
+    ///        presets and the QP changed while it was running. Return false
+    ///        if nothing changed
+    bool startFollowUpJob(const BackgroundJob& job);
+    /// \brief If the background job is done, or once it is done if wait is
+    ///        true, replace the problem and the QP constant parts by the ones
+    ///        it computed
+    void swapInBackgroundJob(bool wait = false);
+    /// \brief Swap in the background jobs until none is left
+    void waitForBackgroundJobs();
+
+    /// \brief Copy the states, references and limits, which do not need
+    ///        any recomputation, from the problem in use to a new one. The
+    ///        references of another number of samples are reset to zero, or
+    ///        resized if resizeReferences is true, in reference
+    static void copyVariableData(const Problem& from, Problem& to,
+                                 VectorX& reference, bool resizeReferences = false);
+    /// \brief ref if it has nbSamples samples, else reference, in which it
+    ///        is resized or reset to zero
+    static const VectorX& resizeReference(const VectorX& ref, int nbSamples,
+                                          bool keepSamples, VectorX& reference);
+
+    /// \brief New problem of nbSamples samples, with the models of pb
+    static ProblemPtr resizeProblem(const Problem& pb, int nbSamples);
+    /// \brief problem_ if it has nbSamples samples, else a problem of
+    ///        nbSamples samples with the same models, to compute the QP
+    ///        constant parts of nbSamples samples
+    ProblemPtr getHorizonProblem(int nbSamples) const;
+    /// \brief Reserve each of nbSamples, with the latest models
+    void reserveNbSamples(const std::vector<int>& nbSamples);
+    /// \brief Grow problem_ and the buffers to nbSamples samples, if they
+    ///        have fewer
+    void reserveCapacity(int nbSamples);
+    /// \brief Compute the QP constant parts of nbSamples samples from the
+    ///        models in use, and store them in reservedHorizons_
+    void reserveHorizon(int nbSamples);
+    /// \brief Swap in the reserved QP constant parts of nbSamples samples,
+    ///        and store the ones in use in reservedHorizons_
+    void switchNbSamples(int nbSamples);
+
+    /// \brief Number of rows of each constraint of config, in the order of
+    ///        the QP, in a QP of nbSamples samples. The functions of problem_
+    ///        have one row per sample in each of their blocks of rows
+    void getNbConstraints(const ZebulonWalkgenConfig<Scalar>& config, int nbSamples,
+                          int nbConstraints[4]) const;
+
+    /// \brief Reference of nbSamples_ samples, extended by its last sample
+    ///        to the samples of problem_ in reference_ if they differ
+    const VectorX& extendReference(const VectorX& ref);
+    /// \brief ref of problem_ shifted by one sample, with value as last
+    ///        sample of nbSamples_ samples, extended as above, in reference_
+    const VectorX& pushReference(const VectorX& ref, const Vector2& value);
+    /// \brief Extend the references of problem_ by their sample
+    ///        nbSamples_ - 1, after nbSamples_ decreased
+    void extendReferences();
+
+    /// \brief Update the rows of the tilt motion constraint in all the QP
+    ///        constant parts after a change of the yaw, without computing
+    ///        them again
+    void updateTiltMotionRows();
+    void updateTiltMotionRows(QPConstantPart& part, int nbSamples) const;
+
+    /// \brief Update the QP constant parts of every reserved number of
+    ///        samples after change: the QP in use is computed again, or
+    ///        taken from the selected preset, and the other presets are
+    ///        marked as stale when the models change
+    void updateConstantParts(ConstantPartChange change);
+    void updateConstantPart(int nbSamples, QPConstantPartPtr& qp, PresetMap& presets,
+                            ConstantPartChange change, bool initialize) const;
+    /// \brief Compute preset again for pb, with the polygon simplification
+    ///        of config
+    QPConstantPartPtr computePreset(Problem& pb, const QPConstantPart& preset,
+                                    const ZebulonWalkgenConfig<Scalar>& config) const;
+    QPConstantPartPtr computeConstantPart(Problem& pb,
+                                          const ZebulonWalkgenWeighting<Scalar>& weighting,
+                                          const ZebulonWalkgenConfig<Scalar>& config) const;
+
+    /// \brief Solve a QP without any active bound nor constraint, so that
+    ///        the solvers of part are factorized before their first use
+    void initializeSolvers(QPConstantPart& part) const;
+
+    /// \brief Shift X_ and the dual solutions by one sample
+    void shiftWarmStart();
+
+    /// \brief Compute the trajectories of prediction if they are not up to
+    ///        date, and copy them to trajX and trajY
+    void getPrediction(Prediction prediction, VectorX& trajX, VectorX& trajY) const;
+
+    QPSolver<Scalar>* createQPSolver(const ZebulonWalkgenConfig<Scalar>& config,
+                                     int nbVar, int nbCtr) const;
+
+    /// \brief Check if the X and Y axes are independent in part.qpMatrix,
+    ///        and if so, build the QP matrices and solvers of both axes. With
+    ///        the tilt motion constraints, they are never split, as the yaw
+    ///        couples them
+    void computeAxisProblems(QPConstantPart& part) const;
+    /// \brief Solve the QP of axis 0 (X) or 1 (Y)
+    bool solveAxisProblem(int axis);
+    bool solveAxisProblems();
+
+    /// \brief Save or load the values of the weightings, of the config,
+    ///        of QP matrices, or of the models and functions of a problem
+    static void archiveWeighting(ConstantPartArchive<Scalar>& ar,
+                                 ZebulonWalkgenWeighting<Scalar>& weighting);
+    static void archiveConfig(ConstantPartArchive<Scalar>& ar,
+                              ZebulonWalkgenConfig<Scalar>& config);
+    static void archiveQPMatrices(ConstantPartArchive<Scalar>& ar, QPMatrices<Scalar>& m);
+    static void archiveProblem(ConstantPartArchive<Scalar>& ar, Problem& pb);
+    /// \brief Save or load a QP constant part of nbSamples samples. The
+    ///        solvers of a loaded one are created and initialized here
+    void archiveQPConstantPart(ConstantPartArchive<Scalar>& ar, QPConstantPart& part,
+                               int nbSamples) const;
+
+    /// \brief Apply the polygon simplification requested in config_
+    ConvexPolygon<Scalar> simplifyConvexPolygon(
+        const ConvexPolygon<Scalar>& convexPolygon) const;
 
   private:
-    LIPModel<Scalar> lipModel_;
-    BaseModel<Scalar> baseModel_;
-
-    BaseVelocityTrackingObjective<Scalar> velTrackingObj_;
-    BasePositionTrackingObjective<Scalar> posTrackingObj_;
-    JerkMinimizationObjective<Scalar> jerkMinObj_;
-    TiltMinimizationObjective<Scalar> tiltMinObj_;
-    TiltVelMinimizationObjective<Scalar> tiltVelMinObj_;
-    CopCenteringObjective<Scalar> copCenteringObj_;
-    ComCenteringObjective<Scalar> comCenteringObj_;
-    CopConstraint<Scalar> copConstraint_;
-    ComConstraint<Scalar> comConstraint_;
-    BaseMotionConstraint<Scalar> baseMotionConstraint_;
-    TiltMotionConstraint<Scalar> tiltMotionConstraint_;
-
-    boost::scoped_ptr< QPSolver<Scalar> > qpoasesSolver_;
+    /// \brief Models and functions of the largest reserved number of
+    ///        samples. The QP of nbSamples_ samples uses their first
+    ///        nbSamples_ samples
+    ProblemPtr problem_;
+    int nbSamples_;
 
     ZebulonWalkgenWeighting<Scalar> weighting_;
     ZebulonWalkgenConfig<Scalar> config_;
 
-    VectorX dX_;
+    /// \brief Support convex polygons as given by the user, before simplification
+    ConvexPolygon<Scalar> copConvexPolygon_;
+    ConvexPolygon<Scalar> comConvexPolygon_;
+
+    /// \brief Warm start, and its base part, for the samples of problem_.
+    ///        The samples after nbSamples_ are the last one
     VectorX X_;
     VectorX B_;
+    /// \brief Reference extended to the samples of problem_
+    VectorX reference_;
+
+    /// \brief Constant part of the QP in use, which may be shared with
+    ///        one of the presets
+    QPConstantPartPtr qp_;
+    PresetMap presets_;
+    /// \brief Name of the selected preset, empty if the weightings or the
+    ///        config were set since
+    std::string selectedPreset_;
+    /// \brief Incremented each time the weightings or the config change
+    int qpVersion_;
+
+    HorizonTuner<Scalar> horizonTuner_;
+    /// \brief Reserved numbers of samples, empty if none was reserved
+    HorizonMap reservedHorizons_;
+    /// \brief Reserved number of samples requested by the horizon tuner,
+    ///         used at the start of the next solve, or 0
+    int nextNbSamples_;
+
+    std::vector<ProblemUpdate> pendingUpdates_;
+    boost::shared_ptr<BackgroundJob> backgroundJob_;
+    boost::scoped_ptr<boost::thread> backgroundThread_;
+
+    /// \brief With withParallelAxisSolve, pool whose second thread solves
+    ///        the Y axis while the calling thread solves the X axis. It is
+    ///        created on the first parallel solve and kept for the next
+    ///        ones, as are the solves of both axes given to it.
+    boost::scoped_ptr<WalkgenScheduler> axisScheduler_;
+    boost::function<bool ()> axisSolves_[2];
+
+    /// \brief Time elapsed since the last shift of the warm start
+    Scalar timeSinceLastShift_;
 
-    QPMatrices<Scalar> qpMatrix_;
+    /// \brief States of the CoM along X and Y, then of the base along X and
+    ///         Y, and their jerks, during the last solve, before the update
+    Vector3 lastStates_[4];
+    Scalar lastJerks_[4];
+    Scalar lastFeedBackPeriod_;
 
-    Scalar invObjNormFactor_;
-    Scalar invCtrNormFactor_;
+    /// \brief Solution of the last solve, before the shift of the warm start,
+    ///         for the samples of problem_
+    VectorX lastSolution_;
+    /// \brief Trajectories predicted by the last solve, along X and Y for
+    ///         each prediction. Bit i of predictionsUpToDate_ is set once the
+    ///         ones of prediction i are computed.
+    mutable VectorX predictions_[2*NB_PREDICTIONS];
+    mutable int predictionsUpToDate_;
   };
 
 }
@@ -47,12 +47,54 @@ namespace MPCWalkgen
     ,withComConstraints(false)
     ,withBaseMotionConstraints(false)
     ,withTiltMotionConstraints(false)
+    ,maxNbPolygonVertices(0)
+    ,maxPolygonAreaLossRatio(0.)
+    ,withPresolve(false)
+    ,withWarmStartShift(false)
+    ,withPeriodWeighting(false)
+    ,withParallelAxisSolve(false)
+    ,withBackgroundConstantPart(false)
     {}
 
     bool withCopConstraints;
     bool withComConstraints;
     bool withBaseMotionConstraints;
     bool withTiltMotionConstraints;
+
+    /// \brief If greater than or equal to 3, the CoP and CoM support convex
+    ///        polygons are replaced by inner approximations with at most this
+    ///        number of vertices, losing at most maxPolygonAreaLossRatio
+    ///        of their area. See ConvexPolygon::simplifyVertices
+    int maxNbPolygonVertices;
+    Scalar maxPolygonAreaLossRatio;
+
+    /// \brief Presolve the QP before solving it. See QPPresolver
+    bool withPresolve;
+
+    /// \brief Each time a sampling period has elapsed, shift the previous
+    ///        solution and the working set of the solver by one sample before
+    ///        the next solve, so that it starts close to the optimum. With
+    ///        different sampling periods, they are shifted in time by the
+    ///        first period instead, see Tools::shiftInTime
+    bool withWarmStartShift;
+
+    /// \brief With different sampling periods, weight the cost of each
+    ///        sample by its period, relative to the first one, so that the
+    ///        objectives approximate integrals over the horizon. Otherwise,
+    ///        all the samples have the same weight. See
+    ///        LIPModel::setPeriodWeighting
+    bool withPeriodWeighting;
+
+    /// \brief When the X and Y axes are decoupled, the QP is split in two
+    ///        independent QPs. If true, they are solved in two threads: the
+    ///        calling one and a thread kept by the walkgen
+    bool withParallelAxisSolve;
+
+    /// \brief If true, the setters which change the models (number of
+    ///        samples, sampling period, support polygons...) compute the new
+    ///        constant part in a worker thread. The current problem is used
+    ///        until the new one is swapped in, at the start of a solve
+    bool withBackgroundConstantPart;
   };
 }
 
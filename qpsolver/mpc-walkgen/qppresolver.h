@@ -0,0 +1,713 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\file qppresolver.h
+///\brief Presolve and postsolve of QP problems, and a QP solver decorator
+///       using them
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef MPC_WALKGEN_QPPRESOLVER_H
+#define MPC_WALKGEN_QPPRESOLVER_H
+
+#include <mpc-walkgen/qpsolver.h>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+
+namespace MPCWalkgen
+{
+  /// \brief Shrink a QP problem before solving it, and map the solution of the
+  ///        reduced problem back to the original one.
+  ///
+  ///        The following reductions are applied:
+  ///        - rows of A without any nonzero element are removed,
+  ///        - rows of A with a single nonzero element are turned into bounds,
+  ///        - rows of A which are a multiple of a previous row are merged into it,
+  ///        - variables with xl == xu (after the above tightening) are eliminated,
+  ///          as well as the rows which only involve such variables.
+  ///
+  ///        The analysis of Q and A is cached: it is only done again when their
+  ///        size or their version (see QPMatrices::notifyMatricesChanged)
+  ///        change. p and the bounds are processed on each call. As fixed
+  ///        variables are found from the bounds, the reduced problem may
+  ///        still change between two calls with the same Q and A, for
+  ///        instance when a bound is released. hasReducedStructureChanged
+  ///        then returns true and the solver must not be hotstarted.
+  ///
+  ///        Crossed bounds which the reductions reveal (a variable or a merged
+  ///        row with a lower bound above its upper bound, or a removed row
+  ///        violated by the fixed variables) are reported by isFeasible.
+  ///        Bounds crossed by less than epsilon are taken as equal.
+  template <typename Scalar>
+  class QPPresolver
+  {
+  public:
+    typedef typename QPMatrices<Scalar>::MatrixX MatrixX;
+    typedef typename QPMatrices<Scalar>::VectorX VectorX;
+
+    /// \param epsilon: tolerance used to detect zeros, proportional rows
+    ///        and fixed variables
+    QPPresolver(Scalar epsilon = static_cast<Scalar>(1e-8));
+
+    /// \brief Return the reduced problem of m
+    const QPMatrices<Scalar>& presolve(const QPMatrices<Scalar>& m);
+    /// \brief Return true if the Q and A matrices of the reduced problem changed
+    ///        during the last call to presolve. If not, a solver which was
+    ///        initialized with the previous reduced problem can be hotstarted.
+    inline bool hasReducedStructureChanged() const
+    {return reducedStructureChanged_;}
+    /// \brief Return false if the last call to presolve proved the problem
+    ///        infeasible. The reduced problem must not be solved then.
+    inline bool isFeasible() const
+    {return isFeasible_;}
+
+    /// \brief Compute sol, the solution of the original problem, from the
+    ///        solution of the last reduced problem
+    void postsolve(const VectorX& reducedSol, VectorX& sol);
+    /// \brief Compute the multipliers of the original problem from the ones
+    ///        of the reduced problem. Multipliers are ordered as in qpOASES:
+    ///        bounds first, then constraints, such that
+    ///        Q.x + p = dual.head(nbVar) + At.dual.tail(nbCtr).
+    ///        It must be called after postsolve.
+    void postsolveDual(const VectorX& reducedDual, VectorX& dual) const;
+    /// \brief Map multipliers of the original problem to the last reduced
+    ///        problem, which is the reverse of postsolveDual. It is meant to
+    ///        build a guess of the working set of the reduced problem.
+    void presolveDual(const VectorX& dual, VectorX& reducedDual) const;
+
+    inline int getNbVar() const
+    {return reduced_.Q.rows();}
+    inline int getNbCtr() const
+    {return reduced_.A.rows();}
+
+  private:
+    enum RowType
+    {
+      GENERAL_ROW,
+      EMPTY_ROW,
+      SINGLETON_ROW,
+      DUPLICATED_ROW
+    };
+
+    bool isStructureUnchanged(const QPMatrices<Scalar>& m) const;
+    /// \brief Return false if lower is above upper by more than epsilon_.
+    ///        Otherwise, bounds crossed by less than epsilon_ are both set
+    ///        to their midpoint
+    bool checkBounds(Scalar& lower, Scalar& upper) const;
+    /// \brief Classify the rows of A. Only depends on A
+    void analyzeStructure(const QPMatrices<Scalar>& m);
+    /// \brief Build the reduced Q and A. Only depends on A, Q and isFixed_
+    void computeReducedStructure();
+
+  private:
+    Scalar epsilon_;
+
+    /// \brief Copies of the last analyzed Q and A, and of the last p
+    bool isAnalyzed_;
+    unsigned int matricesVersion_;
+    MatrixX Q_;
+    MatrixX A_;
+    VectorX p_;
+
+    /// \brief For each row of A, its type, and:
+    ///        - for singleton rows, the index of the variable and its coefficient,
+    ///        - for duplicated rows, the index of the kept row and the ratio
+    ///          between both rows
+    std::vector<int> rowType_;
+    std::vector<int> rowPivot_;
+    VectorX rowRatio_;
+
+    /// \brief Bounds tightened by singleton rows, and the row which gave the
+    ///        bound (-1 if it comes from xl or xu)
+    VectorX xl_;
+    VectorX xu_;
+    std::vector<int> lowerBoundSource_;
+    std::vector<int> upperBoundSource_;
+
+    /// \brief Row bounds intersected with the bounds of their duplicates
+    VectorX bl_;
+    VectorX bu_;
+
+    std::vector<bool> isFixed_;
+    std::vector<int> freeVars_;
+    std::vector<int> fixedVars_;
+    std::vector<int> keptRows_;
+    std::vector<int> removedRows_;
+    VectorX fixedValues_;
+
+    VectorX sol_;
+
+    QPMatrices<Scalar> reduced_;
+    bool reducedStructureChanged_;
+    bool isFeasible_;
+  };
+
+  /// \brief QP solver which presolves the problem, solves the reduced problem
+  ///        with a solver built by the given factory, and postsolves
+  ///        the solution
+  template <typename Scalar>
+  class PresolvedQPSolver : public QPSolver<Scalar>
+  {
+  public:
+    typedef QPSolver<Scalar>* (*Factory)(int nbVar, int nbCtr);
+
+    PresolvedQPSolver(int nbVar, int nbCtr, Factory factory);
+    ~PresolvedQPSolver();
+
+    bool solve(const QPMatrices<Scalar>& m,
+               typename QPMatrices<Scalar>::VectorX& sol,
+               bool useWarmStart = false);
+    void getDualSolution(typename QPMatrices<Scalar>::VectorX& dual) const;
+    void setDualGuess(const typename QPMatrices<Scalar>::VectorX& dual);
+    int getNbIterations() const;
+
+    inline int getNbVar() const
+    {return nbVar_;}
+    inline int getNbCtr() const
+    {return nbCtr_;}
+
+  private:
+    PresolvedQPSolver(const PresolvedQPSolver&);
+    PresolvedQPSolver& operator=(const PresolvedQPSolver&);
+
+  private:
+    int nbVar_;
+    int nbCtr_;
+    Factory factory_;
+    QPSolver<Scalar>* solver_;
+    QPPresolver<Scalar> presolver_;
+    typename QPMatrices<Scalar>::VectorX reducedSol_;
+    mutable typename QPMatrices<Scalar>::VectorX reducedDual_;
+    typename QPMatrices<Scalar>::VectorX dualGuess_;
+    bool hasDualGuess_;
+  };
+
+
+///QPPresolver
+template <typename Scalar>
+QPPresolver<Scalar>::QPPresolver(Scalar epsilon)
+:epsilon_(epsilon)
+,isAnalyzed_(false)
+,matricesVersion_(0)
+,reducedStructureChanged_(true)
+,isFeasible_(true)
+{}
+
+template <typename Scalar>
+const QPMatrices<Scalar>& QPPresolver<Scalar>::presolve(const QPMatrices<Scalar>& m)
+{
+  assert(m.Q.rows() == m.Q.cols());
+  assert(m.Q.rows() == m.p.size());
+  assert(m.Q.rows() == m.A.cols());
+  assert(m.A.rows() == m.bl.size());
+  assert(m.A.rows() == m.bu.size());
+  assert(m.Q.rows() == m.xl.size());
+  assert(m.Q.rows() == m.xu.size());
+
+  const int nbVar = m.Q.rows();
+  const int nbCtr = m.A.rows();
+
+  reducedStructureChanged_ = false;
+  isFeasible_ = true;
+  if (!isStructureUnchanged(m))
+  {
+    analyzeStructure(m);
+    reducedStructureChanged_ = true;
+  }
+  p_ = m.p;
+
+  // Singleton rows to bounds
+  xl_ = m.xl;
+  xu_ = m.xu;
+  lowerBoundSource_.assign(nbVar, -1);
+  upperBoundSource_.assign(nbVar, -1);
+  for(int i=0; i<nbCtr; ++i)
+  {
+    if (rowType_[i] != SINGLETON_ROW)
+    {
+      continue;
+    }
+    const int j = rowPivot_[i];
+    const Scalar a = rowRatio_(i);
+    const Scalar lower = a>0 ? m.bl(i)/a : m.bu(i)/a;
+    const Scalar upper = a>0 ? m.bu(i)/a : m.bl(i)/a;
+    if (lower>xl_(j))
+    {
+      xl_(j) = lower;
+      lowerBoundSource_[j] = i;
+    }
+    if (upper<xu_(j))
+    {
+      xu_(j) = upper;
+      upperBoundSource_[j] = i;
+    }
+  }
+
+  // Duplicated rows merged into the kept ones
+  bl_ = m.bl;
+  bu_ = m.bu;
+  for(int i=0; i<nbCtr; ++i)
+  {
+    if (rowType_[i] != DUPLICATED_ROW)
+    {
+      continue;
+    }
+    const int k = rowPivot_[i];
+    const Scalar s = rowRatio_(i);
+    const Scalar lower = s>0 ? m.bl(i)/s : m.bu(i)/s;
+    const Scalar upper = s>0 ? m.bu(i)/s : m.bl(i)/s;
+    bl_(k) = std::max(bl_(k), lower);
+    bu_(k) = std::min(bu_(k), upper);
+  }
+  for(int i=0; i<nbCtr; ++i)
+  {
+    if (rowType_[i] == GENERAL_ROW)
+    {
+      isFeasible_ = checkBounds(bl_(i), bu_(i)) && isFeasible_;
+    }
+    else if (rowType_[i] == EMPTY_ROW)
+    {
+      isFeasible_ = m.bl(i)<=epsilon_ && m.bu(i)>=-epsilon_ && isFeasible_;
+    }
+  }
+
+  // Fixed variables
+  fixedValues_.resize(nbVar);
+  for(int j=0; j<nbVar; ++j)
+  {
+    isFeasible_ = checkBounds(xl_(j), xu_(j)) && isFeasible_;
+    const bool isFixed = std::abs(xu_(j) - xl_(j))<=epsilon_;
+    if (isFixed != isFixed_[j])
+    {
+      isFixed_[j] = isFixed;
+      reducedStructureChanged_ = true;
+    }
+    fixedValues_(j) = isFixed ? static_cast<Scalar>(0.5)*(xl_(j) + xu_(j)) : 0;
+  }
+
+  if (reducedStructureChanged_)
+  {
+    computeReducedStructure();
+  }
+
+  const int nbFreeVars = freeVars_.size();
+  const int nbFixedVars = fixedVars_.size();
+  const int nbKeptRows = keptRows_.size();
+
+  for(int jj=0; jj<nbFreeVars; ++jj)
+  {
+    const int j = freeVars_[jj];
+    Scalar pj = m.p(j);
+    for(int kk=0; kk<nbFixedVars; ++kk)
+    {
+      const int k = fixedVars_[kk];
+      pj += Q_(j, k)*fixedValues_(k);
+    }
+    reduced_.p(jj) = pj;
+    reduced_.xl(jj) = xl_(j);
+    reduced_.xu(jj) = xu_(j);
+  }
+
+  for(int ii=0; ii<nbKeptRows; ++ii)
+  {
+    const int i = keptRows_[ii];
+    Scalar shift = 0;
+    for(int kk=0; kk<nbFixedVars; ++kk)
+    {
+      const int k = fixedVars_[kk];
+      shift += A_(i, k)*fixedValues_(k);
+    }
+    reduced_.bl(ii) = bl_(i) - shift;
+    reduced_.bu(ii) = bu_(i) - shift;
+  }
+
+  // General rows which only involve fixed variables are removed, so they
+  // must hold for the fixed values
+  const int nbRemovedRows = removedRows_.size();
+  for(int ii=0; ii<nbRemovedRows; ++ii)
+  {
+    const int i = removedRows_[ii];
+    Scalar value = 0;
+    for(int kk=0; kk<nbFixedVars; ++kk)
+    {
+      const int k = fixedVars_[kk];
+      value += A_(i, k)*fixedValues_(k);
+    }
+    isFeasible_ = value>=bl_(i) - epsilon_ && value<=bu_(i) + epsilon_ && isFeasible_;
+  }
+
+  return reduced_;
+}
+
+template <typename Scalar>
+void QPPresolver<Scalar>::postsolve(const VectorX& reducedSol, VectorX& sol)
+{
+  assert(reducedSol.size() == static_cast<int>(freeVars_.size()));
+
+  sol.resize(Q_.rows());
+  for(size_t jj=0; jj<freeVars_.size(); ++jj)
+  {
+    sol(freeVars_[jj]) = reducedSol(jj);
+  }
+  for(size_t kk=0; kk<fixedVars_.size(); ++kk)
+  {
+    sol(fixedVars_[kk]) = fixedValues_(fixedVars_[kk]);
+  }
+  sol_ = sol;
+}
+
+template <typename Scalar>
+void QPPresolver<Scalar>::postsolveDual(const VectorX& reducedDual, VectorX& dual) const
+{
+  const int nbVar = Q_.rows();
+  const int nbCtr = A_.rows();
+  const int nbFreeVars = freeVars_.size();
+
+  assert(reducedDual.size() == nbFreeVars + static_cast<int>(keptRows_.size()));
+  assert(sol_.size() == nbVar);
+
+  dual.setZero(nbVar + nbCtr);
+
+  // Removed, empty and duplicated rows are given a null multiplier, the
+  // multiplier of a kept row accounts for all its duplicates
+  for(size_t ii=0; ii<keptRows_.size(); ++ii)
+  {
+    dual(nbVar + keptRows_[ii]) = reducedDual(nbFreeVars + ii);
+  }
+
+  // The multiplier of a free variable bound is given back to the singleton
+  // row which provided the active bound, if any
+  for(int jj=0; jj<nbFreeVars; ++jj)
+  {
+    const int j = freeVars_[jj];
+    const Scalar y = reducedDual(jj);
+    const int source = y>0 ? lowerBoundSource_[j] : upperBoundSource_[j];
+    if (source<0)
+    {
+      dual(j) = y;
+    }
+    else
+    {
+      dual(nbVar + source) = y/rowRatio_(source);
+    }
+  }
+
+  // Fixed variables get the multiplier which closes the stationarity condition
+  for(size_t kk=0; kk<fixedVars_.size(); ++kk)
+  {
+    const int k = fixedVars_[kk];
+    dual(k) = Q_.row(k).dot(sol_) + p_(k) - A_.col(k).dot(dual.tail(nbCtr));
+  }
+}
+
+template <typename Scalar>
+void QPPresolver<Scalar>::presolveDual(const VectorX& dual, VectorX& reducedDual) const
+{
+  const int nbVar = Q_.rows();
+  const int nbFreeVars = freeVars_.size();
+
+  assert(dual.size() == nbVar + A_.rows());
+
+  reducedDual.resize(nbFreeVars + keptRows_.size());
+
+  for(size_t ii=0; ii<keptRows_.size(); ++ii)
+  {
+    reducedDual(nbFreeVars + ii) = dual(nbVar + keptRows_[ii]);
+  }
+
+  // A bound given by a singleton row takes the multiplier of that row
+  for(int jj=0; jj<nbFreeVars; ++jj)
+  {
+    const int j = freeVars_[jj];
+    Scalar y = dual(j);
+    const int lowerSource = lowerBoundSource_[j];
+    const int upperSource = upperBoundSource_[j];
+    if (lowerSource>=0 && dual(nbVar + lowerSource)*rowRatio_(lowerSource)>0)
+    {
+      y = dual(nbVar + lowerSource)*rowRatio_(lowerSource);
+    }
+    else if (upperSource>=0 && dual(nbVar + upperSource)*rowRatio_(upperSource)<0)
+    {
+      y = dual(nbVar + upperSource)*rowRatio_(upperSource);
+    }
+    reducedDual(jj) = y;
+  }
+}
+
+template <typename Scalar>
+bool QPPresolver<Scalar>::checkBounds(Scalar& lower, Scalar& upper) const
+{
+  if (lower<=upper)
+  {
+    return true;
+  }
+  if (lower - upper>epsilon_)
+  {
+    return false;
+  }
+  lower = upper = static_cast<Scalar>(0.5)*(lower + upper);
+  return true;
+}
+
+template <typename Scalar>
+bool QPPresolver<Scalar>::isStructureUnchanged(const QPMatrices<Scalar>& m) const
+{
+  return isAnalyzed_ && matricesVersion_ == m.getMatricesVersion() &&
+         Q_.rows() == m.Q.rows() && Q_.cols() == m.Q.cols() &&
+         A_.rows() == m.A.rows() && A_.cols() == m.A.cols();
+}
+
+template <typename Scalar>
+void QPPresolver<Scalar>::analyzeStructure(const QPMatrices<Scalar>& m)
+{
+  Q_ = m.Q;
+  A_ = m.A;
+  isAnalyzed_ = true;
+  matricesVersion_ = m.getMatricesVersion();
+
+  const int nbVar = A_.cols();
+  const int nbCtr = A_.rows();
+
+  rowType_.assign(nbCtr, GENERAL_ROW);
+  rowPivot_.assign(nbCtr, -1);
+  rowRatio_.setZero(nbCtr);
+  isFixed_.assign(nbVar, false);
+
+  // Count nonzero elements of each row and find the first one
+  std::vector<int> nbNonZeros(nbCtr, 0);
+  std::vector<int> firstNonZero(nbCtr, -1);
+  for(int i=0; i<nbCtr; ++i)
+  {
+    for(int j=0; j<nbVar; ++j)
+    {
+      if (std::abs(A_(i, j))>epsilon_)
+      {
+        if (nbNonZeros[i] == 0)
+        {
+          firstNonZero[i] = j;
+        }
+        ++nbNonZeros[i];
+      }
+    }
+
+    if (nbNonZeros[i] == 0)
+    {
+      rowType_[i] = EMPTY_ROW;
+    }
+    else if (nbNonZeros[i] == 1)
+    {
+      rowType_[i] = SINGLETON_ROW;
+      rowPivot_[i] = firstNonZero[i];
+      rowRatio_(i) = A_(i, firstNonZero[i]);
+    }
+  }
+
+  // Proportional rows share their first nonzero element and their number of
+  // nonzero elements, so only rows of such groups are compared
+  std::vector<int> order;
+  order.reserve(nbCtr);
+  for(int i=0; i<nbCtr; ++i)
+  {
+    if (rowType_[i] == GENERAL_ROW)
+    {
+      order.push_back(i);
+    }
+  }
+  for(size_t a=0; a<order.size(); ++a)
+  {
+    const int k = order[a];
+    if (rowType_[k] != GENERAL_ROW)
+    {
+      continue;
+    }
+    for(size_t b=a+1; b<order.size(); ++b)
+    {
+      const int i = order[b];
+      if (rowType_[i] != GENERAL_ROW ||
+          firstNonZero[i] != firstNonZero[k] ||
+          nbNonZeros[i] != nbNonZeros[k])
+      {
+        continue;
+      }
+      const Scalar s = A_(i, firstNonZero[i])/A_(k, firstNonZero[k]);
+      if ((A_.row(i) - s*A_.row(k)).cwiseAbs().maxCoeff()
+          <=epsilon_*A_.row(i).cwiseAbs().maxCoeff())
+      {
+        rowType_[i] = DUPLICATED_ROW;
+        rowPivot_[i] = k;
+        rowRatio_(i) = s;
+      }
+    }
+  }
+}
+
+template <typename Scalar>
+void QPPresolver<Scalar>::computeReducedStructure()
+{
+  const int nbVar = Q_.rows();
+  const int nbCtr = A_.rows();
+
+  freeVars_.clear();
+  fixedVars_.clear();
+  for(int j=0; j<nbVar; ++j)
+  {
+    if (isFixed_[j])
+    {
+      fixedVars_.push_back(j);
+    }
+    else
+    {
+      freeVars_.push_back(j);
+    }
+  }
+
+  const int nbFreeVars = freeVars_.size();
+
+  // General rows are kept unless all their nonzero elements are on fixed variables
+  keptRows_.clear();
+  removedRows_.clear();
+  for(int i=0; i<nbCtr; ++i)
+  {
+    if (rowType_[i] != GENERAL_ROW)
+    {
+      continue;
+    }
+    bool isKept = false;
+    for(int jj=0; jj<nbFreeVars && !isKept; ++jj)
+    {
+      isKept = std::abs(A_(i, freeVars_[jj]))>epsilon_;
+    }
+    if (isKept)
+    {
+      keptRows_.push_back(i);
+    }
+    else
+    {
+      removedRows_.push_back(i);
+    }
+  }
+
+  const int nbKeptRows = keptRows_.size();
+
+  reduced_.Q.resize(nbFreeVars, nbFreeVars);
+  for(int jj=0; jj<nbFreeVars; ++jj)
+  {
+    for(int ii=0; ii<nbFreeVars; ++ii)
+    {
+      reduced_.Q(ii, jj) = Q_(freeVars_[ii], freeVars_[jj]);
+    }
+  }
+
+  reduced_.A.resize(nbKeptRows, nbFreeVars);
+  for(int jj=0; jj<nbFreeVars; ++jj)
+  {
+    for(int ii=0; ii<nbKeptRows; ++ii)
+    {
+      reduced_.A(ii, jj) = A_(keptRows_[ii], freeVars_[jj]);
+    }
+  }
+  reduced_.At = reduced_.A.transpose();
+
+  reduced_.p.resize(nbFreeVars);
+  reduced_.xl.resize(nbFreeVars);
+  reduced_.xu.resize(nbFreeVars);
+  reduced_.bl.resize(nbKeptRows);
+  reduced_.bu.resize(nbKeptRows);
+}
+
+///PresolvedQPSolver
+template <typename Scalar>
+PresolvedQPSolver<Scalar>::PresolvedQPSolver(int nbVar, int nbCtr, Factory factory)
+:nbVar_(nbVar)
+,nbCtr_(nbCtr)
+,factory_(factory)
+,solver_(NULL)
+,hasDualGuess_(false)
+{}
+
+template <typename Scalar>
+PresolvedQPSolver<Scalar>::~PresolvedQPSolver()
+{
+  delete solver_;
+}
+
+template <typename Scalar>
+bool PresolvedQPSolver<Scalar>::solve(const QPMatrices<Scalar>& m,
+                                      typename QPMatrices<Scalar>::VectorX& sol,
+                                      bool useWarmStart)
+{
+  assert(m.Q.rows() == nbVar_);
+  assert(m.A.rows() == nbCtr_);
+
+  const QPMatrices<Scalar>& reduced = presolver_.presolve(m);
+
+  bool warmStart = useWarmStart && !presolver_.hasReducedStructureChanged();
+  if (solver_ == NULL ||
+      solver_->getNbVar() != presolver_.getNbVar() ||
+      solver_->getNbCtr() != presolver_.getNbCtr())
+  {
+    delete solver_;
+    solver_ = factory_(presolver_.getNbVar(), presolver_.getNbCtr());
+    warmStart = false;
+  }
+
+  if (hasDualGuess_)
+  {
+    presolver_.presolveDual(dualGuess_, reducedDual_);
+    solver_->setDualGuess(reducedDual_);
+    hasDualGuess_ = false;
+  }
+
+  reducedSol_.setZero(presolver_.getNbVar());
+
+  // Everything may have been presolved, or the problem may have been proved
+  // infeasible
+  bool solutionFound = presolver_.isFeasible();
+  if (solutionFound && presolver_.getNbVar()>0)
+  {
+    solutionFound = solver_->solve(reduced, reducedSol_, warmStart);
+  }
+
+  presolver_.postsolve(reducedSol_, sol);
+
+  return solutionFound;
+}
+
+template <typename Scalar>
+void PresolvedQPSolver<Scalar>::getDualSolution(
+    typename QPMatrices<Scalar>::VectorX& dual) const
+{
+  assert(solver_ != NULL);
+
+  if (presolver_.getNbVar()>0)
+  {
+    solver_->getDualSolution(reducedDual_);
+  }
+  else
+  {
+    reducedDual_.setZero(presolver_.getNbCtr());
+  }
+  presolver_.postsolveDual(reducedDual_, dual);
+}
+
+template <typename Scalar>
+void PresolvedQPSolver<Scalar>::setDualGuess(
+    const typename QPMatrices<Scalar>::VectorX& dual)
+{
+  assert(dual.size() == nbVar_ + nbCtr_);
+
+  dualGuess_ = dual;
+  hasDualGuess_ = true;
+}
+
+template <typename Scalar>
+int PresolvedQPSolver<Scalar>::getNbIterations() const
+{
+  return solver_ != NULL && presolver_.getNbVar()>0 ? solver_->getNbIterations() : 0;
+}
+}
+
+#endif
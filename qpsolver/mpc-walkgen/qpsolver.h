@@ -12,6 +12,10 @@
 #define MPC_WALKGEN_QPSOLVER_H
 
 #include <Eigen/Core>
+#include <cmath>
+#include <cassert>
+#include <limits>
+#include <algorithm>
 
 namespace MPCWalkgen
 {
@@ -23,12 +27,67 @@ namespace MPCWalkgen
     typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> MatrixX;
     typedef Eigen::Matrix<Scalar, Eigen::Dynamic, 1> VectorX;
 
-    /// \brief Normalize all QP matrices except xu and xl using two normalization
-    ///        factors computed from Q and A
-    void normalizeMatrices(Scalar epsilon);
-    /// \brief If the smallest element m of mat is smaller than 1,
-    ///        this function returns 1/m. Otherwise it returns 1
-    static Scalar getNormalizationFactor(const MatrixX& mat, Scalar epsilon);
+    QPMatrices();
+
+    /// \brief Scale Q and A with diagonal factors:
+    ///        Q <- objScaling.D.Q.D and A <- E.A.D
+    ///        so that the rows and columns of the problem have comparable norms.
+    ///        D and E are computed with nbIterations of the Ruiz equilibration
+    ///        algorithm the first time, and reused as long as the problem size
+    ///        and the version of the matrices (see notifyMatricesChanged) do
+    ///        not change and resetEquilibration is not called.
+    ///        At is not updated.
+    void equilibrateMatrices(int nbIterations = 10);
+    /// \brief Same as equilibrateMatrices, except when only the values of Q
+    ///        and A changed since the factors were computed: the previous
+    ///        factors are then applied and refined with nbIterations of the
+    ///        Ruiz algorithm, which is cheaper for matrices which change a
+    ///        little on each solve
+    void refineEquilibration(int nbIterations = 1, int nbInitialIterations = 10);
+    /// \brief Scale p, bl, bu, xl and xu consistently with equilibrateMatrices:
+    ///        p <- objScaling.D.p, b <- E.b and x <- D^-1.x
+    ///        Bounds whose magnitude is at least infiniteBound, such as
+    ///        Constant<Scalar>::MAXIMUM_BOUND_VALUE, stand for no bound and
+    ///        are left unscaled.
+    void equilibrateVectors(Scalar infiniteBound = static_cast<Scalar>(10e10));
+    /// \brief Discard the equilibration factors, they will be computed again
+    ///        by the next call to equilibrateMatrices
+    void resetEquilibration();
+    /// \brief Map a solution of the equilibrated problem to the original one
+    void unscalePrimalSolution(VectorX& sol) const;
+    /// \brief Map multipliers of the equilibrated problem (bounds first, then
+    ///        constraints) to the original one
+    void unscaleDualSolution(VectorX& dual) const;
+    /// \brief Compute res = Q.x, where Q is the Hessian before equilibration.
+    ///        Q is assumed symmetric
+    void computeHessianProduct(const VectorX& x, VectorX& res) const;
+
+    inline const VectorX& getVariableScaling() const
+    {return varScaling_;}
+    inline const VectorX& getConstraintScaling() const
+    {return ctrScaling_;}
+    inline Scalar getObjectiveScaling() const
+    {return objScaling_;}
+    inline bool hasEquilibration() const
+    {return equilibrationIsValid_;}
+    /// \brief Use equilibration factors computed beforehand, e.g. restored
+    ///        from a file along with Q and A, which must already be scaled
+    ///        with them
+    void setEquilibration(const VectorX& varScaling, const VectorX& ctrScaling,
+                          Scalar objScaling);
+
+    /// \brief Tell that the values of Q or A changed. Solvers and presolvers
+    ///        which cache an analysis of Q and A only do it again when the
+    ///        version of the matrices changes, they do not compare them.
+    inline void notifyMatricesChanged()
+    {++matricesVersion_;}
+    inline unsigned int getMatricesVersion() const
+    {return matricesVersion_;}
+
+  private:
+    /// \brief Compute the factors with nbIterations of the Ruiz algorithm,
+    ///        starting from the current ones if fromCurrentFactors is true
+    void computeEquilibration(int nbIterations, bool fromCurrentFactors = false);
 
   public:
     MatrixX Q;
@@ -40,6 +99,20 @@ namespace MPCWalkgen
     VectorX bl;
     VectorX xl;
     VectorX xu;
+
+  private:
+    /// \brief Diagonal of D, diagonal of E and cost factor of the equilibration
+    VectorX varScaling_;
+    VectorX ctrScaling_;
+    Scalar objScaling_;
+    bool equilibrationIsValid_;
+    /// \brief Version of the matrices the factors were computed for
+    unsigned int equilibrationVersion_;
+
+    unsigned int matricesVersion_;
+
+    /// \brief Buffer of computeHessianProduct, kept to avoid an allocation
+    mutable VectorX productTmp_;
   };
 
   template <typename Scalar>
@@ -51,43 +124,227 @@ namespace MPCWalkgen
     virtual bool solve(const QPMatrices<Scalar>& m,
                        typename QPMatrices<Scalar>::VectorX& sol,
                        bool useWarmStart = false) = 0;
+    /// \brief Get the multipliers of the last solved problem: bounds first,
+    ///        then constraints, such that Q.x + p = dual.head(nbVar) + At.dual.tail(nbCtr)
+    virtual void getDualSolution(typename QPMatrices<Scalar>::VectorX& dual) const = 0;
+    /// \brief Set a guess of the multipliers of the next problem, with the
+    ///        layout of getDualSolution. Its signs give the initial working set
+    ///        of the next solve, which is used instead of the last working set,
+    ///        even for a warm start.
+    virtual void setDualGuess(const typename QPMatrices<Scalar>::VectorX& dual) = 0;
+    /// \brief Number of iterations of the last solve, i.e. of working set
+    ///        changes for an active set solver
+    virtual int getNbIterations() const = 0;
     virtual int getNbVar() const = 0;
     virtual int getNbCtr() const = 0;
   };
 
 ///QPMatrices
 template <typename Scalar>
-void QPMatrices<Scalar>::normalizeMatrices(Scalar epsilon)
+QPMatrices<Scalar>::QPMatrices()
+:objScaling_(1)
+,equilibrationIsValid_(false)
+,equilibrationVersion_(0)
+,matricesVersion_(0)
+{}
+
+template <typename Scalar>
+void QPMatrices<Scalar>::equilibrateMatrices(int nbIterations)
 {
-  Scalar objFactor = getNormalizationFactor(Q, epsilon);
-  Scalar ctrFactor = getNormalizationFactor(A, epsilon);
+  if (!equilibrationIsValid_ ||
+      equilibrationVersion_ != matricesVersion_ ||
+      varScaling_.size() != Q.rows() ||
+      ctrScaling_.size() != A.rows())
+  {
+    computeEquilibration(nbIterations);
+    return;
+  }
 
-  Q *= objFactor;
-  p *= objFactor;
+  Q = objScaling_*varScaling_.asDiagonal()*Q*varScaling_.asDiagonal();
+  A = ctrScaling_.asDiagonal()*A*varScaling_.asDiagonal();
+}
+
+template <typename Scalar>
+void QPMatrices<Scalar>::refineEquilibration(int nbIterations, int nbInitialIterations)
+{
+  if (!equilibrationIsValid_ ||
+      varScaling_.size() != Q.rows() ||
+      ctrScaling_.size() != A.rows())
+  {
+    computeEquilibration(nbInitialIterations);
+    return;
+  }
 
-  A *= ctrFactor;
-  bu *= ctrFactor;
-  bl *= ctrFactor;
+  if (equilibrationVersion_ != matricesVersion_)
+  {
+    computeEquilibration(nbIterations, true);
+    return;
+  }
+
+  Q = objScaling_*varScaling_.asDiagonal()*Q*varScaling_.asDiagonal();
+  A = ctrScaling_.asDiagonal()*A*varScaling_.asDiagonal();
 }
 
 template <typename Scalar>
-Scalar QPMatrices<Scalar>::getNormalizationFactor(const MatrixX& mat,
-                                                  Scalar epsilon)
+void QPMatrices<Scalar>::equilibrateVectors(Scalar infiniteBound)
 {
-  Scalar normalizationFactor = 1.0;
-  for(int i=0; i<mat.rows(); ++i)
+  assert(equilibrationIsValid_);
+  assert(varScaling_.size() == p.size());
+  assert(ctrScaling_.size() == bl.size());
+
+  p = objScaling_*varScaling_.cwiseProduct(p);
+  for(int i=0; i<bl.size(); ++i)
   {
-    for(int j=0; j<mat.cols(); ++j)
+    if (std::abs(bl(i))<infiniteBound)
     {
-      Scalar v = std::abs(mat(i, j));
-      if (v>epsilon && v<normalizationFactor)
+      bl(i) *= ctrScaling_(i);
+    }
+    if (std::abs(bu(i))<infiniteBound)
+    {
+      bu(i) *= ctrScaling_(i);
+    }
+  }
+  for(int j=0; j<xl.size(); ++j)
+  {
+    if (std::abs(xl(j))<infiniteBound)
+    {
+      xl(j) /= varScaling_(j);
+    }
+    if (std::abs(xu(j))<infiniteBound)
+    {
+      xu(j) /= varScaling_(j);
+    }
+  }
+}
+
+template <typename Scalar>
+void QPMatrices<Scalar>::resetEquilibration()
+{
+  equilibrationIsValid_ = false;
+}
+
+template <typename Scalar>
+void QPMatrices<Scalar>::setEquilibration(const VectorX& varScaling,
+                                          const VectorX& ctrScaling,
+                                          Scalar objScaling)
+{
+  assert(varScaling.size() == Q.rows());
+  assert(ctrScaling.size() == A.rows());
+  assert(objScaling > 0);
+
+  varScaling_ = varScaling;
+  ctrScaling_ = ctrScaling;
+  objScaling_ = objScaling;
+  equilibrationIsValid_ = true;
+  equilibrationVersion_ = matricesVersion_;
+}
+
+template <typename Scalar>
+void QPMatrices<Scalar>::unscalePrimalSolution(VectorX& sol) const
+{
+  assert(sol.size() == varScaling_.size());
+
+  sol = varScaling_.cwiseProduct(sol);
+}
+
+template <typename Scalar>
+void QPMatrices<Scalar>::unscaleDualSolution(VectorX& dual) const
+{
+  const int nbVar = varScaling_.size();
+  const int nbCtr = ctrScaling_.size();
+  assert(dual.size() == nbVar + nbCtr);
+
+  // Q.x + p = D^-1.yb/c + At.E.yc/c
+  dual.head(nbVar) = dual.head(nbVar).cwiseQuotient(varScaling_)/objScaling_;
+  dual.tail(nbCtr) = ctrScaling_.cwiseProduct(dual.tail(nbCtr))/objScaling_;
+}
+
+template <typename Scalar>
+void QPMatrices<Scalar>::computeHessianProduct(const VectorX& x, VectorX& res) const
+{
+  assert(x.size() == Q.cols());
+
+  if (!equilibrationIsValid_)
+  {
+    res.noalias() = Q.template selfadjointView<Eigen::Lower>()*x;
+    return;
+  }
+
+  // Q = (1/c).D^-1.Qs.D^-1, where Qs is the equilibrated Hessian
+  productTmp_ = x.cwiseQuotient(varScaling_);
+  res.noalias() = Q.template selfadjointView<Eigen::Lower>()*productTmp_;
+  res = res.cwiseQuotient(varScaling_)/objScaling_;
+}
+
+template <typename Scalar>
+void QPMatrices<Scalar>::computeEquilibration(int nbIterations, bool fromCurrentFactors)
+{
+  const int nbVar = Q.rows();
+  const int nbCtr = A.rows();
+  const Scalar minNorm = std::sqrt(std::numeric_limits<Scalar>::epsilon());
+  const Scalar minFactor = static_cast<Scalar>(1e-4);
+  const Scalar maxFactor = static_cast<Scalar>(1e4);
+
+  if (fromCurrentFactors)
+  {
+    Q = varScaling_.asDiagonal()*Q*varScaling_.asDiagonal();
+    A = ctrScaling_.asDiagonal()*A*varScaling_.asDiagonal();
+  }
+  else
+  {
+    varScaling_.setOnes(nbVar);
+    ctrScaling_.setOnes(nbCtr);
+  }
+  objScaling_ = 1;
+
+  VectorX colFactor(nbVar);
+  VectorX rowFactor(nbCtr);
+
+  // Ruiz: repeatedly divide each row and column of the KKT matrix
+  // [Q At; A 0] by the square root of its infinity norm
+  for(int k=0; k<nbIterations; ++k)
+  {
+    for(int j=0; j<nbVar; ++j)
+    {
+      Scalar norm = Q.col(j).cwiseAbs().maxCoeff();
+      if (nbCtr>0)
       {
-        normalizationFactor = v;
+        norm = std::max(norm, A.col(j).cwiseAbs().maxCoeff());
       }
+      colFactor(j) = norm>minNorm ? 1/std::sqrt(norm) : 1;
+    }
+    for(int i=0; i<nbCtr; ++i)
+    {
+      Scalar norm = nbVar>0 ? A.row(i).cwiseAbs().maxCoeff() : 0;
+      rowFactor(i) = norm>minNorm ? 1/std::sqrt(norm) : 1;
+    }
+    colFactor = colFactor.cwiseMax(minFactor).cwiseMin(maxFactor);
+    rowFactor = rowFactor.cwiseMax(minFactor).cwiseMin(maxFactor);
+
+    Q = colFactor.asDiagonal()*Q*colFactor.asDiagonal();
+    A = rowFactor.asDiagonal()*A*colFactor.asDiagonal();
+    varScaling_ = varScaling_.cwiseProduct(colFactor);
+    ctrScaling_ = ctrScaling_.cwiseProduct(rowFactor);
+  }
+
+  // Cost scaling, so that the Hessian columns have unit norm on average
+  if (nbVar>0)
+  {
+    Scalar meanNorm = 0;
+    for(int j=0; j<nbVar; ++j)
+    {
+      meanNorm += Q.col(j).cwiseAbs().maxCoeff();
+    }
+    meanNorm /= nbVar;
+    if (meanNorm>minNorm)
+    {
+      objScaling_ = std::max(minFactor, std::min(maxFactor, 1/meanNorm));
+      Q *= objScaling_;
     }
   }
 
-  return 1/normalizationFactor;
+  equilibrationIsValid_ = true;
+  equilibrationVersion_ = matricesVersion_;
 }
 }
 #endif
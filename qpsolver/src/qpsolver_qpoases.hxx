@@ -18,6 +18,13 @@ public:
              typename QPMatrices<Scalar>::VectorX& sol,
              bool useWarmStart = false);
 
+  void getDualSolution(typename QPMatrices<Scalar>::VectorX& dual) const;
+
+  void setDualGuess(const typename QPMatrices<Scalar>::VectorX& dual);
+
+  inline int getNbIterations() const
+  {return nbIterations_;}
+
   inline int getNbVar() const
   {return nbVar_;}
 
@@ -31,6 +38,12 @@ private:
   ::qpOASES::QProblem qp_;
 
   bool qpIsInitialized_;
+  /// \brief Version of the matrices given to the last init
+  unsigned int matricesVersion_;
+  int nbIterations_;
+
+  typename QPMatrices<Scalar>::VectorX dualGuess_;
+  bool hasDualGuess_;
 };
 
 template <typename Scalar>
@@ -40,6 +53,9 @@ QPOasesSolver<Scalar>::QPOasesSolver(int nbVar, int nbCtr)
 ,nbCtr_(nbCtr)
 ,qp_(nbVar, nbCtr)
 ,qpIsInitialized_(false)
+,matricesVersion_(0)
+,nbIterations_(0)
+,hasDualGuess_(false)
 {
   constraints_.fill(0);
   qp_.setPrintLevel(qpOASES::PL_NONE);
@@ -70,7 +86,10 @@ bool QPOasesSolver<Scalar>::solve(const QPMatrices<Scalar>& m,
   //number of constraints, aka 250).
   int ittMax = 10000;
   ::qpOASES::returnValue ret;
-  if (qpIsInitialized_ && useWarmStart)
+  // Hotstarts reuse the matrices of the last init, so changed matrices
+  // are factorized again
+  if (qpIsInitialized_ && useWarmStart && m.getMatricesVersion()==matricesVersion_ &&
+      !hasDualGuess_)
   {
     ret = qp_.hotstart(m.p.data(), m.xl.data(), m.xu.data(),
                                             m.bl.data(), m.bu.data(),
@@ -78,11 +97,16 @@ bool QPOasesSolver<Scalar>::solve(const QPMatrices<Scalar>& m,
   }
   else
   {
+    // The initial working set is deduced from the signs of the guess, if any.
+    // qpOASES 2.0 cannot hotstart from another working set than its last one
     ret = qp_.init(m.Q.data(), m.p.data(), m.At.data(),
                    m.xl.data(), m.xu.data(), m.bl.data(), m.bu.data(),
-                   ittMax, 0);
+                   ittMax, hasDualGuess_ ? dualGuess_.data() : 0);
     qpIsInitialized_ = true;
+    matricesVersion_ = m.getMatricesVersion();
   }
+  hasDualGuess_ = false;
+  nbIterations_ = ittMax;
   qp_.getPrimalSolution(sol.data());
 
   if (ret!=::qpOASES::SUCCESSFUL_RETURN){
@@ -93,4 +117,20 @@ bool QPOasesSolver<Scalar>::solve(const QPMatrices<Scalar>& m,
   return true;
 }
 
+template <typename Scalar>
+void QPOasesSolver<Scalar>::getDualSolution(typename QPMatrices<Scalar>::VectorX& dual) const
+{
+  dual.resize(nbVar_ + nbCtr_);
+  qp_.getDualSolution(dual.data());
+}
+
+template <typename Scalar>
+void QPOasesSolver<Scalar>::setDualGuess(const typename QPMatrices<Scalar>::VectorX& dual)
+{
+  assert(dual.size() == nbVar_ + nbCtr_);
+
+  dualGuess_ = dual;
+  hasDualGuess_ = true;
+}
+
 #endif //MPC_WALKGEN_QPSOLVER_SRC_QPOASES_HXX
@@ -0,0 +1,254 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <mpc-walkgen/blockhessian.h>
+#include <algorithm>
+#include <cassert>
+#include "macro.h"
+
+namespace MPCWalkgen
+{
+  template <typename Scalar>
+  BlockHessian<Scalar>::BlockHessian()
+  :nbBlocks_(0)
+  ,blockSize_(0)
+  {}
+
+  template <typename Scalar>
+  void BlockHessian<Scalar>::reset(int nbBlocks, int blockSize)
+  {
+    assert(nbBlocks>=0);
+    assert(blockSize>=0);
+
+    nbBlocks_ = nbBlocks;
+    blockSize_ = blockSize;
+    blocks_.clear();
+    entries_.clear();
+  }
+
+  template <typename Scalar>
+  int BlockHessian<Scalar>::addBlock(const MatrixX& block)
+  {
+    assert(block.rows()==blockSize_);
+    assert(block.cols()==blockSize_);
+
+    for(size_t i=0; i<blocks_.size(); ++i)
+    {
+      if (blocks_[i]==block)
+      {
+        return static_cast<int>(i);
+      }
+    }
+
+    blocks_.push_back(block);
+    return static_cast<int>(blocks_.size()) - 1;
+  }
+
+  template <typename Scalar>
+  void BlockHessian<Scalar>::setBlock(int row, int col, int index, Scalar factor)
+  {
+    assert(row>=0 && row<nbBlocks_);
+    assert(col>=0 && col<nbBlocks_);
+    assert(index>=0 && index<static_cast<int>(blocks_.size()));
+    assert(row!=col || blocks_[index].isApprox(blocks_[index].transpose()));
+
+    BlockEntry entry;
+    entry.row = std::min(row, col);
+    entry.col = std::max(row, col);
+    entry.index = index;
+    entry.factor = factor;
+    entry.transposed = row>col;
+
+    for(size_t i=0; i<entries_.size(); ++i)
+    {
+      if (entries_[i].row==entry.row && entries_[i].col==entry.col)
+      {
+        entries_[i] = entry;
+        return;
+      }
+    }
+    entries_.push_back(entry);
+  }
+
+  template <typename Scalar>
+  int BlockHessian<Scalar>::rows() const
+  {
+    return nbBlocks_*blockSize_;
+  }
+
+  template <typename Scalar>
+  int BlockHessian<Scalar>::cols() const
+  {
+    return nbBlocks_*blockSize_;
+  }
+
+  template <typename Scalar>
+  int BlockHessian<Scalar>::getNbBlocks() const
+  {
+    return nbBlocks_;
+  }
+
+  template <typename Scalar>
+  int BlockHessian<Scalar>::getBlockSize() const
+  {
+    return blockSize_;
+  }
+
+  template <typename Scalar>
+  int BlockHessian<Scalar>::getNbStoredBlocks() const
+  {
+    return static_cast<int>(blocks_.size());
+  }
+
+  template <typename Scalar>
+  const typename Type<Scalar>::MatrixX&
+  BlockHessian<Scalar>::getStoredBlock(int index) const
+  {
+    assert(index>=0 && index<static_cast<int>(blocks_.size()));
+    return blocks_[index];
+  }
+
+  template <typename Scalar>
+  Scalar BlockHessian<Scalar>::operator()(int i, int j) const
+  {
+    assert(i>=0 && i<rows());
+    assert(j>=0 && j<cols());
+
+    int row = i/blockSize_;
+    int col = j/blockSize_;
+    int ii = i%blockSize_;
+    int jj = j%blockSize_;
+
+    // Coefficients of the lower triangular part are read in the upper one
+    if (row>col)
+    {
+      std::swap(row, col);
+      std::swap(ii, jj);
+    }
+
+    for(size_t k=0; k<entries_.size(); ++k)
+    {
+      const BlockEntry& e = entries_[k];
+      if (e.row==row && e.col==col)
+      {
+        const MatrixX& b = blocks_[e.index];
+        return e.factor*(e.transposed? b(jj, ii) : b(ii, jj));
+      }
+    }
+    return static_cast<Scalar>(0);
+  }
+
+  template <typename Scalar>
+  void BlockHessian<Scalar>::addTo(MatrixX& dst, Scalar weight, int first) const
+  {
+    assert(first>=0);
+    assert(first+rows()<=dst.rows());
+    assert(first+cols()<=dst.cols());
+
+    const int n = blockSize_;
+    for(size_t k=0; k<entries_.size(); ++k)
+    {
+      const BlockEntry& e = entries_[k];
+      const MatrixX& b = blocks_[e.index];
+      Scalar w = weight*e.factor;
+      int r = first + e.row*n;
+      int c = first + e.col*n;
+
+      if (e.transposed)
+      {
+        dst.block(r, c, n, n) += w*b.transpose();
+        if (e.row!=e.col)
+        {
+          dst.block(c, r, n, n) += w*b;
+        }
+      }
+      else
+      {
+        dst.block(r, c, n, n) += w*b;
+        if (e.row!=e.col)
+        {
+          dst.block(c, r, n, n) += w*b.transpose();
+        }
+      }
+    }
+  }
+
+  template <typename Scalar>
+  void BlockHessian<Scalar>::multiply(const VectorX& x, VectorX& res) const
+  {
+    assert(x.size()==cols());
+
+    const int n = blockSize_;
+    res.setZero(rows());
+    for(size_t k=0; k<entries_.size(); ++k)
+    {
+      const BlockEntry& e = entries_[k];
+      const MatrixX& b = blocks_[e.index];
+      int r = e.row*n;
+      int c = e.col*n;
+
+      if (e.transposed)
+      {
+        res.segment(r, n).noalias() += e.factor*(b.transpose()*x.segment(c, n));
+        if (e.row!=e.col)
+        {
+          res.segment(c, n).noalias() += e.factor*(b*x.segment(r, n));
+        }
+      }
+      else
+      {
+        res.segment(r, n).noalias() += e.factor*(b*x.segment(c, n));
+        if (e.row!=e.col)
+        {
+          res.segment(c, n).noalias() += e.factor*(b.transpose()*x.segment(r, n));
+        }
+      }
+    }
+  }
+
+  template <typename Scalar>
+  typename Type<Scalar>::MatrixX BlockHessian<Scalar>::toDense() const
+  {
+    MatrixX dense = MatrixX::Zero(rows(), cols());
+    addTo(dense, static_cast<Scalar>(1));
+    return dense;
+  }
+
+  template <typename Scalar>
+  void BlockHessian<Scalar>::archive(ConstantPartArchive<Scalar>& ar)
+  {
+    ar.process(nbBlocks_);
+    ar.process(blockSize_);
+
+    blocks_.resize(ar.processSize(static_cast<int>(blocks_.size())));
+    for(size_t i=0; i<blocks_.size(); ++i)
+    {
+      ar.process(blocks_[i]);
+      if (blocks_[i].rows()!=blockSize_ || blocks_[i].cols()!=blockSize_)
+      {
+        ar.invalidate();
+      }
+    }
+
+    entries_.resize(ar.processSize(static_cast<int>(entries_.size())));
+    for(size_t i=0; i<entries_.size(); ++i)
+    {
+      BlockEntry& e = entries_[i];
+      ar.process(e.row);
+      ar.process(e.col);
+      ar.process(e.index);
+      ar.process(e.factor);
+      ar.process(e.transposed);
+      if (e.row<0 || e.row>=nbBlocks_ || e.col<0 || e.col>=nbBlocks_ ||
+          e.index<0 || e.index>=static_cast<int>(blocks_.size()))
+      {
+        ar.invalidate();
+      }
+    }
+  }
+
+  MPC_WALKGEN_INSTANTIATE_CLASS_TEMPLATE(BlockHessian);
+}
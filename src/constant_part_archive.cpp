@@ -0,0 +1,218 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <mpc-walkgen/constant_part_archive.h>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include "macro.h"
+
+namespace MPCWalkgen
+{
+
+template <typename Scalar>
+ConstantPartArchive<Scalar>::ConstantPartArchive()
+:isValid_(true)
+,savedData_(HEADER_SIZE, 0)
+,data_(NULL)
+,size_(0)
+,offset_(HEADER_SIZE)
+{
+  const boost::uint32_t header[2] = {VERSION, sizeof(Scalar)};
+  std::memcpy(&savedData_[0], "MWCP", 4);
+  std::memcpy(&savedData_[4], header, sizeof(header));
+  const boost::uint64_t size = HEADER_SIZE;
+  std::memcpy(&savedData_[16], &size, sizeof(size));
+}
+
+template <typename Scalar>
+ConstantPartArchive<Scalar>::ConstantPartArchive(const char* data, size_t size)
+:isValid_(false)
+,data_(data)
+,size_(size)
+,offset_(HEADER_SIZE)
+{
+  assert(data!=NULL);
+
+  if (size<static_cast<size_t>(HEADER_SIZE))
+  {
+    return;
+  }
+
+  boost::uint32_t header[2];
+  boost::uint64_t dataSize;
+  std::memcpy(header, data + 4, sizeof(header));
+  std::memcpy(&dataSize, data + 16, sizeof(dataSize));
+  isValid_ = std::memcmp(data, "MWCP", 4)==0 &&
+      header[0]==VERSION &&
+      header[1]==sizeof(Scalar) &&
+      dataSize==size;
+}
+
+template <typename Scalar>
+void ConstantPartArchive<Scalar>::invalidate()
+{
+  isValid_ = false;
+}
+
+template <typename Scalar>
+bool ConstantPartArchive<Scalar>::isAtEnd() const
+{
+  return isLoading() && isValid_ && offset_==size_;
+}
+
+template <typename Scalar>
+const std::vector<char>& ConstantPartArchive<Scalar>::getData() const
+{
+  assert(!isLoading());
+
+  return savedData_;
+}
+
+template <typename Scalar>
+bool ConstantPartArchive<Scalar>::readData(std::istream& stream, std::vector<char>& data)
+{
+  data.resize(HEADER_SIZE);
+  stream.read(&data[0], HEADER_SIZE);
+  if (!stream || std::memcmp(&data[0], "MWCP", 4)!=0)
+  {
+    return false;
+  }
+
+  boost::uint64_t size;
+  std::memcpy(&size, &data[16], sizeof(size));
+  if (size<static_cast<boost::uint64_t>(HEADER_SIZE) || size%8!=0)
+  {
+    return false;
+  }
+  data.resize(size);
+  if (size>static_cast<boost::uint64_t>(HEADER_SIZE))
+  {
+    stream.read(&data[HEADER_SIZE], size - HEADER_SIZE);
+  }
+  return !stream.fail();
+}
+
+template <typename Scalar>
+void ConstantPartArchive<Scalar>::process(bool& value)
+{
+  boost::int32_t v = value ? 1 : 0;
+  processBytes(&v, sizeof(v));
+  if (isLoading())
+  {
+    value = v!=0;
+  }
+}
+
+template <typename Scalar>
+void ConstantPartArchive<Scalar>::process(int& value)
+{
+  boost::int32_t v = value;
+  processBytes(&v, sizeof(v));
+  if (isLoading())
+  {
+    value = v;
+  }
+}
+
+template <typename Scalar>
+void ConstantPartArchive<Scalar>::process(Scalar& value)
+{
+  processBytes(&value, sizeof(value));
+}
+
+template <typename Scalar>
+void ConstantPartArchive<Scalar>::process(std::string& value)
+{
+  int size = processSize(static_cast<int>(value.size()));
+  value.resize(size);
+  if (size>0)
+  {
+    processBytes(&value[0], size);
+  }
+}
+
+template <typename Scalar>
+void ConstantPartArchive<Scalar>::process(std::vector<int>& value)
+{
+  int size = processSize(static_cast<int>(value.size()));
+  value.resize(size);
+  for(int i=0; i<size; ++i)
+  {
+    process(value[i]);
+  }
+}
+
+template <typename Scalar>
+int ConstantPartArchive<Scalar>::processSize(int size)
+{
+  assert(size>=0);
+
+  process(size);
+  // Each element takes at least 8 bytes, which bounds the size before
+  // anything is allocated for a corrupted one
+  if (isLoading() && (size<0 || static_cast<size_t>(size)>(size_ - offset_)/8))
+  {
+    invalidate();
+  }
+  return isValid_ ? size : 0;
+}
+
+template <typename Scalar>
+void ConstantPartArchive<Scalar>::processMatrixSize(int& rows, int& cols)
+{
+  assert(rows>=0 && cols>=0);
+
+  boost::int32_t size[2] = {rows, cols};
+  processBytes(size, sizeof(size));
+  if (isLoading() &&
+      (size[0]<0 || size[1]<0 ||
+       (size[0]>0 && static_cast<size_t>(size[1])>(size_ - offset_)/sizeof(Scalar)/size[0])))
+  {
+    invalidate();
+  }
+
+  rows = isValid_ ? size[0] : 0;
+  cols = isValid_ ? size[1] : 0;
+}
+
+template <typename Scalar>
+void ConstantPartArchive<Scalar>::processData(Scalar* data, int size)
+{
+  if (size>0)
+  {
+    processBytes(data, size*sizeof(Scalar));
+  }
+}
+
+template <typename Scalar>
+void ConstantPartArchive<Scalar>::processBytes(void* bytes, size_t size)
+{
+  const size_t paddedSize = (size + 7)/8*8;
+
+  if (!isLoading())
+  {
+    savedData_.insert(savedData_.end(), static_cast<char*>(bytes),
+                      static_cast<char*>(bytes) + size);
+    savedData_.resize(savedData_.size() + paddedSize - size, 0);
+    const boost::uint64_t dataSize = savedData_.size();
+    std::memcpy(&savedData_[16], &dataSize, sizeof(dataSize));
+    return;
+  }
+
+  if (!isValid_ || paddedSize>size_ - offset_)
+  {
+    isValid_ = false;
+    std::memset(bytes, 0, size);
+    return;
+  }
+  std::memcpy(bytes, data_ + offset_, size);
+  offset_ += paddedSize;
+}
+
+  MPC_WALKGEN_INSTANTIATE_CLASS_TEMPLATE(ConstantPartArchive);
+
+}
@@ -223,6 +223,84 @@ namespace MPCWalkgen
     }
   }
 
+  template <typename Scalar>
+  bool ConvexPolygon<Scalar>::hasXBounds() const
+  {
+    return xInfBound_>-Constant<Scalar>::MAXIMUM_BOUND_VALUE ||
+           xSupBound_<Constant<Scalar>::MAXIMUM_BOUND_VALUE;
+  }
+
+  template <typename Scalar>
+  bool ConvexPolygon<Scalar>::hasYBounds() const
+  {
+    return yInfBound_>-Constant<Scalar>::MAXIMUM_BOUND_VALUE ||
+           ySupBound_<Constant<Scalar>::MAXIMUM_BOUND_VALUE;
+  }
+
+  template <typename Scalar>
+  Scalar ConvexPolygon<Scalar>::computeArea(const vectorOfVector2& p)
+  {
+    int nbVertices = p.size();
+    Scalar area = static_cast<Scalar>(0.0);
+    for (int i=0; i<nbVertices; ++i)
+    {
+      const Vector2& p1 = p[i];
+      const Vector2& p2 = p[(i+1)%nbVertices];
+      area += p1(0)*p2(1) - p2(0)*p1(1);
+    }
+    return static_cast<Scalar>(0.5)*area;
+  }
+
+  template <typename Scalar>
+  typename Type<Scalar>::vectorOfVector2 ConvexPolygon<Scalar>::simplifyVertices(
+      const vectorOfVector2& p,
+      int maxNbVertices,
+      Scalar maxAreaLossRatio)
+  {
+    assert(maxNbVertices>=3);
+    assert(maxAreaLossRatio>=0);
+
+    vectorOfVector2 simplified(p);
+
+    const Scalar maxAreaLoss = maxAreaLossRatio*computeArea(p);
+    Scalar areaLoss = static_cast<Scalar>(0.0);
+
+    while(static_cast<int>(simplified.size())>maxNbVertices)
+    {
+      int nbVertices = simplified.size();
+
+      // Removing vertex i cuts the triangle (i-1, i, i+1) out of the polygon.
+      // As the polygon is convex, this triangle area is the area lost.
+      int index = 0;
+      Scalar smallestTriangleArea = Constant<Scalar>::MAXIMUM_BOUND_VALUE;
+      for (int i=0; i<nbVertices; ++i)
+      {
+        const Vector2& previous = simplified[(i+nbVertices-1)%nbVertices];
+        const Vector2& current = simplified[i];
+        const Vector2& next = simplified[(i+1)%nbVertices];
+
+        Scalar triangleArea = static_cast<Scalar>(0.5)*std::abs(
+              (current(0) - previous(0))*(next(1) - previous(1)) -
+              (current(1) - previous(1))*(next(0) - previous(0)));
+        if(triangleArea<smallestTriangleArea)
+        {
+          smallestTriangleArea = triangleArea;
+          index = i;
+        }
+      }
+
+      if(areaLoss + smallestTriangleArea>maxAreaLoss)
+      {
+        break;
+      }
+
+      areaLoss += smallestTriangleArea;
+      simplified.erase(simplified.begin() + index);
+    }
+
+    return simplified;
+  }
+
   template <typename Scalar>
   void ConvexPolygon<Scalar>::computeBoundsAndGeneralConstraintValues()
   {
@@ -277,5 +355,24 @@ namespace MPCWalkgen
     }
   }
 
+  template <typename Scalar>
+  void ConvexPolygon<Scalar>::archive(ConstantPartArchive<Scalar>& ar)
+  {
+    p_.resize(ar.processSize(static_cast<int>(p_.size())));
+    for(size_t i=0; i<p_.size(); ++i)
+    {
+      ar.process(p_[i]);
+    }
+
+    ar.process(xSupBound_);
+    ar.process(xInfBound_);
+    ar.process(ySupBound_);
+    ar.process(yInfBound_);
+
+    ar.process(generalConstraintsMatrixCoefsForX_);
+    ar.process(generalConstraintsMatrixCoefsForY_);
+    ar.process(generalConstraintsConstantPart_);
+  }
+
   MPC_WALKGEN_INSTANTIATE_CLASS_TEMPLATE(ConvexPolygon);
 }
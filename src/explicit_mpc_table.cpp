@@ -0,0 +1,259 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <mpc-walkgen/explicit_mpc_table.h>
+#include <iostream>
+#include <cstring>
+#include "macro.h"
+
+namespace MPCWalkgen
+{
+
+template <typename Scalar>
+ExplicitMPCTable<Scalar>::ExplicitMPCTable()
+{
+  reset(0);
+}
+
+template <typename Scalar>
+void ExplicitMPCTable<Scalar>::reset(int nbParameters)
+{
+  assert(nbParameters>=0);
+
+  nbParameters_ = nbParameters;
+  nbRegions_ = 0;
+  nbRows_ = 0;
+
+  ownedOffsets_.assign(1, 0);
+  ownedLaws_.clear();
+  ownedRows_.clear();
+  useOwnedStorage();
+}
+
+template <typename Scalar>
+void ExplicitMPCTable<Scalar>::addRegion(const MatrixX& a, const VectorX& b,
+                                         const VectorX& f, Scalar g)
+{
+  assert(a.cols()==nbParameters_);
+  assert(a.rows()==b.size());
+  assert(f.size()==nbParameters_);
+  assert(offsets_==&ownedOffsets_[0]);
+
+  for(int j=0; j<nbParameters_; ++j)
+  {
+    ownedLaws_.push_back(f(j));
+  }
+  ownedLaws_.push_back(g);
+
+  for(int i=0; i<a.rows(); ++i)
+  {
+    for(int j=0; j<nbParameters_; ++j)
+    {
+      ownedRows_.push_back(a(i, j));
+    }
+    ownedRows_.push_back(b(i));
+  }
+
+  ++nbRegions_;
+  nbRows_ += static_cast<int>(a.rows());
+  ownedOffsets_.push_back(static_cast<boost::uint32_t>(nbRows_));
+  useOwnedStorage();
+}
+
+template <typename Scalar>
+int ExplicitMPCTable<Scalar>::findRegion(const VectorX& theta, int hint,
+                                         Scalar tolerance) const
+{
+  assert(theta.size()==nbParameters_);
+  assert(hint<nbRegions_);
+
+  const int rowSize = nbParameters_ + 1;
+
+  // The hint is tested first, then all the regions in their order
+  for(int k=-1; k<nbRegions_; ++k)
+  {
+    int r = k;
+    if (k<0)
+    {
+      if (hint<0)
+      {
+        continue;
+      }
+      r = hint;
+    }
+    else if (k==hint)
+    {
+      continue;
+    }
+
+    bool isInside = true;
+    for(boost::uint32_t i=offsets_[r]; i<offsets_[r+1] && isInside; ++i)
+    {
+      Eigen::Map<const VectorX> row(rows_ + i*rowSize, nbParameters_);
+      isInside = row.dot(theta) <= rows_[i*rowSize + nbParameters_] + tolerance;
+    }
+    if (isInside)
+    {
+      return r;
+    }
+  }
+
+  return -1;
+}
+
+template <typename Scalar>
+Scalar ExplicitMPCTable<Scalar>::computeControl(int region, const VectorX& theta) const
+{
+  assert(region>=0 && region<nbRegions_);
+  assert(theta.size()==nbParameters_);
+
+  const int rowSize = nbParameters_ + 1;
+  Eigen::Map<const VectorX> law(laws_ + region*rowSize, nbParameters_);
+
+  return law.dot(theta) + laws_[region*rowSize + nbParameters_];
+}
+
+template <typename Scalar>
+Scalar ExplicitMPCTable<Scalar>::getLawCoefficient(int region, int parameter) const
+{
+  assert(region>=0 && region<nbRegions_);
+  assert(parameter>=0 && parameter<nbParameters_);
+
+  return laws_[region*(nbParameters_ + 1) + parameter];
+}
+
+template <typename Scalar>
+void ExplicitMPCTable<Scalar>::save(std::ostream& stream) const
+{
+  const boost::uint32_t header[HEADER_SIZE/4 - 1] = {VERSION,
+                                                     sizeof(Scalar),
+                                                     static_cast<boost::uint32_t>(nbParameters_),
+                                                     static_cast<boost::uint32_t>(nbRegions_),
+                                                     static_cast<boost::uint32_t>(nbRows_)};
+  stream.write("MWEX", 4);
+  stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+  std::vector<char> offsets(getOffsetsSize(nbRegions_), 0);
+  std::memcpy(&offsets[0], offsets_, (nbRegions_+1)*sizeof(boost::uint32_t));
+  stream.write(&offsets[0], offsets.size());
+
+  const int rowSize = nbParameters_ + 1;
+  stream.write(reinterpret_cast<const char*>(laws_),
+               nbRegions_*rowSize*sizeof(Scalar));
+  stream.write(reinterpret_cast<const char*>(rows_),
+               nbRows_*rowSize*sizeof(Scalar));
+}
+
+template <typename Scalar>
+bool ExplicitMPCTable<Scalar>::load(std::istream& stream)
+{
+  std::vector<char> data(HEADER_SIZE);
+  stream.read(&data[0], HEADER_SIZE);
+  if (!stream)
+  {
+    reset(0);
+    return false;
+  }
+
+  boost::uint32_t header[HEADER_SIZE/4];
+  std::memcpy(header, &data[0], HEADER_SIZE);
+  if (std::memcmp(&data[0], "MWEX", 4)!=0 ||
+      header[1]!=VERSION ||
+      header[2]!=sizeof(Scalar))
+  {
+    reset(0);
+    return false;
+  }
+  const size_t rowSize = header[3] + 1;
+  const size_t size = HEADER_SIZE + getOffsetsSize(header[4])
+      + (header[4] + header[5])*rowSize*sizeof(Scalar);
+
+  // The table is read in a buffer aligned on 8 bytes, for setData
+  std::vector<boost::uint64_t> buffer(size/8 + 1);
+  char* bytes = reinterpret_cast<char*>(&buffer[0]);
+  std::memcpy(bytes, &data[0], HEADER_SIZE);
+  stream.read(bytes + HEADER_SIZE, size - HEADER_SIZE);
+  if (!stream || !setData(bytes, size))
+  {
+    reset(0);
+    return false;
+  }
+
+  // Copy the table in the owned storage
+  ownedOffsets_.assign(offsets_, offsets_ + nbRegions_ + 1);
+  ownedLaws_.assign(laws_, laws_ + nbRegions_*rowSize);
+  ownedRows_.assign(rows_, rows_ + nbRows_*rowSize);
+  useOwnedStorage();
+
+  return true;
+}
+
+template <typename Scalar>
+bool ExplicitMPCTable<Scalar>::setData(const char* data, size_t size)
+{
+  boost::uint32_t header[HEADER_SIZE/4];
+  if (size<static_cast<size_t>(HEADER_SIZE) ||
+      reinterpret_cast<size_t>(data)%8!=0)
+  {
+    reset(0);
+    return false;
+  }
+  std::memcpy(header, data, HEADER_SIZE);
+
+  const size_t rowSize = header[3] + 1;
+  const size_t offsetsSize = getOffsetsSize(header[4]);
+  if (std::memcmp(data, "MWEX", 4)!=0 ||
+      header[1]!=VERSION ||
+      header[2]!=sizeof(Scalar) ||
+      size!=HEADER_SIZE + offsetsSize + (header[4] + header[5])*rowSize*sizeof(Scalar))
+  {
+    reset(0);
+    return false;
+  }
+
+  const boost::uint32_t* offsets =
+      reinterpret_cast<const boost::uint32_t*>(data + HEADER_SIZE);
+  for(boost::uint32_t r=0; r<header[4]; ++r)
+  {
+    if (offsets[r]>offsets[r+1])
+    {
+      reset(0);
+      return false;
+    }
+  }
+  if (offsets[0]!=0 || offsets[header[4]]!=header[5])
+  {
+    reset(0);
+    return false;
+  }
+
+  nbParameters_ = header[3];
+  nbRegions_ = header[4];
+  nbRows_ = header[5];
+  offsets_ = offsets;
+  laws_ = reinterpret_cast<const Scalar*>(data + HEADER_SIZE + offsetsSize);
+  rows_ = laws_ + nbRegions_*rowSize;
+
+  return true;
+}
+
+template <typename Scalar>
+size_t ExplicitMPCTable<Scalar>::getOffsetsSize(int nbRegions)
+{
+  return ((nbRegions + 1)*sizeof(boost::uint32_t) + 7)/8*8;
+}
+
+template <typename Scalar>
+void ExplicitMPCTable<Scalar>::useOwnedStorage()
+{
+  offsets_ = &ownedOffsets_[0];
+  laws_ = ownedLaws_.empty() ? NULL : &ownedLaws_[0];
+  rows_ = ownedRows_.empty() ? NULL : &ownedRows_[0];
+}
+
+  MPC_WALKGEN_INSTANTIATE_CLASS_TEMPLATE(ExplicitMPCTable);
+
+}
@@ -16,7 +16,7 @@ TrajectoryJerkMinimizationObjective<Scalar>::TrajectoryJerkMinimizationObjective
 ,function_(1)
 {
   function_.fill(0);
-  gradient_.setZero(1, 1);
+  gradient_.setZero(1);
   hessian_.setZero(1, 1);
 
   computeConstantPart();
@@ -30,9 +30,12 @@ template <typename Scalar>
 const typename
 Type<Scalar>::VectorX& TrajectoryJerkMinimizationObjective<Scalar>::getGradient(const VectorX& x0)
 {
-  assert(model_.getNbSamples()==x0.size());
+  assert(model_.getNbVariables()==x0.size());
 
-  return x0;
+  // The hessian is diagonal, each variable being counted once per sample,
+  // with its weight
+  gradient_ = hessian_.diagonal().cwiseProduct(x0);
+  return gradient_;
 }
 
 template <typename Scalar>
@@ -44,8 +47,9 @@ const typename Type<Scalar>::MatrixX& TrajectoryJerkMinimizationObjective<Scalar
 template <typename Scalar>
 void TrajectoryJerkMinimizationObjective<Scalar>::computeConstantPart()
 {
-  int N = model_.getNbSamples();
-  hessian_ = MatrixX::Identity(N, N);
+  const LinearDynamic<Scalar>& dyn = model_.getJerkLinearDynamic();
+
+  hessian_ = dyn.UT*model_.getSampleWeights().asDiagonal()*dyn.U;
 }
 
 namespace MPCWalkgen
@@ -33,7 +33,7 @@ template <typename Scalar>
 const typename
 Type<Scalar>::VectorX& MotionConstraint<Scalar>::getFunctionInf(const VectorX& x0)
 {
-  assert(model_.getNbSamples()==x0.size());
+  assert(model_.getNbVariables()==x0.size());
 
   computeFunction(x0, functionInf_,
                   -model_.getVelocityLimit(),
@@ -46,7 +46,7 @@ template <typename Scalar>
 const typename
 Type<Scalar>::VectorX& MotionConstraint<Scalar>::getFunctionSup(const VectorX& x0)
 {
-  assert(model_.getNbSamples()==x0.size());
+  assert(model_.getNbVariables()==x0.size());
 
   computeFunction(x0, functionSup_,
                   model_.getVelocityLimit(),
@@ -96,9 +96,9 @@ void MotionConstraint<Scalar>::computeConstantPart()
   int N = model_.getNbSamples();
   int M = getNbConstraints();
 
-  gradient_.setZero(M, N);
-  gradient_.block(0, 0, N, N) = dynBaseVel.U;
-  gradient_.block(N, 0, N, N) = dynBaseAcc.U;
+  gradient_.setZero(M, model_.getNbVariables());
+  gradient_.topRows(N) = dynBaseVel.U;
+  gradient_.bottomRows(N) = dynBaseAcc.U;
 
   tmp_.resize(N);
   tmp2_.resize(N);
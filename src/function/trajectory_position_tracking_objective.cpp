@@ -33,8 +33,8 @@ template <typename Scalar>
 const typename
 Type<Scalar>::MatrixX& PositionTrackingObjective<Scalar>::getGradient(const VectorX& x0)
 {
-  assert(posRefInWorldFrame_.size()==x0.size());
   assert(posRefInWorldFrame_.size()==model_.getNbSamples());
+  assert(x0.size()==model_.getNbVariables());
 
   const LinearDynamic<Scalar>& dyn = model_.getPosLinearDynamic();
 
@@ -43,6 +43,7 @@ Type<Scalar>::MatrixX& PositionTrackingObjective<Scalar>::getGradient(const Vect
 
   tmp_.noalias() = dyn.S * model_.getState();
   tmp_.noalias() -= posRefInWorldFrame_;
+  tmp_.array() *= model_.getSampleWeights().array();
   gradient_.noalias() += dyn.UT*tmp_;
   return gradient_;
 }
@@ -70,7 +71,7 @@ void PositionTrackingObjective<Scalar>::computeConstantPart()
 
   int N = model_.getNbSamples();
 
-  hessian_ = dyn.UT*dyn.U;
+  hessian_ = dyn.UT*model_.getSampleWeights().asDiagonal()*dyn.U;
 
   tmp_.resize(N);
 }
@@ -33,8 +33,8 @@ template <typename Scalar>
 const typename
 Type<Scalar>::MatrixX& VelocityTrackingObjective<Scalar>::getGradient(const VectorX& x0)
 {
-  assert(velRefInWorldFrame_.size()==x0.size());
   assert(velRefInWorldFrame_.size()==model_.getNbSamples());
+  assert(x0.size()==model_.getNbVariables());
 
   const LinearDynamic<Scalar>& dyn = model_.getVelLinearDynamic();
 
@@ -43,6 +43,7 @@ Type<Scalar>::MatrixX& VelocityTrackingObjective<Scalar>::getGradient(const Vect
 
   tmp_.noalias() = dyn.S * model_.getState();
   tmp_.noalias() -= velRefInWorldFrame_;
+  tmp_.array() *= model_.getSampleWeights().array();
   gradient_.noalias() += dyn.UT*tmp_;
 
 
@@ -71,7 +72,7 @@ void VelocityTrackingObjective<Scalar>::computeConstantPart()
 
   int N = model_.getNbSamples();
 
-  hessian_ = dyn.UT*dyn.U;
+  hessian_ = dyn.UT*model_.getSampleWeights().asDiagonal()*dyn.U;
 
   tmp_.resize(N);
 }
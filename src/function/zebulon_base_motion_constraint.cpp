@@ -114,6 +114,17 @@ void BaseMotionConstraint<Scalar>::computeConstantPart()
   tmp2_.resize(N);
 }
 
+template <typename Scalar>
+void BaseMotionConstraint<Scalar>::archive(ConstantPartArchive<Scalar>& ar)
+{
+  ar.process(functionInf_);
+  ar.process(functionSup_);
+  ar.process(gradient_);
+  ar.process(hessian_);
+  ar.process(tmp_);
+  ar.process(tmp2_);
+}
+
 namespace MPCWalkgen
 {
   MPC_WALKGEN_INSTANTIATE_CLASS_TEMPLATE(BaseMotionConstraint);
@@ -6,6 +6,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include <mpc-walkgen/function/zebulon_base_velocity_tracking_objective.h>
+#include <mpc-walkgen/tools.h>
 #include "../macro.h"
 
 using namespace MPCWalkgen;
@@ -16,12 +17,12 @@ BaseVelocityTrackingObjective<Scalar>
 :baseModel_(baseModel)
 ,function_(1)
 ,tmp_(1)
+,refTermIsShiftable_(false)
 {
   velRefInWorldFrame_.setZero(2*baseModel_.getNbSamples());
 
   function_.fill(0);
-  gradient_.setZero(1, 1);
-  hessian_.setZero(1, 1);
+  gradient_.setZero(1);
 
   computeConstantPart();
 }
@@ -32,32 +33,74 @@ BaseVelocityTrackingObjective<Scalar>::~BaseVelocityTrackingObjective(){}
 
 template <typename Scalar>
 const typename
-Type<Scalar>::MatrixX& BaseVelocityTrackingObjective<Scalar>::getGradient(const VectorX& x0)
+Type<Scalar>::VectorX& BaseVelocityTrackingObjective<Scalar>::getGradient(const VectorX& x0)
 {
   assert(velRefInWorldFrame_.size()==x0.size());
+
+  hessian_.multiply(x0, gradient_);
+  gradient_ += getLinearTerm();
+
+  return gradient_;
+}
+
+template <typename Scalar>
+const typename Type<Scalar>::VectorX& BaseVelocityTrackingObjective<Scalar>::getLinearTerm()
+{
   assert(velRefInWorldFrame_.size()==baseModel_.getNbSamples()*2);
 
-  const LinearDynamic<Scalar>& dyn = baseModel_.getBaseVelLinearDynamic();
+  computeStateTerm(baseModel_.getNbSamples());
+  linearTerm_ += refTerm_;
+  return linearTerm_;
+}
 
+template <typename Scalar>
+typename Type<Scalar>::VectorX::ConstSegmentReturnType
+BaseVelocityTrackingObjective<Scalar>::getLinearTerm(int nbSamples)
+{
   int N = baseModel_.getNbSamples();
+  assert(nbSamples>0 && nbSamples<=N);
+  assert(velRefInWorldFrame_.size()==N*2);
+
+  if (nbSamples==N)
+  {
+    return getLinearTerm().head(2*N);
+  }
+
+  // refTerm_ is not restricted, as the later samples of the reference
+  // contribute to its first ones
+  const int n = nbSamples;
+  computeStateTerm(n);
+  linearTerm_.segment(0, n).noalias() +=
+      refGradient_.block(0, 0, n, n)*velRefInWorldFrame_.segment(0, n);
+  linearTerm_.segment(n, n).noalias() +=
+      refGradient_.block(N, N, n, n)*velRefInWorldFrame_.segment(N, n);
+
+  const VectorX& linearTerm = linearTerm_;
+  return linearTerm.head(2*n);
+}
 
-  gradient_.noalias() = getHessian()*x0;
-
+template <typename Scalar>
+void BaseVelocityTrackingObjective<Scalar>::computeStateTerm(int nbSamples)
+{
+  const LinearDynamic<Scalar>& dyn = baseModel_.getBaseVelLinearDynamic();
 
-  tmp_.noalias() = dyn.S * baseModel_.getStateX();
-  tmp_.noalias() -= velRefInWorldFrame_.segment(0, N);
-  gradient_.block(0, 0, N, 1).noalias() += dyn.UT*tmp_;
+  int N = baseModel_.getNbSamples();
+  const int n = nbSamples;
+  const VectorX& weights = baseModel_.getSampleWeights();
 
-  tmp_.noalias() = dyn.S * baseModel_.getStateY();
-  tmp_.noalias()-= velRefInWorldFrame_.segment(N, N);
-  gradient_.block(N, 0, N, 1).noalias() += dyn.UT*tmp_;
+  linearTerm_.setZero(2*N);
 
+  tmp_.head(n).noalias() = dyn.S.topRows(n)*baseModel_.getStateX();
+  tmp_.head(n).array() *= weights.head(n).array();
+  linearTerm_.segment(0, n).noalias() += dyn.UT.topLeftCorner(n, n)*tmp_.head(n);
 
-  return gradient_;
+  tmp_.head(n).noalias() = dyn.S.topRows(n)*baseModel_.getStateY();
+  tmp_.head(n).array() *= weights.head(n).array();
+  linearTerm_.segment(n, n).noalias() += dyn.UT.topLeftCorner(n, n)*tmp_.head(n);
 }
 
 template <typename Scalar>
-const typename Type<Scalar>::MatrixX& BaseVelocityTrackingObjective<Scalar>::getHessian()
+const BlockHessian<Scalar>& BaseVelocityTrackingObjective<Scalar>::getHessian()
 {
   return hessian_;
 }
@@ -69,6 +112,39 @@ void BaseVelocityTrackingObjective<Scalar>::setVelRefInWorldFrame(const VectorX&
   assert(velRefInWorldFrame==velRefInWorldFrame);
 
   velRefInWorldFrame_ = velRefInWorldFrame;
+  computeRefTerm();
+}
+
+template <typename Scalar>
+void BaseVelocityTrackingObjective<Scalar>::pushVelRefInWorldFrame(const Vector2& velRefInWorldFrame)
+{
+  assert(velRefInWorldFrame_.size()==baseModel_.getNbSamples()*2);
+  assert(velRefInWorldFrame==velRefInWorldFrame);
+
+  int N = baseModel_.getNbSamples();
+
+  Tools::shiftSamples<Scalar>(velRefInWorldFrame_, 0, N, 2);
+  velRefInWorldFrame_(N - 1) = velRefInWorldFrame(0);
+  velRefInWorldFrame_(2*N - 1) = velRefInWorldFrame(1);
+
+  if (refTermIsShiftable_)
+  {
+    Tools::shiftProduct<Scalar>(refTerm_, refGradient_, velRefInWorldFrame_, N);
+  }
+  else
+  {
+    computeRefTerm();
+  }
+}
+
+template <typename Scalar>
+void BaseVelocityTrackingObjective<Scalar>::computeRefTerm()
+{
+  // The reference is set again after a change of the number of samples
+  if (velRefInWorldFrame_.size()==refGradient_.cols())
+  {
+    refTerm_.noalias() = refGradient_*velRefInWorldFrame_;
+  }
 }
 
 template <typename Scalar>
@@ -77,13 +153,33 @@ void BaseVelocityTrackingObjective<Scalar>::computeConstantPart()
   const LinearDynamic<Scalar>& dyn = baseModel_.getBaseVelLinearDynamic();
 
   int N = baseModel_.getNbSamples();
+  const VectorX& weights = baseModel_.getSampleWeights();
+
+  hessian_.reset(2, N);
+  int index = hessian_.addBlock(dyn.UT*weights.asDiagonal()*dyn.U);
+  hessian_.setBlock(0, 0, index);
+  hessian_.setBlock(1, 1, index);
 
-  hessian_.resize(2*N, 2*N);
-  hessian_.block(0, 0, N, N) = dyn.UT*dyn.U;
-  hessian_.block(N, N, N, N) = dyn.UT*dyn.U;
-  hessian_.block(0, N, N, N).fill(0.0);
-  hessian_.block(N, 0, N, N).fill(0.0);
+  refGradient_.setZero(2*N, 2*N);
+  refGradient_.block(0, 0, N, N) = -dyn.UT*weights.asDiagonal();
+  refGradient_.block(N, N, N, N) = -dyn.UT*weights.asDiagonal();
+  refTermIsShiftable_ = Tools::isBlockUpperToeplitz<Scalar>(refGradient_, N);
   tmp_.resize(N);
+  computeRefTerm();
+}
+
+template <typename Scalar>
+void BaseVelocityTrackingObjective<Scalar>::archive(ConstantPartArchive<Scalar>& ar)
+{
+  ar.process(velRefInWorldFrame_);
+  ar.process(function_);
+  ar.process(gradient_);
+  ar.process(linearTerm_);
+  hessian_.archive(ar);
+  ar.process(tmp_);
+  ar.process(refTerm_);
+  ar.process(refGradient_);
+  ar.process(refTermIsShiftable_);
 }
 
 namespace MPCWalkgen
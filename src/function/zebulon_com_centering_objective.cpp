@@ -6,6 +6,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include <mpc-walkgen/function/zebulon_com_centering_objective.h>
+#include <mpc-walkgen/tools.h>
 #include "../macro.h"
 
 using namespace MPCWalkgen;
@@ -17,17 +18,17 @@ ComCenteringObjective<Scalar>::ComCenteringObjective(const LIPModel<Scalar>& lip
 ,baseModel_(baseModel)
 ,function_(1)
 ,tmp_(1)
+,refTermIsShiftable_(false)
 {
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
 
   comRefInLocalFrame_.setZero(2*baseModel_.getNbSamples());
   comShiftInLocalFrame_.setZero(2*baseModel_.getNbSamples());
   gravityShift_.setZero(2*baseModel_.getNbSamples());
 
   function_.fill(0);
-  gradient_.setZero(1, 1);
-  hessian_.setZero(1, 1);
+  gradient_.setZero(1);
 
   computeConstantPart();
 }
@@ -46,53 +47,92 @@ void ComCenteringObjective<Scalar>::setNbSamples(int nbSamples)
 }
 
 template <typename Scalar>
-const typename Type<Scalar>::MatrixX& ComCenteringObjective<Scalar>::getGradient(const VectorX& x0)
+const typename Type<Scalar>::VectorX& ComCenteringObjective<Scalar>::getGradient(const VectorX& x0)
+{
+  assert(comRefInLocalFrame_.size()*2==x0.size());
+
+  hessian_.multiply(x0, gradient_);
+  gradient_ += getLinearTerm();
+
+  return gradient_;
+}
+
+template <typename Scalar>
+const typename Type<Scalar>::VectorX& ComCenteringObjective<Scalar>::getLinearTerm()
 {
   assert(comShiftInLocalFrame_.size()==comRefInLocalFrame_.size());
   assert(comShiftInLocalFrame_.size()==gravityShift_.size());
-  assert(comRefInLocalFrame_.size()*2==x0.size());
   assert(comRefInLocalFrame_.size()==baseModel_.getNbSamples()*2);
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
-
-  const LinearDynamic<Scalar>& dynBasePos = baseModel_.getBasePosLinearDynamic();
-  const LinearDynamic<Scalar>& dynCom = lipModel_.getComPosLinearDynamic();
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
 
+  computeStateTerm(lipModel_.getNbSamples());
+  linearTerm_ += refTerm_;
+  return linearTerm_;
+}
 
+template <typename Scalar>
+typename Type<Scalar>::VectorX::ConstSegmentReturnType
+ComCenteringObjective<Scalar>::getLinearTerm(int nbSamples)
+{
   int N = lipModel_.getNbSamples();
+  assert(nbSamples>0 && nbSamples<=N);
+  assert(comShiftInLocalFrame_.size()==N*2);
+
+  if (nbSamples==N)
+  {
+    return getLinearTerm().head(4*N);
+  }
+
+  // refTerm_ is not restricted, as the later samples of the reference
+  // contribute to its first ones
+  const int n = nbSamples;
+  computeStateTerm(n);
+  linearTerm_.segment(0, n).noalias() +=
+      refGradient_.block(0, 0, n, n)*comShiftInLocalFrame_.segment(0, n);
+  linearTerm_.segment(n, n).noalias() +=
+      refGradient_.block(N, N, n, n)*comShiftInLocalFrame_.segment(N, n);
+  linearTerm_.segment(2*n, n).noalias() +=
+      refGradient_.block(2*N, 0, n, n)*comShiftInLocalFrame_.segment(0, n);
+  linearTerm_.segment(3*n, n).noalias() +=
+      refGradient_.block(3*N, N, n, n)*comShiftInLocalFrame_.segment(N, n);
+
+  const VectorX& linearTerm = linearTerm_;
+  return linearTerm.head(4*n);
+}
 
-  gradient_.noalias() = getHessian()*x0;
-
-  tmp_.noalias() = -comShiftInLocalFrame_.segment(0, N);
-  tmp_.noalias() += dynCom.S*lipModel_.getStateX();
-  tmp_.noalias() -= dynBasePos.S*baseModel_.getStateX();
-  gradient_.block(0, 0, N, 1).noalias() += dynCom.UT*tmp_;
+template <typename Scalar>
+void ComCenteringObjective<Scalar>::computeStateTerm(int nbSamples)
+{
+  const LinearDynamic<Scalar>& dynBasePos = baseModel_.getBasePosLinearDynamic();
+  const LinearDynamic<Scalar>& dynCom = lipModel_.getComPosLinearDynamic();
 
 
-  tmp_.noalias() = -comShiftInLocalFrame_.segment(N, N);
-  tmp_.noalias() += dynCom.S*lipModel_.getStateY();
-  tmp_.noalias() -= dynBasePos.S*baseModel_.getStateY();
-  gradient_.block(N, 0, N, 1).noalias() += dynCom.UT*tmp_;
+  int N = lipModel_.getNbSamples();
+  const int n = nbSamples;
+  const VectorX& weights = lipModel_.getSampleWeights();
 
-  tmp_.noalias() = comShiftInLocalFrame_.segment(0, N);
-  tmp_.noalias() -= dynCom.S*lipModel_.getStateX();
-  tmp_.noalias() += dynBasePos.S*baseModel_.getStateX();
-  gradient_.block(2*N, 0, N, 1).noalias() += dynBasePos.UT*tmp_;
+  linearTerm_.setZero(4*N);
 
+  tmp_.head(n).noalias() = dynCom.S.topRows(n)*lipModel_.getStateX();
+  tmp_.head(n).noalias() -= dynBasePos.S.topRows(n)*baseModel_.getStateX();
+  tmp_.head(n).array() *= weights.head(n).array();
+  linearTerm_.segment(0, n).noalias() += dynCom.UT.topLeftCorner(n, n)*tmp_.head(n);
+  linearTerm_.segment(2*n, n).noalias() -= dynBasePos.UT.topLeftCorner(n, n)*tmp_.head(n);
 
-  tmp_.noalias() = comShiftInLocalFrame_.segment(N, N);
-  tmp_.noalias() -= dynCom.S*lipModel_.getStateY();
-  tmp_.noalias() += dynBasePos.S*baseModel_.getStateY();
-  gradient_.block(3*N, 0, N, 1).noalias() += dynBasePos.UT*tmp_;
 
-  return gradient_;
+  tmp_.head(n).noalias() = dynCom.S.topRows(n)*lipModel_.getStateY();
+  tmp_.head(n).noalias() -= dynBasePos.S.topRows(n)*baseModel_.getStateY();
+  tmp_.head(n).array() *= weights.head(n).array();
+  linearTerm_.segment(n, n).noalias() += dynCom.UT.topLeftCorner(n, n)*tmp_.head(n);
+  linearTerm_.segment(3*n, n).noalias() -= dynBasePos.UT.topLeftCorner(n, n)*tmp_.head(n);
 }
 
 template <typename Scalar>
-const typename Type<Scalar>::MatrixX& ComCenteringObjective<Scalar>::getHessian()
+const BlockHessian<Scalar>& ComCenteringObjective<Scalar>::getHessian()
 {
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
 
   return hessian_;
 }
@@ -101,7 +141,7 @@ template <typename Scalar>
 void ComCenteringObjective<Scalar>::updateGravityShift()
 {
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
 
   Scalar m  = lipModel_.getMass();
   Scalar M  = baseModel_.getMass();
@@ -120,6 +160,7 @@ void ComCenteringObjective<Scalar>::updateGravityShift()
   gravityShift_.segment(0,N).fill(shiftX);
   gravityShift_.segment(N,N).fill(shiftY);
   comShiftInLocalFrame_ = comRefInLocalFrame_ + gravityShift_;
+  computeRefTerm();
 }
 
 template <typename Scalar>
@@ -127,39 +168,102 @@ void ComCenteringObjective<Scalar>::setComRefInLocalFrame(const VectorX& comRefI
 {
   assert(comRefInWorldFrame.size() == lipModel_.getNbSamples()*2);
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
   assert(comRefInWorldFrame==comRefInWorldFrame);
 
   comRefInLocalFrame_ = comRefInWorldFrame;
   comShiftInLocalFrame_ = comRefInLocalFrame_ + gravityShift_;
+  computeRefTerm();
+}
+
+template <typename Scalar>
+void ComCenteringObjective<Scalar>::pushComRefInLocalFrame(const Vector2& comRefInLocalFrame)
+{
+  assert(comRefInLocalFrame_.size()==lipModel_.getNbSamples()*2);
+  assert(comRefInLocalFrame==comRefInLocalFrame);
+
+  int N = lipModel_.getNbSamples();
+
+  Tools::shiftSamples<Scalar>(comRefInLocalFrame_, 0, N, 2);
+  comRefInLocalFrame_(N - 1) = comRefInLocalFrame(0);
+  comRefInLocalFrame_(2*N - 1) = comRefInLocalFrame(1);
+
+  // The gravity shift is the same for all the samples
+  Tools::shiftSamples<Scalar>(comShiftInLocalFrame_, 0, N, 2);
+  comShiftInLocalFrame_(N - 1) = comRefInLocalFrame(0) + gravityShift_(N - 1);
+  comShiftInLocalFrame_(2*N - 1) = comRefInLocalFrame(1) + gravityShift_(2*N - 1);
+
+  if (refTermIsShiftable_)
+  {
+    Tools::shiftProduct<Scalar>(refTerm_, refGradient_, comShiftInLocalFrame_, N);
+  }
+  else
+  {
+    computeRefTerm();
+  }
+}
+
+template <typename Scalar>
+void ComCenteringObjective<Scalar>::computeRefTerm()
+{
+  // The reference is set again after a change of the number of samples
+  if (comShiftInLocalFrame_.size()==refGradient_.cols())
+  {
+    refTerm_.noalias() = refGradient_*comShiftInLocalFrame_;
+  }
 }
 
 template <typename Scalar>
 void ComCenteringObjective<Scalar>::computeConstantPart()
 {
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
 
   const LinearDynamic<Scalar>& dynBasePos = baseModel_.getBasePosLinearDynamic();
   const LinearDynamic<Scalar>& dynCom = lipModel_.getComPosLinearDynamic();
 
   int N = lipModel_.getNbSamples();
+  const VectorX& weights = lipModel_.getSampleWeights();
 
 
-  hessian_.setZero(4*N, 4*N);
-  hessian_.block(0, 0, N, N) = dynCom.UT*dynCom.U;
-  hessian_.block(N, N, N, N) = dynCom.UT*dynCom.U;
+  hessian_.reset(4, N);
+  int comIndex = hessian_.addBlock(dynCom.UT*weights.asDiagonal()*dynCom.U);
+  hessian_.setBlock(0, 0, comIndex);
+  hessian_.setBlock(1, 1, comIndex);
 
-  hessian_.block(2*N, 2*N, N, N) = dynBasePos.UT*dynBasePos.U;
-  hessian_.block(3*N, 3*N, N, N) = dynBasePos.UT*dynBasePos.U;
+  int baseIndex = hessian_.addBlock(dynBasePos.UT*weights.asDiagonal()*dynBasePos.U);
+  hessian_.setBlock(2, 2, baseIndex);
+  hessian_.setBlock(3, 3, baseIndex);
 
-  hessian_.block(2*N, 0, N, N) = -dynBasePos.UT*dynCom.U;
-  hessian_.block(3*N, N, N, N) = -dynBasePos.UT*dynCom.U;
+  int crossIndex = hessian_.addBlock(dynCom.UT*weights.asDiagonal()*dynBasePos.U);
+  hessian_.setBlock(0, 2, crossIndex, -1);
+  hessian_.setBlock(1, 3, crossIndex, -1);
 
-  hessian_.block(0, 2*N, N, N) = -dynCom.UT*dynBasePos.U;
-  hessian_.block(N, 3*N, N, N) = -dynCom.UT*dynBasePos.U;
+  refGradient_.setZero(4*N, 2*N);
+  refGradient_.block(0, 0, N, N) = -dynCom.UT*weights.asDiagonal();
+  refGradient_.block(N, N, N, N) = -dynCom.UT*weights.asDiagonal();
+  refGradient_.block(2*N, 0, N, N) = dynBasePos.UT*weights.asDiagonal();
+  refGradient_.block(3*N, N, N, N) = dynBasePos.UT*weights.asDiagonal();
+  refTermIsShiftable_ = Tools::isBlockUpperToeplitz<Scalar>(refGradient_, N);
 
   tmp_.resize(N);
+  computeRefTerm();
+}
+
+template <typename Scalar>
+void ComCenteringObjective<Scalar>::archive(ConstantPartArchive<Scalar>& ar)
+{
+  ar.process(comRefInLocalFrame_);
+  ar.process(comShiftInLocalFrame_);
+  ar.process(gravityShift_);
+  ar.process(function_);
+  ar.process(gradient_);
+  ar.process(linearTerm_);
+  hessian_.archive(ar);
+  ar.process(tmp_);
+  ar.process(refTerm_);
+  ar.process(refGradient_);
+  ar.process(refTermIsShiftable_);
 }
 
 namespace MPCWalkgen
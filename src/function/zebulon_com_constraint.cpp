@@ -6,6 +6,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include <mpc-walkgen/function/zebulon_com_constraint.h>
+#include <mpc-walkgen/constant.h>
 #include "../macro.h"
 
 using namespace MPCWalkgen;
@@ -15,18 +16,23 @@ ComConstraint<Scalar>::ComConstraint(const LIPModel<Scalar>& lipModel,
                                      const BaseModel<Scalar>& baseModel)
 :lipModel_(lipModel)
 ,baseModel_(baseModel)
-,function_(1)
+,functionInf_(1)
+,functionSup_(1)
 ,b_(1)
+,relPos_(1)
 ,tmp_(1)
 {
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
 
-  function_.fill(0);
+  functionInf_.fill(0);
+  functionSup_.fill(0);
   gradient_.setZero(1, 1);
   hessian_.setZero(1, 1);
   A_.setZero(1, 1);
   b_.fill(0);
+  relPosGradient_.setZero(1, 1);
+  relPos_.fill(0);
 
   computeConstantPart();
 }
@@ -36,11 +42,11 @@ template <typename Scalar>
 ComConstraint<Scalar>::~ComConstraint(){}
 
 template <typename Scalar>
-const typename Type<Scalar>::VectorX& ComConstraint<Scalar>::getFunction(const VectorX& x0)
+void ComConstraint<Scalar>::computeRelativePosition(const VectorX& x0)
 {
   assert(baseModel_.getNbSamples()*4==x0.size());
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
 
   const LinearDynamic<Scalar>& dynBasePos = baseModel_.getBasePosLinearDynamic();
   const LinearDynamic<Scalar>& dynCom = lipModel_.getComPosLinearDynamic();
@@ -52,18 +58,70 @@ const typename Type<Scalar>::VectorX& ComConstraint<Scalar>::getFunction(const V
   tmp_.segment(N, N).noalias() = dynCom.S * lipModel_.getStateY() ;
   tmp_.segment(N, N).noalias() -= dynBasePos.S * baseModel_.getStateY();
 
-  function_.noalias() = -b_;
-  function_.noalias() -= getGradient()*x0;
-  function_.noalias() -= A_*tmp_;
+  relPos_.noalias() = relPosGradient_*x0;
+  relPos_ += tmp_;
+}
+
+template <typename Scalar>
+const typename Type<Scalar>::VectorX& ComConstraint<Scalar>::getFunctionInf(const VectorX& x0)
+{
+  computeRelativePosition(x0);
+
+  int N = lipModel_.getNbSamples();
+  const ConvexPolygon<Scalar>& supportConvexPolygon = baseModel_.getComSupportConvexPolygon();
+  int nbGeneralConstraints = N*supportConvexPolygon.getNbGeneralConstraints();
+
+  functionInf_.segment(0, nbGeneralConstraints).noalias() = b_;
+  functionInf_.segment(0, nbGeneralConstraints).noalias() += A_*relPos_;
 
-  return function_;
+  int index = nbGeneralConstraints;
+  if (supportConvexPolygon.hasXBounds())
+  {
+    functionInf_.segment(index, N).fill(supportConvexPolygon.getXInfBound());
+    functionInf_.segment(index, N) -= relPos_.segment(0, N);
+    index += N;
+  }
+  if (supportConvexPolygon.hasYBounds())
+  {
+    functionInf_.segment(index, N).fill(supportConvexPolygon.getYInfBound());
+    functionInf_.segment(index, N) -= relPos_.segment(N, N);
+  }
+
+  return functionInf_;
+}
+
+template <typename Scalar>
+const typename Type<Scalar>::VectorX& ComConstraint<Scalar>::getFunctionSup(const VectorX& x0)
+{
+  computeRelativePosition(x0);
+
+  int N = lipModel_.getNbSamples();
+  const ConvexPolygon<Scalar>& supportConvexPolygon = baseModel_.getComSupportConvexPolygon();
+  int nbGeneralConstraints = N*supportConvexPolygon.getNbGeneralConstraints();
+
+  functionSup_.segment(0, nbGeneralConstraints).fill(Constant<Scalar>::MAXIMUM_BOUND_VALUE);
+
+  int index = nbGeneralConstraints;
+  if (supportConvexPolygon.hasXBounds())
+  {
+    functionSup_.segment(index, N).fill(supportConvexPolygon.getXSupBound());
+    functionSup_.segment(index, N) -= relPos_.segment(0, N);
+    index += N;
+  }
+  if (supportConvexPolygon.hasYBounds())
+  {
+    functionSup_.segment(index, N).fill(supportConvexPolygon.getYSupBound());
+    functionSup_.segment(index, N) -= relPos_.segment(N, N);
+  }
+
+  return functionSup_;
 }
 
 template <typename Scalar>
 const typename Type<Scalar>::MatrixX& ComConstraint<Scalar>::getGradient()
 {
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
 
   return gradient_;
 }
@@ -73,14 +131,25 @@ int ComConstraint<Scalar>::getNbConstraints()
 {
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
 
-  return baseModel_.getNbSamples()*baseModel_.getComSupportConvexPolygon().getNbVertices();
+  const ConvexPolygon<Scalar>& supportConvexPolygon = baseModel_.getComSupportConvexPolygon();
+  int nbRowsPerSample = supportConvexPolygon.getNbGeneralConstraints();
+  if (supportConvexPolygon.hasXBounds())
+  {
+    ++nbRowsPerSample;
+  }
+  if (supportConvexPolygon.hasYBounds())
+  {
+    ++nbRowsPerSample;
+  }
+
+  return baseModel_.getNbSamples()*nbRowsPerSample;
 }
 
 template <typename Scalar>
 void ComConstraint<Scalar>::computeConstantPart()
 {
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
 
   computeconstraintMatrices();
 
@@ -89,16 +158,32 @@ void ComConstraint<Scalar>::computeConstantPart()
 
   int N = lipModel_.getNbSamples();
 
+  relPosGradient_.setZero(2*N, 4*N);
+  relPosGradient_.block(0, 0, N, N) = dynCom.U;
+  relPosGradient_.block(N, N, N, N) = dynCom.U;
+  relPosGradient_.block(0, 2*N, N, N) = -dynBasePos.U;
+  relPosGradient_.block(N, 3*N, N, N) = -dynBasePos.U;
+
+  const ConvexPolygon<Scalar>& supportConvexPolygon = baseModel_.getComSupportConvexPolygon();
+  int nbGeneralConstraints = N*supportConvexPolygon.getNbGeneralConstraints();
 
-  MatrixX tmp(2*N, 4*N);
-  tmp.fill(0.0);
-  tmp.block(0, 0, N, N) = dynCom.U;
-  tmp.block(N, N, N, N) = dynCom.U;
-  tmp.block(0, 2*N, N, N) = -dynBasePos.U;
-  tmp.block(N, 3*N, N, N) = -dynBasePos.U;
+  gradient_.resize(getNbConstraints(), 4*N);
+  gradient_.topRows(nbGeneralConstraints).noalias() = -A_ * relPosGradient_;
 
-  gradient_ = A_ * tmp;
+  int index = nbGeneralConstraints;
+  if (supportConvexPolygon.hasXBounds())
+  {
+    gradient_.middleRows(index, N) = relPosGradient_.topRows(N);
+    index += N;
+  }
+  if (supportConvexPolygon.hasYBounds())
+  {
+    gradient_.middleRows(index, N) = relPosGradient_.bottomRows(N);
+  }
 
+  functionInf_.resize(getNbConstraints());
+  functionSup_.resize(getNbConstraints());
+  relPos_.resize(2*N);
   tmp_.resize(2*N);
 
 }
@@ -108,25 +193,40 @@ void ComConstraint<Scalar>::computeconstraintMatrices()
 {
   int N = lipModel_.getNbSamples();
   const ConvexPolygon<Scalar>& supportConvexPolygon = baseModel_.getComSupportConvexPolygon();
-  int M = supportConvexPolygon.getNbVertices();
+  int M = supportConvexPolygon.getNbGeneralConstraints();
+
+  const VectorX& coefsForX = supportConvexPolygon.getGeneralConstraintsMatrixCoefsForX();
+  const VectorX& coefsForY = supportConvexPolygon.getGeneralConstraintsMatrixCoefsForY();
+  const VectorX& constantPart = supportConvexPolygon.getGeneralConstraintsConstantPart();
 
   A_.setZero(M*N, 2*N);
   b_.resize(M*N);
 
   for(int i=0; i<M; ++i)
   {
-    const Vector2& p1 = supportConvexPolygon.getVertices()[i];
-    const Vector2& p2 = supportConvexPolygon.getVertices()[(i+1)%M];
-
     for(int j=0; j<N; ++j)
     {
-      A_(i*N+j, j) = p2(1)-p1(1);
-      A_(i*N+j, j+N) = -p2(0)+p1(0);
-      b_(i*N+j) = -p1(1)*(p2(0)-p1(0)) + p1(0)*(p2(1)-p1(1));
+      A_(i*N+j, j) = coefsForX(i);
+      A_(i*N+j, j+N) = coefsForY(i);
+      b_(i*N+j) = constantPart(i);
     }
   }
 }
 
+template <typename Scalar>
+void ComConstraint<Scalar>::archive(ConstantPartArchive<Scalar>& ar)
+{
+  ar.process(functionInf_);
+  ar.process(functionSup_);
+  ar.process(gradient_);
+  ar.process(hessian_);
+  ar.process(A_);
+  ar.process(b_);
+  ar.process(relPosGradient_);
+  ar.process(relPos_);
+  ar.process(tmp_);
+}
+
 namespace MPCWalkgen
 {
   MPC_WALKGEN_INSTANTIATE_CLASS_TEMPLATE(ComConstraint);
@@ -7,6 +7,7 @@
 
 #include <mpc-walkgen/function/zebulon_cop_centering_objective.h>
 #include <mpc-walkgen/constant.h>
+#include <mpc-walkgen/tools.h>
 #include "../macro.h"
 
 using namespace MPCWalkgen;
@@ -17,14 +18,14 @@ CopCenteringObjective<Scalar>::CopCenteringObjective(const LIPModel<Scalar>& lip
 :lipModel_(lipModel)
 ,baseModel_(baseModel)
 ,function_(1)
+,refTermIsShiftable_(false)
 {
   copRefInLocalFrame_.setZero(2*baseModel_.getNbSamples());
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
 
   function_.fill(0);
-  gradient_.setZero(1, 1);
-  hessian_.setZero(1, 1);
+  gradient_.setZero(1);
 
   computeConstantPart();
 }
@@ -34,19 +35,69 @@ template <typename Scalar>
 CopCenteringObjective<Scalar>::~CopCenteringObjective(){}
 
 template <typename Scalar>
-const typename Type<Scalar>::MatrixX& CopCenteringObjective<Scalar>::getGradient(const VectorX& x0)
+const typename Type<Scalar>::VectorX& CopCenteringObjective<Scalar>::getGradient(const VectorX& x0)
 {
   assert(copRefInLocalFrame_.size()*2==x0.size());
+
+  hessian_.multiply(x0, gradient_);
+  gradient_ += getLinearTerm();
+
+  return gradient_;
+}
+
+template <typename Scalar>
+const typename Type<Scalar>::VectorX& CopCenteringObjective<Scalar>::getLinearTerm()
+{
   assert(copRefInLocalFrame_.size()==baseModel_.getNbSamples()*2);
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
+
+  computeStateTerm(lipModel_.getNbSamples());
+  linearTerm_ += refTerm_;
+  return linearTerm_;
+}
+
+template <typename Scalar>
+typename Type<Scalar>::VectorX::ConstSegmentReturnType
+CopCenteringObjective<Scalar>::getLinearTerm(int nbSamples)
+{
+  int N = lipModel_.getNbSamples();
+  assert(nbSamples>0 && nbSamples<=N);
+  assert(copRefInLocalFrame_.size()==N*2);
 
+  if (nbSamples==N)
+  {
+    return getLinearTerm().head(4*N);
+  }
+
+  // refTerm_ is not restricted, as the later samples of the reference
+  // contribute to its first ones
+  const int n = nbSamples;
+  computeStateTerm(n);
+  linearTerm_.segment(0, n).noalias() +=
+      refGradient_.block(0, 0, n, n)*copRefInLocalFrame_.segment(0, n);
+  linearTerm_.segment(n, n).noalias() +=
+      refGradient_.block(N, N, n, n)*copRefInLocalFrame_.segment(N, n);
+  linearTerm_.segment(2*n, n).noalias() +=
+      refGradient_.block(2*N, 0, n, n)*copRefInLocalFrame_.segment(0, n);
+  linearTerm_.segment(3*n, n).noalias() +=
+      refGradient_.block(3*N, N, n, n)*copRefInLocalFrame_.segment(N, n);
+
+  const VectorX& linearTerm = linearTerm_;
+  return linearTerm.head(4*n);
+}
+
+template <typename Scalar>
+void CopCenteringObjective<Scalar>::computeStateTerm(int nbSamples)
+{
   const LinearDynamic<Scalar>& dynBasePos = baseModel_.getBasePosLinearDynamic();
 
 
   int N = lipModel_.getNbSamples();
+  const int n = nbSamples;
+  const VectorX& weights = lipModel_.getSampleWeights();
 
-  gradient_.noalias() = getHessian()*x0;
+  linearTerm_.setZero(4*N);
 
   const LinearDynamic<Scalar>& dynCopXCom = lipModel_.getCopXLinearDynamic();
   const LinearDynamic<Scalar>& dynCopYCom = lipModel_.getCopYLinearDynamic();
@@ -56,63 +107,79 @@ const typename Type<Scalar>::MatrixX& CopCenteringObjective<Scalar>::getGradient
     const LinearDynamic<Scalar>& dynCopXBase = baseModel_.getCopXLinearDynamic();
     const LinearDynamic<Scalar>& dynCopYBase = baseModel_.getCopYLinearDynamic();
 
-    tmp_.noalias() = -copRefInLocalFrame_.segment(0, N);
-    tmp_.noalias() += dynCopXCom.S*lipModel_.getStateX() + dynCopXCom.K;
-    tmp_.noalias() += (dynCopXBase.S-dynBasePos.S)*baseModel_.getStateX() + dynCopXBase.K;
-    gradient_.block(0, 0, N, 1).noalias() += dynCopXCom.UT*tmp_;
-
-
-    tmp_.noalias() = -copRefInLocalFrame_.segment(N, N);
-    tmp_.noalias() += dynCopYCom.S*lipModel_.getStateY() + dynCopYCom.K;
-    tmp_.noalias() += (dynCopYBase.S-dynBasePos.S)*baseModel_.getStateY() + dynCopYBase.K;
-    gradient_.block(N, 0, N, 1).noalias() += dynCopYCom.UT*tmp_;
-
-    tmp_.noalias() = -copRefInLocalFrame_.segment(0, N);
-    tmp_.noalias() += dynCopXCom.S*lipModel_.getStateX() + dynCopXCom.K;
-    tmp_.noalias() += (dynCopXBase.S-dynBasePos.S)*baseModel_.getStateX() + dynCopXBase.K;
-    gradient_.block(2*N, 0, N, 1).noalias() += (dynCopXBase.UT-dynBasePos.UT)*tmp_;
-
-
-    tmp_.noalias() = -copRefInLocalFrame_.segment(N, N);
-    tmp_.noalias() += dynCopYCom.S*lipModel_.getStateY() + dynCopYCom.K;
-    tmp_.noalias() += (dynCopYBase.S-dynBasePos.S)*baseModel_.getStateY() + dynCopYBase.K;
-    gradient_.block(3*N, 0, N, 1).noalias() += (dynCopYBase.UT-dynBasePos.UT)*tmp_;
+    tmp_.head(n).noalias() = dynCopXCom.S.topRows(n)*lipModel_.getStateX();
+    tmp_.head(n) += dynCopXCom.K.head(n);
+    tmp_.head(n).noalias() += dynCopXBase.S.topRows(n)*baseModel_.getStateX();
+    tmp_.head(n).noalias() -= dynBasePos.S.topRows(n)*baseModel_.getStateX();
+    tmp_.head(n) += dynCopXBase.K.head(n);
+    tmp_.head(n).array() *= weights.head(n).array();
+    linearTerm_.segment(0, n).noalias() += dynCopXCom.UT.topLeftCorner(n, n)*tmp_.head(n);
+
+
+    tmp_.head(n).noalias() = dynCopYCom.S.topRows(n)*lipModel_.getStateY();
+    tmp_.head(n) += dynCopYCom.K.head(n);
+    tmp_.head(n).noalias() += dynCopYBase.S.topRows(n)*baseModel_.getStateY();
+    tmp_.head(n).noalias() -= dynBasePos.S.topRows(n)*baseModel_.getStateY();
+    tmp_.head(n) += dynCopYBase.K.head(n);
+    tmp_.head(n).array() *= weights.head(n).array();
+    linearTerm_.segment(n, n).noalias() += dynCopYCom.UT.topLeftCorner(n, n)*tmp_.head(n);
+
+    tmp_.head(n).noalias() = dynCopXCom.S.topRows(n)*lipModel_.getStateX();
+    tmp_.head(n) += dynCopXCom.K.head(n);
+    tmp_.head(n).noalias() += dynCopXBase.S.topRows(n)*baseModel_.getStateX();
+    tmp_.head(n).noalias() -= dynBasePos.S.topRows(n)*baseModel_.getStateX();
+    tmp_.head(n) += dynCopXBase.K.head(n);
+    tmp_.head(n).array() *= weights.head(n).array();
+    linearTerm_.segment(2*n, n).noalias() += dynCopXBase.UT.topLeftCorner(n, n)*tmp_.head(n);
+    linearTerm_.segment(2*n, n).noalias() -= dynBasePos.UT.topLeftCorner(n, n)*tmp_.head(n);
+
+
+    tmp_.head(n).noalias() = dynCopYCom.S.topRows(n)*lipModel_.getStateY();
+    tmp_.head(n) += dynCopYCom.K.head(n);
+    tmp_.head(n).noalias() += dynCopYBase.S.topRows(n)*baseModel_.getStateY();
+    tmp_.head(n).noalias() -= dynBasePos.S.topRows(n)*baseModel_.getStateY();
+    tmp_.head(n) += dynCopYBase.K.head(n);
+    tmp_.head(n).array() *= weights.head(n).array();
+    linearTerm_.segment(3*n, n).noalias() += dynCopYBase.UT.topLeftCorner(n, n)*tmp_.head(n);
+    linearTerm_.segment(3*n, n).noalias() -= dynBasePos.UT.topLeftCorner(n, n)*tmp_.head(n);
 
   }
   else
   {
 
-    tmp_.noalias() = -copRefInLocalFrame_.segment(0, N);
-    tmp_.noalias() += dynCopXCom.S*lipModel_.getStateX() + dynCopXCom.K;
-    tmp_.noalias() -= dynBasePos.S*baseModel_.getStateX();
-    gradient_.block(0, 0, N, 1).noalias() += dynCopXCom.UT*tmp_;
+    tmp_.head(n).noalias() = dynCopXCom.S.topRows(n)*lipModel_.getStateX();
+    tmp_.head(n) += dynCopXCom.K.head(n);
+    tmp_.head(n).noalias() -= dynBasePos.S.topRows(n)*baseModel_.getStateX();
+    tmp_.head(n).array() *= weights.head(n).array();
+    linearTerm_.segment(0, n).noalias() += dynCopXCom.UT.topLeftCorner(n, n)*tmp_.head(n);
 
 
-    tmp_.noalias() = -copRefInLocalFrame_.segment(N, N);
-    tmp_.noalias() += dynCopYCom.S*lipModel_.getStateY() + dynCopYCom.K;
-    tmp_.noalias() -= dynBasePos.S*baseModel_.getStateY();
-    gradient_.block(N, 0, N, 1).noalias() += dynCopYCom.UT*tmp_;
+    tmp_.head(n).noalias() = dynCopYCom.S.topRows(n)*lipModel_.getStateY();
+    tmp_.head(n) += dynCopYCom.K.head(n);
+    tmp_.head(n).noalias() -= dynBasePos.S.topRows(n)*baseModel_.getStateY();
+    tmp_.head(n).array() *= weights.head(n).array();
+    linearTerm_.segment(n, n).noalias() += dynCopYCom.UT.topLeftCorner(n, n)*tmp_.head(n);
 
-    tmp_.noalias() = copRefInLocalFrame_.segment(0, N);
-    tmp_.noalias() -= dynCopXCom.S*lipModel_.getStateX() + dynCopXCom.K;
-    tmp_.noalias() += dynBasePos.S*baseModel_.getStateX();
-    gradient_.block(2*N, 0, N, 1).noalias() += dynBasePos.UT*tmp_;
+    tmp_.head(n).noalias() = -dynCopXCom.S.topRows(n)*lipModel_.getStateX();
+    tmp_.head(n) -= dynCopXCom.K.head(n);
+    tmp_.head(n).noalias() += dynBasePos.S.topRows(n)*baseModel_.getStateX();
+    tmp_.head(n).array() *= weights.head(n).array();
+    linearTerm_.segment(2*n, n).noalias() += dynBasePos.UT.topLeftCorner(n, n)*tmp_.head(n);
 
 
-    tmp_.noalias() = copRefInLocalFrame_.segment(N, N);
-    tmp_.noalias() -= dynCopYCom.S*lipModel_.getStateY() + dynCopYCom.K;
-    tmp_.noalias() += dynBasePos.S*baseModel_.getStateY();
-    gradient_.block(3*N, 0, N, 1).noalias() += dynBasePos.UT*tmp_;
+    tmp_.head(n).noalias() = -dynCopYCom.S.topRows(n)*lipModel_.getStateY();
+    tmp_.head(n) -= dynCopYCom.K.head(n);
+    tmp_.head(n).noalias() += dynBasePos.S.topRows(n)*baseModel_.getStateY();
+    tmp_.head(n).array() *= weights.head(n).array();
+    linearTerm_.segment(3*n, n).noalias() += dynBasePos.UT.topLeftCorner(n, n)*tmp_.head(n);
   }
-
-  return gradient_;
 }
 
 template <typename Scalar>
-const typename Type<Scalar>::MatrixX& CopCenteringObjective<Scalar>::getHessian()
+const BlockHessian<Scalar>& CopCenteringObjective<Scalar>::getHessian()
 {
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
 
   return hessian_;
 }
@@ -122,59 +189,116 @@ void CopCenteringObjective<Scalar>::setCopRefInLocalFrame(const VectorX& copRefI
 {
   assert(copRefInWorldFrame.size() == lipModel_.getNbSamples()*2);
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
   assert(copRefInWorldFrame==copRefInWorldFrame);
 
   copRefInLocalFrame_ = copRefInWorldFrame;
+  computeRefTerm();
+}
+
+template <typename Scalar>
+void CopCenteringObjective<Scalar>::pushCopRefInLocalFrame(const Vector2& copRefInLocalFrame)
+{
+  assert(copRefInLocalFrame_.size()==lipModel_.getNbSamples()*2);
+  assert(copRefInLocalFrame==copRefInLocalFrame);
+
+  int N = lipModel_.getNbSamples();
+
+  Tools::shiftSamples<Scalar>(copRefInLocalFrame_, 0, N, 2);
+  copRefInLocalFrame_(N - 1) = copRefInLocalFrame(0);
+  copRefInLocalFrame_(2*N - 1) = copRefInLocalFrame(1);
+
+  if (refTermIsShiftable_)
+  {
+    Tools::shiftProduct<Scalar>(refTerm_, refGradient_, copRefInLocalFrame_, N);
+  }
+  else
+  {
+    computeRefTerm();
+  }
+}
+
+template <typename Scalar>
+void CopCenteringObjective<Scalar>::computeRefTerm()
+{
+  // The reference is set again after a change of the number of samples
+  if (copRefInLocalFrame_.size()==refGradient_.cols())
+  {
+    refTerm_.noalias() = refGradient_*copRefInLocalFrame_;
+  }
 }
 
 template <typename Scalar>
 void CopCenteringObjective<Scalar>::computeConstantPart()
 {
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
 
   const LinearDynamic<Scalar>& dynBasePos = baseModel_.getBasePosLinearDynamic();
   int N = lipModel_.getNbSamples();
+  const VectorX& weights = lipModel_.getSampleWeights();
 
   const LinearDynamic<Scalar>& dynCopXCom = lipModel_.getCopXLinearDynamic();
   const LinearDynamic<Scalar>& dynCopYCom = lipModel_.getCopYLinearDynamic();
 
-  hessian_.setZero(4*N, 4*N);
+  // X and Y blocks are only stored once when the X and Y CoP dynamics are
+  // identical, which is the case when the gravity is vertical
+  hessian_.reset(4, N);
+  hessian_.setBlock(0, 0, hessian_.addBlock(dynCopXCom.UT*weights.asDiagonal()*dynCopXCom.U));
+  hessian_.setBlock(1, 1, hessian_.addBlock(dynCopYCom.UT*weights.asDiagonal()*dynCopYCom.U));
 
   if (baseModel_.getMass()>Constant<Scalar>::EPSILON)
   {
     const LinearDynamic<Scalar>& dynCopXBase = baseModel_.getCopXLinearDynamic();
     const LinearDynamic<Scalar>& dynCopYBase = baseModel_.getCopYLinearDynamic();
 
-    hessian_.block(0, 0, N, N) = dynCopXCom.UT*dynCopXCom.U;
-    hessian_.block(N, N, N, N) = dynCopYCom.UT*dynCopYCom.U;
+    hessian_.setBlock(2, 2, hessian_.addBlock((dynCopXBase.UT-dynBasePos.UT)*weights.asDiagonal()
+                                              *(dynCopXBase.U-dynBasePos.U)));
+    hessian_.setBlock(3, 3, hessian_.addBlock((dynCopYBase.UT-dynBasePos.UT)*weights.asDiagonal()
+                                              *(dynCopYBase.U-dynBasePos.U)));
 
-    hessian_.block(2*N, 2*N, N, N) = (dynCopXBase.UT-dynBasePos.UT)*(dynCopXBase.U-dynBasePos.U);
-    hessian_.block(3*N, 3*N, N, N) = (dynCopYBase.UT-dynBasePos.UT)*(dynCopYBase.U-dynBasePos.U);
+    hessian_.setBlock(0, 2, hessian_.addBlock(dynCopXCom.UT*weights.asDiagonal()
+                                              *(dynCopXBase.U-dynBasePos.U)));
+    hessian_.setBlock(1, 3, hessian_.addBlock(dynCopYCom.UT*weights.asDiagonal()
+                                              *(dynCopYBase.U-dynBasePos.U)));
 
-    hessian_.block(2*N, 0, N, N) = (dynCopXBase.UT-dynBasePos.UT)*dynCopXCom.U;
-    hessian_.block(3*N, N, N, N) = (dynCopYBase.UT-dynBasePos.UT)*dynCopYCom.U;
-
-    hessian_.block(0, 2*N, N, N) = dynCopXCom.UT*(dynCopXBase.U-dynBasePos.U);
-    hessian_.block(N, 3*N, N, N) = dynCopYCom.UT*(dynCopYBase.U-dynBasePos.U);
+    refGradient_.setZero(4*N, 2*N);
+    refGradient_.block(2*N, 0, N, N) = (dynBasePos.UT-dynCopXBase.UT)*weights.asDiagonal();
+    refGradient_.block(3*N, N, N, N) = (dynBasePos.UT-dynCopYBase.UT)*weights.asDiagonal();
   }
   else
   {
-    hessian_.block(0, 0, N, N) = dynCopXCom.UT*dynCopXCom.U;
-    hessian_.block(N, N, N, N) = dynCopYCom.UT*dynCopYCom.U;
-
-    hessian_.block(2*N, 2*N, N, N) = dynBasePos.UT*dynBasePos.U;
-    hessian_.block(3*N, 3*N, N, N) = dynBasePos.UT*dynBasePos.U;
+    int baseIndex = hessian_.addBlock(dynBasePos.UT*weights.asDiagonal()*dynBasePos.U);
+    hessian_.setBlock(2, 2, baseIndex);
+    hessian_.setBlock(3, 3, baseIndex);
 
-    hessian_.block(2*N, 0, N, N) = -dynBasePos.UT*dynCopXCom.U;
-    hessian_.block(3*N, N, N, N) = -dynBasePos.UT*dynCopYCom.U;
+    hessian_.setBlock(0, 2, hessian_.addBlock(dynCopXCom.UT*weights.asDiagonal()*dynBasePos.U), -1);
+    hessian_.setBlock(1, 3, hessian_.addBlock(dynCopYCom.UT*weights.asDiagonal()*dynBasePos.U), -1);
 
-    hessian_.block(0, 2*N, N, N) = -dynCopXCom.UT*dynBasePos.U;
-    hessian_.block(N, 3*N, N, N) = -dynCopYCom.UT*dynBasePos.U;
+    refGradient_.setZero(4*N, 2*N);
+    refGradient_.block(2*N, 0, N, N) = dynBasePos.UT*weights.asDiagonal();
+    refGradient_.block(3*N, N, N, N) = dynBasePos.UT*weights.asDiagonal();
   }
+  refGradient_.block(0, 0, N, N) = -dynCopXCom.UT*weights.asDiagonal();
+  refGradient_.block(N, N, N, N) = -dynCopYCom.UT*weights.asDiagonal();
+  refTermIsShiftable_ = Tools::isBlockUpperToeplitz<Scalar>(refGradient_, N);
 
   tmp_.resize(N);
+  computeRefTerm();
+}
+
+template <typename Scalar>
+void CopCenteringObjective<Scalar>::archive(ConstantPartArchive<Scalar>& ar)
+{
+  ar.process(copRefInLocalFrame_);
+  ar.process(function_);
+  ar.process(gradient_);
+  ar.process(linearTerm_);
+  hessian_.archive(ar);
+  ar.process(tmp_);
+  ar.process(refTerm_);
+  ar.process(refGradient_);
+  ar.process(refTermIsShiftable_);
 }
 
 namespace MPCWalkgen
@@ -16,18 +16,23 @@ CopConstraint<Scalar>::CopConstraint(const LIPModel<Scalar>& lipModel,
                                      const BaseModel<Scalar>& baseModel)
 :lipModel_(lipModel)
 ,baseModel_(baseModel)
-,function_(1)
+,functionInf_(1)
+,functionSup_(1)
 ,b_(1)
+,relPos_(1)
 ,tmp_(1)
 {
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
 
-  function_.fill(0);
+  functionInf_.fill(0);
+  functionSup_.fill(0);
   gradient_.setZero(1, 1);
   hessian_.setZero(1, 1);
   A_.setZero(1, 1);
   b_.fill(0);
+  relPosGradient_.setZero(1, 1);
+  relPos_.fill(0);
 
   computeConstantPart();
 }
@@ -37,11 +42,11 @@ template <typename Scalar>
 CopConstraint<Scalar>::~CopConstraint(){}
 
 template <typename Scalar>
-const typename Type<Scalar>::VectorX& CopConstraint<Scalar>::getFunction(const VectorX& x0)
+void CopConstraint<Scalar>::computeRelativePosition(const VectorX& x0)
 {
   assert(baseModel_.getNbSamples()*4==x0.size());
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
 
   const LinearDynamic<Scalar>& dynBasePos = baseModel_.getBasePosLinearDynamic();
   int N = lipModel_.getNbSamples();
@@ -54,33 +59,89 @@ const typename Type<Scalar>::VectorX& CopConstraint<Scalar>::getFunction(const V
     const LinearDynamic<Scalar>& dynCopXBase = baseModel_.getCopXLinearDynamic();
     const LinearDynamic<Scalar>& dynCopYBase = baseModel_.getCopYLinearDynamic();
 
-    tmp_.segment(0, N).noalias() = dynCopXCom.S * lipModel_.getStateX() + dynCopXCom.K;
-    tmp_.segment(0, N).noalias() +=
-        (dynCopXBase.S-dynBasePos.S) * baseModel_.getStateX() + dynCopXBase.K;
-    tmp_.segment(N, N).noalias() = dynCopYCom.S * lipModel_.getStateY() + dynCopYCom.K;
-    tmp_.segment(N, N).noalias() +=
-        (dynCopYBase.S-dynBasePos.S) * baseModel_.getStateY() + dynCopYBase.K;
+    tmp_.segment(0, N).noalias() = dynCopXCom.S * lipModel_.getStateX();
+    tmp_.segment(0, N).noalias() += dynCopXBase.S * baseModel_.getStateX();
+    tmp_.segment(0, N).noalias() -= dynBasePos.S * baseModel_.getStateX();
+    tmp_.segment(0, N) += dynCopXCom.K + dynCopXBase.K;
+    tmp_.segment(N, N).noalias() = dynCopYCom.S * lipModel_.getStateY();
+    tmp_.segment(N, N).noalias() += dynCopYBase.S * baseModel_.getStateY();
+    tmp_.segment(N, N).noalias() -= dynBasePos.S * baseModel_.getStateY();
+    tmp_.segment(N, N) += dynCopYCom.K + dynCopYBase.K;
   }
   else
   {
-    tmp_.segment(0, N).noalias() = dynCopXCom.S * lipModel_.getStateX() + dynCopXCom.K;
+    tmp_.segment(0, N).noalias() = dynCopXCom.S * lipModel_.getStateX();
     tmp_.segment(0, N).noalias() -= dynBasePos.S * baseModel_.getStateX();
-    tmp_.segment(N, N).noalias() = dynCopYCom.S * lipModel_.getStateY() + dynCopYCom.K;
+    tmp_.segment(0, N) += dynCopXCom.K;
+    tmp_.segment(N, N).noalias() = dynCopYCom.S * lipModel_.getStateY();
     tmp_.segment(N, N).noalias() -= dynBasePos.S * baseModel_.getStateY();
+    tmp_.segment(N, N) += dynCopYCom.K;
+  }
+
+  relPos_.noalias() = relPosGradient_*x0;
+  relPos_ += tmp_;
+}
+
+template <typename Scalar>
+const typename Type<Scalar>::VectorX& CopConstraint<Scalar>::getFunctionInf(const VectorX& x0)
+{
+  computeRelativePosition(x0);
+
+  int N = lipModel_.getNbSamples();
+  const ConvexPolygon<Scalar>& supportConvexPolygon = baseModel_.getCopSupportConvexPolygon();
+  int nbGeneralConstraints = N*supportConvexPolygon.getNbGeneralConstraints();
+
+  functionInf_.segment(0, nbGeneralConstraints).noalias() = b_;
+  functionInf_.segment(0, nbGeneralConstraints).noalias() += A_*relPos_;
+
+  int index = nbGeneralConstraints;
+  if (supportConvexPolygon.hasXBounds())
+  {
+    functionInf_.segment(index, N).fill(supportConvexPolygon.getXInfBound());
+    functionInf_.segment(index, N) -= relPos_.segment(0, N);
+    index += N;
+  }
+  if (supportConvexPolygon.hasYBounds())
+  {
+    functionInf_.segment(index, N).fill(supportConvexPolygon.getYInfBound());
+    functionInf_.segment(index, N) -= relPos_.segment(N, N);
   }
 
-  function_.noalias() = -b_;
-  function_.noalias() -= getGradient()*x0;
-  function_.noalias() -= A_*tmp_;
+  return functionInf_;
+}
+
+template <typename Scalar>
+const typename Type<Scalar>::VectorX& CopConstraint<Scalar>::getFunctionSup(const VectorX& x0)
+{
+  computeRelativePosition(x0);
+
+  int N = lipModel_.getNbSamples();
+  const ConvexPolygon<Scalar>& supportConvexPolygon = baseModel_.getCopSupportConvexPolygon();
+  int nbGeneralConstraints = N*supportConvexPolygon.getNbGeneralConstraints();
+
+  functionSup_.segment(0, nbGeneralConstraints).fill(Constant<Scalar>::MAXIMUM_BOUND_VALUE);
 
-  return function_;
+  int index = nbGeneralConstraints;
+  if (supportConvexPolygon.hasXBounds())
+  {
+    functionSup_.segment(index, N).fill(supportConvexPolygon.getXSupBound());
+    functionSup_.segment(index, N) -= relPos_.segment(0, N);
+    index += N;
+  }
+  if (supportConvexPolygon.hasYBounds())
+  {
+    functionSup_.segment(index, N).fill(supportConvexPolygon.getYSupBound());
+    functionSup_.segment(index, N) -= relPos_.segment(N, N);
+  }
+
+  return functionSup_;
 }
 
 template <typename Scalar>
 const typename Type<Scalar>::MatrixX& CopConstraint<Scalar>::getGradient()
 {
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
 
   return gradient_;
 }
@@ -90,14 +151,25 @@ int CopConstraint<Scalar>::getNbConstraints()
 {
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
 
-  return baseModel_.getNbSamples()*baseModel_.getCopSupportConvexPolygon().getNbVertices();
+  const ConvexPolygon<Scalar>& supportConvexPolygon = baseModel_.getCopSupportConvexPolygon();
+  int nbRowsPerSample = supportConvexPolygon.getNbGeneralConstraints();
+  if (supportConvexPolygon.hasXBounds())
+  {
+    ++nbRowsPerSample;
+  }
+  if (supportConvexPolygon.hasYBounds())
+  {
+    ++nbRowsPerSample;
+  }
+
+  return baseModel_.getNbSamples()*nbRowsPerSample;
 }
 
 template <typename Scalar>
 void CopConstraint<Scalar>::computeConstantPart()
 {
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
 
   computeconstraintMatrices();
 
@@ -108,29 +180,46 @@ void CopConstraint<Scalar>::computeConstantPart()
   const LinearDynamic<Scalar>& dynCopXCom = lipModel_.getCopXLinearDynamic();
   const LinearDynamic<Scalar>& dynCopYCom = lipModel_.getCopYLinearDynamic();
 
-  MatrixX tmp(2*N, 4*N);
-  tmp.fill(0.0);
+  relPosGradient_.setZero(2*N, 4*N);
 
   if (baseModel_.getMass()>Constant<Scalar>::EPSILON)
   {
     const LinearDynamic<Scalar>& dynCopXBase = baseModel_.getCopXLinearDynamic();
     const LinearDynamic<Scalar>& dynCopYBase = baseModel_.getCopYLinearDynamic();
 
-    tmp.block(0, 0, N, N) = dynCopXCom.U;
-    tmp.block(N, N, N, N) = dynCopYCom.U;
-    tmp.block(0, 2*N, N, N) = (dynCopXBase.U-dynBasePos.U);
-    tmp.block(N, 3*N, N, N) = (dynCopYBase.U-dynBasePos.U);
+    relPosGradient_.block(0, 0, N, N) = dynCopXCom.U;
+    relPosGradient_.block(N, N, N, N) = dynCopYCom.U;
+    relPosGradient_.block(0, 2*N, N, N) = (dynCopXBase.U-dynBasePos.U);
+    relPosGradient_.block(N, 3*N, N, N) = (dynCopYBase.U-dynBasePos.U);
   }
   else
   {
-    tmp.block(0, 0, N, N) = dynCopXCom.U;
-    tmp.block(N, N, N, N) = dynCopYCom.U;
-    tmp.block(0, 2*N, N, N) = -dynBasePos.U;
-    tmp.block(N, 3*N, N, N) = -dynBasePos.U;
+    relPosGradient_.block(0, 0, N, N) = dynCopXCom.U;
+    relPosGradient_.block(N, N, N, N) = dynCopYCom.U;
+    relPosGradient_.block(0, 2*N, N, N) = -dynBasePos.U;
+    relPosGradient_.block(N, 3*N, N, N) = -dynBasePos.U;
   }
 
-  gradient_ = A_ * tmp;
+  const ConvexPolygon<Scalar>& supportConvexPolygon = baseModel_.getCopSupportConvexPolygon();
+  int nbGeneralConstraints = N*supportConvexPolygon.getNbGeneralConstraints();
+
+  gradient_.resize(getNbConstraints(), 4*N);
+  gradient_.topRows(nbGeneralConstraints).noalias() = -A_ * relPosGradient_;
+
+  int index = nbGeneralConstraints;
+  if (supportConvexPolygon.hasXBounds())
+  {
+    gradient_.middleRows(index, N) = relPosGradient_.topRows(N);
+    index += N;
+  }
+  if (supportConvexPolygon.hasYBounds())
+  {
+    gradient_.middleRows(index, N) = relPosGradient_.bottomRows(N);
+  }
 
+  functionInf_.resize(getNbConstraints());
+  functionSup_.resize(getNbConstraints());
+  relPos_.resize(2*N);
   tmp_.resize(2*N);
 
 }
@@ -140,26 +229,41 @@ void CopConstraint<Scalar>::computeconstraintMatrices()
 {
   int N = lipModel_.getNbSamples();
   const ConvexPolygon<Scalar>& supportConvexPolygon = baseModel_.getCopSupportConvexPolygon();
-  int M = supportConvexPolygon.getNbVertices();
+  int M = supportConvexPolygon.getNbGeneralConstraints();
+
+  const VectorX& coefsForX = supportConvexPolygon.getGeneralConstraintsMatrixCoefsForX();
+  const VectorX& coefsForY = supportConvexPolygon.getGeneralConstraintsMatrixCoefsForY();
+  const VectorX& constantPart = supportConvexPolygon.getGeneralConstraintsConstantPart();
 
   A_.setZero(M*N, 2*N);
   b_.resize(M*N);
 
   for(int i=0; i<M; ++i)
   {
-    const Vector2& p1 = supportConvexPolygon.getVertices()[i];
-    const Vector2& p2 = supportConvexPolygon.getVertices()[(i+1)%M];
-
     for(int j=0; j<N; ++j)
     {
-      A_(i*N+j, j) = p2(1)-p1(1);
-      A_(i*N+j, j+N) = -p2(0)+p1(0);
-      b_(i*N+j) = -p1(1)*(p2(0)-p1(0)) + p1(0)*(p2(1)-p1(1));
+      A_(i*N+j, j) = coefsForX(i);
+      A_(i*N+j, j+N) = coefsForY(i);
+      b_(i*N+j) = constantPart(i);
     }
   }
 
 }
 
+template <typename Scalar>
+void CopConstraint<Scalar>::archive(ConstantPartArchive<Scalar>& ar)
+{
+  ar.process(functionInf_);
+  ar.process(functionSup_);
+  ar.process(gradient_);
+  ar.process(hessian_);
+  ar.process(A_);
+  ar.process(b_);
+  ar.process(relPosGradient_);
+  ar.process(relPos_);
+  ar.process(tmp_);
+}
+
 namespace MPCWalkgen
 {
   MPC_WALKGEN_INSTANTIATE_CLASS_TEMPLATE(CopConstraint);
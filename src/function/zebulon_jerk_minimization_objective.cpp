@@ -18,11 +18,10 @@ JerkMinimizationObjective<Scalar>::JerkMinimizationObjective(const LIPModel<Scal
 ,function_(1)
 {
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
 
   function_.fill(0);
-  gradient_.setZero(1, 1);
-  hessian_.setZero(1, 1);
+  gradient_.setZero(1);
 
   computeConstantPart();
 }
@@ -38,14 +37,15 @@ Type<Scalar>::VectorX& JerkMinimizationObjective<Scalar>::getGradient(const Vect
   assert(baseModel_.getNbSamples()*4==x0.size());
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
 
-  return x0;
+  hessian_.multiply(x0, gradient_);
+  return gradient_;
 }
 
 template <typename Scalar>
-const typename Type<Scalar>::MatrixX& JerkMinimizationObjective<Scalar>::getHessian()
+const BlockHessian<Scalar>& JerkMinimizationObjective<Scalar>::getHessian()
 {
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
 
   return hessian_;
 }
@@ -54,10 +54,23 @@ template <typename Scalar>
 void JerkMinimizationObjective<Scalar>::computeConstantPart()
 {
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
 
   int N = baseModel_.getNbSamples();
-  hessian_ = MatrixX::Identity(N*4, N*4);
+  hessian_.reset(4, N);
+  int index = hessian_.addBlock(MatrixX(lipModel_.getSampleWeights().asDiagonal()));
+  for(int i=0; i<4; ++i)
+  {
+    hessian_.setBlock(i, i, index);
+  }
+}
+
+template <typename Scalar>
+void JerkMinimizationObjective<Scalar>::archive(ConstantPartArchive<Scalar>& ar)
+{
+  ar.process(function_);
+  ar.process(gradient_);
+  hessian_.archive(ar);
 }
 
 namespace MPCWalkgen
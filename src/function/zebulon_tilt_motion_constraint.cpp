@@ -18,7 +18,7 @@ TiltMotionConstraint<Scalar>::TiltMotionConstraint(const LIPModel<Scalar>& lipMo
 ,function_(1)
 {
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
 
   function_.fill(0);
   gradient_.setZero(1, 1);
@@ -36,7 +36,7 @@ const typename Type<Scalar>::VectorX& TiltMotionConstraint<Scalar>::getFunction(
 {
   assert(baseModel_.getNbSamples()*4==x0.size());
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
 
 
   int N = baseModel_.getNbSamples();
@@ -47,10 +47,10 @@ const typename Type<Scalar>::VectorX& TiltMotionConstraint<Scalar>::getFunction(
 
 
   function_.noalias() = -getGradient()*x0;
-  function_.segment(0, N).noalias() -= dynComVel.S * lipModel_.getStateX()*std::sin(theta);
-  function_.segment(0, N).noalias() += dynComVel.S * lipModel_.getStateY()*std::cos(theta);
-  function_.segment(N, N).noalias() -= dynBaseVel.S * baseModel_.getStateX()*std::sin(theta);
-  function_.segment(N, N).noalias() += dynBaseVel.S * baseModel_.getStateY()*std::cos(theta);
+  function_.segment(0, N).noalias() -= std::sin(theta)*dynComVel.S * lipModel_.getStateX();
+  function_.segment(0, N).noalias() += std::cos(theta)*dynComVel.S * lipModel_.getStateY();
+  function_.segment(N, N).noalias() -= std::sin(theta)*dynBaseVel.S * baseModel_.getStateX();
+  function_.segment(N, N).noalias() += std::cos(theta)*dynBaseVel.S * baseModel_.getStateY();
 
 
   return function_;
@@ -61,7 +61,7 @@ template <typename Scalar>
 const typename Type<Scalar>::MatrixX& TiltMotionConstraint<Scalar>::getGradient()
 {
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
 
   return gradient_;
 }
@@ -76,7 +76,7 @@ template <typename Scalar>
 void TiltMotionConstraint<Scalar>::computeConstantPart()
 {
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
 
   const LinearDynamic<Scalar>& dynBaseVel = baseModel_.getBaseVelLinearDynamic();
   const LinearDynamic<Scalar>& dynComVel = lipModel_.getComVelLinearDynamic();
@@ -85,13 +85,21 @@ void TiltMotionConstraint<Scalar>::computeConstantPart()
   int M = getNbConstraints();
   Scalar theta = baseModel_.getStateYaw()(0);
 
-  gradient_.resize(M, 4*N);
+  gradient_.setZero(M, 4*N);
   gradient_.block(0, 0, N, N) = dynComVel.U*std::sin(theta);
   gradient_.block(0, N, N, N) = -dynComVel.U*std::cos(theta);
   gradient_.block(N, 2*N, N, N) = dynBaseVel.U*std::sin(theta);
   gradient_.block(N, 3*N, N, N) = -dynBaseVel.U*std::cos(theta);
 }
 
+template <typename Scalar>
+void TiltMotionConstraint<Scalar>::archive(ConstantPartArchive<Scalar>& ar)
+{
+  ar.process(function_);
+  ar.process(gradient_);
+  ar.process(hessian_);
+}
+
 namespace MPCWalkgen
 {
   MPC_WALKGEN_INSTANTIATE_CLASS_TEMPLATE(TiltMotionConstraint);
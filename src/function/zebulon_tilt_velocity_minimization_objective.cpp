@@ -20,11 +20,10 @@ TiltVelMinimizationObjective<Scalar>::TiltVelMinimizationObjective(const LIPMode
 ,function_(1)
 {
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
 
   function_.fill(0);
-  gradient_.setZero(1, 1);
-  hessian_.setZero(1, 1);
+  gradient_.setZero(1);
 
   computeConstantPart();
 }
@@ -35,34 +34,70 @@ TiltVelMinimizationObjective<Scalar>::~TiltVelMinimizationObjective(){}
 
 template <typename Scalar>
 const typename
-Type<Scalar>::MatrixX& TiltVelMinimizationObjective<Scalar>::getGradient(const VectorX& x0)
+Type<Scalar>::VectorX& TiltVelMinimizationObjective<Scalar>::getGradient(const VectorX& x0)
 {
   assert(baseModel_.getNbSamples()*4==x0.size());
-  assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
 
-  int N = baseModel_.getNbSamples();
+  hessian_.multiply(x0, gradient_);
+  gradient_ += getLinearTerm();
 
-  gradient_.noalias() = getHessian()*x0;
+  return gradient_;
+}
 
-  VectorX Kx = dynC_.S*lipModel_.getStateX() + dynB_.S*baseModel_.getStateX()
-             + dynPsiX_.S*baseModel_.getStateRoll().segment(0, 2) + dynPsiX_.K;
-  VectorX Ky = dynC_.S*lipModel_.getStateY() + dynB_.S*baseModel_.getStateY()
-             + dynPsiY_.S*baseModel_.getStatePitch().segment(0, 2) + dynPsiY_.K ;
+template <typename Scalar>
+const typename Type<Scalar>::VectorX& TiltVelMinimizationObjective<Scalar>::getLinearTerm()
+{
+  assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
 
-  gradient_.block(0, 0, N, 1).noalias() += dynC_.UT*Kx;
-  gradient_.block(N, 0, N, 1).noalias() += dynC_.UT*Ky;
+  computeStateTerm(baseModel_.getNbSamples());
+  return linearTerm_;
+}
 
-  gradient_.block(2*N, 0, N, 1).noalias() += dynB_.UT*Kx;
-  gradient_.block(3*N, 0, N, 1).noalias() += dynB_.UT*Ky;
+template <typename Scalar>
+typename Type<Scalar>::VectorX::ConstSegmentReturnType
+TiltVelMinimizationObjective<Scalar>::getLinearTerm(int nbSamples)
+{
+  assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
+  assert(nbSamples>0 && nbSamples<=baseModel_.getNbSamples());
 
-  return gradient_;
+  computeStateTerm(nbSamples);
+  const VectorX& linearTerm = linearTerm_;
+  return linearTerm.head(4*nbSamples);
 }
 
 template <typename Scalar>
-const typename Type<Scalar>::MatrixX& TiltVelMinimizationObjective<Scalar>::getHessian()
+void TiltVelMinimizationObjective<Scalar>::computeStateTerm(int nbSamples)
+{
+  int N = baseModel_.getNbSamples();
+  const int n = nbSamples;
+  const VectorX& weights = lipModel_.getSampleWeights();
+
+  linearTerm_.setZero(4*N);
+
+  // Products are accumulated one by one, so that no temporary is allocated
+  tmpX_.head(n).noalias() = dynC_.S.topRows(n)*lipModel_.getStateX();
+  tmpX_.head(n).noalias() += dynB_.S.topRows(n)*baseModel_.getStateX();
+  tmpX_.head(n).noalias() += dynPsiX_.S.topRows(n)*baseModel_.getStateRoll().segment(0, 2);
+  tmpX_.head(n) += dynPsiX_.K.head(n);
+  tmpY_.head(n).noalias() = dynC_.S.topRows(n)*lipModel_.getStateY();
+  tmpY_.head(n).noalias() += dynB_.S.topRows(n)*baseModel_.getStateY();
+  tmpY_.head(n).noalias() += dynPsiY_.S.topRows(n)*baseModel_.getStatePitch().segment(0, 2);
+  tmpY_.head(n) += dynPsiY_.K.head(n);
+
+  tmpX_.head(n).array() *= weights.head(n).array();
+  tmpY_.head(n).array() *= weights.head(n).array();
+  linearTerm_.segment(0, n).noalias() += dynC_.UT.topLeftCorner(n, n)*tmpX_.head(n);
+  linearTerm_.segment(n, n).noalias() += dynC_.UT.topLeftCorner(n, n)*tmpY_.head(n);
+
+  linearTerm_.segment(2*n, n).noalias() += dynB_.UT.topLeftCorner(n, n)*tmpX_.head(n);
+  linearTerm_.segment(3*n, n).noalias() += dynB_.UT.topLeftCorner(n, n)*tmpY_.head(n);
+}
+
+template <typename Scalar>
+const BlockHessian<Scalar>& TiltVelMinimizationObjective<Scalar>::getHessian()
 {
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
 
   return hessian_;
 }
@@ -71,7 +106,7 @@ template <typename Scalar>
 void TiltVelMinimizationObjective<Scalar>::updateTiltContactPoint()
 {
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
 
   int N = baseModel_.getNbSamples();
   Scalar dbx = baseModel_.getTiltContactPointX();
@@ -107,9 +142,10 @@ template <typename Scalar>
 void TiltVelMinimizationObjective<Scalar>::computeConstantPart()
 {
   assert(baseModel_.getNbSamples() == lipModel_.getNbSamples());
-  assert(baseModel_.getSamplingPeriod() == lipModel_.getSamplingPeriod());
+  assert(baseModel_.getSamplingPeriods() == lipModel_.getSamplingPeriods());
 
   int N = baseModel_.getNbSamples();
+  const VectorX& weights = lipModel_.getSampleWeights();
   Scalar L = baseModel_.getComHeight();
   Scalar h = lipModel_.getComHeight();
   Scalar m = lipModel_.getMass();
@@ -166,19 +202,38 @@ void TiltVelMinimizationObjective<Scalar>::computeConstantPart()
   dynB_.UT = dynB_.U.transpose();
   dynB_.S = uInv_*(-A4*dynBaseAcc.S - A2*dynBasePos.S);
 
-  //Compute the hessian
-  hessian_.setZero(4*N, 4*N);
-  hessian_.block(0, 0, N, N) = dynC_.UT*dynC_.U;
-  hessian_.block(N, N, N, N) = dynC_.UT*dynC_.U;
+  tmpX_.resize(N);
+  tmpY_.resize(N);
 
-  hessian_.block(2*N, 2*N, N, N) = dynB_.UT*dynB_.U;
-  hessian_.block(3*N, 3*N, N, N) = dynB_.UT*dynB_.U;
-
-  hessian_.block(2*N, 0, N, N) = dynB_.UT*dynC_.U;
-  hessian_.block(3*N, N, N, N) = dynB_.UT*dynC_.U;
+  //Compute the hessian
+  hessian_.reset(4, N);
+  int comIndex = hessian_.addBlock(dynC_.UT*weights.asDiagonal()*dynC_.U);
+  hessian_.setBlock(0, 0, comIndex);
+  hessian_.setBlock(1, 1, comIndex);
+
+  int baseIndex = hessian_.addBlock(dynB_.UT*weights.asDiagonal()*dynB_.U);
+  hessian_.setBlock(2, 2, baseIndex);
+  hessian_.setBlock(3, 3, baseIndex);
+
+  int crossIndex = hessian_.addBlock(dynC_.UT*weights.asDiagonal()*dynB_.U);
+  hessian_.setBlock(0, 2, crossIndex);
+  hessian_.setBlock(1, 3, crossIndex);
+}
 
-  hessian_.block(0, 2*N, N, N) = dynC_.UT*dynB_.U;
-  hessian_.block(N, 3*N, N, N) = dynC_.UT*dynB_.U;
+template <typename Scalar>
+void TiltVelMinimizationObjective<Scalar>::archive(ConstantPartArchive<Scalar>& ar)
+{
+  ar.process(function_);
+  ar.process(gradient_);
+  ar.process(linearTerm_);
+  ar.process(tmpX_);
+  ar.process(tmpY_);
+  hessian_.archive(ar);
+  ar.process(uInv_);
+  dynB_.archive(ar);
+  dynC_.archive(ar);
+  dynPsiX_.archive(ar);
+  dynPsiY_.archive(ar);
 }
 
 namespace MPCWalkgen
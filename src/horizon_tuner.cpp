@@ -0,0 +1,107 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\file horizon_tuner.cpp
+///\brief Choose the number of samples of a walkgen from its solve times
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <mpc-walkgen/horizon_tuner.h>
+#include "macro.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace MPCWalkgen
+{
+  template <typename Scalar>
+  HorizonTuner<Scalar>::HorizonTuner()
+  {
+    setConfig(HorizonTunerConfig<Scalar>());
+  }
+
+  template <typename Scalar>
+  void HorizonTuner<Scalar>::setConfig(const HorizonTunerConfig<Scalar>& config)
+  {
+    assert(config.minNbSamples>0);
+    assert(config.maxNbSamples>=config.minNbSamples);
+    assert(config.nbSamplesStep>0);
+    assert(config.percentile>=0 && config.percentile<=1);
+    assert(config.windowSize>0);
+    assert(config.increaseRatio>=0 && config.increaseRatio<=1);
+
+    config_ = config;
+    solveTimes_.assign(config_.windowSize, 0);
+    sortedSolveTimes_.assign(config_.windowSize, 0);
+    reset();
+  }
+
+  template <typename Scalar>
+  void HorizonTuner<Scalar>::reset()
+  {
+    nbSolveTimes_ = 0;
+    nextSolveTime_ = 0;
+  }
+
+  template <typename Scalar>
+  int HorizonTuner<Scalar>::addSolveTime(Scalar solveTime, int nbSamples)
+  {
+    if (!isEnabled())
+    {
+      return nbSamples;
+    }
+
+    int newNbSamples = std::max(config_.minNbSamples,
+                                std::min(config_.maxNbSamples, nbSamples));
+    if (newNbSamples!=nbSamples)
+    {
+      reset();
+      return newNbSamples;
+    }
+
+    solveTimes_[nextSolveTime_] = solveTime;
+    nextSolveTime_ = (nextSolveTime_ + 1)%config_.windowSize;
+    nbSolveTimes_ = std::min(nbSolveTimes_ + 1, config_.windowSize);
+    if (nbSolveTimes_<config_.windowSize)
+    {
+      return nbSamples;
+    }
+
+    const Scalar solveTimePercentile = getSolveTimePercentile();
+    if (solveTimePercentile>config_.solveTimeBudget)
+    {
+      newNbSamples = std::max(config_.minNbSamples, nbSamples - config_.nbSamplesStep);
+    }
+    else if (solveTimePercentile<config_.increaseRatio*config_.solveTimeBudget)
+    {
+      newNbSamples = std::min(config_.maxNbSamples, nbSamples + config_.nbSamplesStep);
+    }
+
+    if (newNbSamples!=nbSamples)
+    {
+      reset();
+    }
+    return newNbSamples;
+  }
+
+  template <typename Scalar>
+  Scalar HorizonTuner<Scalar>::getSolveTimePercentile() const
+  {
+    if (nbSolveTimes_==0)
+    {
+      return 0;
+    }
+
+    // The solve times are stored from index 0 until the window is full
+    std::copy(solveTimes_.begin(), solveTimes_.begin() + nbSolveTimes_,
+              sortedSolveTimes_.begin());
+    const int index = std::min(nbSolveTimes_ - 1,
+                               static_cast<int>(std::ceil(config_.percentile*nbSolveTimes_)) - 1);
+    typename std::vector<Scalar>::iterator nth = sortedSolveTimes_.begin() + std::max(index, 0);
+    std::nth_element(sortedSolveTimes_.begin(), nth,
+                     sortedSolveTimes_.begin() + nbSolveTimes_);
+    return *nth;
+  }
+
+  MPC_WALKGEN_INSTANTIATE_CLASS_TEMPLATE(HorizonTuner);
+}
@@ -9,6 +9,7 @@
 #include <mpc-walkgen/humanoid_feet_supervisor.h>
 #include <mpc-walkgen/constant.h>
 #include "macro.h"
+#include <algorithm>
 
 namespace MPCWalkgen
 {
@@ -73,6 +74,9 @@ namespace MPCWalkgen
     ,horizonTimer_(0)
     ,move_(false)
     ,phase_(Phase<Scalar>::DS, DSPeriod_)
+    ,lastUpdatePhaseType_(Phase<Scalar>::DS)
+    ,lastUpdateHasFlyingFoot_(false)
+    ,lastUpdateFeedbackPeriod_(0)
   {
     init();
   }
@@ -93,6 +97,9 @@ namespace MPCWalkgen
     ,horizonTimer_(0)
     ,move_(false)
     ,phase_(Phase<Scalar>::DS, DSPeriod_)
+    ,lastUpdatePhaseType_(Phase<Scalar>::DS)
+    ,lastUpdateHasFlyingFoot_(false)
+    ,lastUpdateFeedbackPeriod_(0)
   {
     init();
   }
@@ -416,7 +423,7 @@ namespace MPCWalkgen
 
   //TODO: change for getSupportFootStateXAtPhase(int phaseIndex)?
   template <typename Scalar>
-  const typename Type<Scalar>::VectorX& HumanoidFeetSupervisor<Scalar>::getSupportFootStateX() const
+  const typename Type<Scalar>::Vector3& HumanoidFeetSupervisor<Scalar>::getSupportFootStateX() const
   {
     if(timeline_.front().phaseType_ == Phase<Scalar>::rightSS)
     {
@@ -431,7 +438,7 @@ namespace MPCWalkgen
   }
 
   template <typename Scalar>
-  const typename Type<Scalar>::VectorX& HumanoidFeetSupervisor<Scalar>::getSupportFootStateY() const
+  const typename Type<Scalar>::Vector3& HumanoidFeetSupervisor<Scalar>::getSupportFootStateY() const
   {
     if(timeline_.front().phaseType_ == Phase<Scalar>::rightSS)
     {
@@ -538,6 +545,13 @@ namespace MPCWalkgen
       horizonTimer_ -= samplingPeriod_;
     }
 
+    // The variable has too many steps if the phases were longer when it was
+    // built, e.g. after copyStateFrom
+    if(move_ && (variable.rows() > 2*nbSamples_ + 2*nbPreviewedSteps_))
+    {
+      shortenStepVecTo(variable, nbPreviewedSteps_);
+    }
+
     //Removing useless phases
     timeline_.set_capacity(phaseIndex + 1);
 
@@ -556,6 +570,10 @@ namespace MPCWalkgen
     stepVec_ = stepVec;
     Scalar flyingTime = timeline_.front().duration_ - samplingPeriod_;
 
+    lastUpdatePhaseType_ = timeline_.front().phaseType_;
+    lastUpdateHasFlyingFoot_ = false;
+    lastUpdateFeedbackPeriod_ = feedBackPeriod;
+
     // This "if" statement checks if we are in a transitional double support
     // or in double support. If so, there is no update to do.
     if(!isInDS() &&
@@ -578,39 +596,105 @@ namespace MPCWalkgen
         break;
       }
 
+      lastUpdateHasFlyingFoot_ = true;
+      lastUpdateInitialStates_[0] = flyingFoot->getStateX();
+      lastUpdateInitialStates_[1] = flyingFoot->getStateY();
+      lastUpdateInitialStates_[2] = flyingFoot->getStateZ();
+
       // Updating X and Y states for the flying foot
-      flyingFoot->updateStateX(Vector3(stepVec(0), 0, 0),
-                               timeToNextPhase_,
+      lastUpdateObjStates_[0] = Vector3(stepVec(0), 0, 0);
+      lastUpdateObjStates_[1] = Vector3(stepVec(nbPreviewedSteps_), 0, 0);
+      lastUpdatePeriods_[0] = lastUpdatePeriods_[1] = timeToNextPhase_;
+      flyingFoot->updateStateX(lastUpdateObjStates_[0],
+                               lastUpdatePeriods_[0],
                                feedBackPeriod);
-      flyingFoot->updateStateY(Vector3(stepVec(nbPreviewedSteps_), 0, 0),
-                               timeToNextPhase_,
+      flyingFoot->updateStateY(lastUpdateObjStates_[1],
+                               lastUpdatePeriods_[1],
                                feedBackPeriod);
 
       //Updating Z state for the flying foot, depending whether the foot is going up or down
       if(timeToNextPhase_ < flyingTime*0.5f + Constant<Scalar>::EPSILON)
       {
-        flyingFoot->updateStateZ(Vector3::Zero(),
-                                 timeToNextPhase_,
-                                 feedBackPeriod);
+        lastUpdateObjStates_[2] = Vector3::Zero();
+        lastUpdatePeriods_[2] = timeToNextPhase_;
       }
       else
       {
-        flyingFoot->updateStateZ(Vector3(flyingFoot->getMaxHeight(), 0, 0),
-                                 timeToNextPhase_ - flyingTime*0.5f,
-                                 feedBackPeriod);
+        lastUpdateObjStates_[2] = Vector3(flyingFoot->getMaxHeight(), 0, 0);
+        lastUpdatePeriods_[2] = timeToNextPhase_ - flyingTime*0.5f;
       }
+      flyingFoot->updateStateZ(lastUpdateObjStates_[2],
+                               lastUpdatePeriods_[2],
+                               feedBackPeriod);
     }
 
     // Updating timeToNextPhase_
     timeToNextPhase_ -= feedBackPeriod;
   }
 
+  template <typename Scalar>
+  void HumanoidFeetSupervisor<Scalar>::computeFeetSetpoints(Scalar dt,
+                                                            int nbSetpoints,
+                                                            Scalar* setpoints)
+  {
+    assert(dt>0);
+    assert(nbSetpoints>=0);
+    assert(nbSetpoints*dt < lastUpdateFeedbackPeriod_ + Constant<Scalar>::EPSILON);
+
+    HumanoidFootModel<Scalar>* feet[2] = {&leftFootModel_, &rightFootModel_};
+    const int n = nbSetpoints;
+
+    for(int foot=0; foot<2; ++foot)
+    {
+      // The support foot is the left one in leftSS
+      const bool isFlying = lastUpdateHasFlyingFoot_ &&
+          ((foot==1) == (lastUpdatePhaseType_==Phase<Scalar>::leftSS));
+      const Vector3* states[3] = {&feet[foot]->getStateX(),
+                                  &feet[foot]->getStateY(),
+                                  &feet[foot]->getStateZ()};
+
+      for(int axis=0; axis<3; ++axis)
+      {
+        Scalar* pos = setpoints + (9*foot + 3*axis)*n;
+        if (isFlying)
+        {
+          feet[foot]->sampleTrajectory(lastUpdateInitialStates_[axis],
+                                       lastUpdateObjStates_[axis],
+                                       lastUpdatePeriods_[axis],
+                                       dt, n, pos, pos + n, pos + 2*n);
+        }
+        else
+        {
+          // The state did not change during the update
+          for(int i=0; i<3; ++i)
+          {
+            std::fill(pos + i*n, pos + (i+1)*n, (*states[axis])(i));
+          }
+        }
+      }
+    }
+  }
+
   template <typename Scalar>
   void HumanoidFeetSupervisor<Scalar>::computeConstantPart()
   {
     //USELESS?
   }
 
+  template <typename Scalar>
+  void HumanoidFeetSupervisor<Scalar>::copyStateFrom(
+      const HumanoidFeetSupervisor<Scalar>& supervisor)
+  {
+    const Scalar stepPeriod = stepPeriod_;
+    const Scalar DSPeriod = DSPeriod_;
+
+    *this = supervisor;
+
+    // The next call to updateTimeline regenerates the previewed phases
+    stepPeriod_ = stepPeriod;
+    DSPeriod_ = DSPeriod;
+  }
+
   template <typename Scalar>
   void HumanoidFeetSupervisor<Scalar>::init()
   {
@@ -700,6 +784,22 @@ namespace MPCWalkgen
         save.segment(nbSamples_ + save.rows()/2 + 1,  newNbOfSteps);
   }
 
+  template <typename Scalar>
+  void HumanoidFeetSupervisor<Scalar>::shortenStepVecTo(VectorX& variable,
+                                                        int nbSteps) const
+  {
+    assert(variable.rows()%2 == 0);
+    assert(nbSteps>=0 && 2*nbSamples_ + 2*nbSteps <= variable.rows());
+
+    // The last previewed steps are removed
+    const int oldNbOfSteps = variable.rows()/2 - nbSamples_;
+    VectorX save = variable;
+
+    variable.conservativeResize(2*nbSamples_ + 2*nbSteps);
+    variable.segment(2*nbSamples_ + nbSteps, nbSteps) =
+        save.segment(2*nbSamples_ + oldNbOfSteps, nbSteps);
+  }
+
   template <typename Scalar>
   void HumanoidFeetSupervisor<Scalar>::enlargeStepVec(VectorX& variable) const
   {
@@ -0,0 +1,74 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\file humanoid_multi_hypothesis_walkgen.cpp
+///\brief Humanoid walkgen evaluating several step timings at once
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <mpc-walkgen/humanoid_multi_hypothesis_walkgen.h>
+#include "macro.h"
+#include <algorithm>
+
+namespace MPCWalkgen
+{
+  template <typename Scalar>
+  HumanoidMultiHypothesisWalkgen<Scalar>::HumanoidMultiHypothesisWalkgen(int nbHypotheses)
+    :scheduler_(new WalkgenScheduler(1))
+    ,selectedHypothesis_(0)
+  {
+    assert(nbHypotheses>0);
+
+    for(int i=0; i<nbHypotheses; ++i)
+    {
+      hypotheses_.push_back(new HumanoidWalkgen<Scalar>());
+    }
+  }
+
+  template <typename Scalar>
+  HumanoidMultiHypothesisWalkgen<Scalar>::~HumanoidMultiHypothesisWalkgen(){}
+
+  template <typename Scalar>
+  void HumanoidMultiHypothesisWalkgen<Scalar>::setNbThreads(int nbThreads)
+  {
+    assert(nbThreads>0);
+
+    scheduler_.reset(new WalkgenScheduler(std::min(nbThreads, getNbHypotheses())));
+  }
+
+  template <typename Scalar>
+  bool HumanoidMultiHypothesisWalkgen<Scalar>::solve(Scalar feedBackPeriod)
+  {
+    for(int i=0; i<getNbHypotheses(); ++i)
+    {
+      scheduler_->addSolve(i, hypotheses_[i], feedBackPeriod);
+    }
+    scheduler_->run();
+
+    int bestHypothesis = -1;
+    for(int i=0; i<getNbHypotheses(); ++i)
+    {
+      if (scheduler_->getStatus(i)==WalkgenScheduler::SOLVED &&
+          (bestHypothesis<0 ||
+           hypotheses_[i].getCost() < hypotheses_[bestHypothesis].getCost()))
+      {
+        bestHypothesis = i;
+      }
+    }
+
+    const bool solutionFound = bestHypothesis>=0;
+    selectedHypothesis_ = solutionFound ? bestHypothesis : 0;
+
+    for(int i=0; i<getNbHypotheses(); ++i)
+    {
+      if (i!=selectedHypothesis_)
+      {
+        hypotheses_[i].copyStateFrom(hypotheses_[selectedHypothesis_]);
+      }
+    }
+
+    return solutionFound;
+  }
+
+  MPC_WALKGEN_INSTANTIATE_CLASS_TEMPLATE(HumanoidMultiHypothesisWalkgen);
+}
@@ -10,6 +10,7 @@
 #include <mpc-walkgen/humanoid_walkgen.h>
 #include "macro.h"
 #include <mpc-walkgen/constant.h>
+#include <mpc-walkgen/tools.h>
 
 namespace MPCWalkgen
 {
@@ -29,6 +30,14 @@ namespace MPCWalkgen
     ,maximumNbOfSteps_(0)
     ,move_(false)
     ,firstCallSinceLastDS_(true)
+    ,timeSinceLastShift_(0)
+    ,hasDualGuess_(false)
+    ,cost_(0)
+    ,lastComStateX_(Vector3::Zero())
+    ,lastComStateY_(Vector3::Zero())
+    ,lastComJerkX_(0)
+    ,lastComJerkY_(0)
+    ,lastFeedBackPeriod_(0)
   {
     const int sizeVec = 2*lipModel_.getNbSamples() +
                         2*feetSupervisor_.getNbPreviewedSteps();
@@ -93,28 +102,32 @@ namespace MPCWalkgen
   void HumanoidWalkgen<Scalar>::setLeftFootKinematicConvexPolygon(
       const ConvexPolygon<Scalar>& convexPolygon)
   {
-    feetSupervisor_.setLeftFootKinematicConvexPolygon(convexPolygon);
+    leftFootKinematicConvexPolygon_ = convexPolygon;
+    feetSupervisor_.setLeftFootKinematicConvexPolygon(simplifyConvexPolygon(convexPolygon));
   }
 
   template <typename Scalar>
   void HumanoidWalkgen<Scalar>::setRightFootKinematicConvexPolygon(
       const ConvexPolygon<Scalar> &convexPolygon)
   {
-    feetSupervisor_.setRightFootKinematicConvexPolygon(convexPolygon);
+    rightFootKinematicConvexPolygon_ = convexPolygon;
+    feetSupervisor_.setRightFootKinematicConvexPolygon(simplifyConvexPolygon(convexPolygon));
   }
 
   template <typename Scalar>
   void HumanoidWalkgen<Scalar>::setLeftFootCopConvexPolygon(
       const ConvexPolygon<Scalar>& convexPolygon)
   {
-    feetSupervisor_.setLeftFootCopConvexPolygon(convexPolygon);
+    leftFootCopConvexPolygon_ = convexPolygon;
+    feetSupervisor_.setLeftFootCopConvexPolygon(simplifyConvexPolygon(convexPolygon));
   }
 
   template <typename Scalar>
   void HumanoidWalkgen<Scalar>::setRightFootCopConvexPolygon(
       const ConvexPolygon<Scalar>& convexPolygon)
   {
-    feetSupervisor_.setRightFootCopConvexPolygon(convexPolygon);
+    rightFootCopConvexPolygon_ = convexPolygon;
+    feetSupervisor_.setRightFootCopConvexPolygon(simplifyConvexPolygon(convexPolygon));
   }
 
   template <typename Scalar>
@@ -296,11 +309,56 @@ namespace MPCWalkgen
   template <typename Scalar>
   void HumanoidWalkgen<Scalar>::setConfig(const HumanoidWalkgenConfig<Scalar>& config)
   {
+    assert(config.maxPolygonAreaLossRatio>=0);
+
+    bool simplificationChanged =
+        config.maxNbPolygonVertices != config_.maxNbPolygonVertices ||
+        config.maxPolygonAreaLossRatio != config_.maxPolygonAreaLossRatio;
+
     config_ = config;
 
+    if (simplificationChanged)
+    {
+      if (leftFootKinematicConvexPolygon_.getNbVertices()>=3)
+      {
+        feetSupervisor_.setLeftFootKinematicConvexPolygon(
+              simplifyConvexPolygon(leftFootKinematicConvexPolygon_));
+      }
+      if (rightFootKinematicConvexPolygon_.getNbVertices()>=3)
+      {
+        feetSupervisor_.setRightFootKinematicConvexPolygon(
+              simplifyConvexPolygon(rightFootKinematicConvexPolygon_));
+      }
+      if (leftFootCopConvexPolygon_.getNbVertices()>=3)
+      {
+        feetSupervisor_.setLeftFootCopConvexPolygon(
+              simplifyConvexPolygon(leftFootCopConvexPolygon_));
+      }
+      if (rightFootCopConvexPolygon_.getNbVertices()>=3)
+      {
+        feetSupervisor_.setRightFootCopConvexPolygon(
+              simplifyConvexPolygon(rightFootCopConvexPolygon_));
+      }
+    }
+
     computeConstantPart();
   }
 
+  template <typename Scalar>
+  ConvexPolygon<Scalar> HumanoidWalkgen<Scalar>::simplifyConvexPolygon(
+      const ConvexPolygon<Scalar>& convexPolygon) const
+  {
+    if (config_.maxNbPolygonVertices<3)
+    {
+      return convexPolygon;
+    }
+
+    return ConvexPolygon<Scalar>(
+          ConvexPolygon<Scalar>::simplifyVertices(convexPolygon.getVertices(),
+                                                  config_.maxNbPolygonVertices,
+                                                  config_.maxPolygonAreaLossRatio));
+  }
+
   template <typename Scalar>
   void HumanoidWalkgen<Scalar>::setMove(bool move)
   {
@@ -422,22 +480,44 @@ namespace MPCWalkgen
           qpMatrices.xu.segment(2*N, 2*M).cwiseMin(footConstraint_.getSupBounds(X_));
     }
 
-    //Normalization of the matrices. The smallest element value of the QP matrices is at least one.
-    qpMatrices.normalizeMatrices(Constant<Scalar>::EPSILON);
+    //Q and A are filled again on each solve
+    qpMatrices.notifyMatricesChanged();
+
+    //Equilibration of the matrices. As Q and A change a little from one solve to the
+    //next, the scaling factors of the last solve are refined with a single pass,
+    //infinite bounds are left unscaled.
+    qpMatrices.refineEquilibration();
+    qpMatrices.equilibrateVectors(Constant<Scalar>::MAXIMUM_BOUND_VALUE);
 
     //Setting matrix At
     qpMatrices.At = qpMatrices.A.transpose();
 
     dX_.resize(sizeVec);
 
+    if (hasDualGuess_)
+    {
+      if (dual_.size() == sizeVec + nbCtr)
+      {
+        qpoasesSolverVec_[index].setDualGuess(dual_);
+      }
+      hasDualGuess_ = false;
+    }
+
     bool solutionFound = qpoasesSolverVec_[index].solve(qpMatrices, dX_, false);
 
+    qpMatrices.unscalePrimalSolution(dX_);
     X_ += dX_;
 
     //Transforming solution
     convertCopInLFtoComJerk();
+    computeCost();
 
     //Updating states
+    lastComStateX_ = lipModel_.getStateX();
+    lastComStateY_ = lipModel_.getStateY();
+    lastComJerkX_ = transformedX_(0);
+    lastComJerkY_ = transformedX_(N);
+    lastFeedBackPeriod_ = feedBackPeriod;
     lipModel_.updateStateX(transformedX_(0), feedBackPeriod);
     lipModel_.updateStateY(transformedX_(N), feedBackPeriod);
 
@@ -447,17 +527,91 @@ namespace MPCWalkgen
                                 2*feetSupervisor_.getNbPreviewedSteps()),
           feedBackPeriod);
 
+    if (config_.withWarmStartShift && solutionFound)
+    {
+      timeSinceLastShift_ += feedBackPeriod;
+      if (timeSinceLastShift_ > lipModel_.getSamplingPeriod() - Constant<Scalar>::EPSILON)
+      {
+        timeSinceLastShift_ -= lipModel_.getSamplingPeriod();
+        shiftWarmStart(qpoasesSolverVec_[index], nbCtrCop);
+      }
+    }
 
     //display("/home/mdegourcuff/Bureau/Test_new_MPCWalkgen/QPSol.txt");
 
     return solutionFound;
   }
 
+  template <typename Scalar>
+  void HumanoidWalkgen<Scalar>::copyStateFrom(const HumanoidWalkgen<Scalar>& walkgen)
+  {
+    assert(lipModel_.getNbSamples() == walkgen.lipModel_.getNbSamples());
+
+    feetSupervisor_.copyStateFrom(walkgen.feetSupervisor_);
+    lipModel_.setStateX(walkgen.lipModel_.getStateX());
+    lipModel_.setStateY(walkgen.lipModel_.getStateY());
+
+    X_ = walkgen.X_;
+    transformedX_ = walkgen.transformedX_;
+
+    move_ = walkgen.move_;
+    firstCallSinceLastDS_ = walkgen.firstCallSinceLastDS_;
+    timeSinceLastShift_ = walkgen.timeSinceLastShift_;
+    dual_ = walkgen.dual_;
+    hasDualGuess_ = walkgen.hasDualGuess_;
+
+    lastComStateX_ = walkgen.lastComStateX_;
+    lastComStateY_ = walkgen.lastComStateY_;
+    lastComJerkX_ = walkgen.lastComJerkX_;
+    lastComJerkY_ = walkgen.lastComJerkY_;
+    lastFeedBackPeriod_ = walkgen.lastFeedBackPeriod_;
+  }
+
+  template <typename Scalar>
+  void HumanoidWalkgen<Scalar>::computeSetpoints(Scalar dt,
+                                                 int nbSetpoints,
+                                                 Scalar* setpoints)
+  {
+    assert(dt>0);
+    assert(nbSetpoints>=0);
+    assert(nbSetpoints*dt < lastFeedBackPeriod_ + Constant<Scalar>::EPSILON);
+
+    const int n = nbSetpoints;
+    Tools::ConstantJerkDynamic<Scalar>::sampleState(lastComStateX_, lastComJerkX_,
+                                                    dt, n, setpoints,
+                                                    setpoints + n,
+                                                    setpoints + 2*n);
+    Tools::ConstantJerkDynamic<Scalar>::sampleState(lastComStateY_, lastComJerkY_,
+                                                    dt, n, setpoints + 3*n,
+                                                    setpoints + 4*n,
+                                                    setpoints + 5*n);
+
+    feetSupervisor_.computeFeetSetpoints(dt, n, setpoints + 6*n);
+  }
+
+  template <typename Scalar>
+  void HumanoidWalkgen<Scalar>::shiftWarmStart(const QPSolver<Scalar>& solver,
+                                               int nbCtrCop)
+  {
+    int N = lipModel_.getNbSamples();
+
+    Tools::shiftSamples<Scalar>(X_, 0, N, 2);
+
+    // CoP bounds are stored in blocks of N, and CoP constraint rows are
+    // grouped by sample. Feet bounds and constraints are kept as is.
+    solver.getDualSolution(dual_);
+    Tools::shiftSamples<Scalar>(dual_, 0, N, 2);
+    Tools::shiftSamples<Scalar>(dual_, solver.getNbVar(), nbCtrCop, 1,
+                                feetSupervisor_.getCopConvexPolygon(0).getNbGeneralConstraints());
+    hasDualGuess_ = true;
+  }
+
   template <typename Scalar>
   void HumanoidWalkgen<Scalar>::computeConstantPart()
   {
     // Updating qpoasesSolverVec_ and qpMatrixVec_
     maximumNbOfSteps_ = feetSupervisor_.getNbSamples();
+    maximumNbOfConstraints_ = 0;
     if(config_.withCopConstraints)
     {
       maximumNbOfConstraints_ = feetSupervisor_.getMaximumNbOfCopConstraints()
@@ -469,6 +623,7 @@ namespace MPCWalkgen
           *maximumNbOfSteps_;
     }
 
+    qpoasesSolverVec_.clear();
     qpoasesSolverVec_.reserve((maximumNbOfSteps_ + 1)*(maximumNbOfConstraints_ + 1));
     qpMatrixVec_.resize((maximumNbOfSteps_ + 1)*(maximumNbOfConstraints_ + 1));
 
@@ -480,7 +635,16 @@ namespace MPCWalkgen
       {
         nbVariables = 2*lipModel_.getNbSamples() + 2*i;
 
-        qpoasesSolverVec_.push_back(makeQPSolver<Scalar>(nbVariables, j));
+        if(config_.withPresolve)
+        {
+          qpoasesSolverVec_.push_back(new PresolvedQPSolver<Scalar>(nbVariables, j,
+                                                                    &makeQPSolver<Scalar>));
+        }
+        else
+        {
+          qpoasesSolverVec_.push_back(makeQPSolver<Scalar>(nbVariables, j));
+        }
+        qpMatrixVec_[i*(maximumNbOfConstraints_ + 1) + j].resetEquilibration();
         qpMatrixVec_[i*(maximumNbOfConstraints_ + 1) + j].Q.setZero(nbVariables, nbVariables);
         qpMatrixVec_[i*(maximumNbOfConstraints_ + 1) + j].p.setZero(nbVariables);
 
@@ -534,5 +698,46 @@ namespace MPCWalkgen
     transformedX_.segment(N, N) = dynCopY.Uinv*tmp.segment(N, N);
   }
 
+  template <typename Scalar>
+  void HumanoidWalkgen<Scalar>::computeCost()
+  {
+    int N = lipModel_.getNbSamples();
+    int nb = feetSupervisor_.getNbOfCallsBeforeNextSample() - 1;
+
+    const MatrixX& weight = feetSupervisor_.getSampleWeightMatrix();
+
+    cost_ = 0;
+
+    // Same objectives as the QP, evaluated on the CoM jerk in world frame
+    // and on the CoP in local frame
+    if (weighting_.velocityTracking>0.0)
+    {
+      const LinearDynamic<Scalar>& dynComVel = lipModel_.getComVelLinearDynamic(nb);
+      const VectorX& velRef = velTrackingObj_.getVelRefInWorldFrame();
+
+      VectorX velError = dynComVel.S*getComStateX()
+          + dynComVel.U*transformedX_.segment(0, N) - velRef.segment(0, N);
+      cost_ += weighting_.velocityTracking*velError.dot(weight*velError);
+
+      velError = dynComVel.S*getComStateY()
+          + dynComVel.U*transformedX_.segment(N, N) - velRef.segment(N, N);
+      cost_ += weighting_.velocityTracking*velError.dot(weight*velError);
+    }
+
+    if (weighting_.jerkMinimization>0.0)
+    {
+      cost_ += weighting_.jerkMinimization*
+          (transformedX_.segment(0, N).dot(weight*transformedX_.segment(0, N))
+           + transformedX_.segment(N, N).dot(weight*transformedX_.segment(N, N)));
+    }
+
+    if (weighting_.copCentering>0.0)
+    {
+      cost_ += weighting_.copCentering*X_.segment(0, 2*N).squaredNorm();
+    }
+
+    cost_ *= 0.5;
+  }
+
   MPC_WALKGEN_INSTANTIATE_CLASS_TEMPLATE(HumanoidWalkgen);
 }
@@ -74,5 +74,68 @@ namespace MPCWalkgen
     }
   }
 
+  template <typename Scalar>
+  void Interpolator<Scalar>::sampleSpline(const VectorX &factor,
+                                          Scalar T,
+                                          Scalar dt,
+                                          int nbSetpoints,
+                                          Scalar* pos,
+                                          Scalar* vel,
+                                          Scalar* acc) const
+  {
+    assert(factor.size()==12);
+    assert(T>0);
+    assert(dt>0);
+    assert(nbSetpoints>=0);
+
+    typedef Eigen::Array<Scalar, Eigen::Dynamic, 1> ArrayX;
+
+    // Same polynom as selectFactors for each setpoint
+    const Scalar ends[2] = {static_cast<Scalar>(T/3.0), static_cast<Scalar>(2.0*T/3.0)};
+
+    int first = 0;
+    for(int i=0; i<3 && first<nbSetpoints; ++i)
+    {
+      int last = first;
+      while (last<nbSetpoints &&
+             (i==2 || static_cast<Scalar>(last + 1)*dt <= ends[i]))
+      {
+        ++last;
+      }
+
+      const int n = last - first;
+      if (n>0)
+      {
+        const Vector4 f = factor.template segment<4>(4*i);
+        // Normalised times of the setpoints, evaluated in the loop of each
+        // assignment
+        const Scalar x0 = static_cast<Scalar>(first + 1)*dt/T;
+        const Scalar x1 = static_cast<Scalar>(last)*dt/T;
+
+        if (pos!=NULL)
+        {
+          Eigen::Map<ArrayX>(pos + first, n) = f(3)
+              + ArrayX::LinSpaced(n, x0, x1)*(f(2)
+              + ArrayX::LinSpaced(n, x0, x1)*(f(1)
+              + ArrayX::LinSpaced(n, x0, x1)*f(0)));
+        }
+        // Division by T is a consequence of the polynoms normalization
+        if (vel!=NULL)
+        {
+          Eigen::Map<ArrayX>(vel + first, n) = (f(2)
+              + ArrayX::LinSpaced(n, x0, x1)*(2.0f*f(1)
+              + ArrayX::LinSpaced(n, x0, x1)*(3.0f*f(0))))/T;
+        }
+        if (acc!=NULL)
+        {
+          Eigen::Map<ArrayX>(acc + first, n) = (2.0f*f(1)
+              + ArrayX::LinSpaced(n, x0, x1)*(6.0f*f(0)))/(T*T);
+        }
+      }
+
+      first = last;
+    }
+  }
+
   MPC_WALKGEN_INSTANTIATE_CLASS_TEMPLATE(Interpolator);
 }
@@ -38,5 +38,50 @@ namespace MPCWalkgen
     K.setZero(nbSamples);
   }
 
+  template <typename Scalar>
+  void LinearDynamic<Scalar>::applyMoveBlocking(const std::vector<int>& blockSizes)
+  {
+    const int nbBlocks = static_cast<int>(blockSizes.size());
+
+    // The columns of each block are summed in its first one, then moved to
+    // the column of the block. Blocks are never moved forward.
+    int first = 0;
+    for(int b=0; b<nbBlocks; ++b)
+    {
+      assert(blockSizes[b]>0);
+      assert(first + blockSizes[b]<=U.cols());
+
+      U.col(b) = U.col(first);
+      for(int j=first+1; j<first+blockSizes[b]; ++j)
+      {
+        U.col(b) += U.col(j);
+      }
+      first += blockSizes[b];
+    }
+    assert(first==U.cols());
+
+    U.conservativeResize(Eigen::NoChange, nbBlocks);
+    UT = U.transpose();
+
+    if (U.rows()!=nbBlocks)
+    {
+      Uinv.setConstant(U.rows(), nbBlocks,
+                       std::numeric_limits<Scalar>::quiet_NaN());
+      UTinv.setConstant(nbBlocks, U.rows(),
+                        std::numeric_limits<Scalar>::quiet_NaN());
+    }
+  }
+
+  template <typename Scalar>
+  void LinearDynamic<Scalar>::archive(ConstantPartArchive<Scalar>& ar)
+  {
+    ar.process(U);
+    ar.process(UT);
+    ar.process(Uinv);
+    ar.process(UTinv);
+    ar.process(S);
+    ar.process(K);
+  }
+
   MPC_WALKGEN_INSTANTIATE_CLASS_TEMPLATE(LinearDynamic);
 }
@@ -127,10 +127,10 @@ namespace MPCWalkgen
   template <typename Scalar>
   void HumanoidFootModel<Scalar>::init()
   {
-    stateX_.setZero(3);
-    stateY_.setZero(3);
-    stateZ_.setZero(3);
-    stateYaw_.setZero(3);
+    stateX_.setZero();
+    stateY_.setZero();
+    stateZ_.setZero();
+    stateYaw_.setZero();
 
     isInContact_.resize(nbSamples_, true);
 
@@ -140,7 +140,7 @@ namespace MPCWalkgen
   }
 
   template <typename Scalar>
-  void HumanoidFootModel<Scalar>::interpolateTrajectory(VectorX& currentState,
+  void HumanoidFootModel<Scalar>::interpolateTrajectory(Vector3& currentState,
                                                 const Vector3& objState,
                                                 Scalar T,
                                                 Scalar t)
@@ -160,5 +160,23 @@ namespace MPCWalkgen
     currentState(2) = Tools::ddPolynomValue(subFactor_, t/T)/(T*T);
   }
 
+  template <typename Scalar>
+  void HumanoidFootModel<Scalar>::sampleTrajectory(const Vector3& initialState,
+                                                   const Vector3& obj,
+                                                   Scalar T,
+                                                   Scalar dt,
+                                                   int nbSetpoints,
+                                                   Scalar* pos,
+                                                   Scalar* vel,
+                                                   Scalar* acc)
+  {
+    interpolator_.computePolynomialNormalisedFactors(factor_,
+                                                     initialState,
+                                                     obj,
+                                                     T);
+
+    interpolator_.sampleSpline(factor_, T, dt, nbSetpoints, pos, vel, acc);
+  }
+
   MPC_WALKGEN_INSTANTIATE_CLASS_TEMPLATE(HumanoidFootModel);
 }
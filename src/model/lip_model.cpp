@@ -14,6 +14,20 @@
 
 using namespace MPCWalkgen;
 
+namespace
+{
+  template <typename Scalar>
+  void archiveDynamics(ConstantPartArchive<Scalar>& ar,
+                       std::vector<LinearDynamic<Scalar> >& dynamics)
+  {
+    dynamics.resize(ar.processSize(static_cast<int>(dynamics.size())));
+    for(size_t i=0; i<dynamics.size(); ++i)
+    {
+      dynamics[i].archive(ar);
+    }
+  }
+}
+
 template <typename Scalar>
 LIPModel<Scalar>::LIPModel(int nbSamples,
                    Scalar samplingPeriod,
@@ -22,6 +36,7 @@ LIPModel<Scalar>::LIPModel(int nbSamples,
   ,useLipModel2_(false)
   ,nbSamples_(nbSamples)
   ,samplingPeriod_(samplingPeriod)
+  ,withPeriodWeighting_(false)
   ,feedbackPeriod_(samplingPeriod_)
   ,comHeight_(1.0)
   ,gravity_(Constant<Scalar>::GRAVITY_VECTOR)
@@ -29,12 +44,13 @@ LIPModel<Scalar>::LIPModel(int nbSamples,
   ,totalMass_(1.0)
 {
 
-  stateX_.setZero(3);
-  stateY_.setZero(3);
-  stateZ_.setZero(3);
+  stateX_.setZero();
+  stateY_.setZero();
+  stateZ_.setZero();
   stateZ_(0) = comHeight_;
-  stateYaw_.setZero(3);
+  stateYaw_.setZero();
 
+  computeSamplingPeriods();
   if (autoCompute_)
   {
     computeDynamics();
@@ -47,6 +63,7 @@ LIPModel<Scalar>::LIPModel()
   ,useLipModel2_(false)
   ,nbSamples_(1)
   ,samplingPeriod_(1.0)
+  ,withPeriodWeighting_(false)
   ,feedbackPeriod_(samplingPeriod_)
   ,comHeight_(1.0)
   ,gravity_(Constant<Scalar>::GRAVITY_VECTOR)
@@ -54,12 +71,13 @@ LIPModel<Scalar>::LIPModel()
   ,totalMass_(1.0)
 {
 
-  stateX_.setZero(3);
-  stateY_.setZero(3);
-  stateZ_.setZero(3);
+  stateX_.setZero();
+  stateY_.setZero();
+  stateZ_.setZero();
   stateZ_(0) = comHeight_;
-  stateYaw_.setZero(3);
+  stateYaw_.setZero();
 
+  computeSamplingPeriods();
   if (autoCompute_)
   {
     computeDynamics();
@@ -88,12 +106,13 @@ void LIPModel<Scalar>::computeCopXDynamicVec()
 {
   copXDynamicVec_.resize(nbFeedbackInOneSample_);
 
+  // The first sample is reached after i+1 feedback periods
+  VectorX periods = samplingPeriods_;
   for (int i=0; i<nbFeedbackInOneSample_; ++i)
   {
-    Tools::ConstantJerkDynamic<Scalar>::computeCopDynamic(static_cast<Scalar>(i + 1)*feedbackPeriod_,
-                                                  samplingPeriod_, nbSamples_,
-                                                  copXDynamicVec_[i],  comHeight_,
-                                                  gravity_(0), gravity_(2),
+    periods(0) = static_cast<Scalar>(i + 1)*feedbackPeriod_;
+    Tools::ConstantJerkDynamic<Scalar>::computeCopDynamic(periods, copXDynamicVec_[i],
+                                                  comHeight_, gravity_(0), gravity_(2),
                                                   mass_, totalMass_);
   }
 }
@@ -103,12 +122,13 @@ void LIPModel<Scalar>::computeCopYDynamicVec()
 {
   copYDynamicVec_.resize(nbFeedbackInOneSample_);
 
+  // The first sample is reached after i+1 feedback periods
+  VectorX periods = samplingPeriods_;
   for (int i=0; i<nbFeedbackInOneSample_; ++i)
   {
-    Tools::ConstantJerkDynamic<Scalar>::computeCopDynamic(static_cast<Scalar>(i + 1)*feedbackPeriod_,
-                                                  samplingPeriod_, nbSamples_,
-                                                  copYDynamicVec_[i],  comHeight_,
-                                                  gravity_(1), gravity_(2),
+    periods(0) = static_cast<Scalar>(i + 1)*feedbackPeriod_;
+    Tools::ConstantJerkDynamic<Scalar>::computeCopDynamic(periods, copYDynamicVec_[i],
+                                                  comHeight_, gravity_(1), gravity_(2),
                                                   mass_, totalMass_);
   }
 }
@@ -118,11 +138,12 @@ void LIPModel<Scalar>::computeComPosDynamicVec()
 {
   comPosDynamicVec_.resize(nbFeedbackInOneSample_);
 
+  // The first sample is reached after i+1 feedback periods
+  VectorX periods = samplingPeriods_;
   for (int i=0; i<nbFeedbackInOneSample_; ++i)
   {
-    Tools::ConstantJerkDynamic<Scalar>::computePosDynamic(static_cast<Scalar>(i + 1)*feedbackPeriod_,
-                                                  samplingPeriod_, nbSamples_,
-                                                  comPosDynamicVec_[i]);
+    periods(0) = static_cast<Scalar>(i + 1)*feedbackPeriod_;
+    Tools::ConstantJerkDynamic<Scalar>::computePosDynamic(periods, comPosDynamicVec_[i]);
   }
 }
 
@@ -131,11 +152,12 @@ void LIPModel<Scalar>::computeComVelDynamicVec()
 {
   comVelDynamicVec_.resize(nbFeedbackInOneSample_);
 
+  // The first sample is reached after i+1 feedback periods
+  VectorX periods = samplingPeriods_;
   for (int i=0; i<nbFeedbackInOneSample_; ++i)
   {
-    Tools::ConstantJerkDynamic<Scalar>::computeVelDynamic(static_cast<Scalar>(i + 1)*feedbackPeriod_,
-                                                  samplingPeriod_, nbSamples_,
-                                                  comVelDynamicVec_[i]);
+    periods(0) = static_cast<Scalar>(i + 1)*feedbackPeriod_;
+    Tools::ConstantJerkDynamic<Scalar>::computeVelDynamic(periods, comVelDynamicVec_[i]);
   }
 }
 
@@ -144,11 +166,12 @@ void LIPModel<Scalar>::computeComAccDynamicVec()
 {
   comAccDynamicVec_.resize(nbFeedbackInOneSample_);
 
+  // The first sample is reached after i+1 feedback periods
+  VectorX periods = samplingPeriods_;
   for (int i=0; i<nbFeedbackInOneSample_; ++i)
   {
-    Tools::ConstantJerkDynamic<Scalar>::computeAccDynamic(static_cast<Scalar>(i + 1)*feedbackPeriod_,
-                                                  samplingPeriod_, nbSamples_,
-                                                  comAccDynamicVec_[i]);
+    periods(0) = static_cast<Scalar>(i + 1)*feedbackPeriod_;
+    Tools::ConstantJerkDynamic<Scalar>::computeAccDynamic(periods, comAccDynamicVec_[i]);
   }
 }
 
@@ -166,6 +189,7 @@ void LIPModel<Scalar>::setNbSamples(int nbSamples)
   assert(nbSamples>0);
 
   nbSamples_ = nbSamples;
+  computeSamplingPeriods();
 
   if (autoCompute_)
   {
@@ -198,6 +222,8 @@ void LIPModel<Scalar>::setSamplingPeriod(Scalar samplingPeriod)
 
   samplingPeriod_ = samplingPeriod;
   feedbackPeriod_ = samplingPeriod;
+  givenSamplingPeriods_.resize(0);
+  computeSamplingPeriods();
 
   if (autoCompute_)
   {
@@ -205,6 +231,47 @@ void LIPModel<Scalar>::setSamplingPeriod(Scalar samplingPeriod)
   }
 }
 
+template <typename Scalar>
+void LIPModel<Scalar>::setSamplingPeriods(const VectorX& samplingPeriods)
+{
+  assert(samplingPeriods.size()>0);
+  assert(samplingPeriods.minCoeff()>0);
+
+  samplingPeriod_ = samplingPeriods(0);
+  feedbackPeriod_ = samplingPeriods(0);
+  givenSamplingPeriods_ = samplingPeriods;
+  computeSamplingPeriods();
+
+  if (autoCompute_)
+  {
+    computeDynamics();
+  }
+}
+
+template <typename Scalar>
+void LIPModel<Scalar>::computeSamplingPeriods()
+{
+  Tools::ConstantJerkDynamic<Scalar>::computeSamplingPeriods(givenSamplingPeriods_,
+                                                             samplingPeriod_, nbSamples_,
+                                                             samplingPeriods_);
+
+  if (withPeriodWeighting_)
+  {
+    sampleWeights_ = samplingPeriods_/samplingPeriod_;
+  }
+  else
+  {
+    sampleWeights_.setOnes(nbSamples_);
+  }
+}
+
+template <typename Scalar>
+void LIPModel<Scalar>::setPeriodWeighting(bool withPeriodWeighting)
+{
+  withPeriodWeighting_ = withPeriodWeighting;
+  computeSamplingPeriods();
+}
+
 template <typename Scalar>
 void LIPModel<Scalar>::setComHeight(Scalar comHeight)
 {
@@ -275,6 +342,51 @@ void LIPModel<Scalar>::setFeedbackPeriod(Scalar feedbackPeriod)
   }
 }
 
+template <typename Scalar>
+void LIPModel<Scalar>::archive(ConstantPartArchive<Scalar>& ar)
+{
+  ar.process(autoCompute_);
+  ar.process(useLipModel2_);
+
+  ar.process(nbSamples_);
+  ar.process(samplingPeriod_);
+  ar.process(givenSamplingPeriods_);
+  ar.process(samplingPeriods_);
+  ar.process(withPeriodWeighting_);
+  ar.process(sampleWeights_);
+  ar.process(feedbackPeriod_);
+  ar.process(nbFeedbackInOneSample_);
+
+  ar.process(stateX_);
+  ar.process(stateY_);
+  ar.process(stateZ_);
+  ar.process(stateYaw_);
+
+  ar.process(comHeight_);
+  ar.process(gravity_);
+  ar.process(mass_);
+  ar.process(totalMass_);
+
+  comPosDynamic_.archive(ar);
+  comVelDynamic_.archive(ar);
+  comAccDynamic_.archive(ar);
+  copXDynamic_.archive(ar);
+  copYDynamic_.archive(ar);
+
+  archiveDynamics(ar, comPosDynamicVec_);
+  archiveDynamics(ar, comVelDynamicVec_);
+  archiveDynamics(ar, comAccDynamicVec_);
+  archiveDynamics(ar, copXDynamicVec_);
+  archiveDynamics(ar, copYDynamicVec_);
+
+  comJerkDynamic_.archive(ar);
+
+  if (ar.isLoading() && (nbSamples_<=0 || samplingPeriods_.size()!=nbSamples_))
+  {
+    ar.invalidate();
+  }
+}
+
 namespace MPCWalkgen
 {
   MPC_WALKGEN_INSTANTIATE_CLASS_TEMPLATE(LIPModel);
@@ -6,6 +6,7 @@
 
 #include <mpc-walkgen/model/no_dynamic_model.h>
 #include <cmath>
+#include <algorithm>
 #include <mpc-walkgen/tools.h>
 #include <mpc-walkgen/constant.h>
 #include "../macro.h"
@@ -19,6 +20,7 @@ NoDynamicModel<Scalar>::NoDynamicModel(int nbSamples,
   :autoCompute_(autoCompute)
   ,nbSamples_(nbSamples)
   ,samplingPeriod_(samplingPeriod)
+  ,withPeriodWeighting_(false)
   ,velocityLimit_(1.0)
   ,accelerationLimit_(1.0)
   ,jerkLimit_(1.0)
@@ -26,7 +28,8 @@ NoDynamicModel<Scalar>::NoDynamicModel(int nbSamples,
   assert(samplingPeriod>0);
   assert(nbSamples>0);
 
-  state_.setZero(3);
+  state_.setZero();
+  computeSamplingPeriods();
   if (autoCompute_)
   {
     computeDynamics();
@@ -38,11 +41,13 @@ NoDynamicModel<Scalar>::NoDynamicModel()
   :autoCompute_(true)
   ,nbSamples_(1)
   ,samplingPeriod_(1.0)
+  ,withPeriodWeighting_(false)
   ,velocityLimit_(1.0)
   ,accelerationLimit_(1.0)
   ,jerkLimit_(1.0)
 {
-  state_.setZero(3);
+  state_.setZero();
+  computeSamplingPeriods();
   if (autoCompute_)
   {
     computeDynamics();
@@ -64,29 +69,29 @@ void NoDynamicModel<Scalar>::computeDynamics()
 template <typename Scalar>
 void NoDynamicModel<Scalar>::computePosDynamic()
 {
-  Tools::ConstantJerkDynamic<Scalar>::computePosDynamic(samplingPeriod_, samplingPeriod_,
-                                                        nbSamples_, posDynamic_);
-
+  Tools::ConstantJerkDynamic<Scalar>::computePosDynamic(samplingPeriods_, posDynamic_);
+  applyMoveBlocking(posDynamic_);
 }
 
 template <typename Scalar>
 void NoDynamicModel<Scalar>::computeVelDynamic()
 {
-  Tools::ConstantJerkDynamic<Scalar>::computeVelDynamic(samplingPeriod_, samplingPeriod_,
-                                                nbSamples_, velDynamic_);
+  Tools::ConstantJerkDynamic<Scalar>::computeVelDynamic(samplingPeriods_, velDynamic_);
+  applyMoveBlocking(velDynamic_);
 }
 
 template <typename Scalar>
 void NoDynamicModel<Scalar>::computeAccDynamic()
 {
-  Tools::ConstantJerkDynamic<Scalar>::computeAccDynamic(samplingPeriod_, samplingPeriod_,
-                                                nbSamples_, accDynamic_);
+  Tools::ConstantJerkDynamic<Scalar>::computeAccDynamic(samplingPeriods_, accDynamic_);
+  applyMoveBlocking(accDynamic_);
 }
 
 template <typename Scalar>
 void NoDynamicModel<Scalar>::computeJerkDynamic()
 {
   Tools::ConstantJerkDynamic<Scalar>::computeJerkDynamic(nbSamples_, jerkDynamic_);
+  applyMoveBlocking(jerkDynamic_);
 }
 
 template <typename Scalar>
@@ -95,6 +100,8 @@ void NoDynamicModel<Scalar>::setNbSamples(int nbSamples)
   assert(nbSamples>0);
 
   nbSamples_ = nbSamples;
+  computeSamplingPeriods();
+  computeBlockSizes();
 
   if (autoCompute_)
   {
@@ -102,6 +109,54 @@ void NoDynamicModel<Scalar>::setNbSamples(int nbSamples)
   }
 }
 
+template <typename Scalar>
+void NoDynamicModel<Scalar>::setMoveBlocking(const std::vector<int>& moveBlocking)
+{
+  moveBlocking_ = moveBlocking;
+  computeBlockSizes();
+
+  if (autoCompute_)
+  {
+    computeDynamics();
+  }
+}
+
+template <typename Scalar>
+void NoDynamicModel<Scalar>::computeBlockSizes()
+{
+  blockSizes_.clear();
+  if (moveBlocking_.empty())
+  {
+    return;
+  }
+
+  int nbBlockedSamples = 0;
+  for(int i=0; nbBlockedSamples<nbSamples_; ++i)
+  {
+    int size = moveBlocking_[std::min(i, static_cast<int>(moveBlocking_.size()) - 1)];
+    assert(size>0);
+    size = std::min(size, nbSamples_ - nbBlockedSamples);
+
+    blockSizes_.push_back(size);
+    nbBlockedSamples += size;
+  }
+
+  // A pattern of blocks of one sample is the same as no move blocking
+  if (static_cast<int>(blockSizes_.size())==nbSamples_)
+  {
+    blockSizes_.clear();
+  }
+}
+
+template <typename Scalar>
+void NoDynamicModel<Scalar>::applyMoveBlocking(LinearDynamic<Scalar>& dyn) const
+{
+  if (!blockSizes_.empty())
+  {
+    dyn.applyMoveBlocking(blockSizes_);
+  }
+}
+
 template <typename Scalar>
 void NoDynamicModel<Scalar>::updateState(Scalar jerk, Scalar feedBackPeriod)
 {
@@ -114,6 +169,24 @@ void NoDynamicModel<Scalar>::setSamplingPeriod(Scalar samplingPeriod)
   assert(samplingPeriod>0);
 
   samplingPeriod_ = samplingPeriod;
+  givenSamplingPeriods_.resize(0);
+  computeSamplingPeriods();
+
+  if (autoCompute_)
+  {
+    computeDynamics();
+  }
+}
+
+template <typename Scalar>
+void NoDynamicModel<Scalar>::setSamplingPeriods(const VectorX& samplingPeriods)
+{
+  assert(samplingPeriods.size()>0);
+  assert(samplingPeriods.minCoeff()>0);
+
+  samplingPeriod_ = samplingPeriods(0);
+  givenSamplingPeriods_ = samplingPeriods;
+  computeSamplingPeriods();
 
   if (autoCompute_)
   {
@@ -121,6 +194,30 @@ void NoDynamicModel<Scalar>::setSamplingPeriod(Scalar samplingPeriod)
   }
 }
 
+template <typename Scalar>
+void NoDynamicModel<Scalar>::computeSamplingPeriods()
+{
+  Tools::ConstantJerkDynamic<Scalar>::computeSamplingPeriods(givenSamplingPeriods_,
+                                                             samplingPeriod_, nbSamples_,
+                                                             samplingPeriods_);
+
+  if (withPeriodWeighting_)
+  {
+    sampleWeights_ = samplingPeriods_/samplingPeriod_;
+  }
+  else
+  {
+    sampleWeights_.setOnes(nbSamples_);
+  }
+}
+
+template <typename Scalar>
+void NoDynamicModel<Scalar>::setPeriodWeighting(bool withPeriodWeighting)
+{
+  withPeriodWeighting_ = withPeriodWeighting;
+  computeSamplingPeriods();
+}
+
 namespace MPCWalkgen
 {
   MPC_WALKGEN_INSTANTIATE_CLASS_TEMPLATE(NoDynamicModel);
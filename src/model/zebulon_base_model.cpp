@@ -20,6 +20,7 @@ BaseModel<Scalar>::BaseModel(int nbSamples,
   :autoCompute_(autoCompute)
   ,nbSamples_(nbSamples)
   ,samplingPeriod_(samplingPeriod)
+  ,withPeriodWeighting_(false)
   ,comHeight_(0.0)
   ,gravity_(Constant<Scalar>::GRAVITY_VECTOR)
   ,mass_(0.0)
@@ -35,11 +36,12 @@ BaseModel<Scalar>::BaseModel(int nbSamples,
   assert(samplingPeriod>0);
   assert(nbSamples>0);
 
-  stateX_.setZero(3);
-  stateY_.setZero(3);
-  stateRoll_.setZero(3);
-  statePitch_.setZero(3);
-  stateYaw_.setZero(3);
+  stateX_.setZero();
+  stateY_.setZero();
+  stateRoll_.setZero();
+  statePitch_.setZero();
+  stateYaw_.setZero();
+  computeSamplingPeriods();
   if (autoCompute_)
   {
     computeDynamics();
@@ -51,6 +53,7 @@ BaseModel<Scalar>::BaseModel()
   :autoCompute_(true)
   ,nbSamples_(1)
   ,samplingPeriod_(1.0)
+  ,withPeriodWeighting_(false)
   ,comHeight_(0.0)
   ,gravity_(Constant<Scalar>::GRAVITY_VECTOR)
   ,mass_(0.0)
@@ -58,14 +61,17 @@ BaseModel<Scalar>::BaseModel()
   ,velocityLimit_(1.0)
   ,accelerationLimit_(1.0)
   ,jerkLimit_(1.0)
+  ,tiltContactPointX_(0.0)
+  ,tiltContactPointY_(0.0)
   ,copSupportConvexPolygon_()
   ,comSupportConvexPolygon_()
 {
-  stateX_.setZero(3);
-  stateY_.setZero(3);
-  stateRoll_.setZero(3);
-  statePitch_.setZero(3);
-  stateYaw_.setZero(3);
+  stateX_.setZero();
+  stateY_.setZero();
+  stateRoll_.setZero();
+  statePitch_.setZero();
+  stateYaw_.setZero();
+  computeSamplingPeriods();
   if (autoCompute_)
   {
     computeDynamics();
@@ -91,17 +97,14 @@ void BaseModel<Scalar>::computeDynamics()
 template <typename Scalar>
 void BaseModel<Scalar>::computeTiltDynamic()
 {
-  Tools::ConstantJerkDynamic<Scalar>::computeOrder2PosDynamic(samplingPeriod_, samplingPeriod_,
-                                                nbSamples_, baseTiltAngleDynamic_);
-  Tools::ConstantJerkDynamic<Scalar>::computeOrder2VelDynamic(samplingPeriod_, samplingPeriod_,
-                                                nbSamples_, baseTiltAngularVelDynamic_);
+  Tools::ConstantJerkDynamic<Scalar>::computeOrder2PosDynamic(samplingPeriods_, baseTiltAngleDynamic_);
+  Tools::ConstantJerkDynamic<Scalar>::computeOrder2VelDynamic(samplingPeriods_, baseTiltAngularVelDynamic_);
 }
 
 template <typename Scalar>
 void BaseModel<Scalar>::computeCopXDynamic()
 {
-  Tools::ConstantJerkDynamic<Scalar>::computeCopDynamic(samplingPeriod_, samplingPeriod_,
-                                                nbSamples_, copXDynamic_,
+  Tools::ConstantJerkDynamic<Scalar>::computeCopDynamic(samplingPeriods_, copXDynamic_,
                                                 comHeight_, gravity_(0),
                                                 gravity_(2), mass_,
                                                 totalMass_);
@@ -110,8 +113,7 @@ void BaseModel<Scalar>::computeCopXDynamic()
 template <typename Scalar>
 void BaseModel<Scalar>::computeCopYDynamic()
 {
-  Tools::ConstantJerkDynamic<Scalar>::computeCopDynamic(samplingPeriod_, samplingPeriod_,
-                                                nbSamples_, copYDynamic_,
+  Tools::ConstantJerkDynamic<Scalar>::computeCopDynamic(samplingPeriods_, copYDynamic_,
                                                 comHeight_, gravity_(1),
                                                 gravity_(2), mass_,
                                                 totalMass_);
@@ -120,23 +122,20 @@ void BaseModel<Scalar>::computeCopYDynamic()
 template <typename Scalar>
 void BaseModel<Scalar>::computeBasePosDynamic()
 {
-  Tools::ConstantJerkDynamic<Scalar>::computePosDynamic(samplingPeriod_, samplingPeriod_,
-                                                nbSamples_, basePosDynamic_);
+  Tools::ConstantJerkDynamic<Scalar>::computePosDynamic(samplingPeriods_, basePosDynamic_);
 
 }
 
 template <typename Scalar>
 void BaseModel<Scalar>::computeBaseVelDynamic()
 {
-  Tools::ConstantJerkDynamic<Scalar>::computeVelDynamic(samplingPeriod_, samplingPeriod_,
-                                                nbSamples_, baseVelDynamic_);
+  Tools::ConstantJerkDynamic<Scalar>::computeVelDynamic(samplingPeriods_, baseVelDynamic_);
 }
 
 template <typename Scalar>
 void BaseModel<Scalar>::computeBaseAccDynamic()
 {
-  Tools::ConstantJerkDynamic<Scalar>::computeAccDynamic(samplingPeriod_, samplingPeriod_,
-                                                nbSamples_, baseAccDynamic_);
+  Tools::ConstantJerkDynamic<Scalar>::computeAccDynamic(samplingPeriods_, baseAccDynamic_);
 }
 
 template <typename Scalar>
@@ -151,6 +150,7 @@ void BaseModel<Scalar>::setNbSamples(int nbSamples)
   assert(nbSamples>0);
 
   nbSamples_ = nbSamples;
+  computeSamplingPeriods();
 
   if (autoCompute_)
   {
@@ -176,6 +176,24 @@ void BaseModel<Scalar>::setSamplingPeriod(Scalar samplingPeriod)
   assert(samplingPeriod>0);
 
   samplingPeriod_ = samplingPeriod;
+  givenSamplingPeriods_.resize(0);
+  computeSamplingPeriods();
+
+  if (autoCompute_)
+  {
+    computeDynamics();
+  }
+}
+
+template <typename Scalar>
+void BaseModel<Scalar>::setSamplingPeriods(const VectorX& samplingPeriods)
+{
+  assert(samplingPeriods.size()>0);
+  assert(samplingPeriods.minCoeff()>0);
+
+  samplingPeriod_ = samplingPeriods(0);
+  givenSamplingPeriods_ = samplingPeriods;
+  computeSamplingPeriods();
 
   if (autoCompute_)
   {
@@ -183,6 +201,30 @@ void BaseModel<Scalar>::setSamplingPeriod(Scalar samplingPeriod)
   }
 }
 
+template <typename Scalar>
+void BaseModel<Scalar>::computeSamplingPeriods()
+{
+  Tools::ConstantJerkDynamic<Scalar>::computeSamplingPeriods(givenSamplingPeriods_,
+                                                             samplingPeriod_, nbSamples_,
+                                                             samplingPeriods_);
+
+  if (withPeriodWeighting_)
+  {
+    sampleWeights_ = samplingPeriods_/samplingPeriod_;
+  }
+  else
+  {
+    sampleWeights_.setOnes(nbSamples_);
+  }
+}
+
+template <typename Scalar>
+void BaseModel<Scalar>::setPeriodWeighting(bool withPeriodWeighting)
+{
+  withPeriodWeighting_ = withPeriodWeighting;
+  computeSamplingPeriods();
+}
+
 template <typename Scalar>
 void BaseModel<Scalar>::setComHeight(Scalar comHeight)
 {
@@ -242,6 +284,54 @@ void BaseModel<Scalar>::setTotalMass(Scalar mass)
   }
 }
 
+template <typename Scalar>
+void BaseModel<Scalar>::archive(ConstantPartArchive<Scalar>& ar)
+{
+  ar.process(autoCompute_);
+
+  ar.process(nbSamples_);
+  ar.process(samplingPeriod_);
+  ar.process(givenSamplingPeriods_);
+  ar.process(samplingPeriods_);
+  ar.process(withPeriodWeighting_);
+  ar.process(sampleWeights_);
+
+  ar.process(stateX_);
+  ar.process(stateY_);
+  ar.process(stateRoll_);
+  ar.process(statePitch_);
+  ar.process(stateYaw_);
+
+  ar.process(comHeight_);
+  ar.process(gravity_);
+  ar.process(mass_);
+  ar.process(totalMass_);
+
+  ar.process(velocityLimit_);
+  ar.process(accelerationLimit_);
+  ar.process(jerkLimit_);
+
+  ar.process(tiltContactPointX_);
+  ar.process(tiltContactPointY_);
+
+  basePosDynamic_.archive(ar);
+  baseVelDynamic_.archive(ar);
+  baseAccDynamic_.archive(ar);
+  baseJerkDynamic_.archive(ar);
+  copXDynamic_.archive(ar);
+  copYDynamic_.archive(ar);
+  baseTiltAngleDynamic_.archive(ar);
+  baseTiltAngularVelDynamic_.archive(ar);
+
+  copSupportConvexPolygon_.archive(ar);
+  comSupportConvexPolygon_.archive(ar);
+
+  if (ar.isLoading() && (nbSamples_<=0 || samplingPeriods_.size()!=nbSamples_))
+  {
+    ar.invalidate();
+  }
+}
+
 namespace MPCWalkgen
 {
   MPC_WALKGEN_INSTANTIATE_CLASS_TEMPLATE(BaseModel);
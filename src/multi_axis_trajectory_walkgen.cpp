@@ -0,0 +1,485 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <mpc-walkgen/multi_axis_trajectory_walkgen.h>
+#include <iostream>
+#include <mpc-walkgen/constant.h>
+#include <mpc-walkgen/tools.h>
+#include <cmath>
+#include "macro.h"
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+
+namespace MPCWalkgen
+{
+
+template <typename Scalar>
+MultiAxisTrajectoryWalkgen<Scalar>::MultiAxisTrajectoryWalkgen(int nbAxes)
+:nbAxes_(nbAxes)
+,nbThreads_(1)
+,jerkMinObj_(noDynModel_)
+,velTrackingObj_(noDynModel_)
+,posTrackingObj_(noDynModel_)
+,motionConstraint_(noDynModel_)
+,states_(MatrixX::Zero(3, nbAxes))
+,jerks_(VectorX::Zero(nbAxes))
+,velLimit_(VectorX::Constant(nbAxes, noDynModel_.getVelocityLimit()))
+,accLimit_(VectorX::Constant(nbAxes, noDynModel_.getAccelerationLimit()))
+,jerkLimit_(VectorX::Constant(nbAxes, noDynModel_.getJerkLimit()))
+,solutionFound_(nbAxes, 1)
+,timeSinceLastShift_(0)
+{
+  assert(nbAxes>0);
+
+  setNbSamples(noDynModel_.getNbSamples());
+}
+
+template <typename Scalar>
+MultiAxisTrajectoryWalkgen<Scalar>::~MultiAxisTrajectoryWalkgen(){}
+
+template <typename Scalar>
+void MultiAxisTrajectoryWalkgen<Scalar>::setNbSamples(int nbSamples)
+{
+  assert(nbSamples>0);
+
+  noDynModel_.setNbSamples(nbSamples);
+
+  // As the references must have the size of the problem, they are reset
+  velRef_.setZero(nbSamples, nbAxes_);
+  posRef_.setZero(nbSamples, nbAxes_);
+  X_.setZero(noDynModel_.getNbVariables(), nbAxes_);
+  p_.setZero(noDynModel_.getNbVariables(), nbAxes_);
+  tmp_.setZero(nbSamples, nbAxes_);
+
+  jerkMinObj_.computeConstantPart();
+  velTrackingObj_.computeConstantPart();
+  posTrackingObj_.computeConstantPart();
+  motionConstraint_.computeConstantPart();
+
+  computeConstantPart();
+}
+
+template <typename Scalar>
+void MultiAxisTrajectoryWalkgen<Scalar>::setMoveBlocking(const std::vector<int>& moveBlocking)
+{
+  noDynModel_.setMoveBlocking(moveBlocking);
+
+  X_.setZero(noDynModel_.getNbVariables(), nbAxes_);
+  p_.setZero(noDynModel_.getNbVariables(), nbAxes_);
+
+  jerkMinObj_.computeConstantPart();
+  velTrackingObj_.computeConstantPart();
+  posTrackingObj_.computeConstantPart();
+  motionConstraint_.computeConstantPart();
+
+  computeConstantPart();
+}
+
+template <typename Scalar>
+void MultiAxisTrajectoryWalkgen<Scalar>::setSamplingPeriod(Scalar samplingPeriod)
+{
+  assert(samplingPeriod>0.0);
+
+  noDynModel_.setSamplingPeriod(samplingPeriod);
+
+  jerkMinObj_.computeConstantPart();
+  velTrackingObj_.computeConstantPart();
+  posTrackingObj_.computeConstantPart();
+  motionConstraint_.computeConstantPart();
+
+  computeConstantPart();
+}
+
+template <typename Scalar>
+void MultiAxisTrajectoryWalkgen<Scalar>::setSamplingPeriods(const VectorX& samplingPeriods)
+{
+  assert(samplingPeriods.size()>0);
+  assert(samplingPeriods.minCoeff()>0.0);
+
+  noDynModel_.setSamplingPeriods(samplingPeriods);
+
+  jerkMinObj_.computeConstantPart();
+  velTrackingObj_.computeConstantPart();
+  posTrackingObj_.computeConstantPart();
+  motionConstraint_.computeConstantPart();
+
+  computeConstantPart();
+}
+
+template <typename Scalar>
+void MultiAxisTrajectoryWalkgen<Scalar>::setNbThreads(int nbThreads)
+{
+  assert(nbThreads>0);
+
+  nbThreads_ = std::min(nbThreads, nbAxes_);
+
+  // The constant parts of the workers are copies of the first one
+  Worker first = workers_[0];
+  workers_.resize(nbThreads_, first);
+
+  workerSolves_.resize(nbThreads_);
+  for(int w=0; w<nbThreads_; ++w)
+  {
+    int firstAxis = w*nbAxes_/nbThreads_;
+    int lastAxis = (w+1)*nbAxes_/nbThreads_;
+    workerSolves_[w] = boost::bind(&MultiAxisTrajectoryWalkgen<Scalar>::solveAxes,
+                                   this, w, firstAxis, lastAxis-firstAxis);
+  }
+  scheduler_.reset(nbThreads_>1 ? new WalkgenScheduler(nbThreads_) : 0);
+}
+
+template <typename Scalar>
+void MultiAxisTrajectoryWalkgen<Scalar>::setVelRefInWorldFrame(const MatrixX& velRef)
+{
+  assert(velRef==velRef);
+  assert(velRef.rows()==noDynModel_.getNbSamples());
+  assert(velRef.cols()==nbAxes_);
+
+  velRef_ = velRef;
+}
+
+template <typename Scalar>
+void MultiAxisTrajectoryWalkgen<Scalar>::setPosRefInWorldFrame(const MatrixX& posRef)
+{
+  assert(posRef==posRef);
+  assert(posRef.rows()==noDynModel_.getNbSamples());
+  assert(posRef.cols()==nbAxes_);
+
+  posRef_ = posRef;
+}
+
+template <typename Scalar>
+void MultiAxisTrajectoryWalkgen<Scalar>::setVelRefInWorldFrame(int axis,
+                                                               const VectorX& velRef)
+{
+  assert(axis>=0 && axis<nbAxes_);
+  assert(velRef==velRef);
+  assert(velRef.size()==noDynModel_.getNbSamples());
+
+  velRef_.col(axis) = velRef;
+}
+
+template <typename Scalar>
+void MultiAxisTrajectoryWalkgen<Scalar>::setPosRefInWorldFrame(int axis,
+                                                               const VectorX& posRef)
+{
+  assert(axis>=0 && axis<nbAxes_);
+  assert(posRef==posRef);
+  assert(posRef.size()==noDynModel_.getNbSamples());
+
+  posRef_.col(axis) = posRef;
+}
+
+template <typename Scalar>
+void MultiAxisTrajectoryWalkgen<Scalar>::setVelLimit(Scalar limit)
+{
+  assert(limit>=0);
+
+  velLimit_.fill(limit);
+}
+
+template <typename Scalar>
+void MultiAxisTrajectoryWalkgen<Scalar>::setAccLimit(Scalar limit)
+{
+  assert(limit>=0);
+
+  accLimit_.fill(limit);
+}
+
+template <typename Scalar>
+void MultiAxisTrajectoryWalkgen<Scalar>::setJerkLimit(Scalar limit)
+{
+  assert(limit>=0);
+
+  jerkLimit_.fill(limit);
+}
+
+template <typename Scalar>
+void MultiAxisTrajectoryWalkgen<Scalar>::setVelLimit(int axis, Scalar limit)
+{
+  assert(axis>=0 && axis<nbAxes_);
+  assert(limit>=0);
+
+  velLimit_(axis) = limit;
+}
+
+template <typename Scalar>
+void MultiAxisTrajectoryWalkgen<Scalar>::setAccLimit(int axis, Scalar limit)
+{
+  assert(axis>=0 && axis<nbAxes_);
+  assert(limit>=0);
+
+  accLimit_(axis) = limit;
+}
+
+template <typename Scalar>
+void MultiAxisTrajectoryWalkgen<Scalar>::setJerkLimit(int axis, Scalar limit)
+{
+  assert(axis>=0 && axis<nbAxes_);
+  assert(limit>=0);
+
+  jerkLimit_(axis) = limit;
+}
+
+template <typename Scalar>
+void MultiAxisTrajectoryWalkgen<Scalar>::setStates(const MatrixX& states)
+{
+  assert(states==states);
+  assert(states.rows()==3);
+  assert(states.cols()==nbAxes_);
+
+  states_ = states;
+}
+
+template <typename Scalar>
+void MultiAxisTrajectoryWalkgen<Scalar>::setState(int axis, const Vector3& state)
+{
+  assert(axis>=0 && axis<nbAxes_);
+  assert(state==state);
+
+  states_.col(axis) = state;
+}
+
+template <typename Scalar>
+void MultiAxisTrajectoryWalkgen<Scalar>::setWeightings(
+    const TrajectoryWalkgenWeighting<Scalar>& weighting)
+{
+  assert(weighting.velocityTracking>=0);
+  assert(weighting.positionTracking>=0);
+  assert(weighting.jerkMinimization>=0);
+
+  weighting_ = weighting;
+
+  computeConstantPart();
+}
+
+template <typename Scalar>
+void MultiAxisTrajectoryWalkgen<Scalar>::setConfig(
+    const TrajectoryWalkgenConfig<Scalar>& config)
+{
+  assert(config.withMotionConstraints == config.withMotionConstraints);
+
+  config_ = config;
+
+  if (noDynModel_.getPeriodWeighting()!=config_.withPeriodWeighting)
+  {
+    noDynModel_.setPeriodWeighting(config_.withPeriodWeighting);
+    jerkMinObj_.computeConstantPart();
+    velTrackingObj_.computeConstantPart();
+    posTrackingObj_.computeConstantPart();
+  }
+
+  computeConstantPart();
+}
+
+template <typename Scalar>
+bool MultiAxisTrajectoryWalkgen<Scalar>::solve(Scalar feedBackPeriod)
+{
+  int N = noDynModel_.getNbSamples();
+
+  assert(feedBackPeriod>0);
+
+  // Gradients of all the axes
+  p_.noalias() = workers_[0].qpMatrix.Q*X_;
+  if (weighting_.velocityTracking>0.0)
+  {
+    tmp_.noalias() = noDynModel_.getVelLinearDynamic().S*states_;
+    tmp_ -= velRef_;
+    p_.noalias() += velGradient_*tmp_;
+  }
+  if (weighting_.positionTracking>0.0)
+  {
+    tmp_.noalias() = noDynModel_.getPosLinearDynamic().S*states_;
+    tmp_ -= posRef_;
+    p_.noalias() += posGradient_*tmp_;
+  }
+
+  // Bounds of the motion constraints of all the axes: velocity rows, then
+  // acceleration rows
+  if (config_.withMotionConstraints)
+  {
+    bl_.noalias() = -workers_[0].qpMatrix.A*X_;
+    bl_.noalias() -= stateGradient_*states_;
+    bu_ = bl_;
+    bl_.topRows(N).rowwise() -= velLimit_.transpose();
+    bl_.bottomRows(N).rowwise() -= accLimit_.transpose();
+    bu_.topRows(N).rowwise() += velLimit_.transpose();
+    bu_.bottomRows(N).rowwise() += accLimit_.transpose();
+  }
+
+  // The request of worker w is bound to the instance w, so that each chunk
+  // of axes is solved by the same thread from solve to solve
+  bool solutionFound;
+  if (scheduler_)
+  {
+    for(int w=0; w<nbThreads_; ++w)
+    {
+      scheduler_->add(w, boost::ref(workerSolves_[w]));
+    }
+    solutionFound = scheduler_->run();
+  }
+  else
+  {
+    solutionFound = solveAxes(0, 0, nbAxes_);
+  }
+
+  for(int k=0; k<nbAxes_; ++k)
+  {
+    Vector3 state = states_.col(k);
+    jerks_(k) = X_(0, k);
+    Tools::ConstantJerkDynamic<Scalar>::updateState(jerks_(k), feedBackPeriod, state);
+    states_.col(k) = state;
+  }
+
+  if (config_.withWarmStartShift && solutionFound)
+  {
+    timeSinceLastShift_ += feedBackPeriod;
+    if (timeSinceLastShift_ > noDynModel_.getSamplingPeriod() - Constant<Scalar>::EPSILON)
+    {
+      timeSinceLastShift_ -= noDynModel_.getSamplingPeriod();
+      shiftWarmStart();
+    }
+  }
+
+  return solutionFound;
+}
+
+template <typename Scalar>
+bool MultiAxisTrajectoryWalkgen<Scalar>::solveAxes(int worker, int firstAxis, int nbAxes)
+{
+  QPMatrices<Scalar>& m = workers_[worker].qpMatrix;
+  VectorX& dX = workers_[worker].dX;
+
+  bool allSolutionsFound = true;
+  for(int k=firstAxis; k<firstAxis+nbAxes; ++k)
+  {
+    m.p = p_.col(k);
+
+    if (config_.withMotionConstraints)
+    {
+      m.bl = bl_.col(k);
+      m.bu = bu_.col(k);
+
+      m.xu.fill(jerkLimit_(k));
+      m.xu -= X_.col(k);
+      m.xl.fill(-jerkLimit_(k));
+      m.xl -= X_.col(k);
+    }
+
+    bool solutionFound = qpSolvers_[k]->solve(m, dX, true);
+    solutionFound_[k] = solutionFound ? 1 : 0;
+
+    if (!solutionFound)
+    {
+      std::cerr << "axis: " << k << std::endl;
+      std::cerr << "p : " << m.p.transpose() << std::endl;
+      std::cerr << "bl: " << m.bl.transpose() << std::endl;
+      std::cerr << "bu: " << m.bu.transpose() << std::endl;
+      std::cerr << "X : " << X_.col(k).transpose() << std::endl;
+      std::cerr << "dX: " << dX.transpose() << std::endl;
+      std::cerr << "c : " << states_.col(k).transpose() << std::endl;
+    }
+
+    X_.col(k) += dX;
+    allSolutionsFound = allSolutionsFound && solutionFound;
+  }
+  return allSolutionsFound;
+}
+
+template <typename Scalar>
+void MultiAxisTrajectoryWalkgen<Scalar>::computeConstantPart()
+{
+  int N = noDynModel_.getNbSamples();
+  int nbVariables = noDynModel_.getNbVariables();
+  int M = config_.withMotionConstraints? motionConstraint_.getNbConstraints() : 0;
+
+  assert(velTrackingObj_.getHessian().rows() == nbVariables);
+  assert(posTrackingObj_.getHessian().rows() == nbVariables);
+  assert(jerkMinObj_.getHessian().rows() == nbVariables);
+
+  qpSolvers_.resize(nbAxes_);
+  for(int k=0; k<nbAxes_; ++k)
+  {
+    qpSolvers_[k].reset(makeQPSolver<Scalar>(nbVariables, M));
+  }
+
+  workers_.resize(nbThreads_);
+  QPMatrices<Scalar>& m = workers_[0].qpMatrix;
+
+  m.Q.setZero(nbVariables, nbVariables);
+  m.p.setZero(nbVariables);
+  m.A.setZero(M, nbVariables);
+  m.bl.setZero(M);
+  m.bu.setZero(M);
+  m.xl.setConstant(nbVariables, Scalar(-10e10));
+  m.xu.setConstant(nbVariables, Scalar(10e10));
+
+  const LinearDynamic<Scalar>& velDyn = noDynModel_.getVelLinearDynamic();
+  const LinearDynamic<Scalar>& posDyn = noDynModel_.getPosLinearDynamic();
+  const LinearDynamic<Scalar>& accDyn = noDynModel_.getAccLinearDynamic();
+
+  const VectorX& weights = noDynModel_.getSampleWeights();
+  velGradient_ = weighting_.velocityTracking*velDyn.UT*weights.asDiagonal();
+  posGradient_ = weighting_.positionTracking*posDyn.UT*weights.asDiagonal();
+
+  if (weighting_.velocityTracking>0.0)
+  {
+    m.Q += weighting_.velocityTracking*velTrackingObj_.getHessian();
+  }
+  if (weighting_.positionTracking>0.0)
+  {
+    m.Q += weighting_.positionTracking*posTrackingObj_.getHessian();
+  }
+  if (weighting_.jerkMinimization>0.0)
+  {
+    m.Q += weighting_.jerkMinimization*jerkMinObj_.getHessian();
+  }
+
+  if (config_.withMotionConstraints)
+  {
+    m.A = motionConstraint_.getGradient();
+
+    stateGradient_.resize(M, 3);
+    stateGradient_.block(0, 0, N, 3) = velDyn.S;
+    stateGradient_.block(N, 0, N, 3) = accDyn.S;
+  }
+
+  m.At = m.A.transpose();
+  workers_[0].dX.setZero(nbVariables);
+
+  for(int w=1; w<nbThreads_; ++w)
+  {
+    workers_[w] = workers_[0];
+  }
+
+  bl_.setZero(M, nbAxes_);
+  bu_.setZero(M, nbAxes_);
+}
+
+template <typename Scalar>
+void MultiAxisTrajectoryWalkgen<Scalar>::shiftWarmStart()
+{
+  const int N = noDynModel_.getNbSamples();
+  const int nbVariables = noDynModel_.getNbVariables();
+
+  noDynModel_.shiftVariables(X_);
+
+  // The working set of each axis is shifted as in TrajectoryWalkgen
+  for(int k=0; k<nbAxes_; ++k)
+  {
+    qpSolvers_[k]->getDualSolution(dual_);
+    assert((dual_.size() - nbVariables)%N == 0);
+    typename VectorX::SegmentReturnType boundDual = dual_.head(nbVariables);
+    noDynModel_.shiftVariables(boundDual);
+    Tools::shiftSamples<Scalar>(dual_, nbVariables, noDynModel_.getSamplingPeriods(),
+                                (dual_.size() - nbVariables)/N);
+    qpSolvers_[k]->setDualGuess(dual_);
+  }
+}
+
+  MPC_WALKGEN_INSTANTIATE_CLASS_TEMPLATE(MultiAxisTrajectoryWalkgen);
+
+}
@@ -8,12 +8,43 @@
 #include <mpc-walkgen/constant.h>
 #include <mpc-walkgen/tools.h>
 #include <cmath>
+#include <algorithm>
 #include "macro.h"
 
 namespace MPCWalkgen
 {
 using namespace Eigen;
 
+template <typename Scalar>
+void Tools::ConstantJerkDynamic<Scalar>::computeSamplingPeriods(Scalar S, Scalar T,
+                                                               int N, VectorX& periods)
+{
+  assert(N>0);
+
+  periods.setConstant(N, T);
+  periods(0) = S;
+}
+
+template <typename Scalar>
+void Tools::ConstantJerkDynamic<Scalar>::computeSamplingPeriods(const VectorX& pattern,
+                                                               Scalar T, int N,
+                                                               VectorX& periods)
+{
+  assert(N>0);
+
+  if (pattern.size()==0)
+  {
+    periods.setConstant(N, T);
+    return;
+  }
+
+  assert(pattern.minCoeff()>0.0);
+
+  const int size = std::min(N, static_cast<int>(pattern.size()));
+  periods.setConstant(N, pattern(pattern.size() - 1));
+  periods.head(size) = pattern.head(size);
+}
+
 template <typename Scalar>
 void Tools::ConstantJerkDynamic<Scalar>::computeCopDynamic(Scalar S, Scalar T,
                                                    int N, LinearDynamic<Scalar>& dyn,
@@ -21,42 +52,49 @@ void Tools::ConstantJerkDynamic<Scalar>::computeCopDynamic(Scalar S, Scalar T,
                                                    Scalar gravityZ, Scalar mass,
                                                    Scalar totalMass)
 {
-  assert(S>0.0);
-  assert(T>0.0);
-  assert(N>0);
+  VectorX periods;
+  computeSamplingPeriods(S, T, N, periods);
+  computeCopDynamic(periods, dyn, comHeight, gravityX, gravityZ, mass, totalMass);
+}
+
+template <typename Scalar>
+void Tools::ConstantJerkDynamic<Scalar>::computeCopDynamic(const VectorX& periods,
+                                                   LinearDynamic<Scalar>& dyn,
+                                                   Scalar comHeight, Scalar gravityX,
+                                                   Scalar gravityZ, Scalar mass,
+                                                   Scalar totalMass)
+{
+  assert(periods.size()>0);
+  assert(periods.minCoeff()>0.0);
   assert(std::abs(gravityZ)>Constant<Scalar>::EPSILON);
   assert(totalMass>=mass);
   assert(totalMass>Constant<Scalar>::EPSILON);
   assert(mass>=0.0);
 
-  Scalar SS = std::pow(S, 2);
-  Scalar SSS = std::pow(S, 3);
-  Scalar TT = std::pow(T, 2);
-  Scalar TTT = std::pow(T, 3);
+  const int N = static_cast<int>(periods.size());
   Scalar m = mass/totalMass;
 
   dyn.reset(N, 3, N);
 
+  // ti is the time of sample i, and tj the end of the period of jerk j
+  Scalar ti = 0;
   for (int i=0; i<N; ++i)
   {
+    ti += periods(i);
+
     dyn.S(i, 0) = m;
-    dyn.S(i, 1) = m*(static_cast<Scalar>(i)*T + S);
-    dyn.S(i, 2) = m*(0.5f*SS
-                  + static_cast<Scalar>(i)*T*S
-                  + 0.5f*std::pow(static_cast<Scalar>(i), 2)*TT
-                  - comHeight/gravityZ);
+    dyn.S(i, 1) = m*ti;
+    dyn.S(i, 2) = m*(0.5f*ti*ti - comHeight/gravityZ);
 
     dyn.K(i) = -m*comHeight*gravityX/gravityZ;
 
-    dyn.U(i, 0) = dyn.UT(0, i) = m*(SSS/6.0f
-                                    + 0.5f*static_cast<Scalar>(i)*T*SS
-                                    + 0.5f*std::pow(static_cast<Scalar>(i), 2)*S*TT
-                                    - S*comHeight/gravityZ);
-    for(int j=1; j<=i; ++j)
+    Scalar tj = 0;
+    for(int j=0; j<=i; ++j)
     {
-      dyn.U(i, j) = dyn.UT(j, i) = m*TTT*(static_cast<Scalar>(1.0/6.0)
-                                          + 0.5f*static_cast<Scalar>(i-j)
-                                          + 0.5f*std::pow(static_cast<Scalar>(i-j),2))
+      const Scalar T = periods(j);
+      tj += T;
+      const Scalar d = ti - tj;
+      dyn.U(i, j) = dyn.UT(j, i) = m*(T*T*T/6.0f + 0.5f*T*T*d + 0.5f*T*d*d)
                                    - m*T*comHeight/gravityZ;
     }
   }
@@ -69,35 +107,39 @@ template <typename Scalar>
 void Tools::ConstantJerkDynamic<Scalar>::computePosDynamic(Scalar S, Scalar T,
                                                    int N, LinearDynamic<Scalar>& dyn)
 {
-  assert(S>0.0);
-  assert(T>0.0);
-  assert(N>0);
+  VectorX periods;
+  computeSamplingPeriods(S, T, N, periods);
+  computePosDynamic(periods, dyn);
+}
 
-  Scalar SS = std::pow(S, 2);
-  Scalar SSS = std::pow(S, 3);
-  Scalar TT = std::pow(T, 2);
-  Scalar TTT = std::pow(T, 3);
+template <typename Scalar>
+void Tools::ConstantJerkDynamic<Scalar>::computePosDynamic(const VectorX& periods,
+                                                           LinearDynamic<Scalar>& dyn)
+{
+  assert(periods.size()>0);
+  assert(periods.minCoeff()>0.0);
+
+  const int N = static_cast<int>(periods.size());
 
   dyn.reset(N, 3, N);
 
+  Scalar ti = 0;
   for (int i=0; i<N; ++i)
   {
+    ti += periods(i);
+
     dyn.S(i, 0) = 1.0f;
-    dyn.S(i, 1) = static_cast<Scalar>(i)*T + S;
-    dyn.S(i, 2) = 0.5f*SS
-                + static_cast<Scalar>(i)*T*S
-                + 0.5f*std::pow(static_cast<Scalar>(i), 2)*TT;
-
-    dyn.U(i, 0) = dyn.UT(0, i) = SSS/6.0f
-                                 + 0.5f*static_cast<Scalar>(i)*T*SS
-                                 + 0.5f*std::pow(static_cast<Scalar>(i), 2)*S*TT;
-    for(int j=1; j<=i; ++j)
+    dyn.S(i, 1) = ti;
+    dyn.S(i, 2) = 0.5f*ti*ti;
+
+    Scalar tj = 0;
+    for(int j=0; j<=i; ++j)
     {
-      dyn.U(i, j) = dyn.UT(j, i) = TTT*(static_cast<Scalar>(1.0/6.0)
-                                   + 0.5f*static_cast<Scalar>(i-j)
-                                   + 0.5f*std::pow(static_cast<Scalar>(i-j),2));
+      const Scalar T = periods(j);
+      tj += T;
+      const Scalar d = ti - tj;
+      dyn.U(i, j) = dyn.UT(j, i) = T*T*T/6.0f + 0.5f*T*T*d + 0.5f*T*d*d;
     }
-
   }
 
   Tools::inverseLU(dyn.U, dyn.Uinv, Constant<Scalar>::EPSILON);
@@ -108,24 +150,36 @@ template <typename Scalar>
 void Tools::ConstantJerkDynamic<Scalar>::computeVelDynamic(Scalar S, Scalar T,
                                                            int N, LinearDynamic<Scalar>& dyn)
 {
-  assert(S>0.0);
-  assert(T>0.0);
-  assert(N>0);
+  VectorX periods;
+  computeSamplingPeriods(S, T, N, periods);
+  computeVelDynamic(periods, dyn);
+}
+
+template <typename Scalar>
+void Tools::ConstantJerkDynamic<Scalar>::computeVelDynamic(const VectorX& periods,
+                                                           LinearDynamic<Scalar>& dyn)
+{
+  assert(periods.size()>0);
+  assert(periods.minCoeff()>0.0);
 
-  Scalar SS = std::pow(S, 2);
-  Scalar TT = std::pow(T, 2);
+  const int N = static_cast<int>(periods.size());
 
   dyn.reset(N, 3, N);
 
+  Scalar ti = 0;
   for (int i=0; i<N; ++i)
   {
+    ti += periods(i);
+
     dyn.S(i, 1) = 1.0;
-    dyn.S(i, 2) = static_cast<Scalar>(i)*T + S;
+    dyn.S(i, 2) = ti;
 
-    dyn.U(i, 0) = dyn.UT(0, i) = 0.5f*SS + static_cast<Scalar>(i)*T*S;
-    for(int j=1; j<=i; ++j)
+    Scalar tj = 0;
+    for(int j=0; j<=i; ++j)
     {
-      dyn.U(i, j) = dyn.UT(j, i) = 0.5f*TT + static_cast<Scalar>(i-j)*TT;
+      const Scalar T = periods(j);
+      tj += T;
+      dyn.U(i, j) = dyn.UT(j, i) = 0.5f*T*T + T*(ti - tj);
     }
   }
 
@@ -137,24 +191,36 @@ template <typename Scalar>
 void Tools::ConstantJerkDynamic<Scalar>::computeOrder2PosDynamic(Scalar S, Scalar T,
                                                                  int N, LinearDynamic<Scalar>& dyn)
 {
-  assert(S>0.0);
-  assert(T>0.0);
-  assert(N>0);
+  VectorX periods;
+  computeSamplingPeriods(S, T, N, periods);
+  computeOrder2PosDynamic(periods, dyn);
+}
 
-  Scalar SS = std::pow(S, 2);
-  Scalar TT = std::pow(T, 2);
+template <typename Scalar>
+void Tools::ConstantJerkDynamic<Scalar>::computeOrder2PosDynamic(const VectorX& periods,
+                                                                 LinearDynamic<Scalar>& dyn)
+{
+  assert(periods.size()>0);
+  assert(periods.minCoeff()>0.0);
+
+  const int N = static_cast<int>(periods.size());
 
   dyn.reset(N, 2, N);
 
+  Scalar ti = 0;
   for (int i=0; i<N; ++i)
   {
+    ti += periods(i);
+
     dyn.S(i, 0) = 1.0;
-    dyn.S(i, 1) = static_cast<Scalar>(i)*T + S;
+    dyn.S(i, 1) = ti;
 
-    dyn.U(i, 0) = dyn.UT(0, i) = 0.5f*SS + static_cast<Scalar>(i)*T*S;
-    for(int j=1; j<=i; ++j)
+    Scalar tj = 0;
+    for(int j=0; j<=i; ++j)
     {
-      dyn.U(i, j) = dyn.UT(j, i) = 0.5f*TT + static_cast<Scalar>(i-j)*TT;
+      const Scalar T = periods(j);
+      tj += T;
+      dyn.U(i, j) = dyn.UT(j, i) = 0.5f*T*T + T*(ti - tj);
     }
   }
 
@@ -166,38 +232,38 @@ template <typename Scalar>
 void Tools::ConstantJerkDynamic<Scalar>::computeAccDynamic(Scalar S, Scalar T,
                                                            int N, LinearDynamic<Scalar>& dyn)
 {
-  assert(std::abs(S)>0.0);
-  assert(T>0.0);
-  assert(N>0);
+  VectorX periods;
+  computeSamplingPeriods(S, T, N, periods);
+  computeAccDynamic(periods, dyn);
+}
 
-  dyn.reset(N, 3, N);
+template <typename Scalar>
+void Tools::ConstantJerkDynamic<Scalar>::computeAccDynamic(const VectorX& periods,
+                                                           LinearDynamic<Scalar>& dyn)
+{
+  assert(periods.size()>0);
+  assert(periods.minCoeff()>0.0);
 
-  dyn.Uinv(0, 0) = dyn.UTinv(0, 0) = 1/S;
+  const int N = static_cast<int>(periods.size());
 
-  if(dyn.Uinv.rows()>1)
-  {
-    dyn.Uinv(1, 0) = dyn.UTinv(0, 1) = -1/S;
-  }
+  dyn.reset(N, 3, N);
 
   for (int i=0; i<N; ++i)
   {
     dyn.S(i, 2) = 1.0;
 
-    dyn.U(i, 0) = dyn.UT(0, i) = S;
-
-    for(int j=1; j<=i; ++j)
+    for(int j=0; j<=i; ++j)
     {
-      dyn.U(i, j) = dyn.UT(j, i) = T;
-      if(i == j)
-      {
-        dyn.Uinv(i, j) = dyn.UTinv(j, i) = 1/T;
-      }
-      if(i == j+1)
-      {
-        dyn.Uinv(i, j) = dyn.UTinv(j, i) = -1/T;
-      }
+      dyn.U(i, j) = dyn.UT(j, i) = periods(j);
     }
 
+    // The jerk of sample i is the difference of the accelerations of
+    // samples i and i-1, divided by its period
+    dyn.Uinv(i, i) = dyn.UTinv(i, i) = 1/periods(i);
+    if (i>0)
+    {
+      dyn.Uinv(i, i-1) = dyn.UTinv(i-1, i) = -1/periods(i);
+    }
   }
 }
 
@@ -205,38 +271,36 @@ template <typename Scalar>
 void Tools::ConstantJerkDynamic<Scalar>::computeOrder2VelDynamic(Scalar S, Scalar T,
                                                                  int N, LinearDynamic<Scalar>& dyn)
 {
-  assert(T>0.0);
-  assert(std::abs(S)>0.0);
-  assert(N>0);
+  VectorX periods;
+  computeSamplingPeriods(S, T, N, periods);
+  computeOrder2VelDynamic(periods, dyn);
+}
 
-  dyn.reset(N, 2, N);
+template <typename Scalar>
+void Tools::ConstantJerkDynamic<Scalar>::computeOrder2VelDynamic(const VectorX& periods,
+                                                                 LinearDynamic<Scalar>& dyn)
+{
+  assert(periods.size()>0);
+  assert(periods.minCoeff()>0.0);
 
-  dyn.Uinv(0, 0) = dyn.UTinv(0, 0) = 1/S;
+  const int N = static_cast<int>(periods.size());
 
-  if(dyn.Uinv.rows()>1)
-  {
-    dyn.Uinv(1, 0) = dyn.UTinv(0, 1) = -1/S;
-  }
+  dyn.reset(N, 2, N);
 
   for (int i=0; i<N; ++i)
   {
     dyn.S(i, 1) = 1.0;
 
-    dyn.U(i, 0) = dyn.UT(0, i) = S;
-
-    for(int j=1; j<=i; ++j)
+    for(int j=0; j<=i; ++j)
     {
-      dyn.U(i, j) = dyn.UT(j, i) = T;
-      if(i == j)
-      {
-        dyn.Uinv(i, j) = dyn.UTinv(j, i) = 1/T;
-      }
-      if(i == j+1)
-      {
-        dyn.Uinv(i, j) = dyn.UTinv(j, i) = -1/T;
-      }
+      dyn.U(i, j) = dyn.UT(j, i) = periods(j);
     }
 
+    dyn.Uinv(i, i) = dyn.UTinv(i, i) = 1/periods(i);
+    if (i>0)
+    {
+      dyn.Uinv(i, i-1) = dyn.UTinv(i-1, i) = -1/periods(i);
+    }
   }
 }
 
@@ -252,7 +316,7 @@ void Tools::ConstantJerkDynamic<Scalar>::computeJerkDynamic(int N, LinearDynamic
 }
 
 template <typename Scalar>
-void Tools::ConstantJerkDynamic<Scalar>::updateState(Scalar jerk, Scalar T, VectorX& state)
+void Tools::ConstantJerkDynamic<Scalar>::updateState(Scalar jerk, Scalar T, Vector3& state)
 {
   assert(jerk==jerk);
   assert(T>0);
@@ -267,5 +331,45 @@ void Tools::ConstantJerkDynamic<Scalar>::updateState(Scalar jerk, Scalar T, Vect
   state(2) += jerk*T;
 }
 
+template <typename Scalar>
+void Tools::ConstantJerkDynamic<Scalar>::sampleState(const Vector3& state, Scalar jerk,
+                                                     Scalar dt, int nbSetpoints,
+                                                     Scalar* pos, Scalar* vel,
+                                                     Scalar* acc)
+{
+  assert(jerk==jerk);
+  assert(dt>0);
+  assert(nbSetpoints>=0);
+
+  typedef Eigen::Array<Scalar, Eigen::Dynamic, 1> ArrayX;
+
+  if (nbSetpoints==0)
+  {
+    return;
+  }
+
+  // The times of the setpoints are a nullary expression, evaluated in the
+  // loop of each assignment
+  const Scalar lastTime = static_cast<Scalar>(nbSetpoints)*dt;
+  if (pos!=NULL)
+  {
+    Eigen::Map<ArrayX>(pos, nbSetpoints) = state(0)
+        + ArrayX::LinSpaced(nbSetpoints, dt, lastTime)*(state(1)
+        + ArrayX::LinSpaced(nbSetpoints, dt, lastTime)*(0.5f*state(2)
+        + ArrayX::LinSpaced(nbSetpoints, dt, lastTime)*(jerk/6.0f)));
+  }
+  if (vel!=NULL)
+  {
+    Eigen::Map<ArrayX>(vel, nbSetpoints) = state(1)
+        + ArrayX::LinSpaced(nbSetpoints, dt, lastTime)*(state(2)
+        + ArrayX::LinSpaced(nbSetpoints, dt, lastTime)*(0.5f*jerk));
+  }
+  if (acc!=NULL)
+  {
+    Eigen::Map<ArrayX>(acc, nbSetpoints) = state(2)
+        + ArrayX::LinSpaced(nbSetpoints, dt, lastTime)*jerk;
+  }
+}
+
   MPC_WALKGEN_INSTANTIATE_CLASS_TEMPLATE(Tools::ConstantJerkDynamic);
 }
@@ -7,7 +7,10 @@
 #include <mpc-walkgen/trajectory_walkgen.h>
 #include <iostream>
 #include <mpc-walkgen/constant.h>
+#include <mpc-walkgen/tools.h>
 #include <cmath>
+#include <limits>
+#include <Eigen/Cholesky>
 #include "macro.h"
 
 namespace MPCWalkgen
@@ -20,9 +23,16 @@ TrajectoryWalkgen<Scalar>::TrajectoryWalkgen()
 ,velTrackingObj_(noDynModel_)
 ,posTrackingObj_(noDynModel_)
 ,motionConstraint_(noDynModel_)
+,timeSinceLastShift_(0)
+,explicitTable_(NULL)
+,explicitRegion_(-1)
+,feedbackGain_(Vector3::Zero())
+,lastState_(Vector3::Zero())
+,lastJerk_(0)
+,lastFeedBackPeriod_(0)
 {
-  dX_.setZero(noDynModel_.getNbSamples());
-  X_.setZero(noDynModel_.getNbSamples());
+  dX_.setZero(noDynModel_.getNbVariables());
+  X_.setZero(noDynModel_.getNbVariables());
 
   computeConstantPart();
 }
@@ -37,8 +47,24 @@ void TrajectoryWalkgen<Scalar>::setNbSamples(int nbSamples)
 
   noDynModel_.setNbSamples(nbSamples);
 
-  dX_.setZero(nbSamples);
-  X_.setZero(nbSamples);
+  dX_.setZero(noDynModel_.getNbVariables());
+  X_.setZero(noDynModel_.getNbVariables());
+
+  jerkMinObj_.computeConstantPart();
+  velTrackingObj_.computeConstantPart();
+  posTrackingObj_.computeConstantPart();
+  motionConstraint_.computeConstantPart();
+
+  computeConstantPart();
+}
+
+template <typename Scalar>
+void TrajectoryWalkgen<Scalar>::setMoveBlocking(const std::vector<int>& moveBlocking)
+{
+  noDynModel_.setMoveBlocking(moveBlocking);
+
+  dX_.setZero(noDynModel_.getNbVariables());
+  X_.setZero(noDynModel_.getNbVariables());
 
   jerkMinObj_.computeConstantPart();
   velTrackingObj_.computeConstantPart();
@@ -63,6 +89,22 @@ void TrajectoryWalkgen<Scalar>::setSamplingPeriod(Scalar samplingPeriod)
   computeConstantPart();
 }
 
+template <typename Scalar>
+void TrajectoryWalkgen<Scalar>::setSamplingPeriods(const VectorX& samplingPeriods)
+{
+  assert(samplingPeriods.size()>0);
+  assert(samplingPeriods.minCoeff()>0.0);
+
+  noDynModel_.setSamplingPeriods(samplingPeriods);
+
+  jerkMinObj_.computeConstantPart();
+  velTrackingObj_.computeConstantPart();
+  posTrackingObj_.computeConstantPart();
+  motionConstraint_.computeConstantPart();
+
+  computeConstantPart();
+}
+
 template <typename Scalar>
 void TrajectoryWalkgen<Scalar>::setVelRefInWorldFrame(const VectorX& velRef)
 {
@@ -104,10 +146,9 @@ void TrajectoryWalkgen<Scalar>::setJerkLimit(Scalar limit)
 }
 
 template <typename Scalar>
-void TrajectoryWalkgen<Scalar>::setState(const VectorX& state)
+void TrajectoryWalkgen<Scalar>::setState(const Vector3& state)
 {
   assert(state==state);
-  assert(state.size()==3);
 
   noDynModel_.setState(state);
 }
@@ -131,6 +172,14 @@ void TrajectoryWalkgen<Scalar>::setConfig(const TrajectoryWalkgenConfig<Scalar>&
 
   config_ = config;
 
+  if (noDynModel_.getPeriodWeighting()!=config_.withPeriodWeighting)
+  {
+    noDynModel_.setPeriodWeighting(config_.withPeriodWeighting);
+    jerkMinObj_.computeConstantPart();
+    velTrackingObj_.computeConstantPart();
+    posTrackingObj_.computeConstantPart();
+  }
+
   computeConstantPart();
 }
 
@@ -138,11 +187,12 @@ template <typename Scalar>
 bool TrajectoryWalkgen<Scalar>::solve(Scalar feedBackPeriod)
 {
   int N = noDynModel_.getNbSamples();
+  int nbVariables = noDynModel_.getNbVariables();
   int M = config_.withMotionConstraints? motionConstraint_.getNbConstraints() : 0;
 
-  assert(velTrackingObj_.getGradient(X_).size() == N);
-  assert(posTrackingObj_.getGradient(X_).size() == N);
-  assert(jerkMinObj_.getGradient(X_).size() == N);
+  assert(velTrackingObj_.getGradient(X_).size() == nbVariables);
+  assert(posTrackingObj_.getGradient(X_).size() == nbVariables);
+  assert(jerkMinObj_.getGradient(X_).size() == nbVariables);
 
   if (config_.withMotionConstraints)
   {
@@ -152,6 +202,27 @@ bool TrajectoryWalkgen<Scalar>::solve(Scalar feedBackPeriod)
 
   assert(feedBackPeriod>0);
 
+  if (explicitTable_!=NULL)
+  {
+    assert(explicitTable_->getNbParameters() == 2*N + 3);
+
+    getExplicitParameters(explicitParameters_);
+    explicitRegion_ = explicitTable_->findRegion(explicitParameters_, explicitRegion_);
+    if (explicitRegion_>=0)
+    {
+      X_(0) = explicitTable_->computeControl(explicitRegion_, explicitParameters_);
+      if (config_.withFeedbackGain)
+      {
+        for(int j=0; j<3; ++j)
+        {
+          feedbackGain_(j) = explicitTable_->getLawCoefficient(explicitRegion_, j);
+        }
+      }
+      updateState(feedBackPeriod);
+      return true;
+    }
+  }
+
   qpMatrix_.p.fill(Scalar(0.0));
   qpMatrix_.bu.fill(Scalar(10e10));
   qpMatrix_.bl.fill(Scalar(-10e10));
@@ -202,15 +273,324 @@ bool TrajectoryWalkgen<Scalar>::solve(Scalar feedBackPeriod)
 
   X_ += dX_;
 
+  if (config_.withFeedbackGain && solutionFound)
+  {
+    computeFeedbackGain();
+  }
+
+  updateState(feedBackPeriod);
 
-  noDynModel_.updateState(X_(0), feedBackPeriod);
+  if (config_.withWarmStartShift && solutionFound)
+  {
+    timeSinceLastShift_ += feedBackPeriod;
+    if (timeSinceLastShift_ > noDynModel_.getSamplingPeriod() - Constant<Scalar>::EPSILON)
+    {
+      timeSinceLastShift_ -= noDynModel_.getSamplingPeriod();
+      shiftWarmStart();
+    }
+  }
 
   return solutionFound;
 }
 
 
 template <typename Scalar>
-const typename Type<Scalar>::VectorX& TrajectoryWalkgen<Scalar>::getState() const
+int TrajectoryWalkgen<Scalar>::buildExplicitTable(ExplicitMPCTable<Scalar>& table,
+                                                  const MatrixX& parameterSamples)
+{
+  const int N = noDynModel_.getNbSamples();
+  const int nbVariables = noDynModel_.getNbVariables();
+  const int M = config_.withMotionConstraints? motionConstraint_.getNbConstraints() : 0;
+  const int P = 2*N + 3;
+  assert(parameterSamples.rows() == P);
+
+  const int nbRows = config_.withMotionConstraints ? M + nbVariables : 0;
+  MatrixX F, G, S;
+  VectorX w;
+  computeParametricQP(F, G, w, S);
+
+  Eigen::LDLT<MatrixX> hessian(qpMatrix_.Q);
+  const MatrixX QinvF = hessian.solve(F);
+  const MatrixX QinvGt = hessian.solve(G.transpose());
+
+  if (table.getNbParameters() != P)
+  {
+    table.reset(P);
+  }
+
+  boost::scoped_ptr< QPSolver<Scalar> > solver(makeQPSolver<Scalar>(nbVariables, M));
+  QPMatrices<Scalar> m;
+  m.Q = qpMatrix_.Q;
+  m.A = qpMatrix_.A;
+  m.At = qpMatrix_.At;
+  VectorX U(nbVariables);
+  VectorX bounds(2*nbRows);
+  std::vector<int> active;
+
+  int nbUncovered = 0;
+  for(int k=0; k<parameterSamples.cols(); ++k)
+  {
+    const VectorX theta = parameterSamples.col(k);
+    if (table.findRegion(theta)>=0)
+    {
+      continue;
+    }
+
+    // Active set of the QP at theta, from the signs of the multipliers
+    m.p = F*theta;
+    bounds = w + S*theta;
+    m.bu = bounds.segment(0, M);
+    m.bl = -bounds.segment(nbRows, M);
+    m.xu = bounds.segment(M, nbVariables);
+    m.xl = -bounds.segment(nbRows + M, nbVariables);
+    if (!config_.withMotionConstraints)
+    {
+      m.xu.fill(Scalar(10e10));
+      m.xl.fill(Scalar(-10e10));
+    }
+
+    if (!solver->solve(m, U, false))
+    {
+      ++nbUncovered;
+      continue;
+    }
+    computeActiveSet(*solver, active);
+    const int nbActive = static_cast<int>(active.size());
+
+    // On the region, the multipliers are lambda = L.theta + l and the
+    // solution is U = Z.theta + z
+    MatrixX GA(nbActive, nbVariables);
+    MatrixX SA(nbActive, P);
+    VectorX wA(nbActive);
+    MatrixX QinvGAt(nbVariables, nbActive);
+    for(int i=0; i<nbActive; ++i)
+    {
+      GA.row(i) = G.row(active[i]);
+      SA.row(i) = S.row(active[i]);
+      wA(i) = w(active[i]);
+      QinvGAt.col(i) = QinvGt.col(active[i]);
+    }
+    MatrixX L(nbActive, P);
+    VectorX l(nbActive);
+    if (nbActive>0)
+    {
+      Eigen::FullPivLU<MatrixX> kkt(GA*QinvGAt);
+      if (kkt.rank() < nbActive)
+      {
+        ++nbUncovered;
+        continue;
+      }
+      L = -kkt.solve(SA + GA*QinvF);
+      l = -kkt.solve(wA);
+    }
+    const MatrixX Z = -QinvF - QinvGAt*L;
+    const VectorX z = -QinvGAt*l;
+
+    // Primal feasibility of the inactive rows and dual feasibility of the
+    // active ones, normalized. Rows which do not depend on theta are
+    // dropped when they always hold.
+    MatrixX a(2*nbRows, P);
+    VectorX b(2*nbRows);
+    int nbRegionRows = 0;
+    bool isEmpty = false;
+    std::vector<bool> isActive(2*nbRows, false);
+    for(int i=0; i<nbActive; ++i)
+    {
+      isActive[active[i]] = true;
+      a.row(nbRegionRows) = -L.row(i);
+      b(nbRegionRows) = l(i);
+      ++nbRegionRows;
+    }
+    for(int i=0; i<2*nbRows; ++i)
+    {
+      if (!isActive[i])
+      {
+        a.row(nbRegionRows) = G.row(i)*Z - S.row(i);
+        b(nbRegionRows) = w(i) - G.row(i).dot(z);
+        ++nbRegionRows;
+      }
+    }
+    int nbKept = 0;
+    for(int i=0; i<nbRegionRows; ++i)
+    {
+      Scalar norm = a.row(i).norm();
+      if (norm < Constant<Scalar>::EPSILON)
+      {
+        isEmpty = isEmpty || b(i) < -Constant<Scalar>::EPSILON;
+        continue;
+      }
+      a.row(nbKept) = a.row(i)/norm;
+      b(nbKept) = b(i)/norm;
+      ++nbKept;
+    }
+
+    const MatrixX regionA = a.topRows(nbKept);
+    const VectorX regionB = b.head(nbKept);
+    if (isEmpty ||
+        (regionA*theta - regionB).maxCoeff() > Constant<Scalar>::EPSILON)
+    {
+      // The active set is degenerate, theta is not in its region
+      ++nbUncovered;
+      continue;
+    }
+
+    table.addRegion(regionA, regionB, Z.row(0).transpose(), z(0));
+  }
+
+  return nbUncovered;
+}
+
+template <typename Scalar>
+void TrajectoryWalkgen<Scalar>::computeParametricQP(MatrixX& F, MatrixX& G,
+                                                    VectorX& w, MatrixX& S)
+{
+  const int N = noDynModel_.getNbSamples();
+  const int nbVariables = noDynModel_.getNbVariables();
+  const int M = config_.withMotionConstraints? motionConstraint_.getNbConstraints() : 0;
+  const int P = 2*N + 3;
+
+  const LinearDynamic<Scalar>& dynVel = noDynModel_.getVelLinearDynamic();
+  const LinearDynamic<Scalar>& dynPos = noDynModel_.getPosLinearDynamic();
+  const LinearDynamic<Scalar>& dynAcc = noDynModel_.getAccLinearDynamic();
+  const VectorX& weights = noDynModel_.getSampleWeights();
+
+  // The velocities, accelerations and jerks (the bounds) depend on the
+  // state through S
+  F.resize(nbVariables, P);
+  F.block(0, 0, nbVariables, 3) =
+      weighting_.velocityTracking*dynVel.UT*weights.asDiagonal()*dynVel.S
+      + weighting_.positionTracking*dynPos.UT*weights.asDiagonal()*dynPos.S;
+  F.block(0, 3, nbVariables, N) = -weighting_.velocityTracking*dynVel.UT*weights.asDiagonal();
+  F.block(0, N+3, nbVariables, N) = -weighting_.positionTracking*dynPos.UT*weights.asDiagonal();
+
+  const int nbRows = config_.withMotionConstraints ? M + nbVariables : 0;
+  G.resize(2*nbRows, nbVariables);
+  w.resize(2*nbRows);
+  S.setZero(2*nbRows, P);
+  if (config_.withMotionConstraints)
+  {
+    G.block(0, 0, M, nbVariables) = motionConstraint_.getGradient();
+    G.block(M, 0, nbVariables, nbVariables).setIdentity();
+    G.block(nbRows, 0, nbRows, nbVariables) = -G.block(0, 0, nbRows, nbVariables);
+
+    w.segment(0, N).fill(noDynModel_.getVelocityLimit());
+    w.segment(N, N).fill(noDynModel_.getAccelerationLimit());
+    w.segment(M, nbVariables).fill(noDynModel_.getJerkLimit());
+    w.segment(nbRows, nbRows) = w.segment(0, nbRows);
+
+    S.block(0, 0, N, 3) = -dynVel.S;
+    S.block(N, 0, N, 3) = -dynAcc.S;
+    S.block(nbRows, 0, nbRows, 3) = -S.block(0, 0, nbRows, 3);
+  }
+}
+
+template <typename Scalar>
+void TrajectoryWalkgen<Scalar>::computeActiveSet(const QPSolver<Scalar>& solver,
+                                                 std::vector<int>& active)
+{
+  const int nbVariables = noDynModel_.getNbVariables();
+  const int M = config_.withMotionConstraints? motionConstraint_.getNbConstraints() : 0;
+  const int nbRows = config_.withMotionConstraints ? M + nbVariables : 0;
+
+  solver.getDualSolution(dual_);
+
+  const Scalar dualTolerance = std::sqrt(std::numeric_limits<Scalar>::epsilon())*
+      std::max(Scalar(1), dual_.cwiseAbs().maxCoeff());
+  active.clear();
+  for(int i=0; i<nbRows; ++i)
+  {
+    // Multipliers are bounds first, then constraints, positive at the
+    // lower bound
+    Scalar y = i<M ? dual_(nbVariables + i) : dual_(i - M);
+    if (y < -dualTolerance)
+    {
+      active.push_back(i);
+    }
+    else if (y > dualTolerance)
+    {
+      active.push_back(nbRows + i);
+    }
+  }
+}
+
+template <typename Scalar>
+void TrajectoryWalkgen<Scalar>::computeFeedbackGain()
+{
+  computeActiveSet(*qpoasesSolver_, activeSet_);
+  const int nbActive = static_cast<int>(activeSet_.size());
+
+  // Without active rows, U = -Q^-1.F.theta. Otherwise the active rows hold
+  // with equality, and their multipliers depend on the state too.
+  if (nbActive==0)
+  {
+    feedbackGain_ = -feedbackQinvF_.row(0).transpose();
+  }
+  else
+  {
+    const int nbVariables = noDynModel_.getNbVariables();
+    MatrixX GA(nbActive, nbVariables);
+    MatrixX SA(nbActive, 3);
+    MatrixX QinvGAt(nbVariables, nbActive);
+    for(int i=0; i<nbActive; ++i)
+    {
+      GA.row(i) = feedbackG_.row(activeSet_[i]);
+      SA.row(i) = feedbackS_.row(activeSet_[i]);
+      QinvGAt.col(i) = feedbackQinvGt_.col(activeSet_[i]);
+    }
+
+    // Linearly dependent active rows, e.g. a degenerate optimum, do not
+    // define the multipliers: the gain of the previous solve is kept
+    Eigen::FullPivLU<MatrixX> kkt(GA*QinvGAt);
+    if (kkt.rank()<nbActive)
+    {
+      return;
+    }
+    const MatrixX L = -kkt.solve(SA + GA*feedbackQinvF_);
+    feedbackGain_ = -(feedbackQinvF_.row(0) + QinvGAt.row(0)*L).transpose();
+  }
+}
+
+template <typename Scalar>
+void TrajectoryWalkgen<Scalar>::updateState(Scalar feedBackPeriod)
+{
+  lastState_ = noDynModel_.getState();
+  lastJerk_ = X_(0);
+  lastFeedBackPeriod_ = feedBackPeriod;
+
+  noDynModel_.updateState(X_(0), feedBackPeriod);
+}
+
+template <typename Scalar>
+void TrajectoryWalkgen<Scalar>::computeSetpoints(Scalar dt, int nbSetpoints,
+                                                 Scalar* pos, Scalar* vel,
+                                                 Scalar* acc) const
+{
+  assert(nbSetpoints*dt < lastFeedBackPeriod_ + Constant<Scalar>::EPSILON);
+
+  Tools::ConstantJerkDynamic<Scalar>::sampleState(lastState_, lastJerk_, dt,
+                                                  nbSetpoints, pos, vel, acc);
+}
+
+template <typename Scalar>
+void TrajectoryWalkgen<Scalar>::setExplicitTable(const ExplicitMPCTable<Scalar>* table)
+{
+  explicitTable_ = table;
+  explicitRegion_ = -1;
+}
+
+template <typename Scalar>
+void TrajectoryWalkgen<Scalar>::getExplicitParameters(VectorX& theta) const
+{
+  int N = noDynModel_.getNbSamples();
+
+  theta.resize(2*N + 3);
+  theta.segment(0, 3) = noDynModel_.getState();
+  theta.segment(3, N) = velTrackingObj_.getVelRefInWorldFrame();
+  theta.segment(N+3, N) = posTrackingObj_.getPosRefInWorldFrame();
+}
+
+template <typename Scalar>
+const typename Type<Scalar>::Vector3& TrajectoryWalkgen<Scalar>::getState() const
 {
   return noDynModel_.getState();
 }
@@ -218,40 +598,41 @@ const typename Type<Scalar>::VectorX& TrajectoryWalkgen<Scalar>::getState() cons
 template <typename Scalar>
 const Scalar TrajectoryWalkgen<Scalar>::getJerk() const
 {
-  return X_(0);
+  // X_ may have been shifted since the last solve
+  return lastJerk_;
 }
 
 template <typename Scalar>
 void TrajectoryWalkgen<Scalar>::computeConstantPart()
 {
-  int N = noDynModel_.getNbSamples();
+  int nbVariables = noDynModel_.getNbVariables();
   int M1 = config_.withMotionConstraints? motionConstraint_.getNbConstraints() : 0;
   int M = M1;
 
-  assert(velTrackingObj_.getHessian().rows() == N);
-  assert(velTrackingObj_.getHessian().cols() == N);
+  assert(velTrackingObj_.getHessian().rows() == nbVariables);
+  assert(velTrackingObj_.getHessian().cols() == nbVariables);
 
-  assert(posTrackingObj_.getHessian().rows() == N);
-  assert(posTrackingObj_.getHessian().cols() == N);
+  assert(posTrackingObj_.getHessian().rows() == nbVariables);
+  assert(posTrackingObj_.getHessian().cols() == nbVariables);
 
-  assert(jerkMinObj_.getHessian().rows() == N);
-  assert(jerkMinObj_.getHessian().cols() == N);
+  assert(jerkMinObj_.getHessian().rows() == nbVariables);
+  assert(jerkMinObj_.getHessian().cols() == nbVariables);
 
   if (config_.withMotionConstraints)
   {
-    assert(motionConstraint_.getGradient().cols() == N);
+    assert(motionConstraint_.getGradient().cols() == nbVariables);
     assert(motionConstraint_.getGradient().rows() == M1);
   }
 
-  qpoasesSolver_.reset(makeQPSolver<Scalar>(N, M));
+  qpoasesSolver_.reset(makeQPSolver<Scalar>(nbVariables, M));
 
-  qpMatrix_.Q.setZero(N, N);
-  qpMatrix_.p.setZero(N, 1);
-  qpMatrix_.A.setZero(M, N);
+  qpMatrix_.Q.setZero(nbVariables, nbVariables);
+  qpMatrix_.p.setZero(nbVariables, 1);
+  qpMatrix_.A.setZero(M, nbVariables);
   qpMatrix_.bl.setZero(M, 1);
   qpMatrix_.bu.setZero(M, 1);
-  qpMatrix_.xl.setZero(N, 1);
-  qpMatrix_.xu.setZero(N, 1);
+  qpMatrix_.xl.setZero(nbVariables, 1);
+  qpMatrix_.xu.setZero(nbVariables, 1);
 
   if (weighting_.velocityTracking>0.0)
   {
@@ -268,13 +649,43 @@ void TrajectoryWalkgen<Scalar>::computeConstantPart()
 
   if (config_.withMotionConstraints)
   {
-    qpMatrix_.A.block(0, 0, M1, N) = motionConstraint_.getGradient();
+    qpMatrix_.A.block(0, 0, M1, nbVariables) = motionConstraint_.getGradient();
   }
 
   qpMatrix_.At = qpMatrix_.A.transpose();
 
+  if (config_.withFeedbackGain)
+  {
+    MatrixX F, S;
+    VectorX w;
+    computeParametricQP(F, feedbackG_, w, S);
+
+    Eigen::LDLT<MatrixX> hessian(qpMatrix_.Q);
+    feedbackQinvF_ = hessian.solve(F.leftCols(3));
+    feedbackQinvGt_ = hessian.solve(feedbackG_.transpose());
+    feedbackS_ = S.leftCols(3);
+  }
+  feedbackGain_.setZero();
 }
 
+template <typename Scalar>
+void TrajectoryWalkgen<Scalar>::shiftWarmStart()
+{
+  const int N = noDynModel_.getNbSamples();
+  const int nbVariables = noDynModel_.getNbVariables();
+
+  noDynModel_.shiftVariables(X_);
+
+  // The multipliers of the jerk bounds are shifted as the variables, then
+  // the velocity and acceleration rows are stored in blocks of N rows
+  qpoasesSolver_->getDualSolution(dual_);
+  assert((dual_.size() - nbVariables)%N == 0);
+  typename VectorX::SegmentReturnType boundDual = dual_.head(nbVariables);
+  noDynModel_.shiftVariables(boundDual);
+  Tools::shiftSamples<Scalar>(dual_, nbVariables, noDynModel_.getSamplingPeriods(),
+                              (dual_.size() - nbVariables)/N);
+  qpoasesSolver_->setDualGuess(dual_);
+}
 
   MPC_WALKGEN_INSTANTIATE_CLASS_TEMPLATE(TrajectoryWalkgen);
 
@@ -0,0 +1,201 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <mpc-walkgen/walkgen_scheduler.h>
+#include <boost/thread/locks.hpp>
+#include <cassert>
+
+namespace MPCWalkgen
+{
+
+WalkgenScheduler::WalkgenScheduler(int nbThreads)
+:batchIndex_(0)
+,nbRemaining_(0)
+,stop_(false)
+,hasDeadline_(false)
+{
+  assert(nbThreads>0);
+
+  for(int w=0; w<nbThreads; ++w)
+  {
+    workers_.push_back(boost::shared_ptr<Worker>(new Worker));
+  }
+  for(int w=1; w<nbThreads; ++w)
+  {
+    threads_.create_thread(boost::bind(&WalkgenScheduler::workerLoop, this, w));
+  }
+}
+
+WalkgenScheduler::~WalkgenScheduler()
+{
+  {
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  batchStarted_.notify_all();
+  threads_.join_all();
+}
+
+void WalkgenScheduler::add(int instance, const boost::function<bool ()>& solve)
+{
+  assert(instance>=0);
+
+  Request request;
+  request.instance = instance;
+  request.solve = solve;
+  requests_.push_back(request);
+}
+
+bool WalkgenScheduler::run(double timeout)
+{
+  assert(timeout>=0);
+
+  batch_.swap(requests_);
+  requests_.clear();
+  status_.assign(batch_.size(), CANCELLED);
+  if (batch_.empty())
+  {
+    return true;
+  }
+
+  hasDeadline_ = timeout>0;
+  if (hasDeadline_)
+  {
+    deadline_ = boost::chrono::steady_clock::now() +
+        boost::chrono::duration_cast<boost::chrono::steady_clock::duration>(
+          boost::chrono::duration<double>(timeout));
+  }
+
+  // A worker still leaving the previous batch may already take the
+  // requests, so they are counted before being queued
+  {
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    nbRemaining_ = static_cast<int>(batch_.size());
+  }
+
+  const int nbWorkers = getNbThreads();
+  for(size_t i=0; i<batch_.size(); ++i)
+  {
+    Worker& worker = *workers_[batch_[i].instance % nbWorkers];
+    boost::lock_guard<boost::mutex> lock(worker.mutex);
+    worker.queue.push_back(static_cast<int>(i));
+  }
+
+  {
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    ++batchIndex_;
+  }
+  batchStarted_.notify_all();
+
+  processRequests(0);
+
+  {
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    while (nbRemaining_>0)
+    {
+      batchDone_.wait(lock);
+    }
+  }
+
+  batch_.clear();
+
+  bool allSolved = true;
+  for(size_t i=0; i<status_.size(); ++i)
+  {
+    allSolved = allSolved && status_[i]==SOLVED;
+  }
+  return allSolved;
+}
+
+void WalkgenScheduler::workerLoop(int worker)
+{
+  unsigned int lastBatch = 0;
+  while (true)
+  {
+    {
+      boost::unique_lock<boost::mutex> lock(mutex_);
+      while (!stop_ && batchIndex_==lastBatch)
+      {
+        batchStarted_.wait(lock);
+      }
+      if (stop_)
+      {
+        return;
+      }
+      lastBatch = batchIndex_;
+    }
+
+    processRequests(worker);
+  }
+}
+
+void WalkgenScheduler::processRequests(int worker)
+{
+  int index = takeRequest(worker);
+  while (index>=0)
+  {
+    if (hasDeadline_ && boost::chrono::steady_clock::now() > deadline_)
+    {
+      status_[index] = CANCELLED;
+    }
+    else
+    {
+      // The request is counted as done whatever happens, otherwise run
+      // would wait for it forever
+      try
+      {
+        status_[index] = batch_[index].solve() ? SOLVED : FAILED;
+      }
+      catch (...)
+      {
+        status_[index] = FAILED;
+      }
+    }
+
+    {
+      boost::lock_guard<boost::mutex> lock(mutex_);
+      --nbRemaining_;
+      if (nbRemaining_==0)
+      {
+        batchDone_.notify_all();
+      }
+    }
+
+    index = takeRequest(worker);
+  }
+}
+
+int WalkgenScheduler::takeRequest(int worker)
+{
+  {
+    Worker& own = *workers_[worker];
+    boost::lock_guard<boost::mutex> lock(own.mutex);
+    if (!own.queue.empty())
+    {
+      int index = own.queue.front();
+      own.queue.pop_front();
+      return index;
+    }
+  }
+
+  // Steal from the back of the other queues, starting with the next worker
+  const int nbWorkers = getNbThreads();
+  for(int k=1; k<nbWorkers; ++k)
+  {
+    Worker& other = *workers_[(worker + k) % nbWorkers];
+    boost::lock_guard<boost::mutex> lock(other.mutex);
+    if (!other.queue.empty())
+    {
+      int index = other.queue.back();
+      other.queue.pop_back();
+      return index;
+    }
+  }
+
+  return -1;
+}
+
+}
@@ -8,63 +8,171 @@
 #include <mpc-walkgen/zebulon_walkgen.h>
 #include <iostream>
 #include <mpc-walkgen/constant.h>
+#include <mpc-walkgen/tools.h>
 #include <cmath>
 #include "macro.h"
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/chrono/chrono.hpp>
+#include <algorithm>
 
 namespace MPCWalkgen
 {
 
+template <typename Scalar>
+ZebulonWalkgen<Scalar>::Problem::Problem()
+:velTrackingObj(baseModel)
+,posTrackingObj(baseModel)
+,jerkMinObj(lipModel, baseModel)
+,tiltMinObj(lipModel, baseModel)
+,tiltVelMinObj(lipModel, baseModel)
+,copCenteringObj(lipModel, baseModel)
+,comCenteringObj(lipModel, baseModel)
+,copConstraint(lipModel, baseModel)
+,comConstraint(lipModel, baseModel)
+,baseMotionConstraint(baseModel)
+,tiltMotionConstraint(lipModel, baseModel)
+{}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::Problem::computeConstantPart()
+{
+  comCenteringObj.setNbSamples(lipModel.getNbSamples());
+
+  jerkMinObj.computeConstantPart();
+  tiltMinObj.computeConstantPart();
+  tiltVelMinObj.computeConstantPart();
+  copConstraint.computeConstantPart();
+  comConstraint.computeConstantPart();
+  copCenteringObj.computeConstantPart();
+  comCenteringObj.computeConstantPart();
+  velTrackingObj.computeConstantPart();
+  posTrackingObj.computeConstantPart();
+  baseMotionConstraint.computeConstantPart();
+  tiltMotionConstraint.computeConstantPart();
+
+  comCenteringObj.updateGravityShift();
+  tiltMinObj.updateTiltContactPoint();
+  tiltVelMinObj.updateTiltContactPoint();
+}
+
 template <typename Scalar>
 ZebulonWalkgen<Scalar>::ZebulonWalkgen()
-:velTrackingObj_(baseModel_)
-,posTrackingObj_(baseModel_)
-,jerkMinObj_(lipModel_, baseModel_)
-,tiltMinObj_(lipModel_, baseModel_)
-,tiltVelMinObj_(lipModel_, baseModel_)
-,copCenteringObj_(lipModel_, baseModel_)
-,comCenteringObj_(lipModel_, baseModel_)
-,copConstraint_(lipModel_, baseModel_)
-,comConstraint_(lipModel_, baseModel_)
-,baseMotionConstraint_(baseModel_)
-,tiltMotionConstraint_(lipModel_, baseModel_)
-,qpoasesSolver_(makeQPSolver<Scalar>(1, 1))
-,invObjNormFactor_(1.0)
-,invCtrNormFactor_(1.0)
+:problem_(new Problem)
+,nbSamples_(problem_->lipModel.getNbSamples())
+,qpVersion_(0)
+,nextNbSamples_(0)
+,timeSinceLastShift_(0)
+,lastFeedBackPeriod_(0)
+,predictionsUpToDate_(0)
+{
+  for(int i=0; i<4; ++i)
+  {
+    lastStates_[i].setZero();
+    lastJerks_[i] = 0;
+  }
+  resetBuffers();
+  for(int axis=0; axis<2; ++axis)
+  {
+    axisSolves_[axis] = boost::bind(&ZebulonWalkgen<Scalar>::solveAxisProblem, this, axis);
+  }
+
+  updateConstantParts(MODELS_CHANGED);
+}
+
+template <typename Scalar>
+ZebulonWalkgen<Scalar>::~ZebulonWalkgen()
+{
+  if (backgroundThread_)
+  {
+    backgroundThread_->join();
+  }
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::updateProblem(const ProblemUpdate& update)
 {
-  dX_.setZero(4*lipModel_.getNbSamples());
-  X_.setZero(4*lipModel_.getNbSamples());
+  if (config_.withBackgroundConstantPart)
+  {
+    pendingUpdates_.push_back(update);
+    startBackgroundJob();
+    return;
+  }
+
+  // Updates queued before the background computation was disabled are
+  // applied first
+  waitForBackgroundJobs();
+  update(*problem_);
 
-  computeConstantPart();
+  // The number of samples of problem_ only changes when none is reserved
+  int N = problem_->lipModel.getNbSamples();
+  if (X_.size()!=4*N)
+  {
+    assert(reservedHorizons_.empty());
+    nbSamples_ = N;
+    resetBuffers();
+  }
+  predictionsUpToDate_ = 0;
+
+  updateConstantParts(MODELS_CHANGED);
 }
 
 template <typename Scalar>
-ZebulonWalkgen<Scalar>::~ZebulonWalkgen(){}
+void ZebulonWalkgen<Scalar>::resetBuffers()
+{
+  int N = problem_->lipModel.getNbSamples();
+  X_.setZero(4*N);
+  B_.setZero(2*N);
+  reference_.setZero(2*N);
+  lastSolution_.setZero(4*N);
+}
 
 template <typename Scalar>
 void ZebulonWalkgen<Scalar>::setNbSamples(int nbSamples)
 {
   assert(nbSamples>0);
 
-  lipModel_.setNbSamples(nbSamples);
-  baseModel_.setNbSamples(nbSamples);
-  comCenteringObj_.setNbSamples(nbSamples);
-
-  dX_.setZero(4*nbSamples);
-  X_.setZero(4*nbSamples);
+  nextNbSamples_ = 0;
+  horizonTuner_.reset();
 
-  jerkMinObj_.computeConstantPart();
-  tiltMinObj_.computeConstantPart();
-  tiltVelMinObj_.computeConstantPart();
-  copConstraint_.computeConstantPart();
-  comConstraint_.computeConstantPart();
-  copCenteringObj_.computeConstantPart();
-  comCenteringObj_.computeConstantPart();
-  velTrackingObj_.computeConstantPart();
-  posTrackingObj_.computeConstantPart();
-  baseMotionConstraint_.computeConstantPart();
-  tiltMotionConstraint_.computeConstantPart();
+  // Once a number of samples is reserved, the others are reserved as well,
+  // and are only swapped in, even while the models are updated in the
+  // background, which computes all of them
+  if (!reservedHorizons_.empty())
+  {
+    if (nbSamples!=nbSamples_)
+    {
+      if (reservedHorizons_.count(nbSamples)==0)
+      {
+        waitForBackgroundJobs();
+        reserveCapacity(nbSamples);
+        reserveHorizon(nbSamples);
+      }
+      switchNbSamples(nbSamples);
+    }
+    return;
+  }
+  updateProblem(boost::bind(&ZebulonWalkgen<Scalar>::applyNbSamples, _1, nbSamples));
+}
 
-  computeConstantPart();
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::applyNbSamples(Problem& pb, int nbSamples)
+{
+  pb.lipModel.setNbSamples(nbSamples);
+  pb.baseModel.setNbSamples(nbSamples);
+  pb.comCenteringObj.setNbSamples(nbSamples);
+
+  pb.jerkMinObj.computeConstantPart();
+  pb.tiltMinObj.computeConstantPart();
+  pb.tiltVelMinObj.computeConstantPart();
+  pb.copConstraint.computeConstantPart();
+  pb.comConstraint.computeConstantPart();
+  pb.copCenteringObj.computeConstantPart();
+  pb.comCenteringObj.computeConstantPart();
+  pb.velTrackingObj.computeConstantPart();
+  pb.posTrackingObj.computeConstantPart();
+  pb.baseMotionConstraint.computeConstantPart();
+  pb.tiltMotionConstraint.computeConstantPart();
 }
 
 template <typename Scalar>
@@ -72,21 +180,71 @@ void ZebulonWalkgen<Scalar>::setSamplingPeriod(Scalar samplingPeriod)
 {
   assert(samplingPeriod>0.0);
 
-  lipModel_.setSamplingPeriod(samplingPeriod);
-  baseModel_.setSamplingPeriod(samplingPeriod);
+  updateProblem(boost::bind(&ZebulonWalkgen<Scalar>::applySamplingPeriod,
+                            _1, samplingPeriod));
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::applySamplingPeriod(Problem& pb, Scalar samplingPeriod)
+{
+  pb.lipModel.setSamplingPeriod(samplingPeriod);
+  pb.baseModel.setSamplingPeriod(samplingPeriod);
+
+  pb.copConstraint.computeConstantPart();
+  pb.comConstraint.computeConstantPart();
+  pb.copCenteringObj.computeConstantPart();
+  pb.comCenteringObj.computeConstantPart();
+  pb.velTrackingObj.computeConstantPart();
+  pb.posTrackingObj.computeConstantPart();
+  pb.baseMotionConstraint.computeConstantPart();
+  pb.tiltMotionConstraint.computeConstantPart();
+  pb.tiltMinObj.computeConstantPart();
+  pb.tiltVelMinObj.computeConstantPart();
+  pb.jerkMinObj.computeConstantPart();
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::setSamplingPeriods(const VectorX& samplingPeriods)
+{
+  assert(samplingPeriods.size()>0);
+  assert(samplingPeriods.minCoeff()>0.0);
+
+  updateProblem(boost::bind(&ZebulonWalkgen<Scalar>::applySamplingPeriods,
+                            _1, samplingPeriods));
+}
 
-  copConstraint_.computeConstantPart();
-  comConstraint_.computeConstantPart();
-  copCenteringObj_.computeConstantPart();
-  comCenteringObj_.computeConstantPart();
-  velTrackingObj_.computeConstantPart();
-  posTrackingObj_.computeConstantPart();
-  baseMotionConstraint_.computeConstantPart();
-  tiltMotionConstraint_.computeConstantPart();
-  tiltMinObj_.computeConstantPart();
-  tiltVelMinObj_.computeConstantPart();
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::applySamplingPeriods(Problem& pb, const VectorX& samplingPeriods)
+{
+  pb.lipModel.setSamplingPeriods(samplingPeriods);
+  pb.baseModel.setSamplingPeriods(samplingPeriods);
+
+  pb.copConstraint.computeConstantPart();
+  pb.comConstraint.computeConstantPart();
+  pb.copCenteringObj.computeConstantPart();
+  pb.comCenteringObj.computeConstantPart();
+  pb.velTrackingObj.computeConstantPart();
+  pb.posTrackingObj.computeConstantPart();
+  pb.baseMotionConstraint.computeConstantPart();
+  pb.tiltMotionConstraint.computeConstantPart();
+  pb.tiltMinObj.computeConstantPart();
+  pb.tiltVelMinObj.computeConstantPart();
+  pb.jerkMinObj.computeConstantPart();
+}
 
-  computeConstantPart();
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::applyPeriodWeighting(Problem& pb, bool withPeriodWeighting)
+{
+  pb.lipModel.setPeriodWeighting(withPeriodWeighting);
+  pb.baseModel.setPeriodWeighting(withPeriodWeighting);
+
+  pb.copCenteringObj.computeConstantPart();
+  pb.comCenteringObj.computeConstantPart();
+  pb.velTrackingObj.computeConstantPart();
+  pb.posTrackingObj.computeConstantPart();
+  pb.tiltMinObj.computeConstantPart();
+  pb.tiltVelMinObj.computeConstantPart();
+  pb.jerkMinObj.computeConstantPart();
 }
 
 template <typename Scalar>
@@ -94,14 +252,18 @@ void ZebulonWalkgen<Scalar>::setGravity(const Vector3& gravity)
 {
   assert(std::abs(gravity(2))>Constant<Scalar>::EPSILON);
 
-  lipModel_.setGravity(gravity);
-  baseModel_.setGravity(gravity);
+  updateProblem(boost::bind(&ZebulonWalkgen<Scalar>::applyGravity, _1, gravity));
+}
 
-  copConstraint_.computeConstantPart();
-  copCenteringObj_.computeConstantPart();
-  comCenteringObj_.updateGravityShift();
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::applyGravity(Problem& pb, const Vector3& gravity)
+{
+  pb.lipModel.setGravity(gravity);
+  pb.baseModel.setGravity(gravity);
 
-  computeConstantPart();
+  pb.copConstraint.computeConstantPart();
+  pb.copCenteringObj.computeConstantPart();
+  pb.comCenteringObj.updateGravityShift();
 }
 
 template <typename Scalar>
@@ -109,11 +271,18 @@ void ZebulonWalkgen<Scalar>::setBaseCopConvexPolygon(const ConvexPolygon<Scalar>
 {
   assert(convexPolygon.getNbVertices()>=3);
 
-  baseModel_.setCopSupportConvexPolygon(convexPolygon);
+  copConvexPolygon_ = convexPolygon;
+  updateProblem(boost::bind(&ZebulonWalkgen<Scalar>::applyCopConvexPolygon,
+                            _1, simplifyConvexPolygon(convexPolygon)));
+}
 
-  copConstraint_.computeConstantPart();
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::applyCopConvexPolygon(Problem& pb,
+                                                   const ConvexPolygon<Scalar>& convexPolygon)
+{
+  pb.baseModel.setCopSupportConvexPolygon(convexPolygon);
 
-  computeConstantPart();
+  pb.copConstraint.computeConstantPart();
 }
 
 template <typename Scalar>
@@ -121,11 +290,33 @@ void ZebulonWalkgen<Scalar>::setBaseComConvexPolygon(const ConvexPolygon<Scalar>
 {
   assert(convexPolygon.getNbVertices()>=3);
 
-  baseModel_.setComSupportConvexPolygon(convexPolygon);
+  comConvexPolygon_ = convexPolygon;
+  updateProblem(boost::bind(&ZebulonWalkgen<Scalar>::applyComConvexPolygon,
+                            _1, simplifyConvexPolygon(convexPolygon)));
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::applyComConvexPolygon(Problem& pb,
+                                                   const ConvexPolygon<Scalar>& convexPolygon)
+{
+  pb.baseModel.setComSupportConvexPolygon(convexPolygon);
 
-  comConstraint_.computeConstantPart();
+  pb.comConstraint.computeConstantPart();
+}
 
-  computeConstantPart();
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::applyConvexPolygons(Problem& pb,
+                                                 const ConvexPolygon<Scalar>& copConvexPolygon,
+                                                 const ConvexPolygon<Scalar>& comConvexPolygon)
+{
+  if (copConvexPolygon.getNbVertices()>=3)
+  {
+    applyCopConvexPolygon(pb, copConvexPolygon);
+  }
+  if (comConvexPolygon.getNbVertices()>=3)
+  {
+    applyComConvexPolygon(pb, comConvexPolygon);
+  }
 }
 
 template <typename Scalar>
@@ -157,15 +348,19 @@ void ZebulonWalkgen<Scalar>::setComBodyHeight(Scalar comHeight)
 {
   assert(comHeight==comHeight);
 
-  lipModel_.setComHeight(comHeight);
+  updateProblem(boost::bind(&ZebulonWalkgen<Scalar>::applyComBodyHeight, _1, comHeight));
+}
 
-  copConstraint_.computeConstantPart();
-  copCenteringObj_.computeConstantPart();
-  comCenteringObj_.updateGravityShift();
-  tiltMinObj_.computeConstantPart();
-  tiltVelMinObj_.computeConstantPart();
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::applyComBodyHeight(Problem& pb, Scalar comHeight)
+{
+  pb.lipModel.setComHeight(comHeight);
 
-  computeConstantPart();
+  pb.copConstraint.computeConstantPart();
+  pb.copCenteringObj.computeConstantPart();
+  pb.comCenteringObj.updateGravityShift();
+  pb.tiltMinObj.computeConstantPart();
+  pb.tiltVelMinObj.computeConstantPart();
 }
 
 template <typename Scalar>
@@ -173,13 +368,17 @@ void ZebulonWalkgen<Scalar>::setComBaseHeight(Scalar comHeight)
 {
   assert(comHeight==comHeight);
 
-  baseModel_.setComHeight(comHeight);
+  updateProblem(boost::bind(&ZebulonWalkgen<Scalar>::applyComBaseHeight, _1, comHeight));
+}
 
-  copConstraint_.computeConstantPart();
-  copCenteringObj_.computeConstantPart();
-  comCenteringObj_.updateGravityShift();
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::applyComBaseHeight(Problem& pb, Scalar comHeight)
+{
+  pb.baseModel.setComHeight(comHeight);
 
-  computeConstantPart();
+  pb.copConstraint.computeConstantPart();
+  pb.copCenteringObj.computeConstantPart();
+  pb.comCenteringObj.updateGravityShift();
 }
 
 template <typename Scalar>
@@ -187,20 +386,23 @@ void ZebulonWalkgen<Scalar>::setBodyMass(Scalar mass)
 {
   assert(mass==mass);
 
+  updateProblem(boost::bind(&ZebulonWalkgen<Scalar>::applyBodyMass, _1, mass));
+}
 
-  Scalar totalMass = mass + baseModel_.getMass();
-  lipModel_.setTotalMass(totalMass);
-  baseModel_.setTotalMass(totalMass);
-
-  lipModel_.setMass(mass);
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::applyBodyMass(Problem& pb, Scalar mass)
+{
+  Scalar totalMass = mass + pb.baseModel.getMass();
+  pb.lipModel.setTotalMass(totalMass);
+  pb.baseModel.setTotalMass(totalMass);
 
-  copConstraint_.computeConstantPart();
-  copCenteringObj_.computeConstantPart();
-  comCenteringObj_.updateGravityShift();
-  tiltMinObj_.computeConstantPart();
-  tiltVelMinObj_.computeConstantPart();
+  pb.lipModel.setMass(mass);
 
-  computeConstantPart();
+  pb.copConstraint.computeConstantPart();
+  pb.copCenteringObj.computeConstantPart();
+  pb.comCenteringObj.updateGravityShift();
+  pb.tiltMinObj.computeConstantPart();
+  pb.tiltVelMinObj.computeConstantPart();
 }
 
 template <typename Scalar>
@@ -208,51 +410,167 @@ void ZebulonWalkgen<Scalar>::setBaseMass(Scalar mass)
 {
   assert(mass==mass);
 
-  Scalar totalMass = lipModel_.getMass() + mass;
-  lipModel_.setTotalMass(totalMass);
-  baseModel_.setTotalMass(totalMass);
+  updateProblem(boost::bind(&ZebulonWalkgen<Scalar>::applyBaseMass, _1, mass));
+}
 
-  baseModel_.setMass(mass);
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::applyBaseMass(Problem& pb, Scalar mass)
+{
+  Scalar totalMass = pb.lipModel.getMass() + mass;
+  pb.lipModel.setTotalMass(totalMass);
+  pb.baseModel.setTotalMass(totalMass);
 
-  copConstraint_.computeConstantPart();
-  copCenteringObj_.computeConstantPart();
-  comCenteringObj_.updateGravityShift();
-  tiltMinObj_.computeConstantPart();
-  tiltVelMinObj_.computeConstantPart();
+  pb.baseModel.setMass(mass);
 
-  computeConstantPart();
+  pb.copConstraint.computeConstantPart();
+  pb.copCenteringObj.computeConstantPart();
+  pb.comCenteringObj.updateGravityShift();
+  pb.tiltMinObj.computeConstantPart();
+  pb.tiltVelMinObj.computeConstantPart();
 }
 
 template <typename Scalar>
 void ZebulonWalkgen<Scalar>::setVelRefInWorldFrame(const VectorX& velRef)
 {
   assert(velRef==velRef);
-  assert(velRef.size()==baseModel_.getNbSamples()*2);
-  velTrackingObj_.setVelRefInWorldFrame(velRef);
+  assert(velRef.size()==nbSamples_*2);
+  problem_->velTrackingObj.setVelRefInWorldFrame(extendReference(velRef));
 }
 
 template <typename Scalar>
 void ZebulonWalkgen<Scalar>::setPosRefInWorldFrame(const VectorX& posRef)
 {
   assert(posRef==posRef);
-  assert(posRef.size()==baseModel_.getNbSamples()*2);
-  posTrackingObj_.setPosRefInWorldFrame(posRef);
+  assert(posRef.size()==nbSamples_*2);
+  problem_->posTrackingObj.setPosRefInWorldFrame(extendReference(posRef));
 }
 
 template <typename Scalar>
 void ZebulonWalkgen<Scalar>::setCopRefInLocalFrame(const VectorX& copRef)
 {
   assert(copRef==copRef);
-  assert(copRef.size()==lipModel_.getNbSamples()*2);
-  copCenteringObj_.setCopRefInLocalFrame(copRef);
+  assert(copRef.size()==nbSamples_*2);
+  problem_->copCenteringObj.setCopRefInLocalFrame(extendReference(copRef));
 }
 
 template <typename Scalar>
 void ZebulonWalkgen<Scalar>::setComRefInLocalFrame(const VectorX& comRef)
 {
   assert(comRef==comRef);
-  assert(comRef.size()==lipModel_.getNbSamples()*2);
-  comCenteringObj_.setComRefInLocalFrame(comRef);
+  assert(comRef.size()==nbSamples_*2);
+  problem_->comCenteringObj.setComRefInLocalFrame(extendReference(comRef));
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::pushVelRefInWorldFrame(const Vector2& velRef)
+{
+  BaseVelocityTrackingObjective<Scalar>& obj = problem_->velTrackingObj;
+  if (nbSamples_==problem_->lipModel.getNbSamples())
+  {
+    obj.pushVelRefInWorldFrame(velRef);
+    return;
+  }
+  obj.setVelRefInWorldFrame(pushReference(obj.getVelRefInWorldFrame(), velRef));
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::pushPosRefInWorldFrame(const Vector2& posRef)
+{
+  BasePositionTrackingObjective<Scalar>& obj = problem_->posTrackingObj;
+  if (nbSamples_==problem_->lipModel.getNbSamples())
+  {
+    obj.pushPosRefInWorldFrame(posRef);
+    return;
+  }
+  obj.setPosRefInWorldFrame(pushReference(obj.getPosRefInWorldFrame(), posRef));
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::pushCopRefInLocalFrame(const Vector2& copRef)
+{
+  CopCenteringObjective<Scalar>& obj = problem_->copCenteringObj;
+  if (nbSamples_==problem_->lipModel.getNbSamples())
+  {
+    obj.pushCopRefInLocalFrame(copRef);
+    return;
+  }
+  obj.setCopRefInLocalFrame(pushReference(obj.getCopRefInLocalFrame(), copRef));
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::pushComRefInLocalFrame(const Vector2& comRef)
+{
+  ComCenteringObjective<Scalar>& obj = problem_->comCenteringObj;
+  if (nbSamples_==problem_->lipModel.getNbSamples())
+  {
+    obj.pushComRefInLocalFrame(comRef);
+    return;
+  }
+  obj.setComRefInLocalFrame(pushReference(obj.getComRefInLocalFrame(), comRef));
+}
+
+template <typename Scalar>
+const typename Type<Scalar>::VectorX& ZebulonWalkgen<Scalar>::extendReference(
+    const VectorX& ref)
+{
+  int N = problem_->lipModel.getNbSamples();
+  if (nbSamples_==N)
+  {
+    return ref;
+  }
+
+  Tools::resizeSamples<Scalar>(ref, 2, N, reference_);
+  return reference_;
+}
+
+template <typename Scalar>
+const typename Type<Scalar>::VectorX& ZebulonWalkgen<Scalar>::pushReference(
+    const VectorX& ref, const Vector2& value)
+{
+  int N = problem_->lipModel.getNbSamples();
+  int n = nbSamples_;
+  assert(ref.size()==2*N);
+
+  // Only the first n samples are shifted, the next ones are the new last one
+  reference_ = ref;
+  Tools::shiftSamples<Scalar>(reference_, 0, n);
+  Tools::shiftSamples<Scalar>(reference_, N, n);
+  reference_.segment(n - 1, N - n + 1).fill(value(0));
+  reference_.segment(N + n - 1, N - n + 1).fill(value(1));
+  return reference_;
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::extendReferences()
+{
+  Problem& pb = *problem_;
+  int N = pb.lipModel.getNbSamples();
+
+  // References which were not set yet are left as they are
+  if (pb.velTrackingObj.getVelRefInWorldFrame().size()==2*N)
+  {
+    reference_ = pb.velTrackingObj.getVelRefInWorldFrame();
+    Tools::padSamples<Scalar>(reference_, 2, nbSamples_);
+    pb.velTrackingObj.setVelRefInWorldFrame(reference_);
+  }
+  if (pb.posTrackingObj.getPosRefInWorldFrame().size()==2*N)
+  {
+    reference_ = pb.posTrackingObj.getPosRefInWorldFrame();
+    Tools::padSamples<Scalar>(reference_, 2, nbSamples_);
+    pb.posTrackingObj.setPosRefInWorldFrame(reference_);
+  }
+  if (pb.copCenteringObj.getCopRefInLocalFrame().size()==2*N)
+  {
+    reference_ = pb.copCenteringObj.getCopRefInLocalFrame();
+    Tools::padSamples<Scalar>(reference_, 2, nbSamples_);
+    pb.copCenteringObj.setCopRefInLocalFrame(reference_);
+  }
+  if (pb.comCenteringObj.getComRefInLocalFrame().size()==2*N)
+  {
+    reference_ = pb.comCenteringObj.getComRefInLocalFrame();
+    Tools::padSamples<Scalar>(reference_, 2, nbSamples_);
+    pb.comCenteringObj.setComRefInLocalFrame(reference_);
+  }
 }
 
 template <typename Scalar>
@@ -260,7 +578,7 @@ void ZebulonWalkgen<Scalar>::setBaseVelLimit(Scalar limit)
 {
   assert(limit>=0);
 
-  baseModel_.setVelocityLimit(limit);
+  problem_->baseModel.setVelocityLimit(limit);
 }
 
 template <typename Scalar>
@@ -268,7 +586,7 @@ void ZebulonWalkgen<Scalar>::setBaseAccLimit(Scalar limit)
 {
   assert(limit>=0);
 
-  baseModel_.setAccelerationLimit(limit);
+  problem_->baseModel.setAccelerationLimit(limit);
 }
 
 template <typename Scalar>
@@ -276,90 +594,161 @@ void ZebulonWalkgen<Scalar>::setBaseJerkLimit(Scalar limit)
 {
   assert(limit>=0);
 
-  baseModel_.setJerkLimit(limit);
+  problem_->baseModel.setJerkLimit(limit);
 }
 
 template <typename Scalar>
-void ZebulonWalkgen<Scalar>::setBaseStateX(const VectorX& state)
+void ZebulonWalkgen<Scalar>::setBaseStateX(const Vector3& state)
 {
   assert(state==state);
-  assert(state.size()==3);
 
-  baseModel_.setStateX(state);
+  problem_->baseModel.setStateX(state);
 }
 
 template <typename Scalar>
-void ZebulonWalkgen<Scalar>::setBaseStateY(const VectorX& state)
+void ZebulonWalkgen<Scalar>::setBaseStateY(const Vector3& state)
 {
   assert(state==state);
-  assert(state.size()==3);
 
-  baseModel_.setStateY(state);
+  problem_->baseModel.setStateY(state);
 }
 
 template <typename Scalar>
-void ZebulonWalkgen<Scalar>::setBaseStateRoll(const VectorX& state)
+void ZebulonWalkgen<Scalar>::setBaseStateRoll(const Vector3& state)
 {
   assert(state==state);
-  assert(state.size()==3);
 
-  baseModel_.setStateRoll(state);
+  problem_->baseModel.setStateRoll(state);
 }
 
 template <typename Scalar>
-void ZebulonWalkgen<Scalar>::setBaseStatePitch(const VectorX& state)
+void ZebulonWalkgen<Scalar>::setBaseStatePitch(const Vector3& state)
 {
   assert(state==state);
-  assert(state.size()==3);
 
-  baseModel_.setStatePitch(state);
+  problem_->baseModel.setStatePitch(state);
 }
 
 template <typename Scalar>
-void ZebulonWalkgen<Scalar>::setBaseStateYaw(const VectorX& state)
+void ZebulonWalkgen<Scalar>::setBaseStateYaw(const Vector3& state)
 {
   assert(state==state);
-  assert(state.size()==3);
 
-  baseModel_.setStateYaw(state);
-  tiltMotionConstraint_.computeConstantPart();
-  computeConstantPart();
+  // The yaw only changes the rows of the tilt motion constraint, which are
+  // updated in place in the QP constant parts of all the reserved numbers
+  // of samples, so that it can be set before each solve. A problem
+  // computed in the background gets the yaw when it is swapped in.
+  problem_->baseModel.setStateYaw(state);
+  problem_->tiltMotionConstraint.computeConstantPart();
+  predictionsUpToDate_ = 0;
+
+  updateTiltMotionRows();
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::updateTiltMotionRows()
+{
+  updateTiltMotionRows(*qp_, nbSamples_);
+  for(typename PresetMap::iterator it=presets_.begin(); it!=presets_.end(); ++it)
+  {
+    if (it->second!=qp_)
+    {
+      updateTiltMotionRows(*it->second, nbSamples_);
+    }
+  }
+
+  for(typename HorizonMap::iterator h=reservedHorizons_.begin();
+      h!=reservedHorizons_.end(); ++h)
+  {
+    if (h->first==nbSamples_)
+    {
+      continue;
+    }
+    ReservedHorizon& horizon = h->second;
+    updateTiltMotionRows(*horizon.qp, h->first);
+    for(typename PresetMap::iterator it=horizon.presets.begin();
+        it!=horizon.presets.end(); ++it)
+    {
+      if (it->second!=horizon.qp)
+      {
+        updateTiltMotionRows(*it->second, h->first);
+      }
+    }
+  }
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::updateTiltMotionRows(QPConstantPart& part, int nbSamples) const
+{
+  // Stale presets are computed again with the new yaw when they are selected
+  if (part.isStale || !part.config.withTiltMotionConstraints)
+  {
+    return;
+  }
+  assert(!part.axesAreDecoupled);
+
+  int N = problem_->lipModel.getNbSamples();
+  int n = nbSamples;
+  int M[4];
+  getNbConstraints(part.config, n, M);
+  int firstRow = M[0] + M[1] + M[2];
+  QPMatrices<Scalar>& m = part.qpMatrix;
+  assert(m.hasEquilibration());
+  assert(m.A.rows()==firstRow + M[3] && m.A.cols()==4*n);
+
+  // The rows are blocks of the tilt gradient of problem_, as the dynamics
+  // are causal. They are equilibrated with the current factors, and the
+  // solvers factorize the new matrices on their next solve.
+  const MatrixX& gradient = problem_->tiltMotionConstraint.getGradient();
+  const VectorX& varScaling = m.getVariableScaling();
+  const VectorX& ctrScaling = m.getConstraintScaling();
+  for(int i=0; i<2; ++i)
+  {
+    for(int j=0; j<4; ++j)
+    {
+      m.A.block(firstRow + i*n, j*n, n, n).noalias() =
+          ctrScaling.segment(firstRow + i*n, n).asDiagonal()
+          *gradient.block(i*N, j*N, n, n)
+          *varScaling.segment(j*n, n).asDiagonal();
+      m.At.block(j*n, firstRow + i*n, n, n) =
+          m.A.block(firstRow + i*n, j*n, n, n).transpose();
+    }
+  }
+  m.notifyMatricesChanged();
 }
 
 template <typename Scalar>
-void ZebulonWalkgen<Scalar>::setComStateX(const VectorX& state)
+void ZebulonWalkgen<Scalar>::setComStateX(const Vector3& state)
 {
   assert(state==state);
-  assert(state.size()==3);
 
-  lipModel_.setStateX(state);
+  problem_->lipModel.setStateX(state);
 }
 
 template <typename Scalar>
-void ZebulonWalkgen<Scalar>::setComStateY(const VectorX& state)
+void ZebulonWalkgen<Scalar>::setComStateY(const Vector3& state)
 {
   assert(state==state);
-  assert(state.size()==3);
 
-  lipModel_.setStateY(state);
+  problem_->lipModel.setStateY(state);
 }
 
 template <typename Scalar>
 void ZebulonWalkgen<Scalar>::setTiltContactPointOnTheGroundInLocalFrameX(Scalar pos)
 {
   assert(pos==pos);
-  baseModel_.setTiltContactPointX(pos);
-  tiltMinObj_.updateTiltContactPoint();
-  tiltVelMinObj_.updateTiltContactPoint();
+  problem_->baseModel.setTiltContactPointX(pos);
+  problem_->tiltMinObj.updateTiltContactPoint();
+  problem_->tiltVelMinObj.updateTiltContactPoint();
 }
 
 template <typename Scalar>
 void ZebulonWalkgen<Scalar>::setTiltContactPointOnTheGroundInLocalFrameY(Scalar pos)
 {
   assert(pos==pos);
-  baseModel_.setTiltContactPointY(pos);
-  tiltMinObj_.updateTiltContactPoint();
-  tiltVelMinObj_.updateTiltContactPoint();
+  problem_->baseModel.setTiltContactPointY(pos);
+  problem_->tiltMinObj.updateTiltContactPoint();
+  problem_->tiltVelMinObj.updateTiltContactPoint();
 }
 
 template <typename Scalar>
@@ -373,8 +762,10 @@ void ZebulonWalkgen<Scalar>::setWeightings(const  ZebulonWalkgenWeighting<Scalar
   assert(weighting.tiltMinimization>=0);
 
   weighting_ = weighting;
+  selectedPreset_.clear();
+  ++qpVersion_;
 
-  computeConstantPart();
+  updateConstantParts(WEIGHTINGS_CHANGED);
 }
 
 template <typename Scalar>
@@ -383,331 +774,1696 @@ void ZebulonWalkgen<Scalar>::setConfig(const ZebulonWalkgenConfig<Scalar>& confi
   assert(config.withBaseMotionConstraints == config.withBaseMotionConstraints);
   assert(config.withComConstraints == config.withComConstraints);
   assert(config.withCopConstraints == config.withCopConstraints);
+  assert(config.maxPolygonAreaLossRatio>=0);
 
-  config_ = config;
-
-  computeConstantPart();
-}
-
-template <typename Scalar>
-bool ZebulonWalkgen<Scalar>::solve(Scalar feedBackPeriod)
-{
-  int N = lipModel_.getNbSamples();
-  int M1 = config_.withCopConstraints? copConstraint_.getNbConstraints() : 0;
-  int M2 = config_.withBaseMotionConstraints? baseMotionConstraint_.getNbConstraints() : 0;
-  int M3 = config_.withComConstraints? comConstraint_.getNbConstraints() : 0;
-  int M4 = config_.withTiltMotionConstraints? tiltMotionConstraint_.getNbConstraints() : 0;
-
-  B_ = X_.segment(2*N, 2*N);
+  bool simplificationChanged =
+      config.maxNbPolygonVertices != config_.maxNbPolygonVertices ||
+      config.maxPolygonAreaLossRatio != config_.maxPolygonAreaLossRatio;
+  bool periodWeightingChanged = config.withPeriodWeighting != config_.withPeriodWeighting;
 
-  assert(velTrackingObj_.getGradient(B_).size() == 2*N);
-  assert(posTrackingObj_.getGradient(B_).size() == 2*N);
-
-  assert(copCenteringObj_.getGradient(X_).size() == 4*N);
-  assert(comCenteringObj_.getGradient(X_).size() == 4*N);
-  assert(jerkMinObj_.getGradient(X_).size() == 4*N);
-  assert(tiltMinObj_.getGradient(X_).size() == 4*N);
-  assert(tiltVelMinObj_.getGradient(X_).size() == 4*N);
+  config_ = config;
+  selectedPreset_.clear();
+  ++qpVersion_;
 
-  if (config_.withCopConstraints)
+  if (!(simplificationChanged || periodWeightingChanged) ||
+      config_.withBackgroundConstantPart)
   {
-    assert(copConstraint_.getFunction(X_).size() == M1);
+    updateConstantParts(WEIGHTINGS_CHANGED);
   }
-  if (config_.withComConstraints)
+
+  if (simplificationChanged)
   {
-    assert(comConstraint_.getFunction(X_).size() == M3);
+    updateProblem(boost::bind(&ZebulonWalkgen<Scalar>::applyConvexPolygons, _1,
+                              simplifyConvexPolygon(copConvexPolygon_),
+                              simplifyConvexPolygon(comConvexPolygon_)));
   }
-  if (config_.withBaseMotionConstraints)
+  if (periodWeightingChanged)
   {
-    assert(baseMotionConstraint_.getFunctionInf(B_).size() == M2);
-    assert(baseMotionConstraint_.getFunctionSup(B_).size() == M2);
+    updateProblem(boost::bind(&ZebulonWalkgen<Scalar>::applyPeriodWeighting, _1,
+                              config_.withPeriodWeighting));
   }
-  if (config_.withTiltMotionConstraints)
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::addPreset(const std::string& name,
+                                       const ZebulonWalkgenWeighting<Scalar>& weighting,
+                                       const ZebulonWalkgenConfig<Scalar>& config)
+{
+  QPConstantPart preset;
+  preset.weighting = weighting;
+  preset.config = config;
+
+  presets_[name] = computePreset(*getHorizonProblem(nbSamples_), preset, config_);
+  for(typename HorizonMap::iterator it=reservedHorizons_.begin();
+      it!=reservedHorizons_.end(); ++it)
   {
-    assert(tiltMotionConstraint_.getFunction(X_).size() == M4);
+    if (it->first!=nbSamples_)
+    {
+      it->second.presets[name] = computePreset(*getHorizonProblem(it->first), preset, config_);
+    }
   }
+}
 
-  assert(feedBackPeriod>0);
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::selectPreset(const std::string& name)
+{
+  assert(presets_.count(name)>0);
 
-  qpMatrix_.p.fill(Scalar(0.0));
-  qpMatrix_.bu.fill(Scalar(10e10));
-  qpMatrix_.bl.fill(Scalar(-10e10));
-  qpMatrix_.xu.fill(Scalar(10e10));
-  qpMatrix_.xl.fill(Scalar(-10e10));
+  selectedPreset_ = name;
+  updateConstantParts(PRESET_SELECTED);
+  weighting_ = qp_->weighting;
+  config_ = qp_->config;
+  ++qpVersion_;
+}
 
-  if (weighting_.velocityTracking>0.0)
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::startBackgroundJob()
+{
+  if (backgroundJob_ || pendingUpdates_.empty())
   {
-    qpMatrix_.p.segment(2*N, 2*N) +=
-       weighting_.velocityTracking*velTrackingObj_.getGradient(B_);
+    return;
   }
-  if (weighting_.positionTracking>0.0)
+
+  // The models are copied here, the worker thread only reads and writes
+  // the job
+  boost::shared_ptr<BackgroundJob> job(new BackgroundJob);
+  job->lipModel = problem_->lipModel;
+  job->baseModel = problem_->baseModel;
+  job->updates.swap(pendingUpdates_);
+  job->weighting = weighting_;
+  job->config = config_;
+  job->qpVersion = qpVersion_;
+  job->selectedPreset = selectedPreset_;
+  job->presets = presets_;
+  for(typename HorizonMap::const_iterator it=reservedHorizons_.begin();
+      it!=reservedHorizons_.end(); ++it)
   {
-    qpMatrix_.p.segment(2*N, 2*N) +=
-        weighting_.positionTracking*posTrackingObj_.getGradient(B_);
+    job->nbSamples.push_back(it->first);
   }
-  if (weighting_.copCentering>0.0)
+  job->isDone = false;
+
+  backgroundJob_ = job;
+  backgroundThread_.reset(new boost::thread(
+                            boost::bind(&ZebulonWalkgen<Scalar>::runBackgroundJob,
+                                        this, job.get())));
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::runBackgroundJob(const ZebulonWalkgen<Scalar>* walkgen,
+                                              BackgroundJob* job)
+{
+  ProblemPtr pb = job->problem;
+  if (!pb)
   {
-    qpMatrix_.p += weighting_.copCentering*copCenteringObj_.getGradient(X_);
+    pb.reset(new Problem);
+    pb->lipModel = job->lipModel;
+    pb->baseModel = job->baseModel;
+    pb->computeConstantPart();
+
+    for(size_t i=0; i<job->updates.size(); ++i)
+    {
+      job->updates[i](*pb);
+    }
   }
-  if (weighting_.comCentering>0.0)
+
+  // Without any reserved number of samples, only the one of the problem is
+  // computed
+  std::vector<int> nbSamples = job->nbSamples;
+  if (nbSamples.empty())
   {
-    qpMatrix_.p += weighting_.comCentering*comCenteringObj_.getGradient(X_);
+    nbSamples.push_back(pb->lipModel.getNbSamples());
   }
-  if (weighting_.jerkMinimization>0.0)
+
+  HorizonMap builtHorizons;
+  builtHorizons.swap(job->builtHorizons);
+  for(size_t i=0; i<nbSamples.size(); ++i)
   {
-    qpMatrix_.p += weighting_.jerkMinimization*jerkMinObj_.getGradient(X_);
+    int n = nbSamples[i];
+    ReservedHorizon& horizon = builtHorizons[n];
+    bool isComplete = horizon.qp.get()!=0;
+    for(typename PresetMap::const_iterator it=job->presets.begin();
+        it!=job->presets.end() && isComplete; ++it)
+    {
+      isComplete = horizon.presets.count(it->first)>0;
+    }
+    if (isComplete)
+    {
+      continue;
+    }
+
+    ProblemPtr horizonPb = n==pb->lipModel.getNbSamples() ? pb : resizeProblem(*pb, n);
+    for(typename PresetMap::const_iterator it=job->presets.begin();
+        it!=job->presets.end(); ++it)
+    {
+      if (horizon.presets.count(it->first)==0)
+      {
+        horizon.presets[it->first] = walkgen->computePreset(*horizonPb, *it->second,
+                                                            job->config);
+      }
+    }
+    if (!horizon.qp && !job->selectedPreset.empty())
+    {
+      horizon.qp = horizon.presets[job->selectedPreset];
+    }
+    else if (!horizon.qp)
+    {
+      horizon.qp = walkgen->computeConstantPart(*horizonPb, job->weighting, job->config);
+      walkgen->initializeSolvers(*horizon.qp);
+    }
   }
-  if (weighting_.tiltMinimization>0.0)
+
+  boost::mutex::scoped_lock lock(job->mutex);
+  job->problem = pb;
+  job->builtHorizons.swap(builtHorizons);
+  job->isDone = true;
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::swapInBackgroundJob(bool wait)
+{
+  if (!backgroundJob_)
   {
-    qpMatrix_.p += weighting_.tiltMinimization*tiltMinObj_.getGradient(X_);
+    return;
   }
-  if (weighting_.tiltVelMinimization>0.0)
+
+  if (!wait)
   {
-    qpMatrix_.p += weighting_.tiltVelMinimization*tiltVelMinObj_.getGradient(X_);
+    boost::mutex::scoped_lock lock(backgroundJob_->mutex);
+    if (!backgroundJob_->isDone)
+    {
+      return;
+    }
   }
+  backgroundThread_->join();
+  backgroundThread_.reset();
 
-  if (config_.withCopConstraints)
+  boost::shared_ptr<BackgroundJob> job;
+  job.swap(backgroundJob_);
+
+  // Presets added or replaced, and weightings changed, while the job was
+  // running are computed in the background as well, before its problem is
+  // used
+  if (startFollowUpJob(*job))
   {
-    qpMatrix_.bl.segment(0, M1) = copConstraint_.getFunction(X_);
+    if (wait)
+    {
+      swapInBackgroundJob(true);
+    }
+    return;
   }
-  if (config_.withBaseMotionConstraints)
-  {
-    qpMatrix_.bl.segment(M1, M2) = baseMotionConstraint_.getFunctionInf(B_);
-    qpMatrix_.bu.segment(M1, M2) = baseMotionConstraint_.getFunctionSup(B_);
 
-    qpMatrix_.xu.segment(2*N, 2*N).fill(baseModel_.getJerkLimit());
-    qpMatrix_.xu.segment(2*N, 2*N) -= B_;
+  // The yaw set while the job was running is given to its problem, and to
+  // the rows of its QP constant parts below
+  bool yawChanged = job->problem->baseModel.getStateYaw()!=problem_->baseModel.getStateYaw();
+  VectorX reference;
+  copyVariableData(*problem_, *job->problem, reference);
+  problem_ = job->problem;
 
-    qpMatrix_.xl.segment(2*N, 2*N).fill(-baseModel_.getJerkLimit());
-    qpMatrix_.xl.segment(2*N, 2*N) -= B_;
-  }
-  if (config_.withComConstraints)
+  int N = problem_->lipModel.getNbSamples();
+  if (X_.size()!=4*N)
   {
-    qpMatrix_.bl.segment(M1+M2, M3) = comConstraint_.getFunction(X_);
+    assert(reservedHorizons_.empty());
+    nbSamples_ = N;
+    resetBuffers();
   }
-  if (config_.withTiltMotionConstraints)
+
+  for(typename HorizonMap::iterator h=job->builtHorizons.begin();
+      h!=job->builtHorizons.end(); ++h)
   {
-    qpMatrix_.bl.segment(M1+M2+M3, M4) = tiltMotionConstraint_.getFunction(X_);
-    qpMatrix_.bu.segment(M1+M2+M3, M4) = tiltMotionConstraint_.getFunction(X_);
+    bool isInUse = h->first==nbSamples_;
+    PresetMap& presets = isInUse ? presets_ : reservedHorizons_[h->first].presets;
+    for(typename PresetMap::iterator it=presets.begin(); it!=presets.end(); ++it)
+    {
+      it->second = h->second.presets[it->first];
+    }
+    QPConstantPartPtr& qp = isInUse ? qp_ : reservedHorizons_[h->first].qp;
+    qp = selectedPreset_.empty() ? h->second.qp : presets[selectedPreset_];
   }
-
-  qpMatrix_.p  *= invObjNormFactor_;
-  qpMatrix_.bu *= invCtrNormFactor_;
-  qpMatrix_.bl *= invCtrNormFactor_;
-
-  bool solutionFound = qpoasesSolver_->solve(qpMatrix_, dX_, true);
-
-  if (!solutionFound)
+  if (yawChanged)
   {
-    std::cerr << "Q : " << std::endl << qpMatrix_.Q << std::endl;
-    std::cerr << "p : " << qpMatrix_.p.transpose() << std::endl;
-    std::cerr << "A : " << std::endl << qpMatrix_.A << std::endl;
-    std::cerr << "bl: " << qpMatrix_.bl.transpose() << std::endl;
-    std::cerr << "bu: " << qpMatrix_.bu.transpose() << std::endl;
-    std::cerr << "X : " << X_.transpose() << std::endl;
-    std::cerr << "dX: " << dX_.transpose() << std::endl;
-    std::cerr << "m : " << lipModel_.getMass() << std::endl;
-    std::cerr << "M : " << baseModel_.getMass() << std::endl;
-    std::cerr << "h : " << lipModel_.getComHeight() << std::endl;
-    std::cerr << "L : " << baseModel_.getComHeight() << std::endl;
-    std::cerr << "T : " << lipModel_.getSamplingPeriod() << std::endl;
-    std::cerr << "cx: " << lipModel_.getStateX() << std::endl;
-    std::cerr << "bx: " << baseModel_.getStateX() << std::endl;
-    std::cerr << "cy: " << lipModel_.getStateY() << std::endl;
-    std::cerr << "by: " << baseModel_.getStateY() << std::endl;
-    std::cerr << "bY: " << baseModel_.getStateYaw() << std::endl;
-    std::cerr << "bP: " << baseModel_.getStatePitch() << std::endl;
-    std::cerr << "bR: " << baseModel_.getStateRoll() << std::endl;
-  }
-
-  X_ += dX_;
-
-
-  lipModel_.updateStateX(X_(0), feedBackPeriod);
-  lipModel_.updateStateY(X_(N), feedBackPeriod);
-  baseModel_.updateStateX(X_(2*N), feedBackPeriod);
-  baseModel_.updateStateY(X_(3*N), feedBackPeriod);
+    updateTiltMotionRows();
+  }
+  predictionsUpToDate_ = 0;
 
-  return solutionFound;
+  startBackgroundJob();
 }
 
-
 template <typename Scalar>
-const typename Type<Scalar>::VectorX& ZebulonWalkgen<Scalar>::getBaseStateX() const
+void ZebulonWalkgen<Scalar>::waitForBackgroundJobs()
 {
-  return baseModel_.getStateX();
+  do
+  {
+    swapInBackgroundJob(true);
+  }
+  while (backgroundJob_);
 }
 
 template <typename Scalar>
-const typename Type<Scalar>::VectorX& ZebulonWalkgen<Scalar>::getBaseStateY() const
+bool ZebulonWalkgen<Scalar>::startFollowUpJob(const BackgroundJob& job)
 {
-  return baseModel_.getStateY();
-}
+  boost::shared_ptr<BackgroundJob> followUp(new BackgroundJob);
+  bool isComplete = true;
+  for(typename HorizonMap::const_iterator h=job.builtHorizons.begin();
+      h!=job.builtHorizons.end(); ++h)
+  {
+    ReservedHorizon& horizon = followUp->builtHorizons[h->first];
+    for(typename PresetMap::const_iterator it=presets_.begin(); it!=presets_.end(); ++it)
+    {
+      typename PresetMap::const_iterator oldIt = job.presets.find(it->first);
+      if (oldIt!=job.presets.end() && oldIt->second==it->second)
+      {
+        horizon.presets[it->first] = h->second.presets.find(it->first)->second;
+      }
+      else
+      {
+        isComplete = false;
+      }
+    }
+
+    // The QP of the job is not used when a preset is selected
+    if (job.qpVersion==qpVersion_ || !selectedPreset_.empty())
+    {
+      horizon.qp = h->second.qp;
+    }
+    else
+    {
+      isComplete = false;
+    }
+  }
+
+  if (isComplete)
+  {
+    return false;
+  }
+
+  followUp->problem = job.problem;
+  followUp->weighting = weighting_;
+  followUp->config = config_;
+  followUp->qpVersion = qpVersion_;
+  followUp->selectedPreset = selectedPreset_;
+  followUp->presets = presets_;
+  followUp->nbSamples = job.nbSamples;
+  followUp->isDone = false;
+
+  backgroundJob_ = followUp;
+  backgroundThread_.reset(new boost::thread(
+                            boost::bind(&ZebulonWalkgen<Scalar>::runBackgroundJob,
+                                        this, followUp.get())));
+  return true;
+}
 
 template <typename Scalar>
-const typename Type<Scalar>::VectorX& ZebulonWalkgen<Scalar>::getComStateX() const
+void ZebulonWalkgen<Scalar>::copyVariableData(const Problem& from, Problem& to,
+                                              VectorX& reference, bool resizeReferences)
 {
-  return lipModel_.getStateX();
+  to.lipModel.setStateX(from.lipModel.getStateX());
+  to.lipModel.setStateY(from.lipModel.getStateY());
+  to.baseModel.setStateX(from.baseModel.getStateX());
+  to.baseModel.setStateY(from.baseModel.getStateY());
+  to.baseModel.setStateRoll(from.baseModel.getStateRoll());
+  to.baseModel.setStatePitch(from.baseModel.getStatePitch());
+  if (to.baseModel.getStateYaw()!=from.baseModel.getStateYaw())
+  {
+    to.baseModel.setStateYaw(from.baseModel.getStateYaw());
+    to.tiltMotionConstraint.computeConstantPart();
+  }
+
+  to.baseModel.setVelocityLimit(from.baseModel.getVelocityLimit());
+  to.baseModel.setAccelerationLimit(from.baseModel.getAccelerationLimit());
+  to.baseModel.setJerkLimit(from.baseModel.getJerkLimit());
+
+  if (to.baseModel.getTiltContactPointX()!=from.baseModel.getTiltContactPointX() ||
+      to.baseModel.getTiltContactPointY()!=from.baseModel.getTiltContactPointY())
+  {
+    to.baseModel.setTiltContactPointX(from.baseModel.getTiltContactPointX());
+    to.baseModel.setTiltContactPointY(from.baseModel.getTiltContactPointY());
+    to.tiltMinObj.updateTiltContactPoint();
+    to.tiltVelMinObj.updateTiltContactPoint();
+  }
+
+  // References of another number of samples are reset, they must be set
+  // again with the new number of samples, unless they are resized
+  int N = to.lipModel.getNbSamples();
+  to.velTrackingObj.setVelRefInWorldFrame(
+        resizeReference(from.velTrackingObj.getVelRefInWorldFrame(), N,
+                        resizeReferences, reference));
+  to.posTrackingObj.setPosRefInWorldFrame(
+        resizeReference(from.posTrackingObj.getPosRefInWorldFrame(), N,
+                        resizeReferences, reference));
+  to.copCenteringObj.setCopRefInLocalFrame(
+        resizeReference(from.copCenteringObj.getCopRefInLocalFrame(), N,
+                        resizeReferences, reference));
+  to.comCenteringObj.setComRefInLocalFrame(
+        resizeReference(from.comCenteringObj.getComRefInLocalFrame(), N,
+                        resizeReferences, reference));
 }
 
 template <typename Scalar>
-const typename Type<Scalar>::VectorX& ZebulonWalkgen<Scalar>::getComStateY() const
+const typename Type<Scalar>::VectorX& ZebulonWalkgen<Scalar>::resizeReference(
+    const VectorX& ref, int nbSamples, bool keepSamples, VectorX& reference)
 {
-  return lipModel_.getStateY();
+  if (ref.size()==2*nbSamples)
+  {
+    return ref;
+  }
+
+  if (keepSamples && ref.size()%2==0)
+  {
+    Tools::resizeSamples<Scalar>(ref, 2, nbSamples, reference);
+  }
+  else
+  {
+    reference.setZero(2*nbSamples);
+  }
+  return reference;
 }
 
 template <typename Scalar>
-void ZebulonWalkgen<Scalar>::computeConstantPart()
+void ZebulonWalkgen<Scalar>::setHorizonTunerConfig(const HorizonTunerConfig<Scalar>& config)
 {
-  int N = lipModel_.getNbSamples();
-  int M1 = config_.withCopConstraints? copConstraint_.getNbConstraints() : 0;
-  int M2 = config_.withBaseMotionConstraints? baseMotionConstraint_.getNbConstraints() : 0;
-  int M3 = config_.withComConstraints? comConstraint_.getNbConstraints() : 0;
-  int M4 = config_.withTiltMotionConstraints? tiltMotionConstraint_.getNbConstraints() : 0;
-  int M = M1+M2+M3+M4;
+  horizonTuner_.setConfig(config);
+  nextNbSamples_ = 0;
 
-  assert(velTrackingObj_.getHessian().rows() == 2*N);
-  assert(velTrackingObj_.getHessian().cols() == 2*N);
+  if (!horizonTuner_.isEnabled())
+  {
+    return;
+  }
 
-  assert(posTrackingObj_.getHessian().rows() == 2*N);
-  assert(posTrackingObj_.getHessian().cols() == 2*N);
+  int N = nbSamples_;
+  int firstNbSamples = std::max(config.minNbSamples, std::min(config.maxNbSamples, N));
+  std::vector<int> nbSamples(1, firstNbSamples);
+  for(int n=firstNbSamples - config.nbSamplesStep; n>=config.minNbSamples;
+      n-=config.nbSamplesStep)
+  {
+    nbSamples.push_back(n);
+  }
+  for(int n=firstNbSamples + config.nbSamplesStep; n<=config.maxNbSamples;
+      n+=config.nbSamplesStep)
+  {
+    nbSamples.push_back(n);
+  }
+  reserveNbSamples(nbSamples);
+}
 
-  assert(copCenteringObj_.getHessian().rows() == 4*N);
-  assert(copCenteringObj_.getHessian().cols() == 4*N);
+template <typename Scalar>
+const HorizonTuner<Scalar>& ZebulonWalkgen<Scalar>::getHorizonTuner() const
+{
+  return horizonTuner_;
+}
 
-  assert(comCenteringObj_.getHessian().rows() == 4*N);
-  assert(comCenteringObj_.getHessian().cols() == 4*N);
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::reserveMaxSamples(int maxNbSamples)
+{
+  assert(maxNbSamples>0);
 
-  assert(jerkMinObj_.getHessian().rows() == 4*N);
-  assert(jerkMinObj_.getHessian().cols() == 4*N);
+  std::vector<int> nbSamples;
+  for(int n=1; n<=maxNbSamples; ++n)
+  {
+    nbSamples.push_back(n);
+  }
+  reserveNbSamples(nbSamples);
+}
 
-  assert(tiltMinObj_.getHessian().rows() == 4*N);
-  assert(tiltMinObj_.getHessian().cols() == 4*N);
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::reserveNbSamples(const std::vector<int>& nbSamples)
+{
+  assert(!nbSamples.empty());
+
+  // The QP constant parts are computed with the latest models
+  waitForBackgroundJobs();
 
-  assert(tiltVelMinObj_.getHessian().rows() == 4*N);
-  assert(tiltVelMinObj_.getHessian().cols() == 4*N);
+  reserveCapacity(*std::max_element(nbSamples.begin(), nbSamples.end()));
+  for(size_t i=0; i<nbSamples.size(); ++i)
+  {
+    if (nbSamples[i]!=nbSamples_ && reservedHorizons_.count(nbSamples[i])==0)
+    {
+      reserveHorizon(nbSamples[i]);
+    }
+  }
+}
+
+template <typename Scalar>
+typename ZebulonWalkgen<Scalar>::ProblemPtr ZebulonWalkgen<Scalar>::resizeProblem(
+    const Problem& pb, int nbSamples)
+{
+  ProblemPtr resized(new Problem);
+  resized->lipModel = pb.lipModel;
+  resized->baseModel = pb.baseModel;
+  resized->lipModel.setNbSamples(nbSamples);
+  resized->baseModel.setNbSamples(nbSamples);
+  resized->computeConstantPart();
+  return resized;
+}
+
+template <typename Scalar>
+typename ZebulonWalkgen<Scalar>::ProblemPtr ZebulonWalkgen<Scalar>::getHorizonProblem(
+    int nbSamples) const
+{
+  if (nbSamples==problem_->lipModel.getNbSamples())
+  {
+    return problem_;
+  }
+  return resizeProblem(*problem_, nbSamples);
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::reserveCapacity(int nbSamples)
+{
+  reservedHorizons_[nbSamples_];
+
+  if (nbSamples<=problem_->lipModel.getNbSamples())
+  {
+    return;
+  }
+
+  // The QP constant parts in use do not depend on the samples after
+  // nbSamples_, and are kept
+  ProblemPtr pb = resizeProblem(*problem_, nbSamples);
+  copyVariableData(*problem_, *pb, reference_, true);
+  problem_ = pb;
+
+  Tools::resizeSamples<Scalar>(X_, 4, nbSamples);
+  Tools::resizeSamples<Scalar>(lastSolution_, 4, nbSamples);
+  B_.setZero(2*nbSamples);
+  reference_.setZero(2*nbSamples);
+  predictionsUpToDate_ = 0;
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::reserveHorizon(int nbSamples)
+{
+  assert(nbSamples!=nbSamples_);
+  assert(nbSamples<=problem_->lipModel.getNbSamples());
+
+  ProblemPtr pb = getHorizonProblem(nbSamples);
+  ReservedHorizon& horizon = reservedHorizons_[nbSamples];
+  horizon.presets.clear();
+  for(typename PresetMap::const_iterator it=presets_.begin(); it!=presets_.end(); ++it)
+  {
+    // Stale presets are computed for each number of samples when selected
+    horizon.presets[it->first] = it->second->isStale ? it->second :
+                                                       computePreset(*pb, *it->second, config_);
+  }
+
+  if (!selectedPreset_.empty())
+  {
+    horizon.qp = horizon.presets[selectedPreset_];
+  }
+  else
+  {
+    horizon.qp = computeConstantPart(*pb, weighting_, config_);
+    initializeSolvers(*horizon.qp);
+  }
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::switchNbSamples(int nbSamples)
+{
+  assert(nbSamples!=nbSamples_);
+  assert(reservedHorizons_.count(nbSamples)>0);
+
+  // Only pointers are swapped, the QP constant parts being up to date
+  ReservedHorizon& current = reservedHorizons_[nbSamples_];
+  ReservedHorizon& horizon = reservedHorizons_[nbSamples];
+  current.qp = qp_;
+  current.presets.swap(presets_);
+  qp_ = horizon.qp;
+  horizon.qp.reset();
+  presets_.swap(horizon.presets);
+
+  // The warm start and the references keep their samples after the last
+  // one equal to it, so that they are extended by their last sample when
+  // the number of samples increases
+  int N = nbSamples_;
+  nbSamples_ = nbSamples;
+  if (nbSamples<N)
+  {
+    Tools::padSamples<Scalar>(X_, 4, nbSamples);
+    extendReferences();
+  }
+  predictionsUpToDate_ = 0;
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::getNbConstraints(const ZebulonWalkgenConfig<Scalar>& config,
+                                              int nbSamples, int nbConstraints[4]) const
+{
+  Problem& pb = *problem_;
+  int N = pb.lipModel.getNbSamples();
+  nbConstraints[0] = config.withCopConstraints ?
+        pb.copConstraint.getNbConstraints()/N*nbSamples : 0;
+  nbConstraints[1] = config.withBaseMotionConstraints ?
+        pb.baseMotionConstraint.getNbConstraints()/N*nbSamples : 0;
+  nbConstraints[2] = config.withComConstraints ?
+        pb.comConstraint.getNbConstraints()/N*nbSamples : 0;
+  nbConstraints[3] = config.withTiltMotionConstraints ?
+        pb.tiltMotionConstraint.getNbConstraints()/N*nbSamples : 0;
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::saveConstantPart(std::ostream& stream) const
+{
+  ConstantPartArchive<Scalar> ar;
+
+  std::string type("ZebulonWalkgen");
+  ar.process(type);
+
+  // The archive methods also load, so the members are saved from copies
+  ZebulonWalkgenWeighting<Scalar> weighting = weighting_;
+  ZebulonWalkgenConfig<Scalar> config = config_;
+  ConvexPolygon<Scalar> copConvexPolygon = copConvexPolygon_;
+  ConvexPolygon<Scalar> comConvexPolygon = comConvexPolygon_;
+  archiveWeighting(ar, weighting);
+  archiveConfig(ar, config);
+  copConvexPolygon.archive(ar);
+  comConvexPolygon.archive(ar);
+
+  // The problem is saved with the number of samples in use
+  int N = nbSamples_;
+  ProblemPtr pb = getHorizonProblem(N);
+  if (pb!=problem_)
+  {
+    VectorX reference;
+    copyVariableData(*problem_, *pb, reference, true);
+  }
+  archiveProblem(ar, *pb);
+
+  ar.processSize(static_cast<int>(presets_.size()));
+  for(typename PresetMap::const_iterator it=presets_.begin(); it!=presets_.end(); ++it)
+  {
+    std::string name = it->first;
+    ar.process(name);
+    // Stale presets are saved as they would be computed when selected
+    QPConstantPartPtr preset = it->second;
+    if (preset->isStale)
+    {
+      preset = computePreset(*pb, *preset, config_);
+    }
+    archiveQPConstantPart(ar, *preset, N);
+  }
+
+  // The QP constant part in use is a preset, or is saved after them
+  std::string selectedPreset = selectedPreset_;
+  ar.process(selectedPreset);
+  if (selectedPreset_.empty())
+  {
+    archiveQPConstantPart(ar, *qp_, N);
+  }
+
+  const std::vector<char>& data = ar.getData();
+  stream.write(&data[0], data.size());
+}
+
+template <typename Scalar>
+bool ZebulonWalkgen<Scalar>::loadConstantPart(std::istream& stream)
+{
+  std::vector<char> data;
+  if (!ConstantPartArchive<Scalar>::readData(stream, data))
+  {
+    return false;
+  }
+  return loadConstantPart(&data[0], data.size());
+}
+
+template <typename Scalar>
+bool ZebulonWalkgen<Scalar>::loadConstantPart(const char* data, size_t size)
+{
+  ConstantPartArchive<Scalar> ar(data, size);
+
+  std::string type;
+  ar.process(type);
+  if (type!="ZebulonWalkgen")
+  {
+    ar.invalidate();
+  }
+
+  // Everything is loaded in new objects, which replace the members only
+  // once the whole constant part is valid
+  ZebulonWalkgenWeighting<Scalar> weighting;
+  ZebulonWalkgenConfig<Scalar> config;
+  ConvexPolygon<Scalar> copConvexPolygon;
+  ConvexPolygon<Scalar> comConvexPolygon;
+  archiveWeighting(ar, weighting);
+  archiveConfig(ar, config);
+  copConvexPolygon.archive(ar);
+  comConvexPolygon.archive(ar);
+
+  ProblemPtr pb(new Problem);
+  archiveProblem(ar, *pb);
+  int N = pb->lipModel.getNbSamples();
+
+  PresetMap presets;
+  int nbPresets = ar.processSize(0);
+  for(int i=0; i<nbPresets; ++i)
+  {
+    std::string name;
+    ar.process(name);
+    QPConstantPartPtr preset(new QPConstantPart);
+    archiveQPConstantPart(ar, *preset, N);
+    presets[name] = preset;
+  }
+
+  std::string selectedPreset;
+  ar.process(selectedPreset);
+  QPConstantPartPtr qp;
+  if (selectedPreset.empty())
+  {
+    qp.reset(new QPConstantPart);
+    archiveQPConstantPart(ar, *qp, N);
+  }
+  else if (presets.count(selectedPreset)>0)
+  {
+    qp = presets[selectedPreset];
+  }
+  else
+  {
+    ar.invalidate();
+  }
+
+  if (!ar.isAtEnd())
+  {
+    return false;
+  }
+
+  // The loaded models replace the ones being updated in the background
+  pendingUpdates_.clear();
+  waitForBackgroundJobs();
+
+  problem_ = pb;
+  nbSamples_ = N;
+  weighting_ = weighting;
+  config_ = config;
+  copConvexPolygon_ = copConvexPolygon;
+  comConvexPolygon_ = comConvexPolygon;
+  presets_.swap(presets);
+  qp_ = qp;
+  selectedPreset_ = selectedPreset;
+  ++qpVersion_;
+
+  nextNbSamples_ = 0;
+  horizonTuner_.reset();
+
+  resetBuffers();
+  timeSinceLastShift_ = 0;
+  predictionsUpToDate_ = 0;
+
+  // The numbers of samples reserved before are reserved again for the
+  // loaded models
+  if (!reservedHorizons_.empty())
+  {
+    std::vector<int> nbSamples;
+    for(typename HorizonMap::const_iterator it=reservedHorizons_.begin();
+        it!=reservedHorizons_.end(); ++it)
+    {
+      nbSamples.push_back(it->first);
+    }
+    reservedHorizons_.clear();
+    reserveNbSamples(nbSamples);
+  }
+
+  return true;
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::archiveWeighting(ConstantPartArchive<Scalar>& ar,
+                                              ZebulonWalkgenWeighting<Scalar>& weighting)
+{
+  ar.process(weighting.velocityTracking);
+  ar.process(weighting.positionTracking);
+  ar.process(weighting.copCentering);
+  ar.process(weighting.comCentering);
+  ar.process(weighting.jerkMinimization);
+  ar.process(weighting.tiltMinimization);
+  ar.process(weighting.tiltVelMinimization);
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::archiveConfig(ConstantPartArchive<Scalar>& ar,
+                                           ZebulonWalkgenConfig<Scalar>& config)
+{
+  ar.process(config.withCopConstraints);
+  ar.process(config.withComConstraints);
+  ar.process(config.withBaseMotionConstraints);
+  ar.process(config.withTiltMotionConstraints);
+  ar.process(config.maxNbPolygonVertices);
+  ar.process(config.maxPolygonAreaLossRatio);
+  ar.process(config.withPresolve);
+  ar.process(config.withWarmStartShift);
+  ar.process(config.withPeriodWeighting);
+  ar.process(config.withParallelAxisSolve);
+  ar.process(config.withBackgroundConstantPart);
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::archiveQPMatrices(ConstantPartArchive<Scalar>& ar,
+                                               QPMatrices<Scalar>& m)
+{
+  ar.process(m.Q);
+  ar.process(m.p);
+  ar.process(m.A);
+  ar.process(m.At);
+  ar.process(m.bu);
+  ar.process(m.bl);
+  ar.process(m.xl);
+  ar.process(m.xu);
+
+  bool hasEquilibration = m.hasEquilibration();
+  VectorX varScaling = m.getVariableScaling();
+  VectorX ctrScaling = m.getConstraintScaling();
+  Scalar objScaling = m.getObjectiveScaling();
+  ar.process(hasEquilibration);
+  ar.process(varScaling);
+  ar.process(ctrScaling);
+  ar.process(objScaling);
+
+  if (!ar.isLoading())
+  {
+    return;
+  }
+
+  const int nbVar = static_cast<int>(m.Q.rows());
+  const int nbCtr = static_cast<int>(m.A.rows());
+  if (m.Q.cols()!=nbVar || m.p.size()!=nbVar || m.xl.size()!=nbVar || m.xu.size()!=nbVar ||
+      m.A.cols()!=nbVar || m.At.rows()!=nbVar || m.At.cols()!=nbCtr ||
+      m.bl.size()!=nbCtr || m.bu.size()!=nbCtr ||
+      (hasEquilibration && (varScaling.size()!=nbVar || ctrScaling.size()!=nbCtr ||
+                            !(objScaling>0))))
+  {
+    ar.invalidate();
+    return;
+  }
+
+  if (hasEquilibration)
+  {
+    m.setEquilibration(varScaling, ctrScaling, objScaling);
+  }
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::archiveProblem(ConstantPartArchive<Scalar>& ar, Problem& pb)
+{
+  pb.lipModel.archive(ar);
+  pb.baseModel.archive(ar);
+
+  pb.velTrackingObj.archive(ar);
+  pb.posTrackingObj.archive(ar);
+  pb.jerkMinObj.archive(ar);
+  pb.tiltMinObj.archive(ar);
+  pb.tiltVelMinObj.archive(ar);
+  pb.copCenteringObj.archive(ar);
+  pb.comCenteringObj.archive(ar);
+  pb.copConstraint.archive(ar);
+  pb.comConstraint.archive(ar);
+  pb.baseMotionConstraint.archive(ar);
+  pb.tiltMotionConstraint.archive(ar);
+
+  if (ar.isLoading() && pb.lipModel.getNbSamples()!=pb.baseModel.getNbSamples())
+  {
+    ar.invalidate();
+  }
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::archiveQPConstantPart(ConstantPartArchive<Scalar>& ar,
+                                                   QPConstantPart& part, int nbSamples) const
+{
+  archiveWeighting(ar, part.weighting);
+  archiveConfig(ar, part.config);
+  archiveQPMatrices(ar, part.qpMatrix);
+
+  ar.process(part.axesAreDecoupled);
+  for(int axis=0; axis<2; ++axis)
+  {
+    ar.process(part.axisVariables[axis]);
+    ar.process(part.axisConstraints[axis]);
+    archiveQPMatrices(ar, part.axisQPMatrix[axis]);
+    ar.process(part.axisDX[axis]);
+  }
+
+  if (!ar.isLoading())
+  {
+    return;
+  }
+
+  const QPMatrices<Scalar>& m = part.qpMatrix;
+  bool isValid = m.Q.rows()==4*nbSamples;
+  for(int axis=0; axis<2 && part.axesAreDecoupled; ++axis)
+  {
+    const std::vector<int>& var = part.axisVariables[axis];
+    const std::vector<int>& ctr = part.axisConstraints[axis];
+    isValid = isValid &&
+        part.axisQPMatrix[axis].Q.rows()==static_cast<int>(var.size()) &&
+        part.axisQPMatrix[axis].A.rows()==static_cast<int>(ctr.size()) &&
+        part.axisDX[axis].size()==static_cast<int>(var.size());
+    for(size_t j=0; j<var.size(); ++j)
+    {
+      isValid = isValid && var[j]>=0 && var[j]<m.Q.rows();
+    }
+    for(size_t i=0; i<ctr.size(); ++i)
+    {
+      isValid = isValid && ctr[i]>=0 && ctr[i]<m.A.rows();
+    }
+  }
+  if (!isValid)
+  {
+    ar.invalidate();
+  }
+  if (!ar.isValid())
+  {
+    return;
+  }
+
+  part.X.setZero(4*nbSamples);
+  part.dX.setZero(4*nbSamples);
+  if (part.axesAreDecoupled)
+  {
+    for(int axis=0; axis<2; ++axis)
+    {
+      part.axisQPSolver[axis].reset(createQPSolver(part.config,
+                                                   part.axisVariables[axis].size(),
+                                                   part.axisConstraints[axis].size()));
+    }
+  }
+  else
+  {
+    part.qpSolver.reset(createQPSolver(part.config, m.Q.rows(), m.A.rows()));
+  }
+  initializeSolvers(part);
+}
+
+template <typename Scalar>
+ConvexPolygon<Scalar> ZebulonWalkgen<Scalar>::simplifyConvexPolygon(
+    const ConvexPolygon<Scalar>& convexPolygon) const
+{
+  if (config_.maxNbPolygonVertices<3 || convexPolygon.getNbVertices()<3)
+  {
+    return convexPolygon;
+  }
+
+  return ConvexPolygon<Scalar>(
+        ConvexPolygon<Scalar>::simplifyVertices(convexPolygon.getVertices(),
+                                                config_.maxNbPolygonVertices,
+                                                config_.maxPolygonAreaLossRatio));
+}
+
+template <typename Scalar>
+bool ZebulonWalkgen<Scalar>::solve(Scalar feedBackPeriod)
+{
+  swapInBackgroundJob();
+
+  // The tuner only requests reserved numbers of samples, whose QP constant
+  // parts are up to date, so the switch does not compute anything
+  if (nextNbSamples_>0)
+  {
+    switchNbSamples(nextNbSamples_);
+    nextNbSamples_ = 0;
+  }
+  const boost::chrono::steady_clock::time_point startTime =
+      boost::chrono::steady_clock::now();
+
+  // The functions are evaluated for all the samples of problem_, and the
+  // QP uses their first N samples, the dynamics being causal
+  int C = problem_->lipModel.getNbSamples();
+  int N = nbSamples_;
+  int M[4];
+  getNbConstraints(config_, N, M);
+  int M1 = M[0];
+  int M2 = M[1];
+  int M3 = M[2];
+  int M4 = M[3];
+  QPMatrices<Scalar>& m = qp_->qpMatrix;
+  VectorX& X = qp_->X;
+  VectorX& dX = qp_->dX;
+
+  B_ = X_.segment(2*C, 2*C);
+
+  assert(problem_->velTrackingObj.getLinearTerm(N).size() == 2*N);
+  assert(problem_->posTrackingObj.getLinearTerm(N).size() == 2*N);
+
+  assert(problem_->copCenteringObj.getLinearTerm(N).size() == 4*N);
+  assert(problem_->comCenteringObj.getLinearTerm(N).size() == 4*N);
+  assert(problem_->tiltMinObj.getLinearTerm(N).size() == 4*N);
+  assert(problem_->tiltVelMinObj.getLinearTerm(N).size() == 4*N);
+  assert(m.Q.rows() == 4*N);
+  assert(m.A.rows() == M1+M2+M3+M4);
 
   if (config_.withCopConstraints)
   {
-    assert(copConstraint_.getGradient().cols() == 4*N);
-    assert(copConstraint_.getGradient().rows() == M1);
+    assert(problem_->copConstraint.getFunctionInf(X_).size() == M1/N*C);
+    assert(problem_->copConstraint.getFunctionSup(X_).size() == M1/N*C);
   }
   if (config_.withComConstraints)
   {
-    assert(comConstraint_.getGradient().cols() == 4*N);
-    assert(comConstraint_.getGradient().rows() == M3);
+    assert(problem_->comConstraint.getFunctionInf(X_).size() == M3/N*C);
+    assert(problem_->comConstraint.getFunctionSup(X_).size() == M3/N*C);
   }
   if (config_.withBaseMotionConstraints)
   {
-    assert(baseMotionConstraint_.getGradient().cols() == 2*N);
-    assert(baseMotionConstraint_.getGradient().rows() == M2);
+    assert(problem_->baseMotionConstraint.getFunctionInf(B_).size() == M2/N*C);
+    assert(problem_->baseMotionConstraint.getFunctionSup(B_).size() == M2/N*C);
   }
   if (config_.withTiltMotionConstraints)
   {
-    assert(tiltMotionConstraint_.getGradient().cols() == 4*N);
-    assert(tiltMotionConstraint_.getGradient().rows() == M4);
+    assert(problem_->tiltMotionConstraint.getFunction(X_).size() == M4/N*C);
   }
 
-  qpoasesSolver_.reset(makeQPSolver<Scalar>(4*N, M));
+  assert(feedBackPeriod>0);
+
+  m.bu.fill(Scalar(10e10));
+  m.bl.fill(Scalar(-10e10));
+  m.xu.fill(Scalar(10e10));
+  m.xl.fill(Scalar(-10e10));
 
-  qpMatrix_.Q.setZero(4*N, 4*N);
-  qpMatrix_.p.setZero(4*N, 1);
-  qpMatrix_.A.setZero(M, 4*N);
-  qpMatrix_.bl.setZero(M, 1);
-  qpMatrix_.bu.setZero(M, 1);
-  qpMatrix_.xl.setZero(4*N, 1);
-  qpMatrix_.xu.setZero(4*N, 1);
+  // The gradient of the objective is Q.X plus the linear terms of the
+  // objectives, Q being the weighted sum of their hessians
+  Tools::restrictSamples<Scalar>(X_, 4, N, X);
+  m.computeHessianProduct(X, m.p);
 
   if (weighting_.velocityTracking>0.0)
   {
-    qpMatrix_.Q.block(2*N, 2*N, 2*N, 2*N) +=
-       weighting_.velocityTracking*velTrackingObj_.getHessian();
+    m.p.segment(2*N, 2*N) +=
+       weighting_.velocityTracking*problem_->velTrackingObj.getLinearTerm(N);
   }
   if (weighting_.positionTracking>0.0)
   {
-    qpMatrix_.Q.block(2*N, 2*N, 2*N, 2*N) +=
-       weighting_.positionTracking*posTrackingObj_.getHessian();
+    m.p.segment(2*N, 2*N) +=
+        weighting_.positionTracking*problem_->posTrackingObj.getLinearTerm(N);
   }
   if (weighting_.copCentering>0.0)
   {
-    qpMatrix_.Q += weighting_.copCentering*copCenteringObj_.getHessian();
+    m.p += weighting_.copCentering*problem_->copCenteringObj.getLinearTerm(N);
   }
   if (weighting_.comCentering>0.0)
   {
-    qpMatrix_.Q += weighting_.comCentering*comCenteringObj_.getHessian();
-  }
-  if (weighting_.jerkMinimization>0.0)
-  {
-    qpMatrix_.Q += weighting_.jerkMinimization*jerkMinObj_.getHessian();
+    m.p += weighting_.comCentering*problem_->comCenteringObj.getLinearTerm(N);
   }
   if (weighting_.tiltMinimization>0.0)
   {
-    qpMatrix_.Q += weighting_.tiltMinimization*tiltMinObj_.getHessian();
+    m.p += weighting_.tiltMinimization*problem_->tiltMinObj.getLinearTerm(N);
   }
   if (weighting_.tiltVelMinimization>0.0)
   {
-    qpMatrix_.Q += weighting_.tiltVelMinimization*tiltVelMinObj_.getHessian();
+    m.p += weighting_.tiltVelMinimization*problem_->tiltVelMinObj.getLinearTerm(N);
   }
 
   if (config_.withCopConstraints)
   {
-    qpMatrix_.A.block(0, 0, M1, 4*N) = copConstraint_.getGradient();
+    Tools::restrictSamples<Scalar>(problem_->copConstraint.getFunctionInf(X_), M1/N, N,
+                                   m.bl, 0);
+    Tools::restrictSamples<Scalar>(problem_->copConstraint.getFunctionSup(X_), M1/N, N,
+                                   m.bu, 0);
   }
   if (config_.withBaseMotionConstraints)
   {
-    qpMatrix_.A.block(M1, 2*N, M2, 2*N) = baseMotionConstraint_.getGradient();
+    Tools::restrictSamples<Scalar>(problem_->baseMotionConstraint.getFunctionInf(B_), M2/N, N,
+                                   m.bl, M1);
+    Tools::restrictSamples<Scalar>(problem_->baseMotionConstraint.getFunctionSup(B_), M2/N, N,
+                                   m.bu, M1);
+
+    m.xu.segment(2*N, 2*N).fill(problem_->baseModel.getJerkLimit());
+    m.xu.segment(2*N, 2*N) -= X.segment(2*N, 2*N);
+
+    m.xl.segment(2*N, 2*N).fill(-problem_->baseModel.getJerkLimit());
+    m.xl.segment(2*N, 2*N) -= X.segment(2*N, 2*N);
   }
   if (config_.withComConstraints)
   {
-    qpMatrix_.A.block(M1+M2, 0, M3, 4*N) = comConstraint_.getGradient();
+    Tools::restrictSamples<Scalar>(problem_->comConstraint.getFunctionInf(X_), M3/N, N,
+                                   m.bl, M1+M2);
+    Tools::restrictSamples<Scalar>(problem_->comConstraint.getFunctionSup(X_), M3/N, N,
+                                   m.bu, M1+M2);
   }
   if (config_.withTiltMotionConstraints)
   {
-    qpMatrix_.A.block(M1+M2+M3, 0, M4, 4*N) = tiltMotionConstraint_.getGradient();
+    const VectorX& tilt = problem_->tiltMotionConstraint.getFunction(X_);
+    Tools::restrictSamples<Scalar>(tilt, M4/N, N, m.bl, M1+M2+M3);
+    Tools::restrictSamples<Scalar>(tilt, M4/N, N, m.bu, M1+M2+M3);
   }
 
-  computeNormalizationFactor(qpMatrix_.Q, qpMatrix_.A);
-  qpMatrix_.Q *= invObjNormFactor_;
-  qpMatrix_.A *= invCtrNormFactor_;
+  m.equilibrateVectors();
 
-  qpMatrix_.At = qpMatrix_.A.transpose();
+  bool solutionFound = qp_->axesAreDecoupled ? solveAxisProblems()
+                                             : qp_->qpSolver->solve(m, dX, true);
 
+  if (!solutionFound)
+  {
+    std::cerr << "Q : " << std::endl << m.Q << std::endl;
+    std::cerr << "p : " << m.p.transpose() << std::endl;
+    std::cerr << "A : " << std::endl << m.A << std::endl;
+    std::cerr << "bl: " << m.bl.transpose() << std::endl;
+    std::cerr << "bu: " << m.bu.transpose() << std::endl;
+    std::cerr << "X : " << X.transpose() << std::endl;
+    std::cerr << "dX: " << dX.transpose() << std::endl;
+    std::cerr << "m : " << problem_->lipModel.getMass() << std::endl;
+    std::cerr << "M : " << problem_->baseModel.getMass() << std::endl;
+    std::cerr << "h : " << problem_->lipModel.getComHeight() << std::endl;
+    std::cerr << "L : " << problem_->baseModel.getComHeight() << std::endl;
+    std::cerr << "T : " << problem_->lipModel.getSamplingPeriod() << std::endl;
+    std::cerr << "cx: " << problem_->lipModel.getStateX() << std::endl;
+    std::cerr << "bx: " << problem_->baseModel.getStateX() << std::endl;
+    std::cerr << "cy: " << problem_->lipModel.getStateY() << std::endl;
+    std::cerr << "by: " << problem_->baseModel.getStateY() << std::endl;
+    std::cerr << "bY: " << problem_->baseModel.getStateYaw() << std::endl;
+    std::cerr << "bP: " << problem_->baseModel.getStatePitch() << std::endl;
+    std::cerr << "bR: " << problem_->baseModel.getStateRoll() << std::endl;
+  }
+
+  m.unscalePrimalSolution(dX);
+  for(int i=0; i<4; ++i)
+  {
+    X_.segment(i*C, N) += dX.segment(i*N, N);
+  }
+  Tools::padSamples<Scalar>(X_, 4, N);
+
+  lastStates_[0] = problem_->lipModel.getStateX();
+  lastStates_[1] = problem_->lipModel.getStateY();
+  lastStates_[2] = problem_->baseModel.getStateX();
+  lastStates_[3] = problem_->baseModel.getStateY();
+  for(int i=0; i<4; ++i)
+  {
+    lastJerks_[i] = X_(i*C);
+  }
+  lastFeedBackPeriod_ = feedBackPeriod;
+  lastSolution_ = X_;
+  predictionsUpToDate_ = 0;
+
+  problem_->lipModel.updateStateX(X_(0), feedBackPeriod);
+  problem_->lipModel.updateStateY(X_(C), feedBackPeriod);
+  problem_->baseModel.updateStateX(X_(2*C), feedBackPeriod);
+  problem_->baseModel.updateStateY(X_(3*C), feedBackPeriod);
+
+  if (config_.withWarmStartShift && solutionFound)
+  {
+    timeSinceLastShift_ += feedBackPeriod;
+    if (timeSinceLastShift_ > problem_->lipModel.getSamplingPeriod() - Constant<Scalar>::EPSILON)
+    {
+      timeSinceLastShift_ -= problem_->lipModel.getSamplingPeriod();
+      shiftWarmStart();
+    }
+  }
+
+  if (horizonTuner_.isEnabled())
+  {
+    const boost::chrono::duration<double> solveTime =
+        boost::chrono::steady_clock::now() - startTime;
+    int nbSamples = horizonTuner_.addSolveTime(static_cast<Scalar>(solveTime.count()), N);
+    nextNbSamples_ = nbSamples!=N && reservedHorizons_.count(nbSamples)>0 ? nbSamples : 0;
+  }
+
+  return solutionFound;
+}
+
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::computeSetpoints(Scalar dt, int nbSetpoints,
+                                              Scalar* setpoints) const
+{
+  assert(dt>0);
+  assert(nbSetpoints>=0);
+  assert(nbSetpoints*dt < lastFeedBackPeriod_ + Constant<Scalar>::EPSILON);
+
+  const int n = nbSetpoints;
+  for(int i=0; i<4; ++i)
+  {
+    Scalar* pos = setpoints + 3*i*n;
+    Tools::ConstantJerkDynamic<Scalar>::sampleState(lastStates_[i], lastJerks_[i],
+                                                    dt, n, pos, pos + n, pos + 2*n);
+  }
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::getPredictedComPosition(VectorX& posX, VectorX& posY) const
+{
+  getPrediction(PREDICTED_COM_POSITION, posX, posY);
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::getPredictedBasePosition(VectorX& posX, VectorX& posY) const
+{
+  getPrediction(PREDICTED_BASE_POSITION, posX, posY);
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::getPredictedCopPosition(VectorX& posX, VectorX& posY) const
+{
+  getPrediction(PREDICTED_COP_POSITION, posX, posY);
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::getPredictedTiltAngle(VectorX& angleX, VectorX& angleY) const
+{
+  getPrediction(PREDICTED_TILT_ANGLE, angleX, angleY);
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::getPrediction(Prediction prediction,
+                                           VectorX& trajX, VectorX& trajY) const
+{
+  // The trajectories are computed for all the samples of problem_, and
+  // their first nbSamples_ samples are given, the dynamics being causal
+  const LIPModel<Scalar>& lipModel = problem_->lipModel;
+  const BaseModel<Scalar>& baseModel = problem_->baseModel;
+  int N = lipModel.getNbSamples();
+
+  assert(lastSolution_.size()==4*N);
+
+  VectorX& predX = predictions_[2*prediction];
+  VectorX& predY = predictions_[2*prediction + 1];
+
+  if ((predictionsUpToDate_ & (1 << prediction))==0)
+  {
+    // Products are accumulated one by one, so that no temporary is allocated
+    switch (prediction)
+    {
+    case PREDICTED_COM_POSITION:
+    {
+      const LinearDynamic<Scalar>& dynComPos = lipModel.getComPosLinearDynamic();
+      predX.noalias() = dynComPos.U*lastSolution_.segment(0, N);
+      predX.noalias() += dynComPos.S*lastStates_[0];
+      predY.noalias() = dynComPos.U*lastSolution_.segment(N, N);
+      predY.noalias() += dynComPos.S*lastStates_[1];
+      break;
+    }
+    case PREDICTED_BASE_POSITION:
+    {
+      const LinearDynamic<Scalar>& dynBasePos = baseModel.getBasePosLinearDynamic();
+      predX.noalias() = dynBasePos.U*lastSolution_.segment(2*N, N);
+      predX.noalias() += dynBasePos.S*lastStates_[2];
+      predY.noalias() = dynBasePos.U*lastSolution_.segment(3*N, N);
+      predY.noalias() += dynBasePos.S*lastStates_[3];
+      break;
+    }
+    case PREDICTED_COP_POSITION:
+    {
+      const LinearDynamic<Scalar>& dynCopXCom = lipModel.getCopXLinearDynamic();
+      const LinearDynamic<Scalar>& dynCopYCom = lipModel.getCopYLinearDynamic();
+      predX.noalias() = dynCopXCom.U*lastSolution_.segment(0, N);
+      predX.noalias() += dynCopXCom.S*lastStates_[0];
+      predX += dynCopXCom.K;
+      predY.noalias() = dynCopYCom.U*lastSolution_.segment(N, N);
+      predY.noalias() += dynCopYCom.S*lastStates_[1];
+      predY += dynCopYCom.K;
+
+      // Same contribution of the base as in the CoP constraint
+      if (baseModel.getMass()>Constant<Scalar>::EPSILON)
+      {
+        const LinearDynamic<Scalar>& dynCopXBase = baseModel.getCopXLinearDynamic();
+        const LinearDynamic<Scalar>& dynCopYBase = baseModel.getCopYLinearDynamic();
+        predX.noalias() += dynCopXBase.U*lastSolution_.segment(2*N, N);
+        predX.noalias() += dynCopXBase.S*lastStates_[2];
+        predX += dynCopXBase.K;
+        predY.noalias() += dynCopYBase.U*lastSolution_.segment(3*N, N);
+        predY.noalias() += dynCopYBase.S*lastStates_[3];
+        predY += dynCopYBase.K;
+      }
+      break;
+    }
+    case PREDICTED_TILT_ANGLE:
+      problem_->tiltMinObj.computeTiltAngles(lastSolution_,
+                                             lastStates_[0], lastStates_[1],
+                                             lastStates_[2], lastStates_[3],
+                                             predX, predY);
+      break;
+    default:
+      assert(false);
+      break;
+    }
+
+    predictionsUpToDate_ |= 1 << prediction;
+  }
+
+  trajX = predX.head(nbSamples_);
+  trajY = predY.head(nbSamples_);
+}
+
+template <typename Scalar>
+int ZebulonWalkgen<Scalar>::getNbIterations() const
+{
+  if (qp_->axesAreDecoupled)
+  {
+    return qp_->axisQPSolver[0]->getNbIterations() + qp_->axisQPSolver[1]->getNbIterations();
+  }
+  return qp_->qpSolver->getNbIterations();
+}
+
+template <typename Scalar>
+int ZebulonWalkgen<Scalar>::getNbSamples() const
+{
+  return nbSamples_;
+}
+
+template <typename Scalar>
+const typename Type<Scalar>::Vector3& ZebulonWalkgen<Scalar>::getBaseStateX() const
+{
+  return problem_->baseModel.getStateX();
+}
+
+template <typename Scalar>
+const typename Type<Scalar>::Vector3& ZebulonWalkgen<Scalar>::getBaseStateY() const
+{
+  return problem_->baseModel.getStateY();
+}
+
+template <typename Scalar>
+const typename Type<Scalar>::Vector3& ZebulonWalkgen<Scalar>::getComStateX() const
+{
+  return problem_->lipModel.getStateX();
+}
+
+template <typename Scalar>
+const typename Type<Scalar>::Vector3& ZebulonWalkgen<Scalar>::getComStateY() const
+{
+  return problem_->lipModel.getStateY();
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::updateConstantParts(ConstantPartChange change)
+{
+  updateConstantPart(nbSamples_, qp_, presets_, change, false);
+  for(typename HorizonMap::iterator it=reservedHorizons_.begin();
+      it!=reservedHorizons_.end(); ++it)
+  {
+    if (it->first!=nbSamples_)
+    {
+      updateConstantPart(it->first, it->second.qp, it->second.presets, change, true);
+    }
+  }
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::updateConstantPart(int nbSamples, QPConstantPartPtr& qp,
+                                                PresetMap& presets,
+                                                ConstantPartChange change,
+                                                bool initialize) const
+{
+  // Only the QP in use is computed right away, so that a change of the
+  // models does not cost one computation per preset
+  if (change==MODELS_CHANGED)
+  {
+    for(typename PresetMap::iterator it=presets.begin(); it!=presets.end(); ++it)
+    {
+      it->second->isStale = true;
+    }
+  }
+
+  if (!selectedPreset_.empty())
+  {
+    QPConstantPartPtr& preset = presets[selectedPreset_];
+    if (preset->isStale)
+    {
+      preset = computePreset(*getHorizonProblem(nbSamples), *preset, config_);
+    }
+    qp = preset;
+  }
+  else if (change!=PRESET_SELECTED)
+  {
+    qp = computeConstantPart(*getHorizonProblem(nbSamples), weighting_, config_);
+    if (initialize)
+    {
+      initializeSolvers(*qp);
+    }
+  }
+}
+
+template <typename Scalar>
+typename ZebulonWalkgen<Scalar>::QPConstantPartPtr ZebulonWalkgen<Scalar>::computePreset(
+    Problem& pb, const QPConstantPart& preset,
+    const ZebulonWalkgenConfig<Scalar>& config) const
+{
+  ZebulonWalkgenConfig<Scalar> presetConfig = preset.config;
+  presetConfig.maxNbPolygonVertices = config.maxNbPolygonVertices;
+  presetConfig.maxPolygonAreaLossRatio = config.maxPolygonAreaLossRatio;
+  presetConfig.withPeriodWeighting = config.withPeriodWeighting;
+
+  QPConstantPartPtr part = computeConstantPart(pb, preset.weighting, presetConfig);
+  initializeSolvers(*part);
+  return part;
+}
+
+template <typename Scalar>
+typename ZebulonWalkgen<Scalar>::QPConstantPartPtr ZebulonWalkgen<Scalar>::computeConstantPart(
+    Problem& pb,
+    const ZebulonWalkgenWeighting<Scalar>& weighting,
+    const ZebulonWalkgenConfig<Scalar>& config) const
+{
+  int N = pb.lipModel.getNbSamples();
+  int M1 = config.withCopConstraints? pb.copConstraint.getNbConstraints() : 0;
+  int M2 = config.withBaseMotionConstraints? pb.baseMotionConstraint.getNbConstraints() : 0;
+  int M3 = config.withComConstraints? pb.comConstraint.getNbConstraints() : 0;
+  int M4 = config.withTiltMotionConstraints? pb.tiltMotionConstraint.getNbConstraints() : 0;
+  int M = M1+M2+M3+M4;
+
+  assert(pb.velTrackingObj.getHessian().rows() == 2*N);
+  assert(pb.velTrackingObj.getHessian().cols() == 2*N);
+
+  assert(pb.posTrackingObj.getHessian().rows() == 2*N);
+  assert(pb.posTrackingObj.getHessian().cols() == 2*N);
+
+  assert(pb.copCenteringObj.getHessian().rows() == 4*N);
+  assert(pb.copCenteringObj.getHessian().cols() == 4*N);
+
+  assert(pb.comCenteringObj.getHessian().rows() == 4*N);
+  assert(pb.comCenteringObj.getHessian().cols() == 4*N);
+
+  assert(pb.jerkMinObj.getHessian().rows() == 4*N);
+  assert(pb.jerkMinObj.getHessian().cols() == 4*N);
+
+  assert(pb.tiltMinObj.getHessian().rows() == 4*N);
+  assert(pb.tiltMinObj.getHessian().cols() == 4*N);
+
+  assert(pb.tiltVelMinObj.getHessian().rows() == 4*N);
+  assert(pb.tiltVelMinObj.getHessian().cols() == 4*N);
+
+  if (config.withCopConstraints)
+  {
+    assert(pb.copConstraint.getGradient().cols() == 4*N);
+    assert(pb.copConstraint.getGradient().rows() == M1);
+  }
+  if (config.withComConstraints)
+  {
+    assert(pb.comConstraint.getGradient().cols() == 4*N);
+    assert(pb.comConstraint.getGradient().rows() == M3);
+  }
+  if (config.withBaseMotionConstraints)
+  {
+    assert(pb.baseMotionConstraint.getGradient().cols() == 2*N);
+    assert(pb.baseMotionConstraint.getGradient().rows() == M2);
+  }
+  if (config.withTiltMotionConstraints)
+  {
+    assert(pb.tiltMotionConstraint.getGradient().cols() == 4*N);
+    assert(pb.tiltMotionConstraint.getGradient().rows() == M4);
+  }
+
+  QPConstantPartPtr part(new QPConstantPart);
+  part->weighting = weighting;
+  part->config = config;
+
+  part->qpMatrix.Q.setZero(4*N, 4*N);
+  part->qpMatrix.p.setZero(4*N, 1);
+  part->qpMatrix.A.setZero(M, 4*N);
+  part->qpMatrix.bl.setZero(M, 1);
+  part->qpMatrix.bu.setZero(M, 1);
+  part->qpMatrix.xl.setZero(4*N, 1);
+  part->qpMatrix.xu.setZero(4*N, 1);
+
+  if (weighting.velocityTracking>0.0)
+  {
+    pb.velTrackingObj.getHessian().addTo(part->qpMatrix.Q, weighting.velocityTracking, 2*N);
+  }
+  if (weighting.positionTracking>0.0)
+  {
+    pb.posTrackingObj.getHessian().addTo(part->qpMatrix.Q, weighting.positionTracking, 2*N);
+  }
+  if (weighting.copCentering>0.0)
+  {
+    pb.copCenteringObj.getHessian().addTo(part->qpMatrix.Q, weighting.copCentering);
+  }
+  if (weighting.comCentering>0.0)
+  {
+    pb.comCenteringObj.getHessian().addTo(part->qpMatrix.Q, weighting.comCentering);
+  }
+  if (weighting.jerkMinimization>0.0)
+  {
+    pb.jerkMinObj.getHessian().addTo(part->qpMatrix.Q, weighting.jerkMinimization);
+  }
+  if (weighting.tiltMinimization>0.0)
+  {
+    pb.tiltMinObj.getHessian().addTo(part->qpMatrix.Q, weighting.tiltMinimization);
+  }
+  if (weighting.tiltVelMinimization>0.0)
+  {
+    pb.tiltVelMinObj.getHessian().addTo(part->qpMatrix.Q, weighting.tiltVelMinimization);
+  }
+
+  if (config.withCopConstraints)
+  {
+    part->qpMatrix.A.block(0, 0, M1, 4*N) = pb.copConstraint.getGradient();
+  }
+  if (config.withBaseMotionConstraints)
+  {
+    part->qpMatrix.A.block(M1, 2*N, M2, 2*N) = pb.baseMotionConstraint.getGradient();
+  }
+  if (config.withComConstraints)
+  {
+    part->qpMatrix.A.block(M1+M2, 0, M3, 4*N) = pb.comConstraint.getGradient();
+  }
+  if (config.withTiltMotionConstraints)
+  {
+    part->qpMatrix.A.block(M1+M2+M3, 0, M4, 4*N) = pb.tiltMotionConstraint.getGradient();
+  }
+
+  part->qpMatrix.equilibrateMatrices();
+
+  part->qpMatrix.At = part->qpMatrix.A.transpose();
+  part->X.setZero(4*N);
+  part->dX.setZero(4*N);
+
+  computeAxisProblems(*part);
+  if (!part->axesAreDecoupled)
+  {
+    part->qpSolver.reset(createQPSolver(config, 4*N, M));
+  }
+
+  return part;
 }
 
 template <typename Scalar>
-void ZebulonWalkgen<Scalar>::computeNormalizationFactor(MatrixX& Q, MatrixX& A)
+QPSolver<Scalar>* ZebulonWalkgen<Scalar>::createQPSolver(
+    const ZebulonWalkgenConfig<Scalar>& config, int nbVar, int nbCtr) const
 {
-  int Qr = Q.rows();
-  int Qc = Q.cols();
-  invObjNormFactor_ = 1.0f;
-  for(int i=0; i<Qr; ++i)
+  if (config.withPresolve)
+  {
+    return new PresolvedQPSolver<Scalar>(nbVar, nbCtr, &makeQPSolver<Scalar>);
+  }
+  return makeQPSolver<Scalar>(nbVar, nbCtr);
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::computeAxisProblems(QPConstantPart& part) const
+{
+  int N = part.qpMatrix.Q.rows()/4;
+  const MatrixX& Q = part.qpMatrix.Q;
+  const MatrixX& A = part.qpMatrix.A;
+
+  // Variables are ordered as [comX, comY, baseX, baseY]
+  std::vector<int> varAxis(4*N);
+  for(int j=0; j<4*N; ++j)
   {
-    for(int j=0; j<Qc; ++j)
+    varAxis[j] = (j/N)%2;
+  }
+
+  // The rows of the tilt motion constraint are updated in place when the
+  // yaw changes, and couple the axes unless it is a multiple of pi/2
+  part.axesAreDecoupled = !part.config.withTiltMotionConstraints;
+  for(int j=0; j<4*N && part.axesAreDecoupled; ++j)
+  {
+    for(int i=0; i<4*N; ++i)
+    {
+      if (varAxis[i]!=varAxis[j] && Q(i, j)!=0)
+      {
+        part.axesAreDecoupled = false;
+        break;
+      }
+    }
+  }
+
+  // Empty rows are given to the X axis
+  std::vector<int> ctrAxis(A.rows(), 0);
+  for(int i=0; i<A.rows() && part.axesAreDecoupled; ++i)
+  {
+    bool hasX = false;
+    bool hasY = false;
+    for(int j=0; j<4*N; ++j)
     {
-      Scalar v = std::abs(Q(i, j));
-      if (v>Constant<Scalar>::EPSILON && v<invObjNormFactor_)
+      if (A(i, j)!=0)
       {
-        invObjNormFactor_ = v;
+        hasX = hasX || varAxis[j]==0;
+        hasY = hasY || varAxis[j]==1;
       }
     }
+    part.axesAreDecoupled = !(hasX && hasY);
+    ctrAxis[i] = hasY ? 1 : 0;
+  }
+
+  for(int axis=0; axis<2; ++axis)
+  {
+    part.axisVariables[axis].clear();
+    part.axisConstraints[axis].clear();
+    part.axisQPSolver[axis].reset();
+  }
+
+  if (!part.axesAreDecoupled)
+  {
+    return;
+  }
+
+  for(int j=0; j<4*N; ++j)
+  {
+    part.axisVariables[varAxis[j]].push_back(j);
+  }
+  for(int i=0; i<A.rows(); ++i)
+  {
+    part.axisConstraints[ctrAxis[i]].push_back(i);
   }
-  invObjNormFactor_ = 1.0f/invObjNormFactor_;
 
-  int Ar = A.rows();
-  int Ac = A.cols();
-  invCtrNormFactor_ = 1.0f;
-  for(int i=0; i<Ar; ++i)
+  for(int axis=0; axis<2; ++axis)
   {
-    for(int j=0; j<Ac; ++j)
+    const std::vector<int>& var = part.axisVariables[axis];
+    const std::vector<int>& ctr = part.axisConstraints[axis];
+    int nbVar = var.size();
+    int nbCtr = ctr.size();
+    QPMatrices<Scalar>& m = part.axisQPMatrix[axis];
+
+    m.Q.resize(nbVar, nbVar);
+    m.A.resize(nbCtr, nbVar);
+    for(int jj=0; jj<nbVar; ++jj)
     {
-      Scalar v = std::abs(A(i, j));
-      if (v>Constant<Scalar>::EPSILON && v<invCtrNormFactor_)
+      for(int ii=0; ii<nbVar; ++ii)
       {
-        invCtrNormFactor_ = v;
+        m.Q(ii, jj) = Q(var[ii], var[jj]);
       }
+      for(int ii=0; ii<nbCtr; ++ii)
+      {
+        m.A(ii, jj) = A(ctr[ii], var[jj]);
+      }
+    }
+    m.At = m.A.transpose();
+    m.p.resize(nbVar);
+    m.xl.resize(nbVar);
+    m.xu.resize(nbVar);
+    m.bl.resize(nbCtr);
+    m.bu.resize(nbCtr);
+
+    part.axisDX[axis].setZero(nbVar);
+    part.axisQPSolver[axis].reset(createQPSolver(part.config, nbVar, nbCtr));
+  }
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::initializeSolvers(QPConstantPart& part) const
+{
+  // The first solve of a solver factorizes Q and A, next ones are hot starts
+  QPMatrices<Scalar>& m = part.qpMatrix;
+  m.p.setZero(m.Q.rows());
+  m.xl.fill(Scalar(-10e10));
+  m.xu.fill(Scalar(10e10));
+  m.bl.fill(Scalar(-10e10));
+  m.bu.fill(Scalar(10e10));
+  m.equilibrateVectors();
+
+  VectorX sol(m.Q.rows());
+  if (!part.axesAreDecoupled)
+  {
+    part.qpSolver->solve(m, sol, false);
+    return;
+  }
+
+  for(int axis=0; axis<2; ++axis)
+  {
+    QPMatrices<Scalar>& am = part.axisQPMatrix[axis];
+    am.p.setZero();
+    am.xl.fill(Scalar(-10e10));
+    am.xu.fill(Scalar(10e10));
+    am.bl.fill(Scalar(-10e10));
+    am.bu.fill(Scalar(10e10));
+    part.axisQPSolver[axis]->solve(am, part.axisDX[axis], false);
+  }
+}
+
+template <typename Scalar>
+bool ZebulonWalkgen<Scalar>::solveAxisProblem(int axis)
+{
+  qp_->axisSolutionFound[axis] =
+      qp_->axisQPSolver[axis]->solve(qp_->axisQPMatrix[axis], qp_->axisDX[axis], true);
+  return qp_->axisSolutionFound[axis];
+}
+
+template <typename Scalar>
+bool ZebulonWalkgen<Scalar>::solveAxisProblems()
+{
+  // The vectors of qp_->qpMatrix are already equilibrated, and so are the
+  // matrices of both axes
+  for(int axis=0; axis<2; ++axis)
+  {
+    const std::vector<int>& var = qp_->axisVariables[axis];
+    const std::vector<int>& ctr = qp_->axisConstraints[axis];
+    QPMatrices<Scalar>& m = qp_->axisQPMatrix[axis];
+
+    for(size_t jj=0; jj<var.size(); ++jj)
+    {
+      m.p(jj) = qp_->qpMatrix.p(var[jj]);
+      m.xl(jj) = qp_->qpMatrix.xl(var[jj]);
+      m.xu(jj) = qp_->qpMatrix.xu(var[jj]);
+    }
+    for(size_t ii=0; ii<ctr.size(); ++ii)
+    {
+      m.bl(ii) = qp_->qpMatrix.bl(ctr[ii]);
+      m.bu(ii) = qp_->qpMatrix.bu(ctr[ii]);
     }
   }
-  invCtrNormFactor_ = 1.0f/invCtrNormFactor_;
+
+  if (config_.withParallelAxisSolve)
+  {
+    if (!axisScheduler_)
+    {
+      axisScheduler_.reset(new WalkgenScheduler(2));
+    }
+    // The solves are given by reference, so that no request allocates
+    axisScheduler_->add(0, boost::ref(axisSolves_[0]));
+    axisScheduler_->add(1, boost::ref(axisSolves_[1]));
+    axisScheduler_->run();
+  }
+  else
+  {
+    solveAxisProblem(0);
+    solveAxisProblem(1);
+  }
+
+  for(int axis=0; axis<2; ++axis)
+  {
+    const std::vector<int>& var = qp_->axisVariables[axis];
+    for(size_t jj=0; jj<var.size(); ++jj)
+    {
+      qp_->dX(var[jj]) = qp_->axisDX[axis](jj);
+    }
+  }
+
+  return qp_->axisSolutionFound[0] && qp_->axisSolutionFound[1];
+}
+
+template <typename Scalar>
+void ZebulonWalkgen<Scalar>::shiftWarmStart()
+{
+  int N = nbSamples_;
+  const VectorX& periods = problem_->lipModel.getSamplingPeriods();
+
+  // With different sampling periods, the jerks are shifted in time by the
+  // first period rather than by one sample. The samples after N being the
+  // last one, they are shifted as if it was extrapolated as constant.
+  Tools::shiftSamples<Scalar>(X_, 0, periods, 4);
+
+  // All the bounds and constraint rows are stored sample by sample,
+  // in blocks of N rows
+  if (qp_->axesAreDecoupled)
+  {
+    for(int axis=0; axis<2; ++axis)
+    {
+      VectorX& dual = qp_->axisDual[axis];
+      qp_->axisQPSolver[axis]->getDualSolution(dual);
+      assert(dual.size()%N == 0);
+      Tools::shiftSamples<Scalar>(dual, 0, periods, N, dual.size()/N);
+      qp_->axisQPSolver[axis]->setDualGuess(dual);
+    }
+  }
+  else
+  {
+    VectorX& dual = qp_->dual;
+    qp_->qpSolver->getDualSolution(dual);
+    assert(dual.size()%N == 0);
+    Tools::shiftSamples<Scalar>(dual, 0, periods, N, dual.size()/N);
+    qp_->qpSolver->setDualGuess(dual);
+  }
 }
 
   MPC_WALKGEN_INSTANTIATE_CLASS_TEMPLATE(ZebulonWalkgen);
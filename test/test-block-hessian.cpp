@@ -0,0 +1,63 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\file test-block-hessian.cpp
+///\brief Test the symmetric block Hessian storage
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mpc_walkgen_gtest.h"
+#include <mpc-walkgen/blockhessian.h>
+
+TYPED_TEST(MpcWalkgenTest, blockHessian)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam)
+
+  MatrixX a(2, 2);
+  a << 2.0, 1.0,
+       1.0, 3.0;
+  MatrixX b(2, 2);
+  b << 1.0, 2.0,
+       3.0, 4.0;
+
+  BlockHessian<TypeParam> h;
+  h.reset(3, 2);
+  int indexA = h.addBlock(a);
+  int indexB = h.addBlock(b);
+  h.setBlock(0, 0, indexA);
+  h.setBlock(2, 2, h.addBlock(a));
+  h.setBlock(2, 0, indexB, -2.0);
+
+  // Identical blocks are stored once
+  ASSERT_EQ(h.getNbStoredBlocks(), 2);
+
+  MatrixX dense = MatrixX::Zero(6, 6);
+  dense.block(0, 0, 2, 2) = a;
+  dense.block(4, 4, 2, 2) = a;
+  dense.block(4, 0, 2, 2) = -2.0*b;
+  dense.block(0, 4, 2, 2) = -2.0*b.transpose();
+
+  ASSERT_EQ(h.rows(), 6);
+  ASSERT_EQ(h.cols(), 6);
+  ASSERT_TRUE(h.toDense().isApprox(dense));
+  for(int i=0; i<6; ++i)
+  {
+    for(int j=0; j<6; ++j)
+    {
+      ASSERT_NEAR(h(i, j), dense(i, j), Constant<TypeParam>::EPSILON);
+    }
+  }
+
+  VectorX x(6);
+  x << 1.0, -1.0, 0.5, 2.0, -3.0, 0.25;
+  VectorX res;
+  h.multiply(x, res);
+  ASSERT_TRUE(res.isApprox(dense*x));
+
+  MatrixX q = MatrixX::Identity(8, 8);
+  h.addTo(q, 0.5, 2);
+  MatrixX expected = MatrixX::Identity(8, 8);
+  expected.block(2, 2, 6, 6) += 0.5*dense;
+  ASSERT_TRUE(q.isApprox(expected));
+}
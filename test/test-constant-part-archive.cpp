@@ -0,0 +1,183 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\file test-constant-part-archive.cpp
+///\brief Test the serialization of the constant parts of the walkgens
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mpc_walkgen_gtest.h"
+#include <mpc-walkgen/constant_part_archive.h>
+#include <mpc-walkgen/zebulon_walkgen.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+TYPED_TEST(MpcWalkgenTest, constantPartArchive)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam)
+
+  bool flag = true;
+  int count = -3;
+  TypeParam value = static_cast<TypeParam>(0.25);
+  std::string name("preset");
+  std::vector<int> indices(3, 7);
+  MatrixX m = MatrixX::Constant(2, 3, 1.5);
+  Vector3 v(1.0, 2.0, 3.0);
+
+  ConstantPartArchive<TypeParam> saved;
+  saved.process(flag);
+  saved.process(count);
+  saved.process(value);
+  saved.process(name);
+  saved.process(indices);
+  saved.process(m);
+  saved.process(v);
+  const std::vector<char> data = saved.getData();
+  ASSERT_EQ(data.size()%8, 0u);
+
+  bool loadedFlag = false;
+  int loadedCount = 0;
+  TypeParam loadedValue = 0;
+  std::string loadedName;
+  std::vector<int> loadedIndices;
+  MatrixX loadedM;
+  Vector3 loadedV = Vector3::Zero();
+
+  ConstantPartArchive<TypeParam> loaded(&data[0], data.size());
+  ASSERT_TRUE(loaded.isLoading());
+  loaded.process(loadedFlag);
+  loaded.process(loadedCount);
+  loaded.process(loadedValue);
+  loaded.process(loadedName);
+  loaded.process(loadedIndices);
+  loaded.process(loadedM);
+  loaded.process(loadedV);
+  ASSERT_TRUE(loaded.isAtEnd());
+  ASSERT_EQ(loadedFlag, flag);
+  ASSERT_EQ(loadedCount, count);
+  ASSERT_EQ(loadedValue, value);
+  ASSERT_EQ(loadedName, name);
+  ASSERT_TRUE(loadedIndices==indices);
+  ASSERT_TRUE(loadedM==m);
+  ASSERT_TRUE(loadedV==v);
+
+  // Truncated data, or data read past its end, is rejected
+  ConstantPartArchive<TypeParam> truncated(&data[0], data.size() - 8);
+  ASSERT_FALSE(truncated.isValid());
+
+  std::stringstream stream;
+  stream.write(&data[0], data.size());
+  std::vector<char> readData;
+  ASSERT_TRUE(ConstantPartArchive<TypeParam>::readData(stream, readData));
+  ASSERT_TRUE(readData==data);
+  ConstantPartArchive<TypeParam> tooLong(&readData[0], readData.size());
+  for(int i=0; i<10; ++i)
+  {
+    tooLong.process(loadedM);
+  }
+  ASSERT_FALSE(tooLong.isValid());
+
+  // So is data of another version
+  std::vector<char> otherVersion = data;
+  otherVersion[4] += 1;
+  ConstantPartArchive<TypeParam> wrongVersion(&otherVersion[0], otherVersion.size());
+  ASSERT_FALSE(wrongVersion.isValid());
+}
+
+template <typename Scalar>
+void setupZebulon(MPCWalkgen::ZebulonWalkgen<Scalar>& walkgen)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(Scalar)
+
+  walkgen.setNbSamples(5);
+  VectorX samplingPeriods(2);
+  samplingPeriods << 0.1f, 0.2f;
+  walkgen.setSamplingPeriods(samplingPeriods);
+  walkgen.setComBodyHeight(0.73f);
+  walkgen.setComBaseHeight(0.13f);
+  walkgen.setBodyMass(13.5f);
+  walkgen.setBaseMass(16.5f);
+
+  vectorOfVector3 p(4);
+  p[0] = Vector3(0.1f, 0.1f, 0.0f);
+  p[1] = Vector3(-0.1f, 0.1f, 0.0f);
+  p[2] = Vector3(-0.1f, -0.1f, 0.0f);
+  p[3] = Vector3(0.1f, -0.1f, 0.0f);
+  walkgen.setBaseCopHull(p);
+  walkgen.setBaseComHull(p);
+
+  ZebulonWalkgenWeighting<Scalar> weighting;
+  weighting.velocityTracking = 1.0f;
+  weighting.jerkMinimization = 0.001f;
+  weighting.copCentering = 0.1f;
+  weighting.comCentering = 0.1f;
+  ZebulonWalkgenConfig<Scalar> config;
+  config.withPeriodWeighting = true;
+  walkgen.setWeightings(weighting);
+  walkgen.setConfig(config);
+  weighting.positionTracking = 1.0f;
+  walkgen.addPreset("tracking", weighting, config);
+}
+
+template <typename Scalar>
+void solveZebulon(MPCWalkgen::ZebulonWalkgen<Scalar>& walkgen)
+{
+  typedef typename MPCWalkgen::Type<Scalar>::VectorX VectorX;
+
+  const int nbSamples = walkgen.getNbSamples();
+  walkgen.setVelRefInWorldFrame(VectorX::Constant(2*nbSamples, static_cast<Scalar>(0.1)));
+  walkgen.setPosRefInWorldFrame(VectorX::Zero(2*nbSamples));
+  walkgen.setCopRefInLocalFrame(VectorX::Zero(2*nbSamples));
+  walkgen.setComRefInLocalFrame(VectorX::Zero(2*nbSamples));
+  ASSERT_TRUE(walkgen.solve(static_cast<Scalar>(0.02)));
+}
+
+TYPED_TEST(MpcWalkgenTest, zebulonConstantPart)
+{
+  using namespace MPCWalkgen;
+
+  ZebulonWalkgen<TypeParam> walkgen;
+  setupZebulon(walkgen);
+
+  std::stringstream stream;
+  walkgen.saveConstantPart(stream);
+  const std::string data = stream.str();
+
+  ZebulonWalkgen<TypeParam> loaded;
+  ASSERT_TRUE(loaded.loadConstantPart(stream));
+  ASSERT_EQ(loaded.getNbSamples(), 5);
+
+  // The loaded walkgen saves the same models and matrices, and gives the
+  // same solutions
+  std::stringstream loadedStream;
+  loaded.saveConstantPart(loadedStream);
+  const std::string loadedData = loadedStream.str();
+  ZebulonWalkgen<TypeParam> reloaded;
+  ASSERT_TRUE(reloaded.loadConstantPart(loadedData.data(), loadedData.size()));
+  ASSERT_EQ(reloaded.getNbSamples(), 5);
+
+  solveZebulon(walkgen);
+  solveZebulon(loaded);
+  ASSERT_TRUE(loaded.getBaseStateX().isApprox(walkgen.getBaseStateX(), 1e-3f));
+  ASSERT_TRUE(loaded.getComStateY().isApprox(walkgen.getComStateY(), 1e-3f));
+
+  ZebulonWalkgen<TypeParam> tracking;
+  setupZebulon(tracking);
+  tracking.selectPreset("tracking");
+  reloaded.selectPreset("tracking");
+  solveZebulon(tracking);
+  solveZebulon(reloaded);
+  ASSERT_TRUE(reloaded.getBaseStateX().isApprox(tracking.getBaseStateX(), 1e-3f));
+
+  // Invalid data is rejected, and the walkgen is left unchanged
+  ZebulonWalkgen<TypeParam> unchanged;
+  const int nbSamples = unchanged.getNbSamples();
+  ASSERT_FALSE(unchanged.loadConstantPart(data.data(), data.size() - 8));
+  std::string otherType = data;
+  otherType[24 + 8] = 'X';
+  ASSERT_FALSE(unchanged.loadConstantPart(otherType.data(), otherType.size()));
+  ASSERT_EQ(unchanged.getNbSamples(), nbSamples);
+}
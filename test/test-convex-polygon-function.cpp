@@ -11,6 +11,7 @@
 #include "mpc_walkgen_gtest.h"
 #include <mpc-walkgen/type.h>
 #include <mpc-walkgen/convexpolygon.h>
+#include <boost/math/constants/constants.hpp>
 
 using namespace MPCWalkgen;
 
@@ -127,3 +128,62 @@ TYPED_TEST(MpcWalkgenTest, DISABLED_getConvexPolygon)
   ASSERT_TRUE(convexSet[1].isApprox(p1[4]));
   ASSERT_TRUE(convexSet[2].isApprox(p1[1]));
 }
+
+TYPED_TEST(MpcWalkgenTest, getArea)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam);
+
+  vectorOfVector2 p(5);
+  createStandardConvexSet<TypeParam>(p);
+
+  ConvexPolygon<TypeParam> convexPolygon(p);
+  ASSERT_NEAR(convexPolygon.getArea(), 4.0, Constant<TypeParam>::EPSILON);
+  ASSERT_NEAR(ConvexPolygon<TypeParam>().getArea(), 0.0, Constant<TypeParam>::EPSILON);
+}
+
+TYPED_TEST(MpcWalkgenTest, simplifyVertices)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam);
+
+  // Aligned vertices are removed without any area loss
+  vectorOfVector2 square(8);
+  square[0] = Vector2(-1.0, -1.0);
+  square[1] = Vector2(0.0, -1.0);
+  square[2] = Vector2(1.0, -1.0);
+  square[3] = Vector2(1.0, 0.0);
+  square[4] = Vector2(1.0, 1.0);
+  square[5] = Vector2(0.0, 1.0);
+  square[6] = Vector2(-1.0, 1.0);
+  square[7] = Vector2(-1.0, 0.0);
+
+  vectorOfVector2 simplified =
+      ConvexPolygon<TypeParam>::simplifyVertices(square, 4, 0.0);
+  ASSERT_EQ(4u, simplified.size());
+  ASSERT_NEAR(ConvexPolygon<TypeParam>::computeArea(simplified), 4.0,
+              Constant<TypeParam>::EPSILON);
+
+  // A finely sampled disc
+  const int nbPoints = 32;
+  vectorOfVector2 disc(nbPoints);
+  for(int i=0; i<nbPoints; ++i)
+  {
+    TypeParam angle = 2*boost::math::constants::pi<TypeParam>()*i/nbPoints;
+    disc[i] = Vector2(std::cos(angle), std::sin(angle));
+  }
+  TypeParam discArea = ConvexPolygon<TypeParam>::computeArea(disc);
+
+  simplified = ConvexPolygon<TypeParam>::simplifyVertices(disc, 8, 0.2);
+  ASSERT_EQ(8u, simplified.size());
+  ASSERT_TRUE(ConvexPolygon<TypeParam>::computeArea(simplified) >= 0.8*discArea);
+  for(size_t i=0; i<simplified.size(); ++i)
+  {
+    ASSERT_NEAR(simplified[i].norm(), 1.0, Constant<TypeParam>::EPSILON);
+  }
+
+  // The area loss bound has priority over the number of vertices
+  simplified = ConvexPolygon<TypeParam>::simplifyVertices(disc, 8, 0.01);
+  ASSERT_TRUE(simplified.size() > 8u);
+  ASSERT_TRUE(ConvexPolygon<TypeParam>::computeArea(simplified) >= 0.99*discArea);
+}
@@ -0,0 +1,83 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\file test-explicit-mpc-table.cpp
+///\brief Test the explicit MPC table point location and serialization
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mpc_walkgen_gtest.h"
+#include <mpc-walkgen/explicit_mpc_table.h>
+#include <sstream>
+#include <string>
+#include <cstring>
+
+TYPED_TEST(MpcWalkgenTest, explicitMPCTable)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam)
+
+  // Saturated law u = clamp(-theta0 - theta1, -1, 1), in three regions
+  ExplicitMPCTable<TypeParam> table;
+  table.reset(2);
+
+  VectorX f(2);
+  f << -1.0, -1.0;
+  MatrixX a(2, 2);
+  a << 1.0, 1.0,
+       -1.0, -1.0;
+  VectorX b(2);
+  b << 1.0, 1.0;
+  table.addRegion(a, b, f, 0.0);
+
+  MatrixX aHigh(1, 2);
+  aHigh << -1.0, -1.0;
+  VectorX bHigh(1);
+  bHigh << -1.0;
+  table.addRegion(aHigh, bHigh, VectorX::Zero(2), -1.0);
+
+  MatrixX aLow(1, 2);
+  aLow << 1.0, 1.0;
+  VectorX bLow(1);
+  bLow << -1.0;
+  table.addRegion(aLow, bLow, VectorX::Zero(2), 1.0);
+
+  ASSERT_EQ(table.getNbRegions(), 3);
+
+  VectorX theta(2);
+  theta << 0.25, 0.5;
+  int region = table.findRegion(theta);
+  ASSERT_EQ(region, 0);
+  ASSERT_NEAR(table.computeControl(region, theta), -0.75, Constant<TypeParam>::EPSILON);
+
+  theta << 2.0, 1.0;
+  region = table.findRegion(theta, 0);
+  ASSERT_EQ(region, 1);
+  ASSERT_NEAR(table.computeControl(region, theta), -1.0, Constant<TypeParam>::EPSILON);
+
+  theta << -2.0, -1.0;
+  ASSERT_EQ(table.findRegion(theta, 1), 2);
+
+  // Serialized table, loaded or used in place
+  std::stringstream stream;
+  table.save(stream);
+  const std::string data = stream.str();
+
+  ExplicitMPCTable<TypeParam> loaded;
+  ASSERT_TRUE(loaded.load(stream));
+  ASSERT_EQ(loaded.getNbRegions(), 3);
+  ASSERT_EQ(loaded.findRegion(theta), 2);
+
+  std::vector<double> buffer(data.size()/sizeof(double) + 1);
+  std::memcpy(&buffer[0], data.data(), data.size());
+  ExplicitMPCTable<TypeParam> inPlace;
+  ASSERT_TRUE(inPlace.setData(reinterpret_cast<const char*>(&buffer[0]), data.size()));
+  ASSERT_EQ(inPlace.getNbParameters(), 2);
+  theta << 0.25, 0.5;
+  ASSERT_NEAR(inPlace.computeControl(inPlace.findRegion(theta), theta), -0.75,
+              Constant<TypeParam>::EPSILON);
+
+  // Truncated data is rejected
+  ASSERT_FALSE(inPlace.setData(reinterpret_cast<const char*>(&buffer[0]), data.size() - 1));
+  ASSERT_EQ(inPlace.getNbRegions(), 0);
+}
@@ -0,0 +1,200 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\file test-fixed-horizon-walkgen.cpp
+///\brief Test the walkgens whose number of samples is fixed at compile time
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mpc_walkgen_gtest.h"
+#include <mpc-walkgen/fixed_horizon_walkgen.h>
+#include <mpc-walkgen/trajectory_walkgen.h>
+#include <cstdlib>
+
+#if defined(__GLIBC__)
+// The allocations of the whole process, Eigen included, go through malloc,
+// which is replaced here to count them
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+
+static bool countAllocations = false;
+static int nbAllocations = 0;
+
+extern "C" void* malloc(size_t size)
+{
+  if (countAllocations)
+  {
+    ++nbAllocations;
+  }
+  return __libc_malloc(size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size)
+{
+  if (countAllocations)
+  {
+    ++nbAllocations;
+  }
+  return __libc_realloc(ptr, size);
+}
+#define MPC_WALKGEN_COUNT_ALLOCATIONS
+#endif
+
+TYPED_TEST(MpcWalkgenTest, fixedHorizonTrajectoryWalkgen)
+{
+  using namespace MPCWalkgen;
+  typedef FixedHorizonTrajectoryWalkgen<TypeParam, 10> Walkgen;
+
+  Walkgen walkgen;
+  walkgen.setSamplingPeriod(0.1f);
+  walkgen.setVelLimit(1.0f);
+  walkgen.setAccLimit(1.0f);
+  walkgen.setJerkLimit(1.0f);
+
+  TrajectoryWalkgenWeighting<TypeParam> weighting;
+  weighting.velocityTracking = 1.0f;
+  weighting.jerkMinimization = 0.0001f;
+  walkgen.setWeightings(weighting);
+  TrajectoryWalkgenConfig<TypeParam> config;
+  config.withMotionConstraints = true;
+  walkgen.setConfig(config);
+
+  // The first solves initialize the solver, the next ones reuse its buffers
+  typename Walkgen::VectorN velRef = Walkgen::VectorN::Constant(0.5f);
+  walkgen.setVelRefInWorldFrame(velRef);
+  for(int i=0; i<5; ++i)
+  {
+    ASSERT_TRUE(walkgen.solve(0.02f));
+  }
+
+#ifdef MPC_WALKGEN_COUNT_ALLOCATIONS
+  nbAllocations = 0;
+  countAllocations = true;
+#endif
+  bool solutionFound = true;
+  for(int i=0; i<10; ++i)
+  {
+    velRef.fill(static_cast<TypeParam>(i<5 ? 0.8 : -0.2));
+    walkgen.setVelRefInWorldFrame(velRef);
+    solutionFound = walkgen.solve(0.02f) && solutionFound;
+  }
+#ifdef MPC_WALKGEN_COUNT_ALLOCATIONS
+  countAllocations = false;
+  ASSERT_EQ(nbAllocations, 0);
+#endif
+  ASSERT_TRUE(solutionFound);
+}
+
+TYPED_TEST(MpcWalkgenTest, fixedHorizonTrajectoryWalkgenMatchesDynamic)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam)
+  const int N = 8;
+  typedef FixedHorizonTrajectoryWalkgen<TypeParam, N> Walkgen;
+
+  Walkgen fixed;
+  TrajectoryWalkgen<TypeParam> dynamic;
+  dynamic.setNbSamples(N);
+
+  fixed.setSamplingPeriod(0.1f);
+  dynamic.setSamplingPeriod(0.1f);
+  fixed.setVelLimit(1.0f);
+  dynamic.setVelLimit(1.0f);
+  fixed.setAccLimit(2.0f);
+  dynamic.setAccLimit(2.0f);
+  fixed.setJerkLimit(5.0f);
+  dynamic.setJerkLimit(5.0f);
+  fixed.setState(Vector3(0.1f, 0.2f, 0.0f));
+  dynamic.setState(Vector3(0.1f, 0.2f, 0.0f));
+
+  TrajectoryWalkgenWeighting<TypeParam> weighting;
+  weighting.velocityTracking = 1.0f;
+  weighting.positionTracking = 0.5f;
+  weighting.jerkMinimization = 0.001f;
+  fixed.setWeightings(weighting);
+  dynamic.setWeightings(weighting);
+  TrajectoryWalkgenConfig<TypeParam> config;
+  config.withMotionConstraints = true;
+  config.withWarmStartShift = true;
+  fixed.setConfig(config);
+  dynamic.setConfig(config);
+
+  typename Walkgen::VectorN velRef;
+  typename Walkgen::VectorN posRef;
+  for(int i=0; i<20; ++i)
+  {
+    // The velocity reference is out of the limits on some solves, to
+    // activate the constraints
+    velRef.fill(static_cast<TypeParam>(i<10 ? 1.5 : -0.5));
+    posRef.setLinSpaced(static_cast<TypeParam>(0.1*i), static_cast<TypeParam>(0.1*i + 0.7));
+    fixed.setVelRefInWorldFrame(velRef);
+    dynamic.setVelRefInWorldFrame(VectorX(velRef));
+    fixed.setPosRefInWorldFrame(posRef);
+    dynamic.setPosRefInWorldFrame(VectorX(posRef));
+
+    ASSERT_TRUE(fixed.solve(0.05f));
+    ASSERT_TRUE(dynamic.solve(0.05f));
+    ASSERT_NEAR(fixed.getJerk(), dynamic.getJerk(), 1e-3f);
+    ASSERT_TRUE(fixed.getState().isApprox(dynamic.getState(), 1e-3f));
+  }
+}
+
+TYPED_TEST(MpcWalkgenTest, fixedHorizonZebulonWalkgen)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam)
+  typedef FixedHorizonZebulonWalkgen<TypeParam, 10> Walkgen;
+
+  Walkgen walkgen;
+  ASSERT_EQ(walkgen.getNbSamples(), 10);
+  walkgen.setSamplingPeriod(0.1f);
+  walkgen.setComBodyHeight(0.73f);
+  walkgen.setComBaseHeight(0.13f);
+  walkgen.setBodyMass(13.5f);
+  walkgen.setBaseMass(16.5f);
+
+  vectorOfVector3 p(4);
+  p[0] = Vector3(0.1f, 0.1f, 0.0f);
+  p[1] = Vector3(-0.1f, 0.1f, 0.0f);
+  p[2] = Vector3(-0.1f, -0.1f, 0.0f);
+  p[3] = Vector3(0.1f, -0.1f, 0.0f);
+  walkgen.setBaseCopHull(p);
+  walkgen.setBaseComHull(p);
+
+  ZebulonWalkgenWeighting<TypeParam> weighting;
+  weighting.velocityTracking = 1.0f;
+  weighting.jerkMinimization = 0.001f;
+  weighting.copCentering = 0.1f;
+  weighting.comCentering = 0.1f;
+  walkgen.setWeightings(weighting);
+  ZebulonWalkgenConfig<TypeParam> config;
+  config.withCopConstraints = true;
+  config.withComConstraints = true;
+  walkgen.setConfig(config);
+
+  typename Walkgen::Vector2N velRef = Walkgen::Vector2N::Constant(0.2f);
+  walkgen.setVelRefInWorldFrame(velRef);
+  for(int i=0; i<5; ++i)
+  {
+    ASSERT_TRUE(walkgen.solve(0.02f));
+  }
+
+#ifdef MPC_WALKGEN_COUNT_ALLOCATIONS
+  nbAllocations = 0;
+  countAllocations = true;
+#endif
+  bool solutionFound = true;
+  for(int i=0; i<10; ++i)
+  {
+    velRef.fill(static_cast<TypeParam>(i<5 ? 0.5 : -0.2));
+    walkgen.setVelRefInWorldFrame(velRef);
+    walkgen.setCopRefInLocalFrame(Walkgen::Vector2N::Zero());
+    solutionFound = walkgen.solve(0.02f) && solutionFound;
+  }
+#ifdef MPC_WALKGEN_COUNT_ALLOCATIONS
+  countAllocations = false;
+  ASSERT_EQ(nbAllocations, 0);
+#endif
+  ASSERT_TRUE(solutionFound);
+  ASSERT_EQ(walkgen.getNbSamples(), 10);
+}
@@ -0,0 +1,69 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\file test-horizon-tuner.cpp
+///\brief Test the choice of the number of samples from the solve times
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mpc_walkgen_gtest.h"
+#include <mpc-walkgen/horizon_tuner.h>
+
+TYPED_TEST(MpcWalkgenTest, horizonTuner)
+{
+  using namespace MPCWalkgen;
+
+  HorizonTuner<TypeParam> tuner;
+  ASSERT_FALSE(tuner.isEnabled());
+  ASSERT_EQ(tuner.addSolveTime(1.0f, 20), 20);
+
+  HorizonTunerConfig<TypeParam> config;
+  config.minNbSamples = 10;
+  config.maxNbSamples = 30;
+  config.nbSamplesStep = 5;
+  config.solveTimeBudget = 0.01f;
+  config.windowSize = 20;
+  tuner.setConfig(config);
+  ASSERT_TRUE(tuner.isEnabled());
+
+  // Out of the bounds
+  ASSERT_EQ(tuner.addSolveTime(0.001f, 40), 30);
+
+  // The budget is respected while fewer than 5% of the solves exceed it
+  int nbSamples = 20;
+  for(int i=0; i<40; ++i)
+  {
+    nbSamples = tuner.addSolveTime(i%20==19 ? 0.02f : 0.008f, 20);
+    ASSERT_EQ(nbSamples, 20);
+  }
+  ASSERT_NEAR(tuner.getSolveTimePercentile(), 0.008f, Constant<TypeParam>::EPSILON);
+
+  // With a second one, the percentile exceeds the budget
+  ASSERT_EQ(tuner.addSolveTime(0.02f, 20), 15);
+  ASSERT_EQ(tuner.getNbSolveTimes(), 0);
+
+  // A new change needs a full window
+  for(int i=0; i<19; ++i)
+  {
+    ASSERT_EQ(tuner.addSolveTime(0.02f, 15), 15);
+  }
+  ASSERT_EQ(tuner.addSolveTime(0.02f, 15), 10);
+
+  // At the bounds
+  for(int i=0; i<20; ++i)
+  {
+    ASSERT_EQ(tuner.addSolveTime(0.02f, 10), 10);
+  }
+
+  // Once the solves are fast again, the number of samples increases
+  for(int i=0; i<18; ++i)
+  {
+    ASSERT_EQ(tuner.addSolveTime(0.001f, 10), 10);
+  }
+  ASSERT_EQ(tuner.addSolveTime(0.001f, 10), 15);
+
+  for(int i=0; i<20; ++i)
+  {
+    ASSERT_EQ(tuner.addSolveTime(0.001f, 30), 30);
+  }
+}
@@ -0,0 +1,95 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\file test-humanoid-multi-hypothesis-walkgen.cpp
+///\brief Test the selection of the step timing hypotheses
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mpc_walkgen_gtest.h"
+#include <mpc-walkgen/humanoid_multi_hypothesis_walkgen.h>
+#include <algorithm>
+#include <cmath>
+
+TYPED_TEST(MpcWalkgenTest, humanoidMultiHypothesisWalkgen)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam)
+
+  const int nbSamples = 16;
+  const TypeParam stepPeriods[2] = {0.8f, 0.5f};
+
+  HumanoidWalkgenWeighting<TypeParam> weighting;
+  weighting.velocityTracking = 1.0f;
+  weighting.copCentering = 1.0f;
+  weighting.jerkMinimization = 0.0001f;
+  HumanoidWalkgenConfig<TypeParam> config;
+  config.withCopConstraints = true;
+
+  // Reachable positions of each foot relative to the other one, and CoP
+  // polygons of the feet, in local frame
+  vectorOfVector2 p(4);
+  p[0] = Vector2(0.2f, 0.3f);
+  p[1] = Vector2(-0.2f, 0.3f);
+  p[2] = Vector2(-0.2f, 0.1f);
+  p[3] = Vector2(0.2f, 0.1f);
+  const ConvexPolygon<TypeParam> leftKinematicPolygon(p);
+  for(int j=0; j<4; ++j)
+  {
+    p[j](1) = -p[j](1);
+  }
+  const ConvexPolygon<TypeParam> rightKinematicPolygon(p);
+  p[0] = Vector2(0.05f, 0.03f);
+  p[1] = Vector2(-0.05f, 0.03f);
+  p[2] = Vector2(-0.05f, -0.03f);
+  p[3] = Vector2(0.05f, -0.03f);
+  const ConvexPolygon<TypeParam> copPolygon(p);
+
+  // The shorter step period tracks the velocity better, the walkgen with
+  // this hypothesis only gives the committed plan
+  HumanoidWalkgen<TypeParam> single;
+  HumanoidMultiHypothesisWalkgen<TypeParam> walkgen(2);
+  ASSERT_EQ(walkgen.getNbHypotheses(), 2);
+  for(int i=0; i<3; ++i)
+  {
+    HumanoidWalkgen<TypeParam>& hypothesis = i<2 ? walkgen.getHypothesis(i) : single;
+    hypothesis.setNbSamples(nbSamples);
+    hypothesis.setSamplingPeriod(0.1f);
+    hypothesis.setStepPeriod(stepPeriods[std::min(i, 1)]);
+    hypothesis.setInitialDoubleSupportLength(0.2f);
+    hypothesis.setLeftFootKinematicConvexPolygon(leftKinematicPolygon);
+    hypothesis.setRightFootKinematicConvexPolygon(rightKinematicPolygon);
+    hypothesis.setLeftFootCopConvexPolygon(copPolygon);
+    hypothesis.setRightFootCopConvexPolygon(copPolygon);
+    hypothesis.setWeightings(weighting);
+    hypothesis.setConfig(config);
+    hypothesis.setVelRefInWorldFrame(VectorX::Constant(2*nbSamples, 0.1f));
+    hypothesis.setMove(true);
+  }
+
+  for(int k=0; k<20; ++k)
+  {
+    ASSERT_TRUE(walkgen.solve(0.02f));
+    ASSERT_TRUE(single.solve(0.02f));
+
+    // The cheaper hypothesis is committed, and the other one starts the
+    // next solve from its state
+    const int selected = walkgen.getSelectedHypothesis();
+    ASSERT_EQ(selected, 1);
+    const HumanoidWalkgen<TypeParam>& committed = walkgen.getSelectedWalkgen();
+    const HumanoidWalkgen<TypeParam>& other = walkgen.getHypothesis(1 - selected);
+    ASSERT_LE(committed.getCost(), other.getCost());
+    ASSERT_TRUE(other.getComStateX()==committed.getComStateX());
+    ASSERT_TRUE(other.getComStateY()==committed.getComStateY());
+    ASSERT_TRUE(other.getLeftFootStateX()==committed.getLeftFootStateX());
+    ASSERT_TRUE(other.getRightFootStateY()==committed.getRightFootStateY());
+    ASSERT_TRUE(committed.getComStateX()==single.getComStateX());
+    ASSERT_TRUE(committed.getComStateY()==single.getComStateY());
+
+    // The hypotheses keep their own step period, hence different costs
+    if (k>0)
+    {
+      ASSERT_GT(std::abs(committed.getCost() - other.getCost()), 1e-6f*committed.getCost());
+    }
+  }
+}
@@ -0,0 +1,95 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\file test-humanoid-walkgen.cpp
+///\brief Test the humanoid walkgen
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mpc_walkgen_gtest.h"
+#include <mpc-walkgen/humanoid_walkgen.h>
+#include <cmath>
+
+TYPED_TEST(MpcWalkgenTest, humanoidPolygonSimplification)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam)
+
+  const int nbSamples = 16;
+
+  HumanoidWalkgenWeighting<TypeParam> weighting;
+  weighting.velocityTracking = 1.0f;
+  weighting.copCentering = 1.0f;
+  weighting.jerkMinimization = 0.0001f;
+  HumanoidWalkgenConfig<TypeParam> config;
+  config.withCopConstraints = true;
+
+  // Hexagons, which the simplification turns into quadrilaterals
+  vectorOfVector2 p(6);
+  for(int j=0; j<6; ++j)
+  {
+    const TypeParam angle = static_cast<TypeParam>(j*M_PI/3 + 0.1);
+    p[j] = Vector2(0.2f*std::cos(angle), 0.2f + 0.1f*std::sin(angle));
+  }
+  const ConvexPolygon<TypeParam> leftKinematicPolygon(p);
+  for(int j=0; j<6; ++j)
+  {
+    p[j](1) = -p[j](1);
+  }
+  const ConvexPolygon<TypeParam> rightKinematicPolygon(p);
+  for(int j=0; j<6; ++j)
+  {
+    const TypeParam angle = static_cast<TypeParam>(j*M_PI/3 + 0.1);
+    p[j] = Vector2(0.05f*std::cos(angle), 0.03f*std::sin(angle));
+  }
+  const ConvexPolygon<TypeParam> copPolygon(p);
+
+  // The walkgen which simplifies the polygons must give the same solution
+  // as the one given the simplified polygons
+  HumanoidWalkgen<TypeParam> walkgens[2];
+  for(int i=0; i<2; ++i)
+  {
+    HumanoidWalkgen<TypeParam>& walkgen = walkgens[i];
+    HumanoidWalkgenConfig<TypeParam> walkgenConfig = config;
+    walkgen.setNbSamples(nbSamples);
+    walkgen.setSamplingPeriod(0.1f);
+    walkgen.setStepPeriod(0.5f);
+    walkgen.setInitialDoubleSupportLength(0.2f);
+    if (i==0)
+    {
+      walkgenConfig.maxNbPolygonVertices = 4;
+      walkgenConfig.maxPolygonAreaLossRatio = 1.0f;
+      walkgen.setLeftFootKinematicConvexPolygon(leftKinematicPolygon);
+      walkgen.setRightFootKinematicConvexPolygon(rightKinematicPolygon);
+      walkgen.setLeftFootCopConvexPolygon(copPolygon);
+      walkgen.setRightFootCopConvexPolygon(copPolygon);
+    }
+    else
+    {
+      walkgen.setLeftFootKinematicConvexPolygon(ConvexPolygon<TypeParam>(
+            ConvexPolygon<TypeParam>::simplifyVertices(
+              leftKinematicPolygon.getVertices(), 4, 1.0f)));
+      walkgen.setRightFootKinematicConvexPolygon(ConvexPolygon<TypeParam>(
+            ConvexPolygon<TypeParam>::simplifyVertices(
+              rightKinematicPolygon.getVertices(), 4, 1.0f)));
+      const ConvexPolygon<TypeParam> simplifiedCopPolygon(
+            ConvexPolygon<TypeParam>::simplifyVertices(copPolygon.getVertices(), 4, 1.0f));
+      walkgen.setLeftFootCopConvexPolygon(simplifiedCopPolygon);
+      walkgen.setRightFootCopConvexPolygon(simplifiedCopPolygon);
+    }
+    walkgen.setWeightings(weighting);
+    walkgen.setConfig(walkgenConfig);
+    walkgen.setVelRefInWorldFrame(VectorX::Constant(2*nbSamples, 0.1f));
+    walkgen.setMove(true);
+  }
+
+  for(int k=0; k<5; ++k)
+  {
+    ASSERT_TRUE(walkgens[0].solve(0.02f));
+    ASSERT_TRUE(walkgens[1].solve(0.02f));
+    ASSERT_TRUE(walkgens[0].getComStateX().isApprox(walkgens[1].getComStateX()));
+    ASSERT_TRUE(walkgens[0].getComStateY().isApprox(walkgens[1].getComStateY()));
+    ASSERT_TRUE(walkgens[0].getLeftFootStateX().isApprox(walkgens[1].getLeftFootStateX()));
+    ASSERT_TRUE(walkgens[0].getRightFootStateY().isApprox(walkgens[1].getRightFootStateY()));
+  }
+}
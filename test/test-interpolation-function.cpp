@@ -144,3 +144,28 @@ TEST_F(InterpolationTest, thirdPolynomValue)
   ASSERT_NEAR (Tools::ddPolynomValue<Real>(subfactor_, t_/T_), 266.5, Constant<Real>::EPSILON);
 }
 
+
+
+TEST_F(InterpolationTest, sampleSpline)
+{
+  const int nbSetpoints = 25;
+  const Real dt = T_/nbSetpoints;
+  Real pos[nbSetpoints], vel[nbSetpoints], acc[nbSetpoints];
+
+  interpolator_.sampleSpline(factor_, T_, dt, nbSetpoints, pos, vel, acc);
+
+  for(int i=0; i<nbSetpoints; ++i)
+  {
+    t_ = (i + 1)*dt;
+    interpolator_.selectFactors(subfactor_, factor_, t_, T_);
+
+    ASSERT_NEAR(Tools::polynomValue<Real>(subfactor_, t_/T_),
+                pos[i], Constant<Real>::EPSILON);
+    ASSERT_NEAR(Tools::dPolynomValue<Real>(subfactor_, t_/T_)/T_,
+                vel[i], Constant<Real>::EPSILON);
+    ASSERT_NEAR(Tools::ddPolynomValue<Real>(subfactor_, t_/T_)/(T_*T_),
+                acc[i], Constant<Real>::EPSILON);
+  }
+
+  ASSERT_NEAR(pos[nbSetpoints - 1], finalState_[0], Constant<Real>::EPSILON);
+}
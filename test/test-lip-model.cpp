@@ -92,3 +92,67 @@ TYPED_TEST(MpcWalkgenTest, valuesOfMatrices)
   ASSERT_NEAR(copY, 0.433333333, Constant<TypeParam>::EPSILON);
 }
 
+
+TYPED_TEST(MpcWalkgenTest, nonUniformSamplingPeriods)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam);
+
+  int nbSamples = 5;
+  bool autoCompute = true;
+  LIPModel<TypeParam> m(nbSamples, 0.1f, autoCompute);
+
+  VectorX periods(3);
+  periods << 0.05f, 0.1f, 0.2f;
+  m.setSamplingPeriods(periods);
+
+  ASSERT_EQ(m.getSamplingPeriods().size(), nbSamples);
+  ASSERT_NEAR(m.getSamplingPeriod(), 0.05f, Constant<TypeParam>::EPSILON);
+  ASSERT_NEAR(m.getSamplingPeriods()(4), 0.2f, Constant<TypeParam>::EPSILON);
+
+  VectorX jerk(nbSamples);
+  jerk << 1.0f, -2.0f, 3.0f, 0.5f, -1.0f;
+
+  Vector3 state(2.0f, 1.5f, -3.0f);
+  m.setStateX(state);
+
+  const LinearDynamic<TypeParam>& dynPos = m.getComPosLinearDynamic();
+  const LinearDynamic<TypeParam>& dynVel = m.getComVelLinearDynamic();
+  const LinearDynamic<TypeParam>& dynAcc = m.getComAccLinearDynamic();
+  VectorX pos = dynPos.S * state + dynPos.U * jerk;
+  VectorX vel = dynVel.S * state + dynVel.U * jerk;
+  VectorX acc = dynAcc.S * state + dynAcc.U * jerk;
+
+  for(int i=0; i<nbSamples; ++i)
+  {
+    m.updateStateX(jerk(i), m.getSamplingPeriods()(i));
+    ASSERT_NEAR(m.getStateX()(0), pos(i), Constant<TypeParam>::EPSILON);
+    ASSERT_NEAR(m.getStateX()(1), vel(i), Constant<TypeParam>::EPSILON);
+    ASSERT_NEAR(m.getStateX()(2), acc(i), Constant<TypeParam>::EPSILON);
+  }
+}
+
+TYPED_TEST(MpcWalkgenTest, setStates)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam)
+
+  LIPModel<TypeParam> m(10, 0.1f, true);
+
+  // The states can be given as VectorX, Vector3 or any expression of size 3
+  VectorX stateX(3);
+  stateX << 0.1f, -0.2f, 0.3f;
+  m.setStateX(stateX);
+  ASSERT_TRUE(m.getStateX() == stateX);
+
+  const Vector3 stateY(-0.4f, 0.5f, -0.6f);
+  m.setStateY(stateY);
+  ASSERT_TRUE(m.getStateY() == stateY);
+
+  VectorX states(6);
+  states << 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f;
+  m.setStateX(states.segment(3, 3));
+  ASSERT_TRUE(m.getStateX() == states.tail(3));
+  m.setStateYaw(2*states.head(3));
+  ASSERT_TRUE(m.getStateYaw() == Vector3(2.0f, 4.0f, 6.0f));
+}
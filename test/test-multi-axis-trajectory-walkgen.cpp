@@ -0,0 +1,88 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\file test-multi-axis-trajectory-walkgen.cpp
+///\brief Test the multi-axis trajectory walkgen against one walkgen per axis
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mpc_walkgen_gtest.h"
+#include <mpc-walkgen/multi_axis_trajectory_walkgen.h>
+#include <mpc-walkgen/trajectory_walkgen.h>
+#include <boost/shared_ptr.hpp>
+#include <limits>
+#include <vector>
+
+template <typename Scalar>
+void checkMultiAxisWalkgen(int nbThreads, Scalar precision)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(Scalar)
+
+  const int nbAxes = 3;
+  const int nbSamples = 10;
+  const Scalar samplingPeriod = static_cast<Scalar>(0.1);
+
+  TrajectoryWalkgenWeighting<Scalar> weighting;
+  weighting.velocityTracking = 1.0f;
+  weighting.positionTracking = 0.1f;
+  weighting.jerkMinimization = 0.0001f;
+  TrajectoryWalkgenConfig<Scalar> config;
+  config.withMotionConstraints = true;
+
+  MultiAxisTrajectoryWalkgen<Scalar> multiAxis(nbAxes);
+  multiAxis.setNbSamples(nbSamples);
+  multiAxis.setSamplingPeriod(samplingPeriod);
+  multiAxis.setWeightings(weighting);
+  multiAxis.setConfig(config);
+  multiAxis.setNbThreads(nbThreads);
+
+  // Each axis has its own limits and reference
+  std::vector< boost::shared_ptr< TrajectoryWalkgen<Scalar> > > axes(nbAxes);
+  MatrixX velRef(nbSamples, nbAxes);
+  MatrixX posRef = MatrixX::Zero(nbSamples, nbAxes);
+  for(int k=0; k<nbAxes; ++k)
+  {
+    const Scalar limit = static_cast<Scalar>(1 + k);
+    velRef.col(k).fill(static_cast<Scalar>(0.5*(k - 1)));
+
+    axes[k].reset(new TrajectoryWalkgen<Scalar>);
+    axes[k]->setNbSamples(nbSamples);
+    axes[k]->setSamplingPeriod(samplingPeriod);
+    axes[k]->setWeightings(weighting);
+    axes[k]->setConfig(config);
+    axes[k]->setVelLimit(limit);
+    axes[k]->setAccLimit(limit);
+    axes[k]->setJerkLimit(2*limit);
+    axes[k]->setVelRefInWorldFrame(VectorX(velRef.col(k)));
+    axes[k]->setPosRefInWorldFrame(VectorX(posRef.col(k)));
+
+    multiAxis.setVelLimit(k, limit);
+    multiAxis.setAccLimit(k, limit);
+    multiAxis.setJerkLimit(k, 2*limit);
+  }
+  multiAxis.setVelRefInWorldFrame(velRef);
+  multiAxis.setPosRefInWorldFrame(posRef);
+
+  const Scalar feedBackPeriod = static_cast<Scalar>(0.02);
+  for(int i=0; i<10; ++i)
+  {
+    ASSERT_TRUE(multiAxis.solve(feedBackPeriod));
+    for(int k=0; k<nbAxes; ++k)
+    {
+      ASSERT_TRUE(axes[k]->solve(feedBackPeriod));
+      ASSERT_TRUE(multiAxis.isSolutionFound(k));
+      ASSERT_NEAR(multiAxis.getJerk(k), axes[k]->getJerk(), precision);
+      ASSERT_TRUE((multiAxis.getState(k) - axes[k]->getState()).cwiseAbs().maxCoeff()
+                  <= precision);
+    }
+  }
+}
+
+TYPED_TEST(MpcWalkgenTest, multiAxisTrajectoryWalkgen)
+{
+  // The problems are the same, only the order of the operations differs
+  const TypeParam precision = 100*std::numeric_limits<TypeParam>::epsilon();
+  checkMultiAxisWalkgen<TypeParam>(1, precision);
+  checkMultiAxisWalkgen<TypeParam>(2, precision);
+}
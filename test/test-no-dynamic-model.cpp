@@ -0,0 +1,174 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\file test-no-dynamic-model.cpp
+///\brief Test the move blocking of the model without dynamic
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mpc_walkgen_gtest.h"
+#include <mpc-walkgen/model/no_dynamic_model.h>
+#include <vector>
+
+TYPED_TEST(MpcWalkgenTest, moveBlockingSizes)
+{
+  using namespace MPCWalkgen;
+
+  NoDynamicModel<TypeParam> m(16, 0.1f, true);
+  ASSERT_EQ(m.getNbVariables(), 16);
+
+  // The last size is repeated, and the last block is truncated
+  std::vector<int> moveBlocking;
+  moveBlocking.push_back(1);
+  moveBlocking.push_back(1);
+  moveBlocking.push_back(2);
+  moveBlocking.push_back(4);
+  m.setMoveBlocking(moveBlocking);
+  ASSERT_EQ(m.getNbVariables(), 6);
+  m.setNbSamples(15);
+  ASSERT_EQ(m.getNbVariables(), 6);
+  m.setNbSamples(3);
+  ASSERT_EQ(m.getNbVariables(), 3);
+
+  // Blocks of one sample are no move blocking
+  moveBlocking.assign(3, 1);
+  m.setNbSamples(16);
+  m.setMoveBlocking(moveBlocking);
+  ASSERT_EQ(m.getNbVariables(), 16);
+
+  m.setMoveBlocking(std::vector<int>());
+  ASSERT_EQ(m.getNbVariables(), 16);
+}
+
+TYPED_TEST(MpcWalkgenTest, moveBlockingDynamics)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam)
+
+  const int nbSamples = 7;
+  NoDynamicModel<TypeParam> unblocked(nbSamples, 0.1f, true);
+  NoDynamicModel<TypeParam> blocked(nbSamples, 0.1f, true);
+  std::vector<int> moveBlocking;
+  moveBlocking.push_back(1);
+  moveBlocking.push_back(2);
+  moveBlocking.push_back(3);
+  blocked.setMoveBlocking(moveBlocking);
+  ASSERT_EQ(blocked.getNbVariables(), 4);
+
+  // B copies each variable to the samples of its block: 1, 2, 3, then 1
+  MatrixX B = MatrixX::Zero(nbSamples, 4);
+  const int blockOfSample[nbSamples] = {0, 1, 1, 2, 2, 2, 3};
+  for(int i=0; i<nbSamples; ++i)
+  {
+    B(i, blockOfSample[i]) = 1;
+  }
+
+  const LinearDynamic<TypeParam>* dyn[4] = {
+    &unblocked.getPosLinearDynamic(), &unblocked.getVelLinearDynamic(),
+    &unblocked.getAccLinearDynamic(), &unblocked.getJerkLinearDynamic()};
+  const LinearDynamic<TypeParam>* blockedDyn[4] = {
+    &blocked.getPosLinearDynamic(), &blocked.getVelLinearDynamic(),
+    &blocked.getAccLinearDynamic(), &blocked.getJerkLinearDynamic()};
+  for(int i=0; i<4; ++i)
+  {
+    const MatrixX UB = dyn[i]->U*B;
+    ASSERT_EQ(blockedDyn[i]->U.rows(), nbSamples);
+    ASSERT_EQ(blockedDyn[i]->U.cols(), 4);
+    ASSERT_TRUE(blockedDyn[i]->U.isApprox(UB, Constant<TypeParam>::EPSILON));
+    ASSERT_TRUE(blockedDyn[i]->UT.isApprox(UB.transpose(), Constant<TypeParam>::EPSILON));
+    ASSERT_TRUE(blockedDyn[i]->S==dyn[i]->S);
+  }
+}
+
+TYPED_TEST(MpcWalkgenTest, moveBlockingShift)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam)
+
+  NoDynamicModel<TypeParam> m(7, 0.1f, true);
+  VectorX X(7);
+  X << 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f;
+  m.shiftVariables(X);
+  VectorX expected(7);
+  expected << 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 7.0f;
+  ASSERT_TRUE(X.isApprox(expected, Constant<TypeParam>::EPSILON));
+
+  // The jerks of the samples, 1 2 2 3 3 3 4, are shifted to 2 2 3 3 3 4 4,
+  // whose means by block are the shifted variables
+  std::vector<int> moveBlocking;
+  moveBlocking.push_back(1);
+  moveBlocking.push_back(2);
+  moveBlocking.push_back(3);
+  m.setMoveBlocking(moveBlocking);
+  MatrixX Xs(4, 2);
+  Xs.col(0) << 1.0f, 2.0f, 3.0f, 4.0f;
+  Xs.col(1) = -Xs.col(0);
+  m.shiftVariables(Xs);
+  MatrixX expectedXs(4, 2);
+  expectedXs.col(0) << 2.0f, 2.5f, 10.0f/3.0f, 4.0f;
+  expectedXs.col(1) = -expectedXs.col(0);
+  ASSERT_TRUE(Xs.isApprox(expectedXs, Constant<TypeParam>::EPSILON));
+}
+
+TYPED_TEST(MpcWalkgenTest, nonUniformShift)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam)
+
+  // The samples last [0, 0.1], [0.1, 0.3], [0.3, 0.5] and [0.5, 0.7], and
+  // are shifted by 0.1
+  NoDynamicModel<TypeParam> m(4, 0.1f, true);
+  VectorX periods(2);
+  periods << 0.1f, 0.2f;
+  m.setSamplingPeriods(periods);
+  VectorX X(4);
+  X << 1.0f, 2.0f, 3.0f, 4.0f;
+  VectorX Xs = X;
+  m.shiftVariables(X);
+  VectorX expected(4);
+  expected << 2.0f, 2.5f, 3.5f, 4.0f;
+  ASSERT_TRUE(X.isApprox(expected, Constant<TypeParam>::EPSILON));
+
+  // Blocks of samples of a vector are shifted in the same way
+  VectorX blocks(9);
+  blocks << 0.0f, Xs, -Xs;
+  Tools::shiftSamples<TypeParam>(blocks, 1, m.getSamplingPeriods(), 2);
+  ASSERT_EQ(blocks(0), 0.0f);
+  ASSERT_TRUE(blocks.segment(1, 4).isApprox(expected, Constant<TypeParam>::EPSILON));
+  ASSERT_TRUE(blocks.segment(5, 4).isApprox(-expected, Constant<TypeParam>::EPSILON));
+
+  // The samples weigh their periods in the objectives, if required
+  ASSERT_TRUE(m.getSampleWeights()==VectorX::Ones(4));
+  m.setPeriodWeighting(true);
+  VectorX weights(4);
+  weights << 1.0f, 2.0f, 2.0f, 2.0f;
+  ASSERT_TRUE(m.getSampleWeights().isApprox(weights));
+
+  // With uniform periods, this is a shift by one sample
+  VectorX uniform = Xs;
+  Tools::shiftSamples<TypeParam>(uniform, 0, VectorX::Constant(4, 0.1f));
+  expected << 2.0f, 3.0f, 4.0f, 4.0f;
+  ASSERT_TRUE(uniform == expected);
+}
+
+TYPED_TEST(MpcWalkgenTest, setState)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam)
+
+  NoDynamicModel<TypeParam> m(10, 0.1f, true);
+
+  // The state can be given as VectorX, Vector3 or any expression of size 3
+  VectorX state(3);
+  state << 0.1f, -0.2f, 0.3f;
+  m.setState(state);
+  ASSERT_TRUE(m.getState() == state);
+
+  m.setState(Vector3(-0.4f, 0.5f, -0.6f));
+  ASSERT_TRUE(m.getState() == Vector3(-0.4f, 0.5f, -0.6f));
+
+  VectorX states(6);
+  states << 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f;
+  m.setState(states.segment(2, 3));
+  ASSERT_TRUE(m.getState() == Vector3(3.0f, 4.0f, 5.0f));
+}
@@ -0,0 +1,166 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\file test-qp-equilibration.cpp
+///\brief Test the QP matrices equilibration
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mpc_walkgen_gtest.h"
+#include <mpc-walkgen/qpsolver.h>
+
+template <typename Scalar>
+void createBadlyScaledProblem(MPCWalkgen::QPMatrices<Scalar>& m)
+{
+  m.Q.setZero(3, 3);
+  m.Q(0, 0) = 1000.0;
+  m.Q(1, 1) = 0.01;
+  m.Q(2, 2) = 1.0;
+  m.Q(0, 2) = m.Q(2, 0) = 0.5;
+  m.p.setZero(3);
+  m.xl.setConstant(3, -10.0);
+  m.xu.setConstant(3, 10.0);
+
+  m.A.setZero(2, 3);
+  m.A(0, 0) = 100.0; m.A(0, 1) = 0.1;
+  m.A(1, 1) = 0.001; m.A(1, 2) = 0.002;
+  m.At = m.A.transpose();
+
+  m.bl.setConstant(2, -1.0);
+  m.bu.setConstant(2, 1.0);
+}
+
+TYPED_TEST(MpcWalkgenTest, equilibrateMatrices)
+{
+  using namespace MPCWalkgen;
+
+  QPMatrices<TypeParam> m;
+  createBadlyScaledProblem(m);
+  m.equilibrateMatrices();
+
+  // Rows and columns of the KKT matrix have comparable norms
+  for(int j=0; j<3; ++j)
+  {
+    TypeParam norm = std::max(m.Q.col(j).cwiseAbs().maxCoeff()
+                              /m.getObjectiveScaling(),
+                              m.A.col(j).cwiseAbs().maxCoeff());
+    ASSERT_NEAR(norm, 1.0, 0.1);
+  }
+  for(int i=0; i<2; ++i)
+  {
+    ASSERT_NEAR(m.A.row(i).cwiseAbs().maxCoeff(), 1.0, 0.1);
+  }
+
+  // Cached factors are applied to a new problem with the same size
+  typename QPMatrices<TypeParam>::MatrixX scaledQ = m.Q;
+  typename QPMatrices<TypeParam>::MatrixX scaledA = m.A;
+  createBadlyScaledProblem(m);
+  m.equilibrateMatrices(1);
+
+  ASSERT_TRUE(m.Q.isApprox(scaledQ));
+  ASSERT_TRUE(m.A.isApprox(scaledA));
+
+  // They are computed again once a change of the matrices is notified
+  createBadlyScaledProblem(m);
+  m.A.row(1) *= 1000.0;
+  m.notifyMatricesChanged();
+  m.equilibrateMatrices();
+  for(int i=0; i<2; ++i)
+  {
+    ASSERT_NEAR(m.A.row(i).cwiseAbs().maxCoeff(), 1.0, 0.1);
+  }
+}
+
+TYPED_TEST(MpcWalkgenTest, refineEquilibration)
+{
+  using namespace MPCWalkgen;
+
+  QPMatrices<TypeParam> m;
+  createBadlyScaledProblem(m);
+  m.refineEquilibration();
+  const typename QPMatrices<TypeParam>::VectorX varScaling = m.getVariableScaling();
+
+  // The first call computes the factors from scratch, as equilibrateMatrices
+  QPMatrices<TypeParam> e;
+  createBadlyScaledProblem(e);
+  e.equilibrateMatrices();
+  ASSERT_TRUE(m.Q.isApprox(e.Q));
+  ASSERT_TRUE(m.A.isApprox(e.A));
+
+  // A small change of the values only refines them, and the rows and
+  // columns of the KKT matrix keep comparable norms
+  createBadlyScaledProblem(m);
+  m.Q(0, 0) *= 1.5;
+  m.A.row(1) *= 0.8;
+  m.notifyMatricesChanged();
+  m.refineEquilibration();
+  ASSERT_TRUE(m.getVariableScaling().isApprox(varScaling, 0.5));
+  for(int j=0; j<3; ++j)
+  {
+    TypeParam norm = std::max(m.Q.col(j).cwiseAbs().maxCoeff()
+                              /m.getObjectiveScaling(),
+                              m.A.col(j).cwiseAbs().maxCoeff());
+    ASSERT_NEAR(norm, 1.0, 0.2);
+  }
+  for(int i=0; i<2; ++i)
+  {
+    ASSERT_NEAR(m.A.row(i).cwiseAbs().maxCoeff(), 1.0, 0.2);
+  }
+}
+
+TYPED_TEST(MpcWalkgenTest, equilibrationUnscaling)
+{
+  using namespace MPCWalkgen;
+  typedef typename QPMatrices<TypeParam>::VectorX VectorX;
+
+  QPMatrices<TypeParam> m;
+  createBadlyScaledProblem(m);
+
+  // Build p so that (x, y) is a KKT point of the original problem
+  VectorX x(3);
+  x << 0.005, 0.5, -0.25;
+  VectorX y(5);
+  y << 0.0, 0.0, 0.0, 2.0, -3.0;
+  m.p = -m.Q*x + m.At*y.tail(2);
+
+  QPMatrices<TypeParam> s = m;
+  s.xu(1) = 10e10;
+  s.bl(0) = -10e10;
+  s.equilibrateMatrices();
+  s.equilibrateVectors();
+  s.At = s.A.transpose();
+
+  const VectorX& d = s.getVariableScaling();
+  const VectorX& e = s.getConstraintScaling();
+  TypeParam c = s.getObjectiveScaling();
+
+  // Constraints and bounds are consistent with the scaled variables
+  VectorX scaledX = x.cwiseQuotient(d);
+  ASSERT_TRUE((s.A*scaledX).isApprox(e.cwiseProduct(m.A*x)));
+  ASSERT_NEAR(s.xu(0), m.xu(0)/d(0), 1e-4);
+  ASSERT_NEAR(s.xu(2), m.xu(2)/d(2), 1e-4);
+  ASSERT_NEAR(s.bl(1), m.bl(1)*e(1), 1e-4);
+
+  // Infinite bounds are left unscaled
+  ASSERT_EQ(s.xu(1), static_cast<TypeParam>(10e10));
+  ASSERT_EQ(s.bl(0), static_cast<TypeParam>(-10e10));
+
+  VectorX sol = scaledX;
+  s.unscalePrimalSolution(sol);
+  ASSERT_TRUE(sol.isApprox(x));
+
+  // Multipliers of the scaled problem
+  VectorX scaledY(5);
+  scaledY.head(3) = c*d.cwiseProduct(y.head(3));
+  scaledY.tail(2) = c*y.tail(2).cwiseQuotient(e);
+  VectorX residual = s.Q*scaledX + s.p - scaledY.head(3) - s.At*scaledY.tail(2);
+  ASSERT_NEAR(residual.norm(), 0.0, 1e-4);
+
+  s.unscaleDualSolution(scaledY);
+  ASSERT_TRUE(scaledY.isApprox(y));
+
+  // The Hessian product is computed with the original Hessian
+  VectorX product;
+  s.computeHessianProduct(x, product);
+  ASSERT_TRUE(product.isApprox(m.Q*x));
+}
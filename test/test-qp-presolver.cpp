@@ -0,0 +1,214 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\file test-qp-presolver.cpp
+///\brief Test the QP presolver
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mpc_walkgen_gtest.h"
+#include <mpc-walkgen/qppresolver.h>
+
+template <typename Scalar>
+void createPresolvableProblem(MPCWalkgen::QPMatrices<Scalar>& m)
+{
+  // 3 variables, x2 is fixed
+  m.Q.setIdentity(3, 3);
+  m.Q(0, 1) = m.Q(1, 0) = 0.5;
+  m.p.setConstant(3, 1.0);
+  m.xl.setConstant(3, -10.0);
+  m.xu.setConstant(3, 10.0);
+  m.xl(2) = 2.0;
+  m.xu(2) = 2.0;
+
+  // row 0: general row
+  // row 1: twice row 0
+  // row 2: singleton row on x1
+  // row 3: empty row
+  // row 4: only involves the fixed variable
+  m.A.setZero(5, 3);
+  m.A(0, 0) = 1.0; m.A(0, 1) = 1.0; m.A(0, 2) = 1.0;
+  m.A(1, 0) = 2.0; m.A(1, 1) = 2.0; m.A(1, 2) = 2.0;
+  m.A(2, 1) = -2.0;
+  m.A(4, 2) = 1.0;
+  m.At = m.A.transpose();
+
+  m.bl.setConstant(5, -100.0);
+  m.bu.setConstant(5, 100.0);
+  m.bu(0) = 3.0;
+  m.bl(1) = -4.0;
+  m.bl(2) = -2.0;
+}
+
+TYPED_TEST(MpcWalkgenTest, presolveReducesProblem)
+{
+  using namespace MPCWalkgen;
+
+  QPMatrices<TypeParam> m;
+  createPresolvableProblem(m);
+
+  QPPresolver<TypeParam> presolver;
+  const QPMatrices<TypeParam>& r = presolver.presolve(m);
+
+  ASSERT_TRUE(presolver.hasReducedStructureChanged());
+  ASSERT_EQ(presolver.getNbVar(), 2);
+  ASSERT_EQ(presolver.getNbCtr(), 1);
+
+  // p is shifted by the fixed variable
+  ASSERT_NEAR(r.p(0), 1.0, Constant<TypeParam>::EPSILON);
+  ASSERT_NEAR(r.p(1), 1.0, Constant<TypeParam>::EPSILON);
+
+  // -2*x1 >= -2 is x1 <= 1
+  ASSERT_NEAR(r.xu(1), 1.0, Constant<TypeParam>::EPSILON);
+  ASSERT_NEAR(r.xl(1), -10.0, Constant<TypeParam>::EPSILON);
+
+  // Row 0 merged with row 1 (-2 <= x0 + x1 + x2 <= 3), shifted by x2 = 2
+  ASSERT_NEAR(r.A(0, 0), 1.0, Constant<TypeParam>::EPSILON);
+  ASSERT_NEAR(r.A(0, 1), 1.0, Constant<TypeParam>::EPSILON);
+  ASSERT_NEAR(r.bl(0), -4.0, Constant<TypeParam>::EPSILON);
+  ASSERT_NEAR(r.bu(0), 1.0, Constant<TypeParam>::EPSILON);
+
+  typename QPMatrices<TypeParam>::VectorX reducedSol(2);
+  reducedSol << 0.5, -0.5;
+  typename QPMatrices<TypeParam>::VectorX sol;
+  presolver.postsolve(reducedSol, sol);
+
+  ASSERT_EQ(sol.size(), 3);
+  ASSERT_NEAR(sol(0), 0.5, Constant<TypeParam>::EPSILON);
+  ASSERT_NEAR(sol(1), -0.5, Constant<TypeParam>::EPSILON);
+  ASSERT_NEAR(sol(2), 2.0, Constant<TypeParam>::EPSILON);
+}
+
+TYPED_TEST(MpcWalkgenTest, presolveCachesAnalysis)
+{
+  using namespace MPCWalkgen;
+
+  QPMatrices<TypeParam> m;
+  createPresolvableProblem(m);
+
+  QPPresolver<TypeParam> presolver;
+  presolver.presolve(m);
+
+  // Only the bounds and the gradient change
+  m.p(0) = 3.0;
+  m.bu(0) = 4.0;
+  const QPMatrices<TypeParam>& r = presolver.presolve(m);
+  ASSERT_FALSE(presolver.hasReducedStructureChanged());
+  ASSERT_NEAR(r.p(0), 3.0, Constant<TypeParam>::EPSILON);
+  ASSERT_NEAR(r.bu(0), 2.0, Constant<TypeParam>::EPSILON);
+
+  // Releasing the fixed variable changes the reduced problem
+  m.xu(2) = 3.0;
+  presolver.presolve(m);
+  ASSERT_TRUE(presolver.hasReducedStructureChanged());
+  ASSERT_EQ(presolver.getNbVar(), 3);
+  ASSERT_EQ(presolver.getNbCtr(), 1);
+
+  // So does a change of A, once it is notified
+  m.A(0, 0) = 3.0;
+  m.notifyMatricesChanged();
+  presolver.presolve(m);
+  ASSERT_TRUE(presolver.hasReducedStructureChanged());
+  ASSERT_EQ(presolver.getNbCtr(), 2);
+}
+
+TYPED_TEST(MpcWalkgenTest, postsolveDual)
+{
+  using namespace MPCWalkgen;
+  typedef typename QPMatrices<TypeParam>::VectorX VectorX;
+
+  QPMatrices<TypeParam> m;
+  createPresolvableProblem(m);
+  m.p(1) = -3.0;
+
+  QPPresolver<TypeParam> presolver;
+  presolver.presolve(m);
+
+  // Reduced optimum: x1 on its upper bound (given by row 2) and row 0
+  // inactive. Then x0 = -1 - 0.5, and the bound multiplier of x1 closes
+  // the stationarity condition of the reduced problem
+  VectorX reducedSol(2);
+  reducedSol << -1.5, 1.0;
+  VectorX reducedDual(3);
+  reducedDual << 0.0, 0.5*(-1.5) + 1.0 - 3.0, 0.0;
+
+  VectorX sol;
+  presolver.postsolve(reducedSol, sol);
+  VectorX dual;
+  presolver.postsolveDual(reducedDual, dual);
+
+  ASSERT_EQ(dual.size(), 8);
+  // The multiplier of x1 upper bound moved to the singleton row
+  ASSERT_NEAR(dual(1), 0.0, Constant<TypeParam>::EPSILON);
+  ASSERT_NEAR(dual(3 + 2), 1.375, Constant<TypeParam>::EPSILON);
+  // The fixed variable gets the multiplier of its bound
+  ASSERT_NEAR(dual(2), 3.0, Constant<TypeParam>::EPSILON);
+
+  // The original stationarity condition holds
+  VectorX residual = m.Q*sol + m.p - dual.head(3) - m.At*dual.tail(5);
+  ASSERT_NEAR(residual.norm(), 0.0, Constant<TypeParam>::EPSILON);
+
+  // Mapping the multipliers back gives the reduced ones
+  VectorX guess;
+  presolver.presolveDual(dual, guess);
+  ASSERT_EQ(guess.size(), 3);
+  ASSERT_TRUE(guess.isApprox(reducedDual));
+}
+
+TYPED_TEST(MpcWalkgenTest, presolveDetectsInfeasibility)
+{
+  using namespace MPCWalkgen;
+
+  QPMatrices<TypeParam> m;
+  createPresolvableProblem(m);
+
+  QPPresolver<TypeParam> presolver;
+  presolver.presolve(m);
+  ASSERT_TRUE(presolver.isFeasible());
+
+  // The singleton row gives x1 <= 1, below the lower bound of x1
+  m.xl(1) = 1.5;
+  presolver.presolve(m);
+  ASSERT_FALSE(presolver.isFeasible());
+
+  // Crossed by less than epsilon, x1 is fixed at the midpoint
+  m.xl(1) = 1.0 + 1e-10;
+  presolver.presolve(m);
+  ASSERT_TRUE(presolver.isFeasible());
+  ASSERT_EQ(presolver.getNbVar(), 1);
+  m.xl(1) = -10.0;
+
+  // Row 1 gives x0 + x1 + x2 >= 4, above the upper bound of row 0
+  m.bl(1) = 8.0;
+  presolver.presolve(m);
+  ASSERT_FALSE(presolver.isFeasible());
+  m.bl(1) = -4.0;
+
+  // Row 4 turns into x2 <= 1, below the fixed value of x2
+  m.bu(4) = 1.0;
+  presolver.presolve(m);
+  ASSERT_FALSE(presolver.isFeasible());
+  m.bu(4) = 100.0;
+
+  // With all variables fixed, row 0 is removed although it gives 2 <= 1
+  m.xl.head(2).setZero();
+  m.xu.head(2).setZero();
+  m.bu(0) = 1.0;
+  presolver.presolve(m);
+  ASSERT_EQ(presolver.getNbVar(), 0);
+  ASSERT_FALSE(presolver.isFeasible());
+  m.bu(0) = 3.0;
+  presolver.presolve(m);
+  ASSERT_TRUE(presolver.isFeasible());
+  m.xl.head(2).setConstant(-10.0);
+  m.xu.head(2).setConstant(10.0);
+
+  // An empty row must accept 0
+  m.bl(3) = 1.0;
+  presolver.presolve(m);
+  ASSERT_FALSE(presolver.isFeasible());
+  m.bl(3) = -100.0;
+
+  presolver.presolve(m);
+  ASSERT_TRUE(presolver.isFeasible());
+}
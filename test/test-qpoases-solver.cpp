@@ -118,6 +118,104 @@ TYPED_TEST(QPSolverTest, testSolverWithConstraint)
 }
 
 
+TYPED_TEST(QPSolverTest, testPresolvedSolverWithConstraint)
+{
+  using namespace MPCWalkgen;
+  typedef typename QPMatrices<TypeParam>::VectorX VectorX;
+
+  // Same problem as testSolverWithConstraint, whose constraint is a bound
+  // in disguise given twice, with an inactive general row and its duplicate
+  boost::scoped_ptr< QPSolver<TypeParam> > qp(
+        new PresolvedQPSolver<TypeParam>(2, 4, &makeQPSolver<TypeParam>));
+  QPMatrices<TypeParam> m;
+
+  m.Q.resize(2, 2);
+  m.Q(0,0)=5.f; m.Q(0,1)=4.f;
+  m.Q(1,0)=4.f; m.Q(1,1)=5.f;
+  m.p.resize(2);
+  m.p[0]=1.f; m.p[1]=-1.f;
+
+  m.A.setZero(4, 2);
+  m.A(0,0)=1.f;
+  m.A(1,0)=2.f;
+  m.A(2,0)=1.f; m.A(2,1)=1.f;
+  m.A(3,0)=-2.f; m.A(3,1)=-2.f;
+  m.At = m.A.transpose();
+  m.bl.setConstant(4, -100);
+  m.bu.setConstant(4, 100);
+  m.bu(0)=-2.f;
+  m.bu(2)=1.f;
+  m.bl(3)=-1.f;
+  m.xl.setConstant(2, -100);
+  m.xu.setConstant(2, 100);
+
+  VectorX x(2);
+  ASSERT_TRUE(qp->solve(m, x));
+
+  ASSERT_NEAR(x(0), -2.0f, Constant<TypeParam>::EPSILON);
+  ASSERT_NEAR(x(1), 1.8f, Constant<TypeParam>::EPSILON);
+
+  VectorX dual;
+  qp->getDualSolution(dual);
+  ASSERT_EQ(dual.size(), 6);
+  VectorX residual = m.Q*x + m.p - dual.head(2) - m.At*dual.tail(4);
+  ASSERT_NEAR(residual.norm(), 0.0, Constant<TypeParam>::EPSILON);
+  ASSERT_TRUE(dual(2)<0);
+
+  // The duplicated row is merged into row 2: x0 + x1 <= 0.5 becomes active
+  m.p[1]=-10.f;
+  ASSERT_TRUE(qp->solve(m, x, true));
+  ASSERT_NEAR(x(0), -5.25f, Constant<TypeParam>::EPSILON);
+  ASSERT_NEAR(x(0) + x(1), 0.5f, Constant<TypeParam>::EPSILON);
+  qp->getDualSolution(dual);
+  residual = m.Q*x + m.p - dual.head(2) - m.At*dual.tail(4);
+  ASSERT_NEAR(residual.norm(), 0.0, Constant<TypeParam>::EPSILON);
+  m.p[1]=-1.f;
+
+  // Hotstart with the same structure
+  m.bu(0)=-3.f;
+  ASSERT_TRUE(qp->solve(m, x, true));
+  ASSERT_NEAR(x(0), -3.0f, Constant<TypeParam>::EPSILON);
+}
+
+TYPED_TEST(QPSolverTest, testSolverWithDualGuess)
+{
+  using namespace MPCWalkgen;
+  typedef typename QPMatrices<TypeParam>::VectorX VectorX;
+
+  // Same problem as testSolverWithConstraint
+  boost::scoped_ptr< QPSolver<TypeParam> > qp(makeQPSolver<TypeParam>(2, 1));
+  QPMatrices<TypeParam> m;
+
+  m.Q.resize(2, 2);
+  m.Q(0,0)=5.f; m.Q(0,1)=4.f;
+  m.Q(1,0)=4.f; m.Q(1,1)=5.f;
+  m.p.resize(2);
+  m.p[0]=1.f; m.p[1]=-1.f;
+  m.A.setZero(1, 2);
+  m.A(0,0)=1.f;
+  m.At = m.A.transpose();
+  m.bl.setConstant(1, -100);
+  m.bu.setConstant(1, -2);
+  m.xl.setConstant(2, -100);
+  m.xu.setConstant(2, 100);
+
+  VectorX x(2);
+  ASSERT_TRUE(qp->solve(m, x));
+  const int nbColdIterations = qp->getNbIterations();
+
+  // The last multipliers are given as a guess of the working set, which is
+  // used instead of the last one even if the solver is warm started
+  VectorX dual;
+  qp->getDualSolution(dual);
+  ASSERT_EQ(dual.size(), 3);
+  qp->setDualGuess(dual);
+  m.bu(0)=-3.f;
+  ASSERT_TRUE(qp->solve(m, x, true));
+  ASSERT_NEAR(x(0), -3.0f, Constant<TypeParam>::EPSILON);
+  ASSERT_LE(qp->getNbIterations(), nbColdIterations);
+}
+
 TEST(QPOasesTest, testSolverWithConstraint)
 {
   using namespace MPCWalkgen;
@@ -0,0 +1,150 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\file test-trajectory-walkgen.cpp
+///\brief Test the trajectory walkgen
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mpc_walkgen_gtest.h"
+#include <mpc-walkgen/trajectory_walkgen.h>
+#include <algorithm>
+#include <cmath>
+
+template <typename Scalar>
+void setupTrajectoryWalkgen(MPCWalkgen::TrajectoryWalkgen<Scalar>& walkgen,
+                            Scalar velLimit)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(Scalar)
+
+  const int nbSamples = 10;
+  walkgen.setNbSamples(nbSamples);
+  walkgen.setSamplingPeriod(0.1f);
+
+  TrajectoryWalkgenWeighting<Scalar> weighting;
+  weighting.velocityTracking = 1.0f;
+  weighting.positionTracking = 0.1f;
+  weighting.jerkMinimization = 0.001f;
+  TrajectoryWalkgenConfig<Scalar> config;
+  config.withMotionConstraints = true;
+  config.withFeedbackGain = true;
+  walkgen.setWeightings(weighting);
+  walkgen.setConfig(config);
+
+  walkgen.setVelLimit(velLimit);
+  walkgen.setAccLimit(10.0f);
+  walkgen.setJerkLimit(100.0f);
+  walkgen.setVelRefInWorldFrame(VectorX::Constant(nbSamples, 1.0f));
+  walkgen.setPosRefInWorldFrame(VectorX::Zero(nbSamples));
+}
+
+/// \brief Compare the feedback gain at state with central finite differences
+///        of the jerk, and return it
+template <typename Scalar>
+typename MPCWalkgen::Type<Scalar>::Vector3 checkFeedbackGain(
+    const typename MPCWalkgen::Type<Scalar>::Vector3& state,
+    Scalar velLimit, Scalar step, Scalar precision)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(Scalar)
+
+  TrajectoryWalkgen<Scalar> walkgen;
+  setupTrajectoryWalkgen(walkgen, velLimit);
+  walkgen.setState(state);
+  EXPECT_TRUE(walkgen.solve(0.02f));
+  const Vector3 gain = walkgen.getFeedbackGain();
+
+  for(int i=0; i<3; ++i)
+  {
+    Scalar jerks[2];
+    for(int j=0; j<2; ++j)
+    {
+      TrajectoryWalkgen<Scalar> perturbed;
+      setupTrajectoryWalkgen(perturbed, velLimit);
+      Vector3 perturbedState = state;
+      perturbedState(i) += j==0 ? step : -step;
+      perturbed.setState(perturbedState);
+      EXPECT_TRUE(perturbed.solve(0.02f));
+      jerks[j] = perturbed.getJerk();
+    }
+    EXPECT_NEAR(gain(i), (jerks[0] - jerks[1])/(2*step),
+                precision*std::max(Scalar(1), std::abs(gain(i))));
+  }
+  return gain;
+}
+
+TYPED_TEST(MpcWalkgenTest, trajectoryFeedbackGain)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam)
+
+  // The jerk is affine in the state as long as the active set does not
+  // change, which the step keeps
+  const TypeParam step = 1e-3f;
+  const TypeParam precision = 1e-2f;
+  const Vector3 state(0.0f, 0.5f, 0.0f);
+
+  // Without active constraints, the gain is the one of the unconstrained QP
+  const Vector3 unconstrainedGain = checkFeedbackGain<TypeParam>(state, 10.0f,
+                                                                 step, precision);
+
+  // With the velocity limit active on the following samples, the gain
+  // accounts for the multipliers of the active rows
+  const Vector3 constrainedGain = checkFeedbackGain<TypeParam>(state, 0.6f,
+                                                               step, precision);
+  ASSERT_GT((constrainedGain - unconstrainedGain).cwiseAbs().maxCoeff(),
+            10*precision);
+}
+
+TYPED_TEST(MpcWalkgenTest, trajectoryWarmStartShift)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam)
+
+  // The velocity limit is active, so that the shifted working set is not
+  // empty
+  TrajectoryWalkgen<TypeParam> unshifted;
+  setupTrajectoryWalkgen<TypeParam>(unshifted, 0.6f);
+  TrajectoryWalkgen<TypeParam> shifted;
+  setupTrajectoryWalkgen<TypeParam>(shifted, 0.6f);
+  TrajectoryWalkgenConfig<TypeParam> config;
+  config.withMotionConstraints = true;
+  config.withFeedbackGain = true;
+  config.withWarmStartShift = true;
+  shifted.setConfig(config);
+
+  // One sampling period elapses between solves
+  for(int i=0; i<10; ++i)
+  {
+    const VectorX velRef = VectorX::Constant(10, i<5 ? 1.0f : -1.0f);
+    unshifted.setVelRefInWorldFrame(velRef);
+    shifted.setVelRefInWorldFrame(velRef);
+    ASSERT_TRUE(unshifted.solve(0.1f));
+    ASSERT_TRUE(shifted.solve(0.1f));
+    ASSERT_NEAR(shifted.getJerk(), unshifted.getJerk(), 5e-2f);
+    ASSERT_TRUE(shifted.getState().isApprox(unshifted.getState(), 1e-3f));
+  }
+}
+
+TYPED_TEST(MpcWalkgenTest, trajectorySetState)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam)
+
+  TrajectoryWalkgen<TypeParam> walkgen;
+
+  // The state can be given as VectorX, Vector3 or any expression of size 3
+  VectorX state(3);
+  state << 0.1f, -0.2f, 0.3f;
+  walkgen.setState(state);
+  ASSERT_TRUE(walkgen.getState() == state);
+
+  walkgen.setState(Vector3(-0.4f, 0.5f, -0.6f));
+  ASSERT_TRUE(walkgen.getState() == Vector3(-0.4f, 0.5f, -0.6f));
+
+  VectorX states(6);
+  states << 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f;
+  walkgen.setState(states.segment(2, 3));
+  ASSERT_TRUE(walkgen.getState() == Vector3(3.0f, 4.0f, 5.0f));
+}
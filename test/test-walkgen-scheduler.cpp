@@ -0,0 +1,158 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\file test-walkgen-scheduler.cpp
+///\brief Test the pool of threads solving batches of walkgens
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include <mpc-walkgen/walkgen_scheduler.h>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+  /// \brief Request which records the thread running it after sleeping
+  ///        for sleepTime milliseconds
+  bool recordThread(boost::thread::id* id, int sleepTime, bool result)
+  {
+    boost::this_thread::sleep(boost::posix_time::milliseconds(sleepTime));
+    *id = boost::this_thread::get_id();
+    return result;
+  }
+
+  bool throwException()
+  {
+    throw std::runtime_error("solve failed");
+  }
+}
+
+TEST(WalkgenSchedulerTest, reuseAcrossBatches)
+{
+  using namespace MPCWalkgen;
+
+  WalkgenScheduler scheduler(3);
+  ASSERT_EQ(scheduler.getNbThreads(), 3);
+
+  // Each batch is solved completely, with the status of its own requests
+  for(int batch=0; batch<5; ++batch)
+  {
+    const int nbRequests = 4 + batch;
+    std::vector<boost::thread::id> ids(nbRequests);
+    for(int i=0; i<nbRequests; ++i)
+    {
+      scheduler.add(i, boost::bind(&recordThread, &ids[i], 1, i!=batch));
+    }
+    ASSERT_FALSE(scheduler.run());
+    ASSERT_EQ(scheduler.getNbRequests(), nbRequests);
+    for(int i=0; i<nbRequests; ++i)
+    {
+      ASSERT_TRUE(ids[i]!=boost::thread::id());
+      ASSERT_EQ(scheduler.getStatus(i), i!=batch ? WalkgenScheduler::SOLVED
+                                                 : WalkgenScheduler::FAILED);
+    }
+  }
+
+  ASSERT_TRUE(scheduler.run());
+  ASSERT_EQ(scheduler.getNbRequests(), 0);
+}
+
+TEST(WalkgenSchedulerTest, affinity)
+{
+  using namespace MPCWalkgen;
+
+  // The first worker is the calling thread, and each instance is solved by
+  // the same thread from batch to batch
+  WalkgenScheduler scheduler(2);
+  boost::thread::id firstIds[2];
+  for(int batch=0; batch<3; ++batch)
+  {
+    boost::thread::id ids[2];
+    scheduler.add(0, boost::bind(&recordThread, &ids[0], 20, true));
+    scheduler.add(1, boost::bind(&recordThread, &ids[1], 20, true));
+    ASSERT_TRUE(scheduler.run());
+
+    ASSERT_TRUE(ids[0]==boost::this_thread::get_id());
+    ASSERT_TRUE(ids[1]!=boost::this_thread::get_id());
+    if (batch==0)
+    {
+      firstIds[0] = ids[0];
+      firstIds[1] = ids[1];
+    }
+    ASSERT_TRUE(ids[0]==firstIds[0]);
+    ASSERT_TRUE(ids[1]==firstIds[1]);
+  }
+}
+
+TEST(WalkgenSchedulerTest, stealing)
+{
+  using namespace MPCWalkgen;
+
+  // All the requests are queued for the first worker, the other one steals
+  // some of them
+  WalkgenScheduler scheduler(2);
+  std::vector<boost::thread::id> ids(6);
+  for(size_t i=0; i<ids.size(); ++i)
+  {
+    scheduler.add(0, boost::bind(&recordThread, &ids[i], 20, true));
+  }
+  ASSERT_TRUE(scheduler.run());
+
+  int nbStolen = 0;
+  for(size_t i=0; i<ids.size(); ++i)
+  {
+    nbStolen += ids[i]!=boost::this_thread::get_id() ? 1 : 0;
+  }
+  ASSERT_GT(nbStolen, 0);
+}
+
+TEST(WalkgenSchedulerTest, deadline)
+{
+  using namespace MPCWalkgen;
+
+  // With one thread, the requests are solved in order. The first one is
+  // started before the deadline, the others after it.
+  WalkgenScheduler scheduler(1);
+  std::vector<boost::thread::id> ids(3);
+  for(size_t i=0; i<ids.size(); ++i)
+  {
+    scheduler.add(0, boost::bind(&recordThread, &ids[i], 50, true));
+  }
+  ASSERT_FALSE(scheduler.run(0.02));
+  ASSERT_EQ(scheduler.getStatus(0), WalkgenScheduler::SOLVED);
+  ASSERT_EQ(scheduler.getStatus(1), WalkgenScheduler::CANCELLED);
+  ASSERT_EQ(scheduler.getStatus(2), WalkgenScheduler::CANCELLED);
+  ASSERT_TRUE(ids[1]==boost::thread::id());
+
+  // The deadline only applies to its batch
+  scheduler.add(0, boost::bind(&recordThread, &ids[1], 1, true));
+  ASSERT_TRUE(scheduler.run());
+}
+
+TEST(WalkgenSchedulerTest, exception)
+{
+  using namespace MPCWalkgen;
+
+  // A request which throws fails, without stopping the batch nor the next
+  // ones
+  WalkgenScheduler scheduler(2);
+  for(int batch=0; batch<2; ++batch)
+  {
+    std::vector<boost::thread::id> ids(4);
+    scheduler.add(0, &throwException);
+    for(size_t i=0; i<ids.size(); ++i)
+    {
+      scheduler.add(static_cast<int>(i), boost::bind(&recordThread, &ids[i], 1, true));
+    }
+    scheduler.add(1, &throwException);
+    ASSERT_FALSE(scheduler.run());
+
+    ASSERT_EQ(scheduler.getStatus(0), WalkgenScheduler::FAILED);
+    for(size_t i=0; i<ids.size(); ++i)
+    {
+      ASSERT_EQ(scheduler.getStatus(static_cast<int>(i) + 1), WalkgenScheduler::SOLVED);
+    }
+    ASSERT_EQ(scheduler.getStatus(5), WalkgenScheduler::FAILED);
+  }
+}
@@ -62,3 +62,29 @@ TYPED_TEST(MpcWalkgenTest, valuesOfMatrices)
   ASSERT_NEAR(j, 1.0, Constant<TypeParam>::EPSILON);
 }
 
+
+TYPED_TEST(MpcWalkgenTest, setStates)
+{
+  TEMPLATE_TYPEDEF(TypeParam)
+
+  BaseModel<TypeParam> m(10, 0.1f, true);
+
+  // The states can be given as VectorX, Vector3 or any expression of size 3
+  VectorX stateX(3);
+  stateX << 0.1f, -0.2f, 0.3f;
+  m.setStateX(stateX);
+  ASSERT_TRUE(m.getStateX() == stateX);
+
+  const Vector3 stateY(-0.4f, 0.5f, -0.6f);
+  m.setStateY(stateY);
+  ASSERT_TRUE(m.getStateY() == stateY);
+
+  VectorX states(9);
+  states << 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f;
+  m.setStateRoll(states.head(3));
+  m.setStatePitch(states.segment(3, 3));
+  m.setStateYaw(states.tail(3) - states.head(3));
+  ASSERT_TRUE(m.getStateRoll() == states.head(3));
+  ASSERT_TRUE(m.getStatePitch() == states.segment(3, 3));
+  ASSERT_TRUE(m.getStateYaw() == Vector3(6.0f, 6.0f, 6.0f));
+}
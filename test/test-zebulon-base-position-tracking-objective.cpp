@@ -10,6 +10,8 @@
 #include "mpc_walkgen_gtest.h"
 #include <mpc-walkgen/model/zebulon_base_model.h>
 #include <mpc-walkgen/function/zebulon_base_position_tracking_objective.h>
+#include <algorithm>
+#include <cmath>
 
 TYPED_TEST(MpcWalkgenTest, functionValue)
 {
@@ -67,3 +69,65 @@ TYPED_TEST(MpcWalkgenTest, sizeOfvalues)
   ASSERT_EQ(obj.getGradient(jerkInit).rows(), 2*nbSamples);
   ASSERT_EQ(obj.getGradient(jerkInit).cols(), 1);
 }
+
+
+TYPED_TEST(MpcWalkgenTest, pushReference)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam)
+
+  // Uniform sampling, whose reference term is shifted, and non-uniform
+  // sampling, whose reference term is computed again
+  const int nbSamples = 6;
+  VectorX samplingPeriods(3);
+  samplingPeriods << 0.05f, 0.1f, 0.2f;
+  for(int i=0; i<2; ++i)
+  {
+    BaseModel<TypeParam> m(nbSamples, 0.1f, true);
+    if (i==1)
+    {
+      m.setSamplingPeriods(samplingPeriods);
+    }
+    m.setStateX(Vector3(0.1f, -0.5f, 0.2f));
+    m.setStateY(Vector3(-0.3f, 0.25f, 0.0f));
+    BasePositionTrackingObjective<TypeParam> pushed(m);
+    BasePositionTrackingObjective<TypeParam> set(m);
+    VectorX ref(2*nbSamples);
+    for(int k=0; k<2*nbSamples; ++k)
+    {
+      ref(k) = std::cos(static_cast<TypeParam>(k));
+    }
+    pushed.setPosRefInWorldFrame(ref);
+
+    VectorX x0(2*nbSamples);
+    for(int k=0; k<2*nbSamples; ++k)
+    {
+      x0(k) = std::sin(static_cast<TypeParam>(k));
+    }
+
+    // More samples than the horizon are pushed, so that none of the set
+    // ones is left
+    for(int k=0; k<2*nbSamples; ++k)
+    {
+      const Vector2 value(static_cast<TypeParam>(0.1*k), static_cast<TypeParam>(-0.2*k));
+      pushed.pushPosRefInWorldFrame(value);
+      for(int j=0; j<nbSamples-1; ++j)
+      {
+        ref(j) = ref(j + 1);
+        ref(nbSamples + j) = ref(nbSamples + j + 1);
+      }
+      ref(nbSamples - 1) = value(0);
+      ref(2*nbSamples - 1) = value(1);
+      set.setPosRefInWorldFrame(ref);
+
+      const VectorX pushedGradient = pushed.getGradient(x0);
+      const VectorX setGradient = set.getGradient(x0);
+      ASSERT_EQ(pushedGradient.size(), 2*nbSamples);
+      for(int j=0; j<2*nbSamples; ++j)
+      {
+        ASSERT_NEAR(pushedGradient(j), setGradient(j),
+                    1e-4f*std::max(TypeParam(1), std::abs(setGradient(j))));
+      }
+    }
+  }
+}
@@ -10,6 +10,8 @@
 #include "mpc_walkgen_gtest.h"
 #include <mpc-walkgen/model/zebulon_base_model.h>
 #include <mpc-walkgen/function/zebulon_base_velocity_tracking_objective.h>
+#include <algorithm>
+#include <cmath>
 
 class ZebulonBaseVelocityTrackingTest: public ::testing::Test{};
 
@@ -72,3 +74,118 @@ TYPED_TEST(MpcWalkgenTest, sizeOfvalues)
   ASSERT_EQ(obj.getGradient(jerkInit).cols(), 1);
 
 }
+
+
+TYPED_TEST(MpcWalkgenTest, pushReference)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam)
+
+  // Uniform sampling, whose reference term is shifted, and non-uniform
+  // sampling, whose reference term is computed again
+  const int nbSamples = 6;
+  VectorX samplingPeriods(3);
+  samplingPeriods << 0.05f, 0.1f, 0.2f;
+  for(int i=0; i<2; ++i)
+  {
+    BaseModel<TypeParam> m(nbSamples, 0.1f, true);
+    if (i==1)
+    {
+      m.setSamplingPeriods(samplingPeriods);
+    }
+    m.setStateX(Vector3(0.1f, -0.5f, 0.2f));
+    m.setStateY(Vector3(-0.3f, 0.25f, 0.0f));
+    BaseVelocityTrackingObjective<TypeParam> pushed(m);
+    BaseVelocityTrackingObjective<TypeParam> set(m);
+    VectorX ref(2*nbSamples);
+    for(int k=0; k<2*nbSamples; ++k)
+    {
+      ref(k) = std::cos(static_cast<TypeParam>(k));
+    }
+    pushed.setVelRefInWorldFrame(ref);
+
+    VectorX x0(2*nbSamples);
+    for(int k=0; k<2*nbSamples; ++k)
+    {
+      x0(k) = std::sin(static_cast<TypeParam>(k));
+    }
+
+    // More samples than the horizon are pushed, so that none of the set
+    // ones is left
+    for(int k=0; k<2*nbSamples; ++k)
+    {
+      const Vector2 value(static_cast<TypeParam>(0.1*k), static_cast<TypeParam>(-0.2*k));
+      pushed.pushVelRefInWorldFrame(value);
+      for(int j=0; j<nbSamples-1; ++j)
+      {
+        ref(j) = ref(j + 1);
+        ref(nbSamples + j) = ref(nbSamples + j + 1);
+      }
+      ref(nbSamples - 1) = value(0);
+      ref(2*nbSamples - 1) = value(1);
+      set.setVelRefInWorldFrame(ref);
+
+      const VectorX pushedGradient = pushed.getGradient(x0);
+      const VectorX setGradient = set.getGradient(x0);
+      ASSERT_EQ(pushedGradient.size(), 2*nbSamples);
+      for(int j=0; j<2*nbSamples; ++j)
+      {
+        ASSERT_NEAR(pushedGradient(j), setGradient(j),
+                    1e-4f*std::max(TypeParam(1), std::abs(setGradient(j))));
+      }
+    }
+  }
+}
+
+TYPED_TEST(MpcWalkgenTest, periodWeighting)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam)
+
+  // With the period weighting, the cost of each sample is multiplied by
+  // its period divided by the first one
+  const int nbSamples = 4;
+  VectorX samplingPeriods(2);
+  samplingPeriods << 0.05f, 0.2f;
+  BaseModel<TypeParam> m(nbSamples, 0.1f, true);
+  m.setSamplingPeriods(samplingPeriods);
+  m.setStateX(Vector3(0.1f, -0.5f, 0.2f));
+  m.setStateY(Vector3(-0.3f, 0.25f, 0.0f));
+  BaseVelocityTrackingObjective<TypeParam> obj(m);
+
+  VectorX ref(2*nbSamples);
+  VectorX x0(2*nbSamples);
+  for(int k=0; k<2*nbSamples; ++k)
+  {
+    ref(k) = std::cos(static_cast<TypeParam>(k));
+    x0(k) = std::sin(static_cast<TypeParam>(k));
+  }
+  obj.setVelRefInWorldFrame(ref);
+  const VectorX unweightedGradient = obj.getGradient(x0);
+
+  m.setPeriodWeighting(true);
+  obj.computeConstantPart();
+  VectorX weights(nbSamples);
+  weights << 1.0f, 4.0f, 4.0f, 4.0f;
+  ASSERT_TRUE(m.getSampleWeights().isApprox(weights));
+
+  const LinearDynamic<TypeParam>& dyn = m.getBaseVelLinearDynamic();
+  const MatrixX hessian = dyn.UT*weights.asDiagonal()*dyn.U;
+  VectorX gradient(2*nbSamples);
+  gradient.head(nbSamples) = hessian*x0.head(nbSamples) + dyn.UT*weights.asDiagonal()
+      *(dyn.S*m.getStateX() - ref.head(nbSamples));
+  gradient.tail(nbSamples) = hessian*x0.tail(nbSamples) + dyn.UT*weights.asDiagonal()
+      *(dyn.S*m.getStateY() - ref.tail(nbSamples));
+
+  const MatrixX denseHessian = obj.getHessian().toDense();
+  ASSERT_TRUE(denseHessian.topLeftCorner(nbSamples, nbSamples).isApprox(hessian));
+  ASSERT_TRUE(denseHessian.bottomRightCorner(nbSamples, nbSamples).isApprox(hessian));
+  ASSERT_TRUE(obj.getGradient(x0).isApprox(gradient));
+  ASSERT_FALSE(obj.getGradient(x0).isApprox(unweightedGradient));
+
+  // Without it, the weights are all 1
+  m.setPeriodWeighting(false);
+  obj.computeConstantPart();
+  ASSERT_TRUE(m.getSampleWeights()==VectorX::Ones(nbSamples));
+  ASSERT_TRUE(obj.getGradient(x0).isApprox(unweightedGradient));
+}
@@ -42,66 +42,66 @@ TYPED_TEST(MpcWalkgenTest, functionValue)
   jerkInit(1) = 0.0;
   jerkInit(2) = 0.0;
   jerkInit(3) = 0.0;
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(0)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(1)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(2)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(3)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(4)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(5)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(6)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(7)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(4)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(5)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(6)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(7)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(0)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(1)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(2)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(3)<0.0);
 
   jerkInit(0) = 0.0f;
   jerkInit(1) = 0.0f;
   jerkInit(2) = 6.0f*copLimitMax;
   jerkInit(3) = 0.0f;
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(3)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(4)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(5)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(6)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(7)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(0)<0.0);
-  ASSERT_NEAR(ctr.getFunction(jerkInit)(1), 0.0, Constant<TypeParam>::EPSILON);
-  ASSERT_NEAR(ctr.getFunction(jerkInit)(2), 0.0, Constant<TypeParam>::EPSILON);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(7)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(0)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(1)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(2)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(3)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(4)<0.0);
+  ASSERT_NEAR(ctr.getFunctionInf(jerkInit)(5), 0.0, Constant<TypeParam>::EPSILON);
+  ASSERT_NEAR(ctr.getFunctionInf(jerkInit)(6), 0.0, Constant<TypeParam>::EPSILON);
 
   jerkInit(0) = 0.0;
   jerkInit(1) = 0.0;
   jerkInit(2) = -6.0f*copLimitMax;
   jerkInit(3) = 0.0;
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(3)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(4)<0.0);
-  ASSERT_NEAR(ctr.getFunction(jerkInit)(5), 0.0, Constant<TypeParam>::EPSILON);
-  ASSERT_NEAR(ctr.getFunction(jerkInit)(6), 0.0, Constant<TypeParam>::EPSILON);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(7)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(0)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(1)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(2)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(7)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(0)<0.0);
+  ASSERT_NEAR(ctr.getFunctionInf(jerkInit)(1), 0.0, Constant<TypeParam>::EPSILON);
+  ASSERT_NEAR(ctr.getFunctionInf(jerkInit)(2), 0.0, Constant<TypeParam>::EPSILON);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(3)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(4)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(5)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(6)<0.0);
 
   jerkInit(0) = 0.0;
   jerkInit(1) = 0.0;
   jerkInit(2) = 0.0;
   jerkInit(3) = 6.0f*copLimitMax;
-  ASSERT_NEAR(ctr.getFunction(jerkInit)(3), 0.0, Constant<TypeParam>::EPSILON);
-  ASSERT_NEAR(ctr.getFunction(jerkInit)(4), 0.0, Constant<TypeParam>::EPSILON);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(5)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(6)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(7)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(0)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(1)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(2)<0.0);
+  ASSERT_NEAR(ctr.getFunctionInf(jerkInit)(7), 0.0, Constant<TypeParam>::EPSILON);
+  ASSERT_NEAR(ctr.getFunctionInf(jerkInit)(0), 0.0, Constant<TypeParam>::EPSILON);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(1)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(2)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(3)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(4)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(5)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(6)<0.0);
 
   jerkInit(0) = 0.0;
   jerkInit(1) = 0.0;
   jerkInit(2) = 0.0;
   jerkInit(3) = -6.0f*copLimitMax;
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(3)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(4)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(5)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(6)<0.0);
-  ASSERT_NEAR(ctr.getFunction(jerkInit)(7), 0.0, Constant<TypeParam>::EPSILON);
-  ASSERT_NEAR(ctr.getFunction(jerkInit)(0), 0.0, Constant<TypeParam>::EPSILON);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(1)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(2)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(7)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(0)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(1)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(2)<0.0);
+  ASSERT_NEAR(ctr.getFunctionInf(jerkInit)(3), 0.0, Constant<TypeParam>::EPSILON);
+  ASSERT_NEAR(ctr.getFunctionInf(jerkInit)(4), 0.0, Constant<TypeParam>::EPSILON);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(5)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(6)<0.0);
 
 }
 
@@ -126,6 +126,6 @@ TYPED_TEST(MpcWalkgenTest, sizeOfvalues)
 
   ASSERT_EQ(ctr.getGradient().rows(), nbSamples*M);
   ASSERT_EQ(ctr.getGradient().cols(), 4*nbSamples);
-  ASSERT_EQ(ctr.getFunction(jerkInit).rows(), nbSamples*M);
-  ASSERT_EQ(ctr.getFunction(jerkInit).cols(), 1);
+  ASSERT_EQ(ctr.getFunctionInf(jerkInit).rows(), nbSamples*M);
+  ASSERT_EQ(ctr.getFunctionInf(jerkInit).cols(), 1);
 }
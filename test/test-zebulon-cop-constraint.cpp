@@ -42,66 +42,66 @@ TYPED_TEST(MpcWalkgenTest, functionValue)
   jerkInit(1) = 0.0;
   jerkInit(2) = 0.0;
   jerkInit(3) = 0.0;
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(0)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(1)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(2)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(3)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(4)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(5)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(6)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(7)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(4)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(5)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(6)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(7)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(0)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(1)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(2)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(3)<0.0);
 
   jerkInit(0) = 0.0;
   jerkInit(1) = 0.0;
   jerkInit(2) = 6.0f*copLimitMax;
   jerkInit(3) = 0.0;
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(3)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(4)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(5)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(6)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(7)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(0)<0.0);
-  ASSERT_NEAR(ctr.getFunction(jerkInit)(1), 0.0, Constant<TypeParam>::EPSILON);
-  ASSERT_NEAR(ctr.getFunction(jerkInit)(2), 0.0, Constant<TypeParam>::EPSILON);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(7)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(0)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(1)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(2)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(3)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(4)<0.0);
+  ASSERT_NEAR(ctr.getFunctionInf(jerkInit)(5), 0.0, Constant<TypeParam>::EPSILON);
+  ASSERT_NEAR(ctr.getFunctionInf(jerkInit)(6), 0.0, Constant<TypeParam>::EPSILON);
 
   jerkInit(0) = 0.0;
   jerkInit(1) = 0.0;
   jerkInit(2) = -6.0f*copLimitMax;
   jerkInit(3) = 0.0;
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(3)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(4)<0.0);
-  ASSERT_NEAR(ctr.getFunction(jerkInit)(5), 0.0, Constant<TypeParam>::EPSILON);
-  ASSERT_NEAR(ctr.getFunction(jerkInit)(6), 0.0, Constant<TypeParam>::EPSILON);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(7)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(0)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(1)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(2)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(7)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(0)<0.0);
+  ASSERT_NEAR(ctr.getFunctionInf(jerkInit)(1), 0.0, Constant<TypeParam>::EPSILON);
+  ASSERT_NEAR(ctr.getFunctionInf(jerkInit)(2), 0.0, Constant<TypeParam>::EPSILON);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(3)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(4)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(5)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(6)<0.0);
 
   jerkInit(0) = 0.0;
   jerkInit(1) = 0.0;
   jerkInit(2) = 0.0;
   jerkInit(3) = 6.0f*copLimitMax;
-  ASSERT_NEAR(ctr.getFunction(jerkInit)(3), 0.0, Constant<TypeParam>::EPSILON);
-  ASSERT_NEAR(ctr.getFunction(jerkInit)(4), 0.0, Constant<TypeParam>::EPSILON);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(5)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(6)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(7)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(0)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(1)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(2)<0.0);
+  ASSERT_NEAR(ctr.getFunctionInf(jerkInit)(7), 0.0, Constant<TypeParam>::EPSILON);
+  ASSERT_NEAR(ctr.getFunctionInf(jerkInit)(0), 0.0, Constant<TypeParam>::EPSILON);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(1)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(2)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(3)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(4)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(5)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(6)<0.0);
 
   jerkInit(0) = 0.0;
   jerkInit(1) = 0.0;
   jerkInit(2) = 0.0;
   jerkInit(3) = -6.0f*copLimitMax;
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(3)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(4)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(5)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(6)<0.0);
-  ASSERT_NEAR(ctr.getFunction(jerkInit)(7), 0.0, Constant<TypeParam>::EPSILON);
-  ASSERT_NEAR(ctr.getFunction(jerkInit)(0), 0.0, Constant<TypeParam>::EPSILON);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(1)<0.0);
-  ASSERT_TRUE(ctr.getFunction(jerkInit)(2)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(7)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(0)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(1)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(2)<0.0);
+  ASSERT_NEAR(ctr.getFunctionInf(jerkInit)(3), 0.0, Constant<TypeParam>::EPSILON);
+  ASSERT_NEAR(ctr.getFunctionInf(jerkInit)(4), 0.0, Constant<TypeParam>::EPSILON);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(5)<0.0);
+  ASSERT_TRUE(ctr.getFunctionInf(jerkInit)(6)<0.0);
 
 }
 
@@ -127,6 +127,45 @@ TYPED_TEST(MpcWalkgenTest, sizeOfvalues)
 
   ASSERT_EQ(ctr.getGradient().rows(), nbSamples*M);
   ASSERT_EQ(ctr.getGradient().cols(), 4*nbSamples);
-  ASSERT_EQ(ctr.getFunction(jerkInit).rows(), nbSamples*M);
-  ASSERT_EQ(ctr.getFunction(jerkInit).cols(), 1);
+  ASSERT_EQ(ctr.getFunctionInf(jerkInit).rows(), nbSamples*M);
+  ASSERT_EQ(ctr.getFunctionInf(jerkInit).cols(), 1);
+}
+
+TYPED_TEST(MpcWalkgenTest, rectangularPolygonAsRangeRows)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam);
+
+  LIPModel<TypeParam> m1;
+  BaseModel<TypeParam> m2;
+
+  TypeParam copLimitX = 0.1f;
+  TypeParam copLimitY = 0.05f;
+
+  vectorOfVector2 p(4);
+  p[0] = Vector2(copLimitX, copLimitY);
+  p[1] = Vector2(-copLimitX, copLimitY);
+  p[2] = Vector2(-copLimitX, -copLimitY);
+  p[3] = Vector2(copLimitX, -copLimitY);
+  m2.setCopSupportConvexPolygon(ConvexPolygon<TypeParam>(p));
+
+  CopConstraint<TypeParam> ctr(m1, m2);
+  VectorX jerkInit(4);
+  jerkInit.fill(0.0);
+
+  // One range row per axis instead of one row per edge
+  ASSERT_EQ(ctr.getNbConstraints(), 2);
+  ASSERT_EQ(ctr.getGradient().rows(), 2);
+  ASSERT_NEAR(ctr.getFunctionInf(jerkInit)(0), -copLimitX, Constant<TypeParam>::EPSILON);
+  ASSERT_NEAR(ctr.getFunctionSup(jerkInit)(0), copLimitX, Constant<TypeParam>::EPSILON);
+  ASSERT_NEAR(ctr.getFunctionInf(jerkInit)(1), -copLimitY, Constant<TypeParam>::EPSILON);
+  ASSERT_NEAR(ctr.getFunctionSup(jerkInit)(1), copLimitY, Constant<TypeParam>::EPSILON);
+
+  // The X row only involves X variables
+  ASSERT_NEAR(ctr.getGradient()(0, 1), 0.0, Constant<TypeParam>::EPSILON);
+  ASSERT_NEAR(ctr.getGradient()(0, 3), 0.0, Constant<TypeParam>::EPSILON);
+
+  jerkInit(2) = 6.0f*copLimitX;
+  ASSERT_NEAR(ctr.getFunctionInf(jerkInit)(0), 0.0, Constant<TypeParam>::EPSILON);
+  ASSERT_NEAR(ctr.getFunctionSup(jerkInit)(0), 2*copLimitX, Constant<TypeParam>::EPSILON);
 }
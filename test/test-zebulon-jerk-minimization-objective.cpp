@@ -11,6 +11,7 @@
 #include <mpc-walkgen/model/zebulon_base_model.h>
 #include <mpc-walkgen/model/lip_model.h>
 #include <mpc-walkgen/function/zebulon_jerk_minimization_objective.h>
+#include <cmath>
 
 TYPED_TEST(MpcWalkgenTest, functionValue)
 {
@@ -25,7 +26,7 @@ TYPED_TEST(MpcWalkgenTest, functionValue)
   jerkInit.fill(1.0);
 
   ASSERT_EQ(obj.getGradient(jerkInit), jerkInit);
-  ASSERT_EQ(obj.getHessian(), MatrixX::Identity(4, 4));
+  ASSERT_EQ(obj.getHessian().toDense(), MatrixX::Identity(4, 4));
 }
 
 
@@ -49,3 +50,35 @@ TYPED_TEST(MpcWalkgenTest, sizeOfvalues)
   ASSERT_EQ(obj.getGradient(jerkInit).rows(), 4*nbSamples);
   ASSERT_EQ(obj.getGradient(jerkInit).cols(), 1);
 }
+
+TYPED_TEST(MpcWalkgenTest, periodWeighting)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam)
+
+  // The samples last 0.1, 0.2 and 0.2, so that they weigh 1, 2 and 2
+  const int nbSamples = 3;
+  VectorX samplingPeriods(2);
+  samplingPeriods << 0.1f, 0.2f;
+  BaseModel<TypeParam> m(nbSamples, 0.1f, true);
+  LIPModel<TypeParam> l(nbSamples, 0.1f, true);
+  m.setSamplingPeriods(samplingPeriods);
+  l.setSamplingPeriods(samplingPeriods);
+  m.setPeriodWeighting(true);
+  l.setPeriodWeighting(true);
+  JerkMinimizationObjective<TypeParam> obj(l, m);
+
+  VectorX weights(4*nbSamples);
+  for(int i=0; i<4; ++i)
+  {
+    weights.segment(i*nbSamples, nbSamples) << 1.0f, 2.0f, 2.0f;
+  }
+  ASSERT_TRUE(obj.getHessian().toDense().isApprox(MatrixX(weights.asDiagonal())));
+
+  VectorX jerkInit(4*nbSamples);
+  for(int k=0; k<4*nbSamples; ++k)
+  {
+    jerkInit(k) = std::sin(static_cast<TypeParam>(k));
+  }
+  ASSERT_TRUE(obj.getGradient(jerkInit).isApprox(weights.cwiseProduct(jerkInit)));
+}
@@ -0,0 +1,528 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+///\file test-zebulon-walkgen.cpp
+///\brief Test the zebulon walkgen solves
+///\author Barthelemy Sebastien
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mpc_walkgen_gtest.h"
+#include <mpc-walkgen/zebulon_walkgen.h>
+#include <algorithm>
+#include <Eigen/Geometry>
+#include <boost/thread/thread.hpp>
+
+template <typename Scalar>
+void setupWalkgen(MPCWalkgen::ZebulonWalkgen<Scalar>& walkgen,
+                  const MPCWalkgen::ZebulonWalkgenConfig<Scalar>& config,
+                  Scalar hullAngle = 0)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(Scalar)
+
+  walkgen.setNbSamples(10);
+  walkgen.setSamplingPeriod(0.1f);
+  walkgen.setComBodyHeight(0.73f);
+  walkgen.setComBaseHeight(0.13f);
+  walkgen.setBodyMass(13.5f);
+  walkgen.setBaseMass(16.5f);
+
+  vectorOfVector3 p(4);
+  p[0] = Vector3(0.1f, 0.1f, 0.0f);
+  p[1] = Vector3(-0.1f, 0.1f, 0.0f);
+  p[2] = Vector3(-0.1f, -0.1f, 0.0f);
+  p[3] = Vector3(0.1f, -0.1f, 0.0f);
+  const Eigen::AngleAxis<Scalar> rotation(hullAngle, Vector3::UnitZ());
+  for(int i=0; i<4; ++i)
+  {
+    p[i] = rotation*p[i];
+  }
+  walkgen.setBaseCopHull(p);
+  walkgen.setBaseComHull(p);
+
+  ZebulonWalkgenWeighting<Scalar> weighting;
+  weighting.velocityTracking = 1.0f;
+  weighting.jerkMinimization = 0.001f;
+  weighting.copCentering = 0.1f;
+  weighting.comCentering = 0.1f;
+  walkgen.setWeightings(weighting);
+  walkgen.setConfig(config);
+}
+
+template <typename Scalar>
+void setReferences(MPCWalkgen::ZebulonWalkgen<Scalar>& walkgen,
+                   Scalar velRefX, Scalar velRefY)
+{
+  typedef typename MPCWalkgen::Type<Scalar>::VectorX VectorX;
+
+  const int nbSamples = walkgen.getNbSamples();
+  VectorX velRef(2*nbSamples);
+  velRef.head(nbSamples).fill(velRefX);
+  velRef.tail(nbSamples).fill(velRefY);
+  walkgen.setVelRefInWorldFrame(velRef);
+  walkgen.setPosRefInWorldFrame(VectorX::Zero(2*nbSamples));
+  walkgen.setCopRefInLocalFrame(VectorX::Zero(2*nbSamples));
+  walkgen.setComRefInLocalFrame(VectorX::Zero(2*nbSamples));
+}
+
+template <typename Scalar>
+bool haveSameStates(const MPCWalkgen::ZebulonWalkgen<Scalar>& walkgen1,
+                    const MPCWalkgen::ZebulonWalkgen<Scalar>& walkgen2,
+                    Scalar precision)
+{
+  return (walkgen1.getBaseStateX() - walkgen2.getBaseStateX()).cwiseAbs().maxCoeff()<precision &&
+      (walkgen1.getBaseStateY() - walkgen2.getBaseStateY()).cwiseAbs().maxCoeff()<precision &&
+      (walkgen1.getComStateX() - walkgen2.getComStateX()).cwiseAbs().maxCoeff()<precision &&
+      (walkgen1.getComStateY() - walkgen2.getComStateY()).cwiseAbs().maxCoeff()<precision;
+}
+
+TYPED_TEST(MpcWalkgenTest, zebulonWarmStartShift)
+{
+  using namespace MPCWalkgen;
+
+  ZebulonWalkgenConfig<TypeParam> config;
+  config.withCopConstraints = true;
+  config.withComConstraints = true;
+  ZebulonWalkgen<TypeParam> unshifted;
+  setupWalkgen(unshifted, config);
+  config.withWarmStartShift = true;
+  ZebulonWalkgen<TypeParam> shifted;
+  setupWalkgen(shifted, config);
+
+  // One sampling period elapses between solves, so the warm start is
+  // shifted before each of them
+  const TypeParam feedBackPeriod = static_cast<TypeParam>(0.1);
+  int nbUnshiftedIterations = 0;
+  int nbShiftedIterations = 0;
+  for(int i=0; i<20; ++i)
+  {
+    const TypeParam velRef = static_cast<TypeParam>(i<10 ? 0.2 : -0.1);
+    setReferences(unshifted, velRef, velRef);
+    setReferences(shifted, velRef, velRef);
+    ASSERT_TRUE(unshifted.solve(feedBackPeriod));
+    ASSERT_TRUE(shifted.solve(feedBackPeriod));
+    ASSERT_TRUE(haveSameStates(shifted, unshifted, static_cast<TypeParam>(1e-3)));
+    nbUnshiftedIterations += unshifted.getNbIterations();
+    nbShiftedIterations += shifted.getNbIterations();
+  }
+  ASSERT_LE(nbShiftedIterations, nbUnshiftedIterations);
+}
+
+TYPED_TEST(MpcWalkgenTest, zebulonAxisSplit)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam)
+
+  // With square support polygons aligned with the axes, the QP is split in
+  // one QP per axis. Rotated, the polygons couple the axes, and the whole
+  // QP is solved. As all the objectives are isotropic, the solution of the
+  // rotated problem is the rotated solution of the aligned one.
+  const TypeParam angle = static_cast<TypeParam>(0.5);
+  const Eigen::Rotation2D<TypeParam> rotation(angle);
+
+  ZebulonWalkgenConfig<TypeParam> config;
+  config.withCopConstraints = true;
+  config.withComConstraints = true;
+  ZebulonWalkgen<TypeParam> aligned;
+  setupWalkgen(aligned, config);
+  ZebulonWalkgen<TypeParam> rotated;
+  setupWalkgen(rotated, config, angle);
+  config.withParallelAxisSolve = true;
+  ZebulonWalkgen<TypeParam> parallel;
+  setupWalkgen(parallel, config);
+
+  const TypeParam feedBackPeriod = static_cast<TypeParam>(0.02);
+  for(int i=0; i<20; ++i)
+  {
+    // A step of the reference, for which the CoP reaches its bounds
+    const Vector2 velRef(i<10 ? 1.0f : 0.0f, i<10 ? 0.3f : -0.5f);
+    const Vector2 rotatedVelRef = rotation*velRef;
+    setReferences(aligned, velRef(0), velRef(1));
+    setReferences(rotated, rotatedVelRef(0), rotatedVelRef(1));
+    setReferences(parallel, velRef(0), velRef(1));
+    ASSERT_TRUE(aligned.solve(feedBackPeriod));
+    ASSERT_TRUE(rotated.solve(feedBackPeriod));
+    ASSERT_TRUE(parallel.solve(feedBackPeriod));
+
+    ASSERT_TRUE(haveSameStates(parallel, aligned, static_cast<TypeParam>(1e-5)));
+
+    Vector2 position(aligned.getBaseStateX()(0), aligned.getBaseStateY()(0));
+    Vector2 rotatedPosition(rotated.getBaseStateX()(0), rotated.getBaseStateY()(0));
+    ASSERT_TRUE(((rotation*position) - rotatedPosition).norm()<1e-3);
+    position = Vector2(aligned.getComStateX()(2), aligned.getComStateY()(2));
+    rotatedPosition = Vector2(rotated.getComStateX()(2), rotated.getComStateY()(2));
+    ASSERT_TRUE(((rotation*position) - rotatedPosition).norm()<1e-3);
+  }
+}
+
+TYPED_TEST(MpcWalkgenTest, zebulonStalePreset)
+{
+  using namespace MPCWalkgen;
+
+  ZebulonWalkgenConfig<TypeParam> config;
+  config.withCopConstraints = true;
+  config.withComConstraints = true;
+  ZebulonWalkgenWeighting<TypeParam> weighting;
+  weighting.velocityTracking = 1.0f;
+  weighting.positionTracking = 1.0f;
+  weighting.jerkMinimization = 0.001f;
+
+  // The preset is added before the change of the models, and is only
+  // computed again when it is selected
+  ZebulonWalkgen<TypeParam> changed;
+  setupWalkgen(changed, config);
+  changed.addPreset("tracking", weighting, config);
+  changed.setSamplingPeriod(static_cast<TypeParam>(0.15));
+  changed.setBodyMass(static_cast<TypeParam>(15.0));
+  changed.selectPreset("tracking");
+
+  ZebulonWalkgen<TypeParam> fresh;
+  setupWalkgen(fresh, config);
+  fresh.setSamplingPeriod(static_cast<TypeParam>(0.15));
+  fresh.setBodyMass(static_cast<TypeParam>(15.0));
+  fresh.addPreset("tracking", weighting, config);
+  fresh.selectPreset("tracking");
+
+  for(int i=0; i<10; ++i)
+  {
+    setReferences(changed, static_cast<TypeParam>(0.2), static_cast<TypeParam>(-0.1));
+    setReferences(fresh, static_cast<TypeParam>(0.2), static_cast<TypeParam>(-0.1));
+    ASSERT_TRUE(changed.solve(static_cast<TypeParam>(0.02)));
+    ASSERT_TRUE(fresh.solve(static_cast<TypeParam>(0.02)));
+    ASSERT_TRUE(haveSameStates(changed, fresh, static_cast<TypeParam>(1e-5)));
+  }
+}
+
+template <typename Scalar>
+void solveUntilSwappedIn(MPCWalkgen::ZebulonWalkgen<Scalar>& background,
+                         MPCWalkgen::ZebulonWalkgen<Scalar>& synchronous,
+                         int nbSamples)
+{
+  typedef typename MPCWalkgen::Type<Scalar>::Vector3 Vector3;
+
+  const Scalar feedBackPeriod = static_cast<Scalar>(0.02);
+  Vector3 baseStateX;
+  Vector3 baseStateY;
+  Vector3 comStateX;
+  Vector3 comStateY;
+  for(int i=0; i<1000; ++i)
+  {
+    baseStateX = background.getBaseStateX();
+    baseStateY = background.getBaseStateY();
+    comStateX = background.getComStateX();
+    comStateY = background.getComStateY();
+    setReferences(background, static_cast<Scalar>(0.2), static_cast<Scalar>(-0.1));
+    ASSERT_TRUE(background.solve(feedBackPeriod));
+    if (background.getNbSamples()==nbSamples)
+    {
+      break;
+    }
+    boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+  }
+  ASSERT_EQ(background.getNbSamples(), nbSamples);
+
+  // The first solve of the new problem gives the synchronous solution. Its
+  // references were reset, as they had the size of the previous problem
+  synchronous.setBaseStateX(baseStateX);
+  synchronous.setBaseStateY(baseStateY);
+  synchronous.setComStateX(comStateX);
+  synchronous.setComStateY(comStateY);
+  setReferences(synchronous, static_cast<Scalar>(0), static_cast<Scalar>(0));
+  ASSERT_TRUE(synchronous.solve(feedBackPeriod));
+  ASSERT_TRUE(haveSameStates(background, synchronous, static_cast<Scalar>(1e-5)));
+}
+
+TYPED_TEST(MpcWalkgenTest, zebulonBackgroundConstantPart)
+{
+  using namespace MPCWalkgen;
+
+  ZebulonWalkgenConfig<TypeParam> config;
+  config.withCopConstraints = true;
+  config.withComConstraints = true;
+  ZebulonWalkgen<TypeParam> synchronous;
+  setupWalkgen(synchronous, config);
+  config.withBackgroundConstantPart = true;
+  ZebulonWalkgen<TypeParam> background;
+  setupWalkgen(background, config);
+  config.withBackgroundConstantPart = false;
+
+  ZebulonWalkgenWeighting<TypeParam> weighting;
+  weighting.velocityTracking = 2.0f;
+  weighting.jerkMinimization = 0.01f;
+  weighting.copCentering = 0.1f;
+
+  // The weightings change while the new number of samples is computed in
+  // the background, and their QP is computed by a follow-up job
+  synchronous.setNbSamples(12);
+  synchronous.setWeightings(weighting);
+  background.setNbSamples(12);
+  background.setWeightings(weighting);
+  solveUntilSwappedIn(background, synchronous, 12);
+
+  // So is a preset added during the job
+  weighting.positionTracking = 1.0f;
+  synchronous.setNbSamples(8);
+  synchronous.addPreset("tracking", weighting, config);
+  synchronous.selectPreset("tracking");
+  config.withBackgroundConstantPart = true;
+  background.setNbSamples(8);
+  background.addPreset("tracking", weighting, config);
+  background.selectPreset("tracking");
+  solveUntilSwappedIn(background, synchronous, 8);
+}
+
+TYPED_TEST(MpcWalkgenTest, zebulonPrediction)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam)
+
+  const bool isDouble = sizeof(TypeParam)==sizeof(double);
+  const TypeParam precision = static_cast<TypeParam>(isDouble ? 1e-6 : 1e-3);
+  const int nbSamples = 10;
+  const TypeParam samplingPeriod = 0.1f;
+
+  ZebulonWalkgenConfig<TypeParam> config;
+  config.withCopConstraints = true;
+  config.withComConstraints = true;
+  ZebulonWalkgen<TypeParam> walkgen;
+  setupWalkgen(walkgen, config);
+  setReferences(walkgen, static_cast<TypeParam>(0.2), static_cast<TypeParam>(0.1));
+
+  // Same models as the walkgen
+  LIPModel<TypeParam> lipModel(nbSamples, samplingPeriod, true);
+  lipModel.setComHeight(0.73f);
+  lipModel.setTotalMass(30.0f);
+  lipModel.setMass(13.5f);
+  BaseModel<TypeParam> baseModel(nbSamples, samplingPeriod, true);
+  baseModel.setComHeight(0.13f);
+  baseModel.setTotalMass(30.0f);
+  baseModel.setMass(16.5f);
+
+  VectorX comX, comY, baseX, baseY, copX, copY, tiltX, tiltY;
+  for(int i=0; i<5; ++i)
+  {
+    const Vector3 states[4] = {walkgen.getComStateX(), walkgen.getComStateY(),
+                               walkgen.getBaseStateX(), walkgen.getBaseStateY()};
+
+    // One sampling period elapses during the solve, so that the state
+    // reaches the first predicted sample
+    ASSERT_TRUE(walkgen.solve(samplingPeriod));
+    walkgen.getPredictedComPosition(comX, comY);
+    walkgen.getPredictedBasePosition(baseX, baseY);
+    walkgen.getPredictedCopPosition(copX, copY);
+    walkgen.getPredictedTiltAngle(tiltX, tiltY);
+    ASSERT_EQ(comX.size(), nbSamples);
+    ASSERT_EQ(baseY.size(), nbSamples);
+    ASSERT_EQ(copX.size(), nbSamples);
+    ASSERT_EQ(tiltY.size(), nbSamples);
+
+    const VectorX* positions[4] = {&comX, &comY, &baseX, &baseY};
+    const Vector3 reached[4] = {walkgen.getComStateX(), walkgen.getComStateY(),
+                                walkgen.getBaseStateX(), walkgen.getBaseStateY()};
+    const LinearDynamic<TypeParam>* dynamics[4] = {
+      &lipModel.getComPosLinearDynamic(), &lipModel.getComPosLinearDynamic(),
+      &baseModel.getBasePosLinearDynamic(), &baseModel.getBasePosLinearDynamic()};
+    VectorX jerks[4];
+    for(int j=0; j<4; ++j)
+    {
+      ASSERT_NEAR((*positions[j])(0), reached[j](0), precision);
+
+      // The positions are S.x0 + U.X, whose jerks X give the reached
+      // acceleration
+      const VectorX rhs = *positions[j] - dynamics[j]->S*states[j];
+      jerks[j] = dynamics[j]->U.fullPivLu().solve(rhs);
+      ASSERT_NEAR(states[j](2) + jerks[j](0)*samplingPeriod, reached[j](2),
+                  10*precision);
+    }
+
+    // The CoP follows from the same jerks
+    const LinearDynamic<TypeParam>& copXCom = lipModel.getCopXLinearDynamic();
+    const LinearDynamic<TypeParam>& copXBase = baseModel.getCopXLinearDynamic();
+    const VectorX expectedCopX = copXCom.U*jerks[0] + copXCom.S*states[0] + copXCom.K +
+        copXBase.U*jerks[2] + copXBase.S*states[2] + copXBase.K;
+    const LinearDynamic<TypeParam>& copYCom = lipModel.getCopYLinearDynamic();
+    const LinearDynamic<TypeParam>& copYBase = baseModel.getCopYLinearDynamic();
+    const VectorX expectedCopY = copYCom.U*jerks[1] + copYCom.S*states[1] + copYCom.K +
+        copYBase.U*jerks[3] + copYBase.S*states[3] + copYBase.K;
+    ASSERT_TRUE((copX - expectedCopX).cwiseAbs().maxCoeff()<10*precision);
+    ASSERT_TRUE((copY - expectedCopY).cwiseAbs().maxCoeff()<10*precision);
+
+    // The trajectories are computed once per solve
+    VectorX comX2, comY2;
+    walkgen.getPredictedComPosition(comX2, comY2);
+    ASSERT_TRUE(comX2==comX);
+    ASSERT_TRUE(comY2==comY);
+  }
+}
+
+template <typename Scalar>
+void copyStates(const MPCWalkgen::ZebulonWalkgen<Scalar>& from,
+                MPCWalkgen::ZebulonWalkgen<Scalar>& to)
+{
+  to.setComStateX(from.getComStateX());
+  to.setComStateY(from.getComStateY());
+  to.setBaseStateX(from.getBaseStateX());
+  to.setBaseStateY(from.getBaseStateY());
+}
+
+/// \brief Reference whose first 8 samples differ, and are then constant, so
+///        that it is the same once resized as a reserved number of samples
+///        does: truncated, or extended by its last sample
+template <typename Scalar>
+typename MPCWalkgen::Type<Scalar>::VectorX rampReference(int nbSamples)
+{
+  typename MPCWalkgen::Type<Scalar>::VectorX ref(2*nbSamples);
+  for(int i=0; i<nbSamples; ++i)
+  {
+    ref(i) = static_cast<Scalar>(0.02*std::min(i, 7));
+    ref(nbSamples + i) = -ref(i);
+  }
+  return ref;
+}
+
+TYPED_TEST(MpcWalkgenTest, zebulonReservedSamples)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam)
+
+  ZebulonWalkgenConfig<TypeParam> config;
+  config.withCopConstraints = true;
+  config.withComConstraints = true;
+  ZebulonWalkgen<TypeParam> walkgen;
+  setupWalkgen(walkgen, config);
+  walkgen.reserveMaxSamples(12);
+  setReferences(walkgen, TypeParam(0), TypeParam(0));
+  walkgen.setVelRefInWorldFrame(rampReference<TypeParam>(10));
+  for(int i=0; i<3; ++i)
+  {
+    ASSERT_TRUE(walkgen.solve(0.02f));
+  }
+
+  // The QP constant parts of the reserved numbers of samples are computed
+  // again with the new model right away, and the references are carried
+  // over when they are swapped in
+  walkgen.setBodyMass(14.0f);
+  const int nbSamples[2] = {8, 12};
+  for(int k=0; k<2; ++k)
+  {
+    walkgen.setNbSamples(nbSamples[k]);
+    ASSERT_EQ(walkgen.getNbSamples(), nbSamples[k]);
+
+    ZebulonWalkgen<TypeParam> fresh;
+    setupWalkgen(fresh, config);
+    fresh.setNbSamples(nbSamples[k]);
+    fresh.setBodyMass(14.0f);
+    setReferences(fresh, TypeParam(0), TypeParam(0));
+    fresh.setVelRefInWorldFrame(rampReference<TypeParam>(nbSamples[k]));
+    copyStates(walkgen, fresh);
+
+    for(int i=0; i<3; ++i)
+    {
+      ASSERT_TRUE(walkgen.solve(0.02f));
+      ASSERT_TRUE(fresh.solve(0.02f));
+      ASSERT_TRUE(haveSameStates(walkgen, fresh, static_cast<TypeParam>(1e-3)));
+    }
+  }
+}
+
+TYPED_TEST(MpcWalkgenTest, zebulonReservedSamplesYaw)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam)
+
+  ZebulonWalkgenConfig<TypeParam> config;
+  config.withCopConstraints = true;
+  config.withTiltMotionConstraints = true;
+  ZebulonWalkgen<TypeParam> walkgen;
+  setupWalkgen(walkgen, config);
+  walkgen.reserveMaxSamples(12);
+  walkgen.setNbSamples(8);
+  setReferences(walkgen, static_cast<TypeParam>(0.2), static_cast<TypeParam>(0.1));
+  for(int i=0; i<3; ++i)
+  {
+    ASSERT_TRUE(walkgen.solve(0.02f));
+  }
+
+  // The yaw and the references pushed with fewer samples than reserved are
+  // used by the other reserved numbers of samples as well
+  const Vector3 yaw(0.3f, 0.0f, 0.0f);
+  walkgen.setBaseStateYaw(yaw);
+  walkgen.pushVelRefInWorldFrame(Vector2(0.2f, 0.1f));
+  walkgen.setNbSamples(12);
+
+  ZebulonWalkgen<TypeParam> fresh;
+  fresh.setBaseStateYaw(yaw);
+  setupWalkgen(fresh, config);
+  fresh.setNbSamples(12);
+  setReferences(fresh, static_cast<TypeParam>(0.2), static_cast<TypeParam>(0.1));
+  copyStates(walkgen, fresh);
+
+  for(int i=0; i<3; ++i)
+  {
+    ASSERT_TRUE(walkgen.solve(0.02f));
+    ASSERT_TRUE(fresh.solve(0.02f));
+    ASSERT_TRUE(haveSameStates(walkgen, fresh, static_cast<TypeParam>(1e-3)));
+  }
+}
+
+TYPED_TEST(MpcWalkgenTest, zebulonBaseStateYaw)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam)
+
+  ZebulonWalkgenConfig<TypeParam> config;
+  config.withCopConstraints = true;
+  config.withTiltMotionConstraints = true;
+
+  // The yaw couples the axes, so the rows of the tilt motion constraint are
+  // updated in place when it changes
+  ZebulonWalkgen<TypeParam> walkgen;
+  walkgen.setBaseStateYaw(Vector3(0.1f, 0.0f, 0.0f));
+  setupWalkgen(walkgen, config);
+  walkgen.addPreset("other", ZebulonWalkgenWeighting<TypeParam>(), config);
+  setReferences(walkgen, static_cast<TypeParam>(0.2), static_cast<TypeParam>(0.1));
+  for(int i=0; i<3; ++i)
+  {
+    ASSERT_TRUE(walkgen.solve(0.02f));
+  }
+  const Vector3 yaw(0.3f, 0.0f, 0.0f);
+  walkgen.setBaseStateYaw(yaw);
+
+  ZebulonWalkgen<TypeParam> fresh;
+  fresh.setBaseStateYaw(yaw);
+  setupWalkgen(fresh, config);
+  setReferences(fresh, static_cast<TypeParam>(0.2), static_cast<TypeParam>(0.1));
+  copyStates(walkgen, fresh);
+
+  for(int i=0; i<3; ++i)
+  {
+    ASSERT_TRUE(walkgen.solve(0.02f));
+    ASSERT_TRUE(fresh.solve(0.02f));
+    ASSERT_TRUE(haveSameStates(walkgen, fresh, static_cast<TypeParam>(1e-3)));
+  }
+}
+
+TYPED_TEST(MpcWalkgenTest, zebulonSetStates)
+{
+  using namespace MPCWalkgen;
+  TEMPLATE_TYPEDEF(TypeParam)
+
+  ZebulonWalkgen<TypeParam> walkgen;
+
+  // The states can be given as VectorX, Vector3 or any expression of size 3
+  VectorX comStateX(3);
+  comStateX << 0.1f, -0.2f, 0.3f;
+  walkgen.setComStateX(comStateX);
+  ASSERT_TRUE(walkgen.getComStateX() == comStateX);
+
+  const Vector3 comStateY(-0.4f, 0.5f, -0.6f);
+  walkgen.setComStateY(comStateY);
+  ASSERT_TRUE(walkgen.getComStateY() == comStateY);
+
+  VectorX states(6);
+  states << 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f;
+  walkgen.setBaseStateX(states.head(3));
+  walkgen.setBaseStateY(states.tail(3) - states.head(3));
+  ASSERT_TRUE(walkgen.getBaseStateX() == states.head(3));
+  ASSERT_TRUE(walkgen.getBaseStateY() == Vector3(3.0f, 3.0f, 3.0f));
+}
@@ -34,20 +34,7 @@ void updatePsi(ZebulonWalkgen<Real>& walkgen, Type<Real>::VectorX& psi)
   if (psi(0)>=0.0 || touch){
     psi.fill(0.0);
     touch = true;
-    ZebulonWalkgenWeighting<Real> weighting;
-    weighting.copCentering = 10.0;
-    weighting.comCentering = 100.0;
-    weighting.velocityTracking = 10.0;
-    weighting.positionTracking = 0.0;
-    weighting.jerkMinimization = 0.00001;
-    weighting.tiltMinimization = 0.0;
-    weighting.tiltVelMinimization = 0.0;
-    walkgen.setWeightings(weighting);
-    ZebulonWalkgenConfig<Real> config;
-    config.withBaseMotionConstraints = false;
-    config.withComConstraints = false;
-    config.withCopConstraints = true;
-    walkgen.setConfig(config);
+    walkgen.selectPreset("landing");
   }
 
 }
@@ -106,6 +93,27 @@ int main(void)
   config.withCopConstraints = true;
   walkgen.setConfig(config);
 
+  // Weightings and configs used at the end of the tilt and when the robot
+  // touches the ground again, switched to without recomputing the QP
+  ZebulonWalkgenWeighting<Real> tiltRecoveryWeighting;
+  tiltRecoveryWeighting.copCentering = 0.0;
+  tiltRecoveryWeighting.comCentering = 100.0;
+  tiltRecoveryWeighting.velocityTracking = 0.001;
+  tiltRecoveryWeighting.positionTracking = 0.0;
+  tiltRecoveryWeighting.jerkMinimization = 0.001;
+  tiltRecoveryWeighting.tiltMinimization = 10.0;
+  tiltRecoveryWeighting.tiltVelMinimization = 10.0;
+  ZebulonWalkgenConfig<Real> tiltRecoveryConfig;
+  tiltRecoveryConfig.withBaseMotionConstraints = false;
+  tiltRecoveryConfig.withComConstraints = false;
+  tiltRecoveryConfig.withCopConstraints = false;
+
+  ZebulonWalkgenWeighting<Real> landingWeighting = weighting;
+  landingWeighting.velocityTracking = 10.0;
+
+  walkgen.addPreset("tiltRecovery", tiltRecoveryWeighting, tiltRecoveryConfig);
+  walkgen.addPreset("landing", landingWeighting, config);
+
   Type<Real>::VectorX velRef(2*nbSamples);
   velRef.segment(0, nbSamples).fill(0.0);
   velRef.segment(nbSamples, nbSamples).fill(0.0);
@@ -178,20 +186,7 @@ int main(void)
     }
     if (t>=5.22f && t<5.24f){
       std::cout << "!!!!!!!!!!!!!!!!!! end TILT !!!!!!!!!!!!!!!!" << std::endl;
-      ZebulonWalkgenWeighting<Real> weighting;
-      weighting.copCentering = 0.0;
-      weighting.comCentering = 100.0;
-      weighting.velocityTracking = 0.001;
-      weighting.positionTracking = 0.0;
-      weighting.jerkMinimization = 0.001;
-      weighting.tiltMinimization = 10.0;
-      weighting.tiltVelMinimization = 10.0;
-      walkgen.setWeightings(weighting);
-      ZebulonWalkgenConfig<Real> config;
-      config.withBaseMotionConstraints = false;
-      config.withComConstraints = false;
-      config.withCopConstraints = false;
-      walkgen.setConfig(config);
+      walkgen.selectPreset("tiltRecovery");
     }
 
 